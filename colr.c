@@ -32,6 +32,55 @@
 */
 int colr_printf_esc_mod = 0;
 
+/*! The global compiled-regex cache, used by colr_re_cache_acquire().
+    Use colr_re_cache_set_capacity() to change it's size.
+*/
+ColrRegexCache colr_re_cache = {
+    .lock=PTHREAD_MUTEX_INITIALIZER,
+    .head=NULL,
+    .tail=NULL,
+    .stats={.hits=0, .misses=0, .count=0, .capacity=COLR_RE_CACHE_SIZE},
+};
+
+/*! The global terminal-size cache, used by colr_term_size().
+    Use colr_term_size_invalidate() or colr_term_size_watch() to refresh it.
+*/
+ColrTermSizeCache colr_term_size_cache = {
+    .fd=0,
+    .size=0,
+    .stale=true,
+    .watching=false,
+};
+
+/*! The global terminal-capability cache, used by colr_term_caps().
+    It is filled in once, by colr_term_caps_init().
+*/
+ColrTermCapsCache colr_term_caps_cache = {
+    .once=PTHREAD_ONCE_INIT,
+    .caps={.depth=DEPTH_BASIC, .is_tty=false, .disabled=false},
+};
+
+/*! Whether colors are disabled for the whole process.
+    Use colr_set_disabled() or colr_set_disabled_auto() to change it.
+
+    \details
+    This is `true` by default when ColrC is compiled with COLR_DISABLE.
+*/
+#ifdef COLR_DISABLE
+atomic_bool colr_disabled = true;
+#else
+atomic_bool colr_disabled = false;
+#endif
+
+/*! The empty ColorArg that fore(), back(), and style() use when ColrC is
+    compiled with COLR_DISABLE. It is never freed by ColorArg_free().
+*/
+ColorArg colr_disabled_arg = {
+    .marker=COLORARG_MARKER,
+    .type=ARGTYPE_NONE,
+    .value={.type=TYPE_NONE},
+};
+
 //! An array of BasicInfo items, used with BasicValue_from_str().
 const BasicInfo basic_names[] = {
     {"reset", RESET},
@@ -789,6 +838,915 @@ const ColorNameData colr_name_data[] = {
 //! Length of colr_name_data.
 const size_t colr_name_data_len = sizeof(colr_name_data) / sizeof(colr_name_data[0]);
 
+/*! An array of ColrSgrInfo, where the index is the SGR parameter.
+    Parameters that aren't listed are `SGR_UNKNOWN`.
+*/
+const ColrSgrInfo colr_sgr_info[] = {
+    // Styles.
+    [0] = {SGR_STYLE, RESET_ALL},
+    [1] = {SGR_STYLE, BRIGHT},
+    [2] = {SGR_STYLE, DIM},
+    [3] = {SGR_STYLE, ITALIC},
+    [4] = {SGR_STYLE, UNDERLINE},
+    [5] = {SGR_STYLE, FLASH},
+    [6] = {SGR_STYLE, 6},
+    [7] = {SGR_STYLE, HIGHLIGHT},
+    [8] = {SGR_STYLE, 8},
+    [9] = {SGR_STYLE, STRIKETHRU},
+    [22] = {SGR_STYLE, NORMAL},
+    // Basic fore colors.
+    [30] = {SGR_FORE_BASIC, BLACK},
+    [31] = {SGR_FORE_BASIC, RED},
+    [32] = {SGR_FORE_BASIC, GREEN},
+    [33] = {SGR_FORE_BASIC, YELLOW},
+    [34] = {SGR_FORE_BASIC, BLUE},
+    [35] = {SGR_FORE_BASIC, MAGENTA},
+    [36] = {SGR_FORE_BASIC, CYAN},
+    [37] = {SGR_FORE_BASIC, WHITE},
+    [38] = {SGR_FORE_EXT, 0},
+    [39] = {SGR_FORE_BASIC, RESET},
+    // Basic back colors.
+    [40] = {SGR_BACK_BASIC, BLACK},
+    [41] = {SGR_BACK_BASIC, RED},
+    [42] = {SGR_BACK_BASIC, GREEN},
+    [43] = {SGR_BACK_BASIC, YELLOW},
+    [44] = {SGR_BACK_BASIC, BLUE},
+    [45] = {SGR_BACK_BASIC, MAGENTA},
+    [46] = {SGR_BACK_BASIC, CYAN},
+    [47] = {SGR_BACK_BASIC, WHITE},
+    [48] = {SGR_BACK_EXT, 0},
+    [49] = {SGR_BACK_BASIC, RESET},
+    // Styles that may not be supported.
+    [51] = {SGR_STYLE, FRAME},
+    [52] = {SGR_STYLE, ENCIRCLE},
+    [53] = {SGR_STYLE, OVERLINE},
+    [58] = {SGR_UNDERLINE_EXT, 0},
+    // Bright fore colors.
+    [90] = {SGR_FORE_BASIC, LIGHTBLACK},
+    [91] = {SGR_FORE_BASIC, LIGHTRED},
+    [92] = {SGR_FORE_BASIC, LIGHTGREEN},
+    [93] = {SGR_FORE_BASIC, LIGHTYELLOW},
+    [94] = {SGR_FORE_BASIC, LIGHTBLUE},
+    [95] = {SGR_FORE_BASIC, LIGHTMAGENTA},
+    [96] = {SGR_FORE_BASIC, LIGHTCYAN},
+    [97] = {SGR_FORE_BASIC, LIGHTWHITE},
+    // Bright back colors.
+    [100] = {SGR_BACK_BASIC, LIGHTBLACK},
+    [101] = {SGR_BACK_BASIC, LIGHTRED},
+    [102] = {SGR_BACK_BASIC, LIGHTGREEN},
+    [103] = {SGR_BACK_BASIC, LIGHTYELLOW},
+    [104] = {SGR_BACK_BASIC, LIGHTBLUE},
+    [105] = {SGR_BACK_BASIC, LIGHTMAGENTA},
+    [106] = {SGR_BACK_BASIC, LIGHTCYAN},
+    [107] = {SGR_BACK_BASIC, LIGHTWHITE},
+};
+
+//! Length of colr_sgr_info.
+const size_t colr_sgr_info_len = sizeof(colr_sgr_info) / sizeof(colr_sgr_info[0]);
+
+// Generated by tools/gen_width_table.py (Unicode 14.0.0).
+/*! Stage 1 of the display-width table, used by colr_codepoint_width().
+    The index is `codepoint >> 8`, and the value is an index into
+    colr_width_stage2.
+*/
+const unsigned char colr_width_stage1[] = {
+      0,   1,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+     15,  16,  17,  18,   1,   1,  19,  20,  21,  22,  23,  24,  25,  26,   1,  27,
+     28,  29,   1,  30,  31,  32,  33,  34,   1,   1,   1,  35,  36,  37,  38,  39,
+     40,  39,  41,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  42,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  43,   1,  44,  45,  46,  47,  48,  49,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  50,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,  39,  39,  51,   1,  52,  53,  54,
+     55,  56,  57,  58,  59,  60,   1,  61,  62,  63,  64,  65,  66,  67,  68,  69,
+     70,  71,  72,  73,  74,  75,  76,  77,  78,  79,  80,  39,  81,  82,  83,  84,
+      1,   1,   1,  85,  86,  87,  39,  39,  39,  39,  39,  39,  39,  39,  39,  88,
+      1,   1,   1,   1,  89,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,   1,   1,  90,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,   1,   1,  91,  92,  39,  39,  93,  94,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  95,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  96,
+     97,  98,  99, 100, 101, 102, 103, 104,   1,   1, 105,  39,  39,  39,  39, 106,
+    107, 108, 109,  39,  39,  39,  39, 110, 111, 112,  39,  39, 113, 114, 115,  39,
+    116, 117,  39, 118, 119, 120, 121, 122, 123, 124, 125, 126,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+     39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,  39,
+};
+
+/*! Stage 2 of the display-width table, used by colr_codepoint_width().
+    Each block holds 256 code points, packed at 2 bits each (0, 1, or 2 columns).
+*/
+const unsigned char colr_width_stage2[][64] = {
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x55, 0x5a, 0x55,
+        0xaa, 0x55, 0x95, 0x59, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x15, 0x00, 0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x95, 0x56, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,
+        0x41, 0x10, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x6a, 0x55, 0xa9, 0xaa, 0xaa,
+    },
+    {
+        0x00, 0x50, 0x55, 0x55, 0x00, 0x00, 0x40, 0x54, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x55, 0x55, 0x55, 0x55, 0x54, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x00, 0x10, 0x00, 0x14, 0x04, 0x50, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x25, 0x51, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x80, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x00, 0x00, 0xa4, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x00, 0x55, 0x95, 0x52,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x10, 0x00, 0x00, 0x01, 0x01, 0xa0, 0x55, 0x55, 0x55, 0x95,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x01, 0x9a, 0x55, 0x55, 0x95, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x95, 0xa0, 0xaa, 0x00, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    },
+    {
+        0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x45, 0x54,
+        0x01, 0x00, 0x54, 0x51, 0x01, 0x00, 0x55, 0x55, 0x05, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x51, 0x56, 0x55, 0x69, 0x69, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x99, 0x5a, 0xa5, 0x54,
+        0x01, 0x68, 0x69, 0x91, 0xaa, 0x6a, 0xaa, 0x65, 0x05, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x85,
+    },
+    {
+        0x42, 0x56, 0x95, 0x6a, 0x69, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x59, 0x96, 0xa5, 0x58,
+        0x81, 0x2a, 0x28, 0xa0, 0xa2, 0xaa, 0x56, 0x99, 0xaa, 0x5a, 0x55, 0x55, 0x50, 0x91, 0xaa, 0xaa,
+        0x42, 0x56, 0x55, 0x65, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x59, 0x56, 0xa5, 0x54,
+        0x01, 0x20, 0x64, 0xa1, 0xa9, 0xaa, 0xaa, 0xaa, 0x05, 0x5a, 0x55, 0x55, 0xa5, 0xaa, 0x06, 0x00,
+    },
+    {
+        0x52, 0x56, 0x55, 0x69, 0x69, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x59, 0x56, 0xa5, 0x14,
+        0x01, 0x68, 0x69, 0xa1, 0xaa, 0x42, 0xaa, 0x65, 0x05, 0x5a, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa,
+        0x4a, 0x56, 0x95, 0x5a, 0x59, 0xa5, 0x96, 0x59, 0x6a, 0xa9, 0x95, 0x5a, 0x55, 0x55, 0xa5, 0x5a,
+        0x94, 0x5a, 0x59, 0xa1, 0xa9, 0x6a, 0xaa, 0xaa, 0xaa, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa,
+    },
+    {
+        0x54, 0x54, 0x55, 0x59, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x55, 0x55, 0xa5, 0x04,
+        0x54, 0x09, 0x08, 0xa0, 0xaa, 0x82, 0x95, 0xa6, 0x05, 0x5a, 0x55, 0x55, 0xaa, 0x6a, 0x55, 0x55,
+        0x51, 0x55, 0x55, 0x59, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x55, 0x56, 0xa5, 0x14,
+        0x55, 0x49, 0x59, 0xa0, 0xaa, 0x96, 0xaa, 0x96, 0x05, 0x5a, 0x55, 0x55, 0x96, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x50, 0x55, 0x55, 0x59, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x54,
+        0x01, 0x58, 0x59, 0x51, 0xaa, 0x55, 0x55, 0x55, 0x05, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x52, 0x56, 0x55, 0x55, 0x55, 0x95, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0xa6,
+        0x55, 0x95, 0x8a, 0x6a, 0x05, 0x88, 0x55, 0x55, 0xaa, 0x5a, 0x55, 0x55, 0x5a, 0xa9, 0xaa, 0xaa,
+    },
+    {
+        0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x51, 0x00, 0x80, 0x6a,
+        0x55, 0x15, 0x00, 0x40, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x96, 0x59, 0x95, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x66, 0x55, 0x55, 0x51, 0x00, 0x00, 0xa4,
+        0x55, 0x99, 0x00, 0xa0, 0x55, 0x55, 0xa5, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x11, 0x51, 0x55,
+        0x55, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x02, 0x00, 0x00, 0x40,
+        0x00, 0x04, 0x55, 0x01, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x58,
+        0x55, 0x45, 0x55, 0x59, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x01, 0x04, 0x00, 0x41, 0x41,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x50, 0x05, 0x54, 0x55, 0x55, 0x55, 0x01, 0x54, 0x55, 0x55,
+        0x45, 0x41, 0x55, 0x51, 0x55, 0x55, 0x55, 0x51, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x65, 0xaa, 0xa6, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x59, 0xa5, 0x55, 0x95, 0x59, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x59, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0xa5, 0x55, 0x95,
+        0x59, 0xa5, 0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x59, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x02, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0xa5,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x05, 0xa4, 0xaa, 0x6a, 0x55, 0x55, 0x55, 0x55, 0x05, 0x95, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x05, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x59, 0x09, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x10, 0x00, 0x50,
+        0x55, 0x45, 0x01, 0x00, 0x00, 0x55, 0x55, 0xa1, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0xa5, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x15, 0x00, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa,
+        0x55, 0x41, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x91, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x40, 0x15, 0x54, 0xaa, 0x45, 0x55, 0x01, 0xaa,
+        0xa9, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0xa9, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x95, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x14, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x45, 0x00, 0x80, 0x44, 0x01, 0x00, 0x54, 0x15, 0x00, 0x00, 0x28,
+        0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0xa5, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x80, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x00, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x04, 0x40, 0x54,
+        0x45, 0x55, 0x55, 0xa9, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x00, 0x55, 0x55, 0x95,
+        0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x50, 0x10, 0x50, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x45, 0x50, 0x11, 0x50, 0xaa, 0xaa, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x00, 0x05, 0x6a, 0x55,
+        0x55, 0x55, 0xa5, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xa9, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x56,
+        0x55, 0x55, 0xaa, 0xaa, 0x40, 0x00, 0x00, 0x00, 0x04, 0x00, 0x54, 0x51, 0x55, 0x54, 0x90, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0xa5, 0x55, 0xa5, 0x55, 0x55, 0x66, 0x66, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x55,
+        0x55, 0x59, 0x55, 0x55, 0x55, 0x5a, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x5a, 0x59, 0x55, 0x95,
+    },
+    {
+        0x55, 0x55, 0x15, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x40, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x08, 0x00, 0x00, 0xa5, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55, 0xa9, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0xa9, 0xaa, 0xaa, 0xaa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa8, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x69, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x56, 0x96, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x69,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95,
+        0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55, 0x59, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x69,
+        0x55, 0x5a, 0x55, 0x65, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0xa5, 0x59, 0x65, 0x59,
+    },
+    {
+        0x55, 0x59, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x66, 0x95, 0x9a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x95,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x56, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x5a, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x50, 0xaa, 0x56, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0xaa, 0xa6, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x6a, 0xa9, 0xaa, 0xaa, 0x2a,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0x55, 0x95, 0x55, 0x95, 0x55, 0x95, 0x55, 0x95,
+        0x55, 0x95, 0x55, 0x95, 0x55, 0x95, 0x55, 0x95, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x0a, 0xa0, 0xaa, 0xaa, 0xaa, 0x6a,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x82, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x40, 0x00, 0x00, 0x50,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x50, 0x55, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x95, 0xaa, 0x65, 0x56, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x5a, 0x55, 0x55, 0x55,
+    },
+    {
+        0x45, 0x45, 0x15, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x41, 0x55, 0xa8, 0x55, 0x55, 0xa5, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0xa0, 0xaa, 0x5a, 0x55, 0x55, 0xa5, 0xaa, 0x00, 0x00, 0x00, 0x00, 0x50, 0x55, 0x55, 0x15,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x00, 0x50, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x15, 0x00, 0x00, 0x50, 0xaa, 0xaa, 0x6a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x05, 0x50, 0x50,
+        0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0xa5, 0x5a, 0x55, 0x51, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x01, 0x40, 0x41, 0x81, 0xaa, 0xaa,
+        0x15, 0x55, 0x55, 0xa4, 0x55, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x54,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x04, 0x14, 0x54, 0x05,
+        0x91, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0x55, 0x55, 0x55, 0x55, 0x50, 0x55, 0x85, 0xaa, 0xaa,
+    },
+    {
+        0x56, 0x95, 0x56, 0x95, 0x56, 0x95, 0xaa, 0xaa, 0x55, 0x95, 0x55, 0x95, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x51, 0x54, 0xa1, 0x55, 0x55, 0xa5, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x95, 0x6a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa,
+    },
+    {
+        0x55, 0x95, 0xaa, 0xaa, 0x6a, 0x55, 0xaa, 0x46, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0x99,
+        0x65, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x95, 0xaa, 0xaa, 0xaa, 0x6a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xaa, 0x6a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x00, 0x00, 0x00, 0x00, 0xaa, 0xaa, 0xaa, 0xaa, 0x00, 0x00, 0x00, 0x00, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x59, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x29,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95,
+        0x5a, 0x55, 0x5a, 0x55, 0x5a, 0x55, 0x5a, 0xa9, 0xaa, 0xaa, 0x55, 0x95, 0xaa, 0xaa, 0x02, 0xa5,
+    },
+    {
+        0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55, 0x55, 0x95, 0x65,
+        0x55, 0x55, 0x55, 0xa5, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa,
+    },
+    {
+        0x95, 0x6a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x6a, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55, 0xa9, 0xa9, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa1,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0xaa, 0xaa, 0x54, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0x56, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x95, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x80, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0xaa, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0x6a, 0x55, 0x55, 0x95, 0x55,
+        0x55, 0x55, 0x95, 0x55, 0x95, 0x65, 0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x65, 0x55, 0x65, 0xa9,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x95, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0xa5, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0xa9, 0x69,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0x6a, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x95, 0xa5, 0x6a, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x6a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x6a,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x01, 0x82, 0xaa, 0x00, 0x55, 0x56, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x80, 0x2a,
+        0x55, 0x55, 0xa9, 0xaa, 0x55, 0x55, 0xa9, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x81, 0x6a, 0x55, 0x55, 0x95, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x56, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0x56, 0xa9, 0xaa, 0xaa, 0x56, 0x55, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xa9, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0x5a, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x25, 0xa4, 0xa5, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x05, 0x00, 0x00, 0x54, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x05, 0x50, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa,
+    },
+    {
+        0x51, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x00,
+        0x00, 0x40, 0x55, 0xa5, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x14, 0xa4, 0xaa, 0x2a,
+        0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x40, 0x41, 0x51,
+        0x85, 0xaa, 0xaa, 0xa2, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0x55, 0x55, 0xa5, 0xaa,
+    },
+    {
+        0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x01, 0x00, 0x58, 0x55, 0x55,
+        0x55, 0x55, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x95, 0xaa, 0xaa,
+        0x50, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x00, 0x40,
+        0x55, 0x55, 0x01, 0x14, 0x55, 0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x50, 0x04, 0x55, 0x85,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x95, 0x59, 0x65, 0x55, 0x55, 0x55, 0x65, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x15, 0x00, 0x80, 0xaa, 0x55, 0x55, 0xa5, 0xaa,
+    },
+    {
+        0x50, 0x56, 0x55, 0x69, 0x69, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x59, 0x56, 0x25, 0x54,
+        0x54, 0x69, 0x69, 0xa5, 0xa9, 0x6a, 0xaa, 0x56, 0x55, 0x0a, 0x00, 0xa8, 0x00, 0xa8, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x00,
+        0x05, 0x44, 0x55, 0x55, 0x55, 0x55, 0x55, 0x46, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x44, 0x15,
+        0x04, 0x55, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0xa0, 0x55, 0x10,
+        0x54, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa0, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x40, 0x11,
+        0x54, 0xa9, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x51, 0x00, 0x10, 0xa5, 0xaa,
+        0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x02, 0x05, 0x10, 0x00, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x00, 0x41, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0x6a,
+    },
+    {
+        0x55, 0x95, 0xa6, 0x55, 0x55, 0x96, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0x29, 0x44,
+        0x15, 0x95, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x0a, 0x55, 0x54, 0xa9, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x01, 0x00, 0x40, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x00, 0x14, 0x40,
+        0x55, 0x15, 0xaa, 0xaa, 0x01, 0x40, 0x01, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x05, 0x00, 0x00, 0x40, 0x50, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x80, 0x00, 0x10,
+        0x55, 0xa5, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x04, 0x81, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x95, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x01, 0x80, 0x8a, 0x20,
+        0x00, 0x10, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x65, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x95, 0x60, 0x11, 0xa9, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x15, 0x54, 0xa9, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xa9, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0x6a,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0xa9, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x00, 0x00, 0xa8, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0xa5, 0x5a, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95,
+        0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x00, 0xa4, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x40, 0x55, 0x55,
+        0x55, 0xa5, 0xaa, 0xaa, 0x55, 0x55, 0x65, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x56,
+        0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x95, 0x2a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xaa, 0x2a, 0x40, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xa8, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0x55, 0x55, 0x55, 0xa9,
+        0x55, 0x55, 0xa9, 0xaa, 0x55, 0x55, 0xa5, 0x41, 0x00, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa0, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x80, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x15, 0x50, 0x55, 0x15, 0x00, 0x00, 0x00,
+        0x40, 0x01, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x05, 0x50, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x05, 0xa4, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x59, 0x9a, 0x96, 0x56, 0x59, 0x55, 0x55, 0x65, 0x56,
+        0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x65, 0x95, 0x56, 0x55, 0x59, 0x55, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x65, 0x95,
+        0x55, 0x99, 0x5a, 0x55, 0x59, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x15, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x54, 0x55, 0x51, 0x55, 0x55,
+        0x55, 0x54, 0x55, 0xaa, 0xaa, 0xaa, 0x2a, 0x00, 0x02, 0x00, 0x00, 0x00, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x28, 0x00, 0x20, 0x08, 0x80, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0x00, 0x40, 0x55, 0xa5,
+        0x55, 0x55, 0xa5, 0x5a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x85, 0xaa, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x00, 0x55, 0x55, 0xa5, 0x6a,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x95, 0x55, 0x96, 0x55, 0x55, 0x55, 0x95,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x69, 0x55, 0x55, 0x00, 0x80, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x00, 0x40, 0xaa, 0x55, 0x55, 0xa5, 0x5a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x96, 0x69, 0x56, 0x55, 0x95, 0x55, 0x66, 0xaa,
+        0x9a, 0x6a, 0x66, 0x56, 0x96, 0x69, 0x66, 0x66, 0x96, 0x69, 0x95, 0x55, 0x95, 0x55, 0x56, 0x99,
+        0x55, 0x55, 0x65, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x56, 0x56, 0x65, 0x55, 0x55, 0x55, 0x55, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xa5, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x95, 0x56, 0x55, 0x55, 0x55,
+        0x56, 0x55, 0x55, 0x95, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x65, 0xa9, 0xaa, 0x6a, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x5a, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x55, 0x55, 0xa9, 0xaa, 0x9a, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xa6,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0x6a, 0x95, 0xaa, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x56, 0xaa, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a,
+        0xa6, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x96,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x5a,
+        0x55, 0x55, 0x95, 0x6a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x65, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x69, 0x55, 0x55, 0x55, 0x56, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x95, 0xaa,
+    },
+    {
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0x5a, 0x55, 0x56, 0x6a, 0xa9, 0xaa, 0xaa, 0x55, 0x55, 0x95, 0xaa, 0x55, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xa5, 0xa5, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0xaa,
+        0xaa, 0x9a, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+        0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+    },
+    {
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x55, 0x55, 0x95, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0xa5, 0xaa,
+    },
+};
+
+//! Length of colr_width_stage1.
+const size_t colr_width_stage1_len = sizeof(colr_width_stage1) / sizeof(colr_width_stage1[0]);
+
 /*! Allocate and format a string like `asprintf`, but wrap it in an allocated
     ColorResult.
 
@@ -1129,6 +2087,36 @@ bool colr_check_marker(uint32_t marker, void* p) {
     return true;
 }
 
+/*! Returns the number of terminal columns used to display a Unicode code point.
+
+    \details
+    This uses a compiled-in two-stage table (colr_width_stage1 and
+    colr_width_stage2), built from the East Asian Width property and the
+    combining/format character categories by `tools/gen_width_table.py`.
+
+    \details
+    ASCII characters are always 1 column, even control characters, so plain
+    text has the same width as it's length.
+
+    \pi codepoint The code point to check.
+    \return       `0` for combining marks and other zero-width characters,
+                  `2` for wide and full-width characters (CJK, most emoji),
+                  otherwise `1`.
+
+    \sa colr_str_display_width
+*/
+int colr_codepoint_width(uint32_t codepoint) {
+    if (codepoint < 0x80) return 1;
+    if ((codepoint >> 8) < colr_width_stage1_len) {
+        unsigned char block = colr_width_stage1[codepoint >> 8];
+        unsigned char packed = colr_width_stage2[block][(codepoint & 0xFF) >> 2];
+        return (packed >> ((codepoint & 0x03) * 2)) & 0x03;
+    }
+    // Tags, and the variation selectors supplement.
+    if ((codepoint >= 0xE0000) && (codepoint <= 0xE0FFF)) return 0;
+    return 1;
+}
+
 /*! Allocates an empty \string.
     \details
     This is for keeping the interface simple, so the return values from
@@ -1147,6 +2135,31 @@ char* colr_empty_str(void) {
     return s;
 }
 
+/*! Writes the decimal digits for an `unsigned char`, like `"%d"` would,
+    without the `snprintf()` overhead.
+
+    \po out   \parblock
+                  Memory to write the digits to.
+                  <em>Must have room for 3 chars</em>.
+                  A `'\0'` is not written.
+              \endparblock
+    \pi value The value to write.
+    \return   A pointer just past the last digit that was written.
+*/
+char* colr_fmt_uchar(char* out, unsigned char value) {
+    if (value >= 100) {
+        *out++ = (char)('0' + (value / 100));
+        value %= 100;
+        *out++ = (char)('0' + (value / 10));
+        value %= 10;
+    } else if (value >= 10) {
+        *out++ = (char)('0' + (value / 10));
+        value %= 10;
+    }
+    *out++ = (char)('0' + value);
+    return out;
+}
+
 /*! Free any ColrC objects (\colrfreetypes) passed in through a `va_list`.
 
     \pi args  \parblock
@@ -1176,6 +2189,67 @@ void colr_free_re_matches(regmatch_t** matches) {
     free(matches);
 }
 
+/*! Write a padding character to a file, any number of times, without
+    allocating.
+
+    \pi fp    The file to write to.
+    \pi pad   The character to pad with.
+    \pi count Number of times to write \p pad.
+    \return   The number of bytes written.
+
+    \sa colr_printf_write
+*/
+size_t colr_fwrite_pad(FILE* fp, char pad, size_t count) {
+    if (!(fp && count)) return 0;
+    // Spaces are the usual padding, and don't need to be filled in.
+    static const char spaces[64] = "                                                                ";
+    char custom[sizeof(spaces)];
+    const char* block = spaces;
+    if (pad != ' ') {
+        memset(custom, pad, sizeof(custom));
+        block = custom;
+    }
+    size_t total = 0;
+    while (count) {
+        size_t chunk = count < sizeof(spaces) ? count : sizeof(spaces);
+        size_t written = fwrite(block, 1, chunk, fp);
+        total += written;
+        if (written < chunk) break;
+        count -= chunk;
+    }
+    return total;
+}
+
+/*! Write the start of a \string to a file, optionally skipping any escape
+    codes, without allocating.
+
+    \pi fp          The file to write to.
+    \pi s           \parblock
+                        The string to write.
+                        \mustnullin
+                    \endparblock
+    \pi length      Number of bytes to write from \p s, at most.
+    \pi strip_codes Whether to skip escape codes, like colr_str_strip_codes().
+    \return         The number of bytes written.
+
+    \sa colr_printf_write
+*/
+size_t colr_fwrite_text(FILE* fp, const char* s, size_t length, bool strip_codes) {
+    if (!(fp && s && length)) return 0;
+    if (!strip_codes) return fwrite(s, 1, length, fp);
+    size_t total = 0;
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.offset >= length) break;
+        if (token.type != TOKEN_TEXT) continue;
+        size_t token_len = token.length;
+        if ((token.offset + token_len) > length) token_len = length - token.offset;
+        total += fwrite(token.start, 1, token_len, fp);
+    }
+    return total;
+}
+
 /*! Determines whether a void pointer is a \colrfreetypes.
 
     \pi p    A pointer to a possible ColrC object.
@@ -1189,6 +2263,139 @@ bool colr_is_colr_ptr(void* p) {
     );
 }
 
+/*! Determines whether colors are disabled for the whole process.
+
+    \details
+    When disabled, the \colrmacros, ColorText_to_str(), and the `printf`
+    handler only produce text and justification. No escape codes are built.
+
+    \return `true` if colors are disabled, otherwise `false`.
+
+    \sa colr_set_disabled
+*/
+bool colr_is_disabled(void) {
+    return atomic_load_explicit(&colr_disabled, memory_order_relaxed);
+}
+
+/*! Determines whether multibyte strings should be treated as UTF-8.
+
+    \details
+    If a locale has been set with `setlocale()`, it's codeset is used.
+    Otherwise (the default "C" locale), the `LC_ALL`, `LC_CTYPE`, and `LANG`
+    environment variables are checked without modifying the global locale.
+    When none of them are set (or they are "C"/"POSIX"), UTF-8 is assumed.
+
+    \details
+    The environment is only checked on the first call. This is thread-safe.
+
+    \return `true` if UTF-8 should be used, or `false` if the locale uses some
+            other multibyte encoding (and `mbrlen()` should be used).
+
+    \sa colr_utf8_decode
+*/
+bool colr_locale_is_utf8(void) {
+    const char* codeset = nl_langinfo(CODESET);
+    if (codeset && (colr_istr_either(codeset, "UTF-8", "utf8"))) return true;
+    const char* ctype = setlocale(LC_CTYPE, NULL);
+    if (ctype && !colr_str_either(ctype, "C", "POSIX")) {
+        // A non-UTF-8 locale was set by the user.
+        return false;
+    }
+    // Threads that race on the first call compute the same value.
+    static atomic_int env_state = 0;
+    int state = atomic_load_explicit(&env_state, memory_order_relaxed);
+    if (state) return (state == 1);
+    char* envnames[] = {"LC_ALL", "LC_CTYPE", "LANG"};
+    state = 1;
+    for (size_t i = 0; i < (sizeof(envnames) / sizeof(envnames[0])); i++) {
+        char* envval = getenv(envnames[i]);
+        if (!envval || (envval[0] == '\0')) continue;
+        // The first non-empty variable is the one that would be used.
+        if (
+            !colr_str_either(envval, "C", "POSIX") &&
+            !strcasestr(envval, "UTF-8") &&
+            !strcasestr(envval, "utf8")
+        ) {
+            state = -1;
+        }
+        break;
+    }
+    atomic_store_explicit(&env_state, state, memory_order_relaxed);
+    return (state == 1);
+}
+
+/*! Get the length, in bytes, of the first multibyte character in a buffer
+    that is not necessarily null-terminated, and may end in the middle of a
+    character.
+
+    \details
+    This is for reading text in chunks, where a multibyte character may be
+    split between two chunks. In UTF-8 locales this does not depend on
+    `mbrlen()`.
+
+    \pi s      The buffer to look at.
+    \pi length Number of bytes available in \p s.
+    \return    The number of bytes in the first character (`1` for `'\0'`).
+    \retval 0          if \p s is `NULL`, \p length is `0`, or the buffer ends
+                       before the character does.
+    \retval (size_t)-1 if the bytes are not a valid multibyte character.
+
+    \sa colr_mb_len
+*/
+size_t colr_mb_char_len(const char* s, size_t length) {
+    if (!(s && length)) return 0;
+    if ((unsigned char)s[0] < 0x80) return 1;
+    if (!colr_locale_is_utf8()) {
+        colr_set_locale();
+        mbstate_t st;
+        memset(&st, 0, sizeof(mbstate_t));
+        size_t char_len = mbrlen(s, length, &st);
+        if (char_len == (size_t)-2) return 0;
+        return char_len ? char_len : 1;
+    }
+    unsigned char lead = (unsigned char)s[0];
+    size_t expected = (lead >= 0xF0) ? 4 : ((lead >= 0xE0) ? 3 : 2);
+    if ((lead >= 0xC2) && (lead < 0xF5) && (length < expected)) return 0;
+    // Null-terminated, for colr_utf8_decode().
+    char c[5] = {0};
+    memcpy(c, s, (length < 4) ? length : 4);
+    return colr_utf8_decode(c, NULL);
+}
+
+/*! Get the number of terminal columns used by the first multibyte character
+    in a buffer that is not necessarily null-terminated.
+
+    \details
+    Invalid or incomplete characters are 1 column, like they are for
+    colr_str_display_width().
+
+    \pi s      The buffer to look at.
+    \pi length Number of bytes available in \p s.
+    \return    The width, like colr_codepoint_width(), or `0` if \p s is
+               `NULL` or \p length is `0`.
+
+    \sa colr_mb_char_len
+*/
+int colr_mb_char_width(const char* s, size_t length) {
+    if (!(s && length)) return 0;
+    if ((unsigned char)s[0] < 0x80) return 1;
+    uint32_t codepoint = 0;
+    if (colr_locale_is_utf8()) {
+        // Null-terminated, for colr_utf8_decode().
+        char c[5] = {0};
+        memcpy(c, s, (length < 4) ? length : 4);
+        if (!colr_is_valid_mblen(colr_utf8_decode(c, &codepoint))) return 1;
+    } else {
+        colr_set_locale();
+        mbstate_t st;
+        memset(&st, 0, sizeof(mbstate_t));
+        wchar_t wc = 0;
+        if (!colr_is_valid_mblen(mbrtowc(&wc, s, length, &st))) return 1;
+        codepoint = (uint32_t)wc;
+    }
+    return colr_codepoint_width(codepoint);
+}
+
 /*! Like `mbrlen`, except it will return the length of the next N (`length`)
     multibyte characters in bytes.
 
@@ -1248,17 +2455,31 @@ bool colr_is_colr_ptr(void* p) {
 size_t colr_mb_len(const char* s, size_t length) {
     if ((!s) || (s[0] == '\0')) return 0;
     if (length < 1) return 0;
-    colr_set_locale();
-    mbstate_t st;
-    memset(&st, 0, sizeof(mbstate_t));
-    if (length == 1) return mbrlen(s, MB_LEN_MAX, &st);
     size_t total = 0;
+    if (!colr_locale_is_utf8()) {
+        // Some other multibyte encoding, use the locale.
+        colr_set_locale();
+        mbstate_t st;
+        memset(&st, 0, sizeof(mbstate_t));
+        while (s[total] && length--) {
+            size_t char_len = mbrlen(s + total, MB_LEN_MAX, &st);
+            if (!colr_is_valid_mblen(char_len)) {
+                // Invalid multibyte (-1), or incomplete multibyte (-2).
+                return char_len;
+            }
+            total += char_len;
+        }
+        return total;
+    }
     while (s[total] && length--) {
-        size_t char_len = mbrlen(s, MB_LEN_MAX, &st);
-        if (!colr_is_valid_mblen(char_len)) {
-            // Invalid multibyte (-1), or incomplete multibyte (-2).
-            return char_len;
+        // ASCII chars are always 1 byte.
+        if ((unsigned char)s[total] < 0x80) {
+            total++;
+            continue;
         }
+        size_t char_len = colr_utf8_decode(s + total, NULL);
+        // Invalid multibyte (-1).
+        if (!colr_is_valid_mblen(char_len)) return char_len;
         total += char_len;
     }
     return total;
@@ -1280,79 +2501,155 @@ size_t colr_mb_len(const char* s, size_t length) {
     \return  The number of characters written.
 */
 int colr_printf_handler(FILE *fp, const struct printf_info *info, const void *const *args) {
-    (void)info; // Unused.
     // Wide character output is not supported right now.
     assert(info->wide == 0);
 
     void* p = *(void**)args[0];
+    if (!(info->user & colr_printf_esc_mod)) {
+        return (int)colr_printf_write(fp, info, p);
+    }
+    // Escape output if the '/' modifier was used.
+    // colr_repr() needs the whole string, so it is built in memory first.
     char* s = NULL;
+    size_t length = 0;
+    FILE* memfp = open_memstream(&s, &length);
+    if (!memfp) return 0; // LCOV_EXCL_LINE
+    colr_printf_write(memfp, info, p);
+    fclose(memfp);
+    char* escaped = colr_repr(s);
+    free(s);
+    if (!escaped) return 0; // LCOV_EXCL_LINE
+    length = strlen(escaped);
+    fwrite(escaped, 1, length, fp);
+    free(escaped);
+    return (int)length;
+}
+
+/*! Writes a Colr object for colr_printf_handler(), without allocating.
+
+    \details
+    The escape-codes, text, reset code, and padding are written straight to
+    \p fp. The result is the same as building the string with
+    ColorText_to_str() (or ColorArg_to_esc(), etc.), stripping it for the
+    alternate form (`#`), and justifying it for the width.
+
+    \gnuonly
+
+    \pi fp   FILE pointer for output.
+    \pi info Info from printf about how to format the argument.
+    \pi p    \parblock
+                 A ColorArg, ColorResult, ColorText, or \string to write.
+                 Colr objects are freed.
+             \endparblock
+    \return  The number of bytes written.
+*/
+size_t colr_printf_write(FILE* fp, const struct printf_info* info, void* p) {
+    bool strip = info->alt;
+    // No codes are built when colors are disabled.
+    bool disabled = colr_is_disabled();
+    // Escape-codes that come before the text.
+    char codes[CODE_ANY_LEN] = {0};
+    const char* text = NULL;
+    bool do_reset = false;
+    ColorJustify just = ColorJustify_empty();
     ColorArg* cargp = NULL;
     ColorResult* cresp = NULL;
     ColorText* ctextp = NULL;
     if (ColorArg_is_ptr(p)) {
         cargp = p;
-        s = ColorArg_to_esc(*cargp);
-        ColorArg_free(cargp);
+        if (!disabled) ColorArg_to_esc_s(codes, *cargp);
+        text = "";
     } else if (ColorText_is_ptr(p)) {
         ctextp = p;
-        s = ColorText_to_str(*ctextp);
-        ColorText_free(ctextp);
+        text = ctextp->text;
+        // Same order as ColorText_to_str().
+        ColorArg* cargs[] = {ctextp->style, ctextp->fore, ctextp->back};
+        for (size_t i = 0; i < 3; i++) {
+            if (disabled) break;
+            if (!cargs[i]) continue;
+            do_reset = true;
+            char code[CODE_ANY_LEN];
+            if (ColorArg_to_esc_s(code, *cargs[i])) strcat(codes, code);
+        }
+        just = ctextp->just;
     } else if (ColorResult_is_ptr(p)) {
         cresp = p;
-        s = ColorResult_to_str(*cresp);
+        text = cresp->result;
     } else {
         // Better be a string.
-        s = (char*)p;
-    }
-    if (!s) return 1;
-    if (info->alt) {
-        // Alternate-form (#), no codes.
-        char* stripped = colr_str_strip_codes(s);
-        // If I couldn't allocate for the stripped version, use the original.
-        // Worse things than that are about to happen anyway.
-        if (stripped) {
-            free(s);
-            s = stripped;
+        text = p;
+    }
+    if (!text) {
+        if (cargp) ColorArg_free(cargp);
+        if (ctextp) ColorText_free(ctextp);
+        if (cresp) ColorResult_free(cresp);
+        return 0;
+    }
+    size_t text_len = strlen(text);
+    size_t body_len = text_len;
+    size_t newlines = 0;
+    if (do_reset) {
+        // Same as colr_append_reset(), the reset goes before trailing newlines.
+        bool has_reset = text_len ?
+            colr_str_ends_with(text, CODE_RESET_ALL) :
+            colr_str_ends_with(codes, CODE_RESET_ALL);
+        if (has_reset) {
+            do_reset = false;
+        } else {
+            while (body_len && (text[body_len - 1] == '\n')) {
+                body_len--;
+                newlines++;
+            }
         }
-
     }
-    char* justified = NULL;
+    // Codes have no width, so only the text is measured.
+    size_t display_width = colr_str_display_width(text);
+    // Justification from the ColorText itself.
+    size_t just_diff = 0;
+    char just_pad = just.padchar ? just.padchar : ' ';
+    if (just.method != JUST_NONE) {
+        int width = just.width ? just.width : colr_term_size().columns;
+        if (width > (int)display_width) just_diff = (size_t)width - display_width;
+    }
+    display_width += just_diff;
+    // Justification from printf.
+    size_t width_diff = 0;
+    ColorJustifyMethod width_method = JUST_RIGHT;
+    int width_pad = ' ';
     if (info->width) {
         // TODO: Use wchar_t in justification funcs to forward `info->pad` to it.
         //       I'm not sure how this is used from printf though.
-        int pad = info->pad ? wctob(info->pad) : ' ';
-        if (pad == EOF) pad = ' ';
+        width_pad = info->pad ? wctob(info->pad) : ' ';
+        if ((width_pad == EOF) || (width_pad == '\0')) width_pad = ' ';
         if (info->left) {
-            justified = colr_str_ljust(s, info->width, pad);
+            width_method = JUST_LEFT;
         } else if (info->space) {
-            justified = colr_str_center(s, info->width, pad);
-        } else {
-            justified = colr_str_rjust(s, info->width, pad);
-        }
-        if (justified) {
-            if (cargp || ctextp) free(s);
-            if (cresp) ColorResult_free(cresp);
-            s = justified;
-        } else {
-            // Can't allocate for justified text.
-            return 1; // LCOV_EXCL_LINE
-        }
-    }
-    // Escape output if the '/' modifier was used.
-    if (info->user & colr_printf_esc_mod) {
-        char* escaped = colr_repr(s);
-        if (escaped) {
-            // Escape was successful, we don't need the original `s` anymore.
-            free(s);
-            s = escaped;
+            width_method = JUST_CENTER;
         }
+        if (info->width > (int)display_width) width_diff = (size_t)info->width - display_width;
     }
-    fprintf(fp, "%s", s);
-    size_t length = strlen(s);
-    if (cargp || ctextp || justified) free(s);
+    size_t total = 0;
+    // Padding is split like colr_str_ljust(), colr_str_rjust(), and colr_str_center().
+    size_t just_left = (
+        just.method == JUST_RIGHT ? just_diff :
+        just.method == JUST_CENTER ? (just_diff / 2) + (just_diff % 2) : 0
+    );
+    size_t width_left = (
+        width_method == JUST_RIGHT ? width_diff :
+        width_method == JUST_CENTER ? (width_diff / 2) + (width_diff % 2) : 0
+    );
+    total += colr_fwrite_pad(fp, (char)width_pad, width_left);
+    total += colr_fwrite_pad(fp, just_pad, just_left);
+    if (!strip) total += colr_fwrite_text(fp, codes, strlen(codes), false);
+    total += colr_fwrite_text(fp, text, body_len, strip);
+    if (do_reset && !strip) total += colr_fwrite_text(fp, CODE_RESET_ALL, CODE_RESET_LEN - 1, false);
+    total += colr_fwrite_pad(fp, '\n', newlines);
+    total += colr_fwrite_pad(fp, just_pad, just_diff - just_left);
+    total += colr_fwrite_pad(fp, (char)width_pad, width_diff - width_left);
+    if (cargp) ColorArg_free(cargp);
+    if (ctextp) ColorText_free(ctextp);
     if (cresp) ColorResult_free(cresp);
-
-    return length;
+    return total;
 }
 
 /*! Handles the arg count/size for the Colr printf handler.
@@ -1425,6 +2722,40 @@ void colr_printf_register(void) {
 }
 #endif // COLR_GNU
 
+/*! Disables or enables colors for the whole process.
+
+    \details
+    This should be set before any other threads are building strings with
+    ColrC. Sizes are measured before the strings are written, and both must
+    see the same setting.
+
+    \pi disabled Whether colors should be disabled.
+
+    \sa colr_is_disabled
+    \sa colr_set_disabled_auto
+*/
+void colr_set_disabled(bool disabled) {
+    atomic_store(&colr_disabled, disabled);
+}
+
+/*! Disables colors when `stdout` is not a terminal, `$NO_COLOR` is set, or
+    `TERM=dumb`, using colr_term_caps().
+
+    \details
+    Like colr_set_disabled(), this should be called before any other threads
+    are building strings with ColrC.
+
+    \return `true` if colors were disabled, otherwise `false`.
+
+    \sa colr_set_disabled
+*/
+bool colr_set_disabled_auto(void) {
+    ColrTermCaps caps = colr_term_caps();
+    bool disabled = caps.disabled || !caps.is_tty;
+    colr_set_disabled(disabled);
+    return disabled;
+}
+
 /*! Sets the locale to `(LC_ALL, "")` if it hasn't already been set.
     \details
     This is used for functions dealing with multibyte strings.
@@ -1512,6 +2843,9 @@ void colr_str_array_free(char** ps) {
 
 /*! Center-justifies a \string, ignoring escape codes when measuring the width.
 
+    \details
+    The width is measured in terminal columns, with colr_str_display_width().
+
     \pi s       \parblock
                     The string to justify.
                     \mustnullin
@@ -1547,12 +2881,12 @@ char* colr_str_center(const char* s, int width, const char padchar) {
     if (!s) return NULL;
     char pad = padchar == '\0' ? ' ' : padchar;
     size_t length = strlen(s);
-    size_t noncode_len = colr_str_noncode_len(s);
+    size_t display_width = colr_str_display_width(s);
     if (width == 0) {
         TermSize ts = colr_term_size();
         width = ts.columns;
     }
-    int diff = width - noncode_len;
+    int diff = width - display_width;
     char* result;
     if (diff < 1) {
         // No room for padding, also asprintf can't do empty strings.
@@ -1714,30 +3048,12 @@ size_t colr_str_chars_lcount(const char* restrict s, const char* restrict chars)
 size_t colr_str_code_count(const char* s) {
     if (!s) return 0;
     if (s[0] == '\0') return 0;
-    // Length of code, minus the 'm' and '\0'.
-    size_t code_max = CODE_RGB_LEN - 2;
     size_t total = 0;
-    size_t i = 0;
-    while (s[i]) {
-        // Skip past non code stuff, if any.
-        while (s[i] && s[i] != '\x1b') i++;
-        if (s[i] == '\0') break;
-        // Have code.
-        size_t current_code = 0;
-        // Grab the rest of the code chars.
-        while (s[i] && !colr_char_is_code_end(s[i])) {
-            i++;
-            current_code++;
-            if (current_code > code_max) {
-                // Overflow. Ignore this crazy code.
-                current_code = 0;
-                break;
-            }
-        }
-        if (current_code && (current_code <= code_max)) {
-            // Have a complete code.
-            total += 1;
-        }
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        // Codes longer than the longest RGB code are ignored.
+        if (ColrToken_is_code(token) && (token.length < CODE_RGB_LEN)) total++;
     }
     return total;
 }
@@ -1762,29 +3078,13 @@ size_t colr_str_code_count(const char* s) {
 size_t colr_str_code_len(const char* s) {
     if (!s) return 0;
     if (s[0] == '\0') return 0;
-    // Length of code, minus the 'm' and '\0'.
-    size_t code_max = CODE_RGB_LEN - 2;
     size_t total = 0;
-    size_t i = 0;
-    while (s[i]) {
-        // Skip past non code stuff, if any.
-        while (s[i] && s[i] != '\x1b') i++;
-        if (s[i] == '\0') break;
-        // Have code.
-        size_t current_code = 0;
-        // Grab the rest of the code chars.
-        while (s[i] && !colr_char_is_code_end(s[i])) {
-            i++;
-            current_code++;
-            if (current_code > code_max) {
-                // Overflow. Ignore this crazy code.
-                current_code = 0;
-                break;
-            }
-        }
-        if (current_code && (current_code <= code_max)) {
-            // Have a complete code, don't forget the last 'm'.
-            total += current_code + 1;
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        // Codes longer than the longest RGB code are ignored.
+        if (ColrToken_is_code(token) && (token.length < CODE_RGB_LEN)) {
+            total += token.length;
         }
     }
     return total;
@@ -1857,6 +3157,83 @@ char* colr_str_copy(char* restrict dest, const char* restrict src, size_t length
     return dest;
 }
 
+/*! Returns the number of terminal columns needed to display a \string,
+    ignoring escape codes.
+
+    \details
+    Wide characters (CJK, most emoji) count as 2 columns, and combining marks
+    count as 0. ASCII text is counted without decoding, so for plain ASCII
+    strings this is the same as colr_str_noncode_len().
+
+    \details
+    Invalid multibyte sequences are counted as 1 column per byte.
+
+    \pi s   \parblock
+                The string to measure.
+                \mustnullin
+            \endparblock
+    \return The display width, or `0` if \p s is `NULL` or empty.
+
+    \sa colr_codepoint_width
+    \sa colr_str_noncode_len
+
+    \examplecodefor{colr_str_display_width,.c}
+    char* s = colr("１３３７", fore(RED));
+    if (!s) exit(1);
+    // 4 full-width characters, 12 bytes.
+    assert(colr_str_display_width(s) == 8);
+    assert(colr_str_noncode_len(s) == 12);
+    free(s);
+    \endexamplecode
+*/
+size_t colr_str_display_width(const char* s) {
+    if (!s) return 0;
+    if (s[0] == '\0') return 0;
+    // The locale is only checked when a non-ASCII char is found.
+    int use_utf8 = -1;
+    mbstate_t st;
+    size_t total = 0;
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_TEXT) continue;
+        size_t i = 0;
+        while (i < token.length) {
+            if ((unsigned char)token.start[i] < 0x80) {
+                total++;
+                i++;
+                continue;
+            }
+            if (use_utf8 == -1) {
+                use_utf8 = colr_locale_is_utf8();
+                if (!use_utf8) {
+                    // Some other multibyte encoding, use the locale.
+                    colr_set_locale();
+                    memset(&st, 0, sizeof(mbstate_t));
+                }
+            }
+            uint32_t codepoint = 0;
+            size_t char_len;
+            if (use_utf8) {
+                char_len = colr_utf8_decode(token.start + i, &codepoint);
+            } else {
+                wchar_t wc = 0;
+                char_len = mbrtowc(&wc, token.start + i, token.length - i, &st);
+                codepoint = (uint32_t)wc;
+            }
+            if (!colr_is_valid_mblen(char_len)) {
+                if (!use_utf8) memset(&st, 0, sizeof(mbstate_t));
+                total++;
+                i++;
+                continue;
+            }
+            total += colr_codepoint_width(codepoint);
+            i += char_len;
+        }
+    }
+    return total;
+}
+
 /*! Determine if one \string ends with another.
 
     \details
@@ -1945,58 +3322,39 @@ char** colr_str_get_codes(const char* s, bool unique) {
     // Allocate memory for some string pointers.
     char** code_array = calloc(code_cnt + 1, sizeof(char*));
     if (!code_array) return NULL;
-    char** array_start = code_array;
     size_t array_pos = 0;
-    size_t i = 0;
-    char current_code[CODE_RGB_LEN] = {0};
-    // Length of code, minus the 'm' and the '\0'.
-    size_t code_max = CODE_RGB_LEN - 2;
-    while (s[i]) {
-        // Skip past non code stuff, if any.
-        while (s[i] && s[i] != '\x1b') i++;
-        if (s[i] == '\0') break;
-        // Have code, copy the start char.
-        size_t pos = 0;
-        current_code[pos] = s[i++];
-        pos++;
-        // Grab the rest of the code chars.
-        while (s[i] && !colr_char_is_code_end(s[i])) {
-            if (pos < code_max) {
-                current_code[pos++] = s[i];
-            } else {
-                // Overflowed the code buffer because the code is probably
-                // malformed. Just ignore this one.
-                current_code[0] = '\0';
-            }
-            i++;
-        };
-        if (current_code[0]) {
-            // Have a complete code.
-            current_code[pos++] = 'm';
-            current_code[pos] = '\0';
-            // Make a copy of it and add it to the array of pointers.
-            char* code_copy = strndup(current_code, pos);
-            if (!code_copy) return NULL;
-            if (unique) {
-                // Mark this position as NULL, until we know that it will be added.
-                // The NULL marker will be overwritten for the next code, or
-                // will symbolize the end of the array.
-                code_array[array_pos] = NULL;
-                if (colr_str_array_contains(code_array, code_copy)) {
-                    // Skip it.
-                    free(code_copy);
-                    current_code[0] = '\0';
-                    continue;
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        // Codes longer than the longest RGB code are probably malformed.
+        // Just ignore them.
+        if (!ColrToken_is_code(token) || (token.length >= CODE_RGB_LEN)) continue;
+        if (unique) {
+            // The array is NULL-terminated at array_pos (calloc), so it can
+            // be searched before the code is copied.
+            bool found = false;
+            for (size_t i = 0; i < array_pos; i++) {
+                if (
+                    (strncmp(code_array[i], token.start, token.length) == 0) &&
+                    (code_array[i][token.length] == '\0')
+                ) {
+                    found = true;
+                    break;
                 }
             }
-            code_array[array_pos++] = code_copy;
-            // Reset current code.
-            current_code[0] = '\0';
+            if (found) continue;
         }
+        // Make a copy of it and add it to the array of pointers.
+        char* code_copy = strndup(token.start, token.length);
+        if (!code_copy) {
+            colr_str_array_free(code_array);
+            return NULL;
+        }
+        code_array[array_pos++] = code_copy;
     }
     // Set the last item to NULL, even if it's the first item.
     code_array[array_pos] = NULL;
-    return array_start;
+    return code_array;
 }
 
 /*! Determines whether a string contains a specific color code.
@@ -2157,15 +3515,11 @@ bool colr_str_is_all(const char* s, const char c) {
 bool colr_str_is_codes(const char* s) {
     if (!s) return false;
     if (s[0] == '\0') return false;
-    size_t i = 0;
-    while (s[i]) {
-        if (s[i] == '\x1b') {
-            // Skip past the code.
-            while (!colr_char_is_code_end(s[i++]));
-            continue;
-        }
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
         // Found a non-escape-code char.
-        return false;
+        if (token.type == TOKEN_TEXT) return false;
     }
     return true;
 }
@@ -2195,6 +3549,9 @@ bool colr_str_is_digits(const char* s) {
 
 /*! Left-justifies a \string, ignoring escape codes when measuring the width.
 
+    \details
+    The width is measured in terminal columns, with colr_str_display_width().
+
     \pi s       \parblock
                     The string to justify.
                     \mustnullin
@@ -2229,12 +3586,12 @@ char* colr_str_ljust(const char* s, int width, const char padchar) {
     if (!s) return NULL;
     char pad = padchar == '\0' ? ' ' : padchar;
     size_t length = strlen(s);
-    size_t noncode_len = colr_str_noncode_len(s);
+    size_t display_width = colr_str_display_width(s);
     if (width == 0) {
         TermSize ts = colr_term_size();
         width = ts.columns;
     }
-    int diff = width - noncode_len;
+    int diff = width - display_width;
     char* result;
     if (diff < 1) {
         // No room for padding, also asprintf can't do empty strings.
@@ -2421,19 +3778,33 @@ char* colr_str_lstrip_chars(const char* restrict s, const char* restrict chars)
 */
 size_t colr_str_mb_len(const char* s) {
     if ((!s) || (s[0] == '\0')) return 0;
-    colr_set_locale();
-    int i = 0;
-    int next_len = 0;
+    size_t i = 0;
     size_t total = 0;
+    bool use_utf8 = colr_locale_is_utf8();
     mbstate_t st;
-    memset(&st, 0, sizeof(mbstate_t));
-    while ((next_len = mbrlen(s + i, MB_LEN_MAX, &st))) {
-        if (next_len < 0) {
+    if (!use_utf8) {
+        // Some other multibyte encoding, use the locale.
+        colr_set_locale();
+        memset(&st, 0, sizeof(mbstate_t));
+    }
+    while (s[i]) {
+        // ASCII chars are always 1 byte, in UTF-8.
+        if (use_utf8 && ((unsigned char)s[i] < 0x80)) {
+            i++;
+            total++;
+            continue;
+        }
+        size_t next_len = (
+            use_utf8 ?
+                colr_utf8_decode(s + i, NULL) :
+                mbrlen(s + i, MB_LEN_MAX, &st)
+        );
+        if (!colr_is_valid_mblen(next_len)) {
             #if defined(COLR_DEBUG) && !defined(COLR_TEST)
                 // Make sure this is a no-op when not explicitly requesting
                 // colrc-debug-mode. It helps to know which part was "invalid".
                 char* repr = colr_repr(s + i);
-                dbug("Invalid multibyte sequence at: %d, Repr: %s\n", i, repr ? repr : "NULL");
+                dbug("Invalid multibyte sequence at: %zu, Repr: %s\n", i, repr ? repr : "NULL");
                 if (repr) free(repr);
             #endif
             return 0;
@@ -2459,45 +3830,267 @@ size_t colr_str_mb_len(const char* s) {
 size_t colr_str_noncode_len(const char* s) {
     if (!s) return 0;
     if (s[0] == '\0') return 0;
-    size_t i = 0, total = 0;
-    while (s[i]) {
-        if (s[i] == '\x1b') {
-            // Skip past the code.
-            while (!colr_char_is_code_end(s[i++]));
-            continue;
-        }
-        i++;
-        total++;
+    size_t total = 0;
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type == TOKEN_TEXT) total += token.length;
     }
     return total;
 }
 
-/*! Returns all `regmatch_t` matches for regex pattern in a \string.
+/*! Returns a compiled regex pattern from the regex cache, compiling and
+    caching it if needed.
 
-    \pi s         The string to search.
-    \pi repattern The pattern to look for.
-    \return       \parblock
-                    A pointer to an allocated array of `regmatch_t*`,
-                    or `NULL` if \p s is `NULL` or \p repattern is `NULL`.
-                    The last member is always `NULL`.
-                    \mustfree
-                  \endparblock
+    \details
+    Patterns are cached by (pattern, flags). When the cache is full, the least
+    recently used pattern is evicted. Evicted patterns that are still in use
+    are not freed until they are released.
 
-    \examplecodefor{colr_re_matches,.c}
-        #include "colr.h"
-        int main(void) {
-            // Compile a regex pattern.
-            regex_t pat;
-            if (regcomp(&pat, "foo", 0)) {
-                regfree(&pat);
-                return EXIT_FAILURE;
-            }
-            // The string to operate on.
-            const char* s = "This foo is a foo string, foo?";
-            // Get all matches.
-            regmatch_t** matches = colr_re_matches(s, &pat);
-            if (!matches) {
-                // This should be impossible (for this example).
+    \details
+    This is thread-safe. The same compiled pattern may be returned to several
+    threads at once, which is fine for `regexec()`.
+
+    \pi pattern  The regex pattern to compile.
+    \pi re_flags Flags for `regcomp()`. `REG_EXTENDED` is always used, whether
+                 flags are provided or not.
+    \return      \parblock
+                     A compiled pattern, or `NULL` if \p pattern is `NULL`, it
+                     does not compile, or allocation fails.
+                     You must call colr_re_cache_release() when you are done
+                     with it. Do not call `regfree()` on it.
+                 \endparblock
+
+    \examplecodefor{colr_re_cache_acquire,.c}
+    regex_t* repat = colr_re_cache_acquire("fo+", 0);
+    if (!repat) return EXIT_FAILURE;
+    regmatch_t match;
+    if (!regexec(repat, "This is a foo line.", 1, &match, 0)) {
+        printf("Found a match at: %d-%d\n", match.rm_so, match.rm_eo);
+    }
+    colr_re_cache_release(repat);
+    \endexamplecode
+
+    \sa colr_re_cache_release
+    \sa colr_re_cache_stats
+*/
+regex_t* colr_re_cache_acquire(const char* pattern, int re_flags) {
+    if (!pattern) return NULL;
+    // Always use extended regex.
+    if (!(re_flags & REG_EXTENDED)) re_flags = re_flags | REG_EXTENDED;
+    ColrHash hash = colr_str_hash(pattern);
+    pthread_mutex_lock(&colr_re_cache.lock);
+    ColrRegexCacheEntry* entry = colr_re_cache_find(pattern, re_flags, hash);
+    if (entry) {
+        colr_re_cache.stats.hits++;
+        pthread_mutex_unlock(&colr_re_cache.lock);
+        return &entry->repat;
+    }
+    colr_re_cache.stats.misses++;
+    pthread_mutex_unlock(&colr_re_cache.lock);
+    // Compile it without holding the lock.
+    entry = calloc(1, sizeof(ColrRegexCacheEntry));
+    if (!entry) return NULL;
+    entry->pattern = strdup(pattern);
+    if (!entry->pattern) {
+        free(entry);
+        return NULL;
+    }
+    if (regcomp(&entry->repat, pattern, re_flags)) {
+        free(entry->pattern);
+        free(entry);
+        return NULL;
+    }
+    entry->re_flags = re_flags;
+    entry->hash = hash;
+    entry->refs = 1;
+    pthread_mutex_lock(&colr_re_cache.lock);
+    // Another thread may have cached the same pattern while this one compiled.
+    ColrRegexCacheEntry* cached = colr_re_cache_find(pattern, re_flags, hash);
+    if (cached) {
+        pthread_mutex_unlock(&colr_re_cache.lock);
+        regfree(&entry->repat);
+        free(entry->pattern);
+        free(entry);
+        return &cached->repat;
+    }
+    if (colr_re_cache.stats.capacity) {
+        entry->cached = true;
+        entry->next = colr_re_cache.head;
+        if (colr_re_cache.head) colr_re_cache.head->prev = entry;
+        else colr_re_cache.tail = entry;
+        colr_re_cache.head = entry;
+        colr_re_cache.stats.count++;
+        colr_re_cache_evict(colr_re_cache.stats.capacity);
+    }
+    pthread_mutex_unlock(&colr_re_cache.lock);
+    return &entry->repat;
+}
+
+/*! Removes all compiled patterns from the regex cache, and resets the hit/miss
+    counters.
+
+    \details
+    Patterns that are still in use are freed when they are released.
+
+    \sa colr_re_cache_acquire
+*/
+void colr_re_cache_clear(void) {
+    pthread_mutex_lock(&colr_re_cache.lock);
+    colr_re_cache_evict(0);
+    colr_re_cache.stats.hits = 0;
+    colr_re_cache.stats.misses = 0;
+    pthread_mutex_unlock(&colr_re_cache.lock);
+}
+
+/*! Evicts the least recently used patterns from the regex cache until it
+    holds no more than \p capacity patterns.
+
+    \details
+    The caller must hold the `colr_re_cache.lock`.
+
+    \pi capacity The number of patterns to keep.
+
+    \sa colr_re_cache_set_capacity
+*/
+void colr_re_cache_evict(size_t capacity) {
+    while (colr_re_cache.stats.count > capacity) {
+        ColrRegexCacheEntry* entry = colr_re_cache.tail;
+        colr_re_cache.tail = entry->prev;
+        if (colr_re_cache.tail) colr_re_cache.tail->next = NULL;
+        else colr_re_cache.head = NULL;
+        colr_re_cache.stats.count--;
+        entry->cached = false;
+        entry->prev = NULL;
+        if (entry->refs) continue;
+        regfree(&entry->repat);
+        free(entry->pattern);
+        free(entry);
+    }
+}
+
+/*! Finds a cached pattern, moves it to the front of the regex cache, and adds
+    a reference to it.
+
+    \details
+    The caller must hold the `colr_re_cache.lock`.
+
+    \pi pattern  The regex pattern to look for.
+    \pi re_flags The `regcomp()` flags it was compiled with.
+    \pi hash     The hash of \p pattern, from colr_str_hash().
+    \return      The cache entry, or `NULL` if the pattern is not cached.
+
+    \sa colr_re_cache_acquire
+*/
+ColrRegexCacheEntry* colr_re_cache_find(const char* pattern, int re_flags, ColrHash hash) {
+    ColrRegexCacheEntry* entry = colr_re_cache.head;
+    while (entry) {
+        if (
+            (entry->hash == hash) &&
+            (entry->re_flags == re_flags) &&
+            (strcmp(entry->pattern, pattern) == 0)
+        ) {
+            break;
+        }
+        entry = entry->next;
+    }
+    if (!entry) return NULL;
+    entry->refs++;
+    if (entry != colr_re_cache.head) {
+        // Move it to the front.
+        entry->prev->next = entry->next;
+        if (entry->next) entry->next->prev = entry->prev;
+        else colr_re_cache.tail = entry->prev;
+        entry->prev = NULL;
+        entry->next = colr_re_cache.head;
+        colr_re_cache.head->prev = entry;
+        colr_re_cache.head = entry;
+    }
+    return entry;
+}
+
+/*! Releases a compiled pattern from colr_re_cache_acquire().
+
+    \pi repat The compiled pattern to release. If `NULL`, nothing is done.
+
+    \sa colr_re_cache_acquire
+*/
+void colr_re_cache_release(regex_t* repat) {
+    if (!repat) return;
+    ColrRegexCacheEntry* entry = (ColrRegexCacheEntry*)repat;
+    pthread_mutex_lock(&colr_re_cache.lock);
+    entry->refs--;
+    bool evicted = !(entry->refs || entry->cached);
+    pthread_mutex_unlock(&colr_re_cache.lock);
+    if (!evicted) return;
+    regfree(&entry->repat);
+    free(entry->pattern);
+    free(entry);
+}
+
+/*! Sets the maximum number of compiled patterns kept in the regex cache.
+
+    \details
+    Extra patterns are evicted right away. Using `0` disables caching, so
+    every pattern is compiled on each use.
+
+    \pi capacity The maximum number of patterns to cache.
+
+    \sa colr_re_cache_acquire
+*/
+void colr_re_cache_set_capacity(size_t capacity) {
+    pthread_mutex_lock(&colr_re_cache.lock);
+    colr_re_cache.stats.capacity = capacity;
+    colr_re_cache_evict(capacity);
+    pthread_mutex_unlock(&colr_re_cache.lock);
+}
+
+/*! Returns the regex cache's hit/miss counters, size, and capacity.
+
+    \return A copy of the current ColrRegexCacheStats.
+
+    \sa colr_re_cache_acquire
+    \sa colr_re_cache_clear
+*/
+ColrRegexCacheStats colr_re_cache_stats(void) {
+    pthread_mutex_lock(&colr_re_cache.lock);
+    ColrRegexCacheStats stats = colr_re_cache.stats;
+    pthread_mutex_unlock(&colr_re_cache.lock);
+    return stats;
+}
+
+/*! Returns all `regmatch_t` matches for regex pattern in a \string.
+
+    \details
+    This is a wrapper around ColrMatches_from_re(), which stores the matches
+    in a single allocation. Use that, or ColrMatchIter_next(), when you don't
+    need an array of individually allocated matches.
+
+    \pi s         The string to search.
+    \pi repattern The pattern to look for.
+    \return       \parblock
+                    A pointer to an allocated array of `regmatch_t*`,
+                    or `NULL` if \p s is `NULL`, \p repattern is `NULL`,
+                    or there are no matches.
+                    The last member is always `NULL`.
+                    \mustfree
+                  \endparblock
+
+    \examplecodefor{colr_re_matches,.c}
+        #include "colr.h"
+        int main(void) {
+            // Compile a regex pattern.
+            regex_t pat;
+            if (regcomp(&pat, "foo", 0)) {
+                regfree(&pat);
+                return EXIT_FAILURE;
+            }
+            // The string to operate on.
+            const char* s = "This foo is a foo string, foo?";
+            // Get all matches.
+            regmatch_t** matches = colr_re_matches(s, &pat);
+            if (!matches) {
+                // This should be impossible (for this example).
                 fprintf(stderr, "No matches?\n");
                 return EXIT_FAILURE;
             }
@@ -2515,40 +4108,129 @@ size_t colr_str_noncode_len(const char* s) {
     \endexamplecode
 */
 regmatch_t** colr_re_matches(const char* s, regex_t* repattern) {
-    if (!(s && repattern)) return NULL;
-
-    size_t num_matches_all = strlen(s);
-    size_t num_submatches = 1;
-    regmatch_t match_current[num_submatches];
-    regmatch_t** matches = calloc(num_matches_all + 1, sizeof(regmatch_t));
-    int ret = regexec(repattern, s, num_submatches, match_current, 0);
-    if (ret) {
-        // No match found.
-        free(matches);
+    ColrMatches cmatches = ColrMatches_from_re(s, repattern);
+    if (!cmatches.count) return NULL;
+    regmatch_t** matches = calloc(cmatches.count + 1, sizeof(regmatch_t*));
+    if (!matches) {
+        ColrMatches_free(&cmatches);
         return NULL;
     }
-    size_t index = 0;
-    while (ret == 0) {
-        // Found a match, add it to the collection.
-        matches[index++] = colr_alloc_regmatch(match_current[0]);
-        size_t offset_diff = match_current[0].rm_eo;
-        const char* rest = s + offset_diff;
-        ret = regexec(repattern, rest, num_submatches, match_current, 0);
-        match_current[0].rm_so = match_current[0].rm_so + offset_diff;
-        match_current[0].rm_eo = match_current[0].rm_eo + offset_diff;
+    for (size_t i = 0; i < cmatches.count; i++) {
+        matches[i] = colr_alloc_regmatch(cmatches.matches[i]);
     }
     // Mark the end.
-    free(matches[index]);
-    matches[index++] = NULL;
-    // Free any unused matches.
-    while (index <= num_matches_all) {
-        free(matches[index]);
-        matches[index++] = NULL;
-    }
-
+    matches[cmatches.count] = NULL;
+    ColrMatches_free(&cmatches);
     return matches;
 }
 
+/*! Colorizes the capture groups for every match of a regex pattern in
+    a \string, in a single pass.
+
+    \details
+    Each match is found once, and every capture group is wrapped with it's
+    own escape-codes and CODE_RESET_ALL. The result is built with one
+    allocation, instead of calling a replace function for each group.
+
+    \details
+    `codes[0]` is used for group `1`, `codes[1]` for group `2`, and so on.
+    Groups with a `NULL` or empty (`""`) code, groups without a code, and
+    groups that did not participate in a match are left alone.
+    When groups are nested or overlap, the group that starts first wins
+    (the outer group, for nested groups).
+
+    \pi s         The string to operate on.
+    \pi repattern The pattern to match, with one or more capture groups.
+    \pi codes     \parblock
+                      An array of escape-code strings, one for each group.
+                      It may be `NULL` if \p count is `0`.
+                  \endparblock
+    \pi count     The number of strings in \p codes.
+    \return       \parblock
+                      An allocated string with the result, or `NULL` if
+                      \p s / \p repattern is `NULL`, or allocation fails.
+                      \mustfree
+                      \maybenullalloc
+                  \endparblock
+
+    \sa colr_re_groups
+    \sa ColrMatchIter_next_groups
+*/
+char* colr_str_re_groups(const char* restrict s, regex_t* repattern, char* const* codes, size_t count) {
+    if (!(s && repattern)) return NULL;
+    if (!codes) count = 0;
+    size_t s_len = strlen(s);
+    size_t nmatch = repattern->re_nsub + 1;
+    regmatch_t* groups = calloc(nmatch, sizeof(regmatch_t));
+    // Group spans for one match. The `rule` member is the index into `codes`.
+    ColrHighlightSpan* found = calloc(nmatch, sizeof(ColrHighlightSpan));
+    ColrHighlightSpan* spans = NULL;
+    size_t span_count = 0;
+    size_t span_cap = 0;
+    size_t final_len = s_len;
+    bool failed = !(groups && found);
+    ColrMatchIter miter = ColrMatchIter_new(s, repattern);
+    // End of the last colorized group, to skip nested/overlapping groups.
+    regoff_t last_end = 0;
+    while (!failed && ColrMatchIter_next_groups(&miter, groups, nmatch)) {
+        size_t found_count = 0;
+        for (size_t g = 1; (g < nmatch) && (g <= count); g++) {
+            regmatch_t group = groups[g];
+            if ((group.rm_so < 0) || (group.rm_so == group.rm_eo)) continue;
+            if (!(codes[g - 1] && codes[g - 1][0])) continue;
+            // Insertion sort by starting offset, keeping the group order for ties.
+            size_t i = found_count++;
+            while (i && (found[i - 1].match.rm_so > group.rm_so)) {
+                found[i] = found[i - 1];
+                i--;
+            }
+            found[i] = (ColrHighlightSpan){.match=group, .rule=g - 1};
+        }
+        for (size_t i = 0; i < found_count; i++) {
+            if (found[i].match.rm_so < last_end) continue;
+            if (span_count == span_cap) {
+                span_cap = span_cap ? span_cap * 2 : 16;
+                ColrHighlightSpan* grown = realloc(spans, span_cap * sizeof(ColrHighlightSpan));
+                if (!grown) {
+                    failed = true;
+                    break;
+                }
+                spans = grown;
+            }
+            spans[span_count++] = found[i];
+            last_end = found[i].match.rm_eo;
+            final_len += strlen(codes[found[i].rule]) + (CODE_RESET_LEN - 1);
+        }
+    }
+    free(groups);
+    free(found);
+    char* result = failed ? NULL : malloc(final_len + 1);
+    if (!result) {
+        free(spans);
+        return NULL;
+    }
+    char* dest = result;
+    size_t pos = 0;
+    for (size_t i = 0; i < span_count; i++) {
+        regmatch_t match = spans[i].match;
+        const char* code = codes[spans[i].rule];
+        size_t code_len = strlen(code);
+        memcpy(dest, s + pos, match.rm_so - pos);
+        dest += match.rm_so - pos;
+        memcpy(dest, code, code_len);
+        dest += code_len;
+        memcpy(dest, s + match.rm_so, match.rm_eo - match.rm_so);
+        dest += match.rm_eo - match.rm_so;
+        memcpy(dest, CODE_RESET_ALL, CODE_RESET_LEN - 1);
+        dest += CODE_RESET_LEN - 1;
+        pos = match.rm_eo;
+    }
+    memcpy(dest, s + pos, s_len - pos);
+    dest[s_len - pos] = '\0';
+    free(spans);
+    return result;
+}
+
 /*! Replaces the first substring found in a \string.
 
     \details
@@ -2908,8 +4590,13 @@ char* colr_str_replace_ColorText(const char* restrict s, const char* restrict ta
                  \endparblock
 
 
+    \details
+    The compiled pattern is cached with colr_re_cache_acquire(), so repeated
+    calls with the same pattern and flags only compile it once.
+
     \sa colr_replace
     \sa colr_replace_re
+    \sa colr_re_cache_acquire
 
     \examplecodefor{colr_str_replace_re,.c}
     #include "colr.h"
@@ -2931,14 +4618,10 @@ char* colr_str_replace_ColorText(const char* restrict s, const char* restrict ta
 char* colr_str_replace_re(const char* restrict s, const char* restrict pattern, const char* restrict repl, int re_flags) {
     if (!(s && pattern)) return NULL;
     if ((s[0] == '\0') || (pattern[0] == '\0')) return NULL;
-    regex_t repat;
-    // Always use extended regex.
-    if (!(re_flags & REG_EXTENDED)) re_flags = re_flags | REG_EXTENDED;
-    if (regcomp(&repat, pattern, re_flags)) {
-        return NULL;
-    }
-    char* result = colr_str_replace_re_pat(s, &repat, repl);
-    regfree(&repat);
+    regex_t* repat = colr_re_cache_acquire(pattern, re_flags);
+    if (!repat) return NULL;
+    char* result = colr_str_replace_re_pat(s, repat, repl);
+    colr_re_cache_release(repat);
     return result;
 }
 
@@ -2962,8 +4645,13 @@ char* colr_str_replace_re(const char* restrict s, const char* restrict pattern,
                  \endparblock
 
 
+    \details
+    The compiled pattern is cached with colr_re_cache_acquire(), so repeated
+    calls with the same pattern and flags only compile it once.
+
     \sa colr_replace
     \sa colr_replace_re
+    \sa colr_re_cache_acquire
 
     \examplecodefor{colr_str_replace_re_all,.c}
     #include "colr.h"
@@ -2985,14 +4673,10 @@ char* colr_str_replace_re(const char* restrict s, const char* restrict pattern,
 char* colr_str_replace_re_all(const char* restrict s, const char* restrict pattern, const char* restrict repl, int re_flags) {
     if (!(s && pattern)) return NULL;
     if ((s[0] == '\0') || (pattern[0] == '\0')) return NULL;
-    regex_t repat;
-    // Always use extended regex.
-    if (!(re_flags & REG_EXTENDED)) re_flags = re_flags | REG_EXTENDED;
-    if (regcomp(&repat, pattern, re_flags)) {
-        return NULL;
-    }
-    char* result = colr_str_replace_re_pat_all(s, &repat, repl);
-    regfree(&repat);
+    regex_t* repat = colr_re_cache_acquire(pattern, re_flags);
+    if (!repat) return NULL;
+    char* result = colr_str_replace_re_pat_all(s, repat, repl);
+    colr_re_cache_release(repat);
     return result;
 }
 
@@ -3420,6 +5104,10 @@ char* colr_str_replace_re_match_i(const char* restrict ref, char* target, regmat
     Using `NULL` as a replacement is like using an empty string (""), which
     removes the \p target string from \p s.
 
+    \details
+    The matches must be in order, and must not overlap. The result is built
+    in a single forward pass with ColrMatches_replace().
+
     \pi s        The string to operate on.
     \pi matches  \parblock
                     Regex match objects to find text to replace.
@@ -3440,48 +5128,18 @@ char* colr_str_replace_re_match_i(const char* restrict ref, char* target, regmat
 char* colr_str_replace_re_matches(const char* restrict s, regmatch_t** matches, const char* restrict repl) {
     if (!(s && matches)) return NULL;
     if (s[0] == '\0') return NULL;
-    size_t final_len = 0;
     // Count matches, this better be NULL-terminated!
     size_t cnt = 0;
     while (matches[cnt]) cnt++;
-
-    if (repl) {
-        size_t repl_len = strlen(repl);
-        final_len = strlen(s) + (repl_len * cnt);
-    } else {
-        repl = "";
-        final_len = strlen(s);
-    }
-
-    char* result = calloc(final_len + 1, sizeof(char));
-    // Using the original string as a reference for the first time around.
-    const char* using = s;
-    // Loop through the matches backwards, so starting/ending offsets don't change.
-    cnt--;
-    while (cnt > 0) {
-        regmatch_t* match = matches[cnt];
-        if (!match) break;
-        char* replaced = colr_str_replace_re_match_i(using, result, match, repl);
-        if (!replaced) {
-            // LCOV_EXCL_START
-            // Could happen if `result` is not big enough.
-            free(result);
-            return NULL;
-            // LCOV_EXCL_STOP
+    ColrMatches cmatches = {.matches=NULL, .count=0, .cap=0};
+    for (size_t i = 0; i < cnt; i++) {
+        if (!ColrMatches_append(&cmatches, *matches[i])) {
+            ColrMatches_free(&cmatches); // LCOV_EXCL_LINE
+            return NULL; // LCOV_EXCL_LINE
         }
-        // We need to reference the result now, to pick up line changes.
-        using = result;
-        cnt--;
-    }
-    if (!matches[0]) return result;
-    char* finalrepl = colr_str_replace_re_match_i(using, result, matches[0], repl);
-    if (!finalrepl) {
-        // LCOV_EXCL_START
-        // Could happen if `result` is not big enough.
-        free(result);
-        return NULL;
-        // LCOV_EXCL_STOP
     }
+    char* result = ColrMatches_replace(&cmatches, s, repl);
+    ColrMatches_free(&cmatches);
     return result;
 }
 
@@ -3772,17 +5430,52 @@ char* colr_str_replace_re_pat_all(const char* restrict s, regex_t* repattern, co
     if (!(s && repattern)) return NULL;
     if (s[0] == '\0') return NULL;
     if (!repl) repl = "";
-    regmatch_t** matches = colr_re_matches(s, repattern);
-    if (!matches) return NULL;
-
+    ColrMatches cmatches = ColrMatches_from_re(s, repattern);
+    if (!cmatches.count) return NULL;
     // Found all matches, now replace them.
-    char* result = colr_str_replace_re_matches(s, matches, repl);
-    // Free all of the matches.
-    colr_free_re_matches(matches);
-    matches = NULL;
+    char* result = ColrMatches_replace(&cmatches, s, repl);
+    ColrMatches_free(&cmatches);
     return result;
 }
 
+/*! Replaces all matches to a regex pattern in a \string, writing the result
+    to a file.
+
+    \details
+    Matches are found lazily with ColrMatchIter_next(), and nothing is
+    allocated. Unlike colr_str_replace_re_pat_all(), the string is still
+    written when there are no matches.
+
+    \details
+    Using `NULL` as a replacement is like using an empty string (""), which
+    removes the matches from \p s.
+
+    \pi fp        The file to write to.
+    \pi s         The string to operate on.
+    \pi repattern The regex pattern to match.
+    \pi repl      The string to replace with.
+    \return       The number of matches that were replaced.
+
+    \sa colr_str_replace_re_pat_all
+*/
+size_t colr_str_replace_re_pat_all_fp(FILE* fp, const char* restrict s, regex_t* repattern, const char* restrict repl) {
+    if (!(fp && s && repattern)) return 0;
+    if (!repl) repl = "";
+    size_t repl_len = strlen(repl);
+    size_t cnt = 0;
+    size_t pos = 0;
+    ColrMatchIter iter = ColrMatchIter_new(s, repattern);
+    regmatch_t match;
+    while (ColrMatchIter_next(&iter, &match)) {
+        fwrite(s + pos, 1, match.rm_so - pos, fp);
+        fwrite(repl, 1, repl_len, fp);
+        pos = match.rm_eo;
+        cnt++;
+    }
+    fwrite(s + pos, 1, iter.length - pos, fp);
+    return cnt;
+}
+
 /*! Replace all matches to a regex pattern in a \string with a ColorArg's string result.
     \details
     Using `NULL` as a replacement is like using an empty string ("").
@@ -4034,6 +5727,9 @@ char* colr_str_repr(const char* s) {
 
 /*! Right-justifies a \string, ignoring escape codes when measuring the width.
 
+    \details
+    The width is measured in terminal columns, with colr_str_display_width().
+
     \pi s       \parblock
                     The string to justify.
                     \mustnullin
@@ -4068,12 +5764,12 @@ char* colr_str_rjust(const char* s, int width, const char padchar) {
     if (!s) return NULL;
     char pad = padchar == '\0' ? ' ' : padchar;
     size_t length = strlen(s);
-    size_t noncode_len = colr_str_noncode_len(s);
+    size_t display_width = colr_str_display_width(s);
     if (width == 0) {
         TermSize ts = colr_term_size();
         width = ts.columns;
     }
-    int diff = width - noncode_len;
+    int diff = width - display_width;
     char* result;
     if (diff < 1) {
         // No room for padding, also asprintf can't do empty strings.
@@ -4167,17 +5863,34 @@ bool colr_str_starts_with(const char* restrict s, const char* restrict prefix) {
 */
 char* colr_str_strip_codes(const char* s) {
     if (!s) return NULL;
-    if (s[0] == '\0') return colr_empty_str();
-    size_t length = strlen(s);
+    return colr_str_strip_codes_n(s, strlen(s));
+}
+
+/*! Like colr_str_strip_codes(), but only strips the first \p length bytes
+    of \p s, which does not need to be null-terminated.
+
+    \pi s      The string to strip escape codes from.
+    \pi length Number of bytes in \p s to use.
+    \return    \parblock
+                   An allocated string with the result.
+                   \mustfree
+                   \maybenullalloc
+               \endparblock
+
+    \sa colr_str_strip_codes
+*/
+char* colr_str_strip_codes_n(const char* s, size_t length) {
+    if (!s) return NULL;
+    if (!length) return colr_empty_str();
     char* final = calloc(length + 1, sizeof(char));
-    size_t i = 0, pos = 0;
-    while (s[i]) {
-        if (s[i] == '\x1b') {
-            // Skip past the code.
-            while (!colr_char_is_code_end(s[i++]));
-            continue;
-        }
-        final[pos++] = s[i++];
+    if (!final) return NULL;
+    char* pos = final;
+    ColrTokenIter iter = ColrTokenIter_new_n(s, length);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_TEXT) continue;
+        memcpy(pos, token.start, token.length);
+        pos += token.length;
     }
     return final;
 }
@@ -4245,22 +5958,56 @@ bool colr_supports_rgb(void) {
     return false;
 }
 
-/*! Same as colr_supports_rgb(), but the environment is only checked on the
-    first call. All other calls return the same result as the first call.
+/*! Same as colr_supports_rgb(), but the environment is only checked once.
+    All other calls return the same result as the first call.
+
+    \details
+    This uses colr_term_caps(), so it is thread-safe.
 
     \return `true` if 24-bit (true color, or "rgb") support is detected, otherwise `false`.
 */
 bool colr_supports_rgb_static(void) {
-    static int support_state = 0;
-    // If we've already checked, return the previous result.
-    if (support_state) return (support_state == 1);
-    // Check for rgb support, and store the result for later calls.
-    support_state = colr_supports_rgb() ? 1 : -1;
-    return (support_state == 1);
+    return colr_term_caps().depth == DEPTH_RGB;
+}
+
+/*! Returns the capabilities of the terminal attached to `stdout`.
+
+    \details
+    The terminal is only probed (with ColrTermCaps_probe()) on the first call.
+    After that, the result is returned without any system calls or
+    environment lookups.
+
+    \details
+    This is thread-safe.
+
+    \return A ColrTermCaps struct, with the detected capabilities.
+
+    \sa ColrTermCaps_probe
+*/
+ColrTermCaps colr_term_caps(void) {
+    pthread_once(&colr_term_caps_cache.once, colr_term_caps_init);
+    return colr_term_caps_cache.caps;
+}
+
+/*! Fills in the global terminal-capability cache.
+
+    \details
+    This is only called once, through `pthread_once()` in colr_term_caps().
+
+    \sa colr_term_caps
+*/
+void colr_term_caps_init(void) {
+    colr_term_caps_cache.caps = ColrTermCaps_probe(STDOUT_FILENO);
 }
 
 /*! Attempts to retrieve the row/column size of the terminal and returns a TermSize.
 
+    \details
+    The size is only queried on the first call, or after the cache has been
+    invalidated with colr_term_size_invalidate(), colr_term_size_set_fd(),
+    or a `SIGWINCH` signal (see colr_term_size_watch()).
+    Without one of those, a terminal resize is not noticed.
+
     \details
     If the call fails, the environment variables `LINES` and `COLUMNS` are checked.
     If that fails, a default `TermSize` struct is returned:
@@ -4268,60 +6015,256 @@ bool colr_supports_rgb_static(void) {
     (TermSize){.rows=35, .columns=80}
     \endcode
 
+    \details
+    This is thread-safe.
+
     \return A TermSize struct with terminal size information.
+
+    \sa colr_win_size
 */
 TermSize colr_term_size(void) {
-    struct winsize ws = colr_win_size();
-    return (TermSize){.rows=ws.ws_row, .columns=ws.ws_col};
+    uint_fast64_t packed = atomic_load(&colr_term_size_cache.size);
+    bool stale = (
+        atomic_load(&colr_term_size_cache.stale) &&
+        atomic_exchange(&colr_term_size_cache.stale, false)
+    );
+    if (stale || !packed) {
+        struct winsize ws = colr_win_size();
+        packed = COLR_TERM_SIZE_VALID | ((uint_fast64_t)ws.ws_row << 16) | ws.ws_col;
+        atomic_store(&colr_term_size_cache.size, packed);
+    }
+    return (TermSize){
+        .rows=(unsigned short)(packed >> 16),
+        .columns=(unsigned short)packed,
+    };
 }
 
-/*! Attempts to retrieve a `winsize` struct from an `ioctl` call.
+/*! Mark the cached terminal size as stale, so the next colr_term_size() call
+    queries it again.
 
     \details
-    If the call fails, the environment variables `LINES` and `COLUMNS` are checked.
-    If that fails, a default `winsize` struct is returned:
-    \code
-    (struct winsize){.ws_row=35, .ws_col=80, .ws_xpixel=0, .ws_ypixel=0}
-    \endcode
+    This is async-signal-safe, and can be called from your own `SIGWINCH`
+    handler instead of using colr_term_size_watch().
+*/
+void colr_term_size_invalidate(void) {
+    atomic_store(&colr_term_size_cache.stale, true);
+}
+
+/*! Set the file descriptor that colr_term_size() and colr_win_size() query.
 
     \details
-    `man ioctl_tty` says that `.ws_xpixel` and `.ws_ypixel` are unused.
+    The default is `0` (stdin), which is not a terminal when input is piped.
+    Use `STDOUT_FILENO`, `STDERR_FILENO`, or an open `/dev/tty` in that case.
+    The cached size is invalidated.
 
-    \return A `winsize` struct (`sys/ioctl.h`) with window size information.
+    \pi fd The file descriptor to use.
 */
-struct winsize colr_win_size(void) {
-    struct winsize ws = {.ws_row=0, .ws_col=0, .ws_xpixel=0, .ws_ypixel=0};
-    if (ioctl(0, TIOCGWINSZ, &ws) < 0) {
-        // No support? Print a message for debug builds, when not testing.
-        #ifndef COLR_TEST
-            dbug("No support for ioctl TIOCGWINSZ, using defaults.\n");
-        #endif
-        return colr_win_size_env();
+void colr_term_size_set_fd(int fd) {
+    atomic_store(&colr_term_size_cache.fd, fd);
+    colr_term_size_invalidate();
+}
+
+/*! The `SIGWINCH` handler installed by colr_term_size_watch().
+
+    \details
+    It invalidates the cached terminal size, and then calls the handler that
+    was installed before it (if any).
+
+    \pi signum  The signal number.
+    \pi info    Signal info, passed on to the previous handler.
+    \pi context Signal context, passed on to the previous handler.
+*/
+void colr_term_size_sigwinch(int signum, siginfo_t* info, void* context) {
+    colr_term_size_invalidate();
+    struct sigaction* old = &colr_term_size_cache.old_action;
+    if (old->sa_flags & SA_SIGINFO) {
+        if (old->sa_sigaction) old->sa_sigaction(signum, info, context);
+    } else if ((old->sa_handler != SIG_DFL) && (old->sa_handler != SIG_IGN)) {
+        old->sa_handler(signum);
     }
-    return ws;
 }
 
-/*! Get window/terminal size using the environment variables `LINES`, `COLUMNS`,
-    or `COLS`.
+/*! Install or remove a `SIGWINCH` handler that invalidates the cached
+    terminal size when the terminal is resized.
 
     \details
-    This is used as a fallback if the `ioctl()` call fails in colr_win_size().
-    If environment variables are not available, a default `winsize` struct is returned:
-    \code
-    (struct winsize){.ws_row=35, .ws_col=80, .ws_xpixel=0, .ws_ypixel=0}
-    \endcode
+    The previous `SIGWINCH` handler is still called, and it is restored when
+    the handler is removed. This is not thread-safe, call it during setup.
 
+    \pi enabled Whether to install (`true`) or remove (`false`) the handler.
+    \return     `true` on success, or `false` if `sigaction()` fails.
 
-    \return A `winsize` struct (`sys/ioctl.h`) with window size information.
+    \sa colr_term_size
 */
-struct winsize colr_win_size_env(void) {
-    char* env_rows = getenv("LINES");
-    unsigned short default_rows = 0;
-    if (!env_rows || sscanf(env_rows, "%hu", &default_rows) != 1) {
-        default_rows = 35;
-    }
-    char* env_cols = getenv("COLUMNS");
-    if (!env_cols) env_cols = getenv("COLS");
+bool colr_term_size_watch(bool enabled) {
+    if (enabled == colr_term_size_cache.watching) return true;
+    if (!enabled) {
+        if (sigaction(SIGWINCH, &colr_term_size_cache.old_action, NULL) < 0) return false;
+        colr_term_size_cache.watching = false;
+        return true;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = colr_term_size_sigwinch;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGWINCH, &action, &colr_term_size_cache.old_action) < 0) return false;
+    colr_term_size_cache.watching = true;
+    // Anything cached before this may be out of date.
+    colr_term_size_invalidate();
+    return true;
+}
+
+/*! Decodes a single UTF-8 character from the start of a \string.
+
+    \details
+    This is a strict decoder. Overlong encodings, surrogates, and values
+    above `U+10FFFF` are invalid. It does not depend on the locale.
+
+    \pi s         \parblock
+                      The string to decode.
+                      \mustnullin
+                  \endparblock
+    \po codepoint Set to the decoded code point on success. Can be `NULL`.
+    \return       The number of bytes in the character (1-4).
+    \retval 0          if \p s is `NULL` or empty.
+    \retval (size_t)-1 if an invalid or incomplete UTF-8 sequence is found at
+                       the start of \p s.
+
+    \sa colr_mb_len
+    \sa colr_str_mb_len
+*/
+size_t colr_utf8_decode(const char* s, uint32_t* codepoint) {
+    if (!s) return 0;
+    const unsigned char* us = (const unsigned char*)s;
+    if (us[0] < 0x80) {
+        if (codepoint) *codepoint = us[0];
+        return us[0] ? 1 : 0;
+    }
+    size_t length = 0;
+    uint32_t value = 0;
+    // Allowed range for the second byte, to reject overlongs and surrogates.
+    unsigned char lower = 0x80;
+    unsigned char upper = 0xBF;
+    if (us[0] < 0xC2) {
+        // Continuation byte, or an overlong 2 byte sequence.
+        return (size_t)-1;
+    } else if (us[0] < 0xE0) {
+        length = 2;
+        value = us[0] & 0x1F;
+    } else if (us[0] < 0xF0) {
+        length = 3;
+        value = us[0] & 0x0F;
+        if (us[0] == 0xE0) lower = 0xA0;
+        else if (us[0] == 0xED) upper = 0x9F;
+    } else if (us[0] < 0xF5) {
+        length = 4;
+        value = us[0] & 0x07;
+        if (us[0] == 0xF0) lower = 0x90;
+        else if (us[0] == 0xF4) upper = 0x8F;
+    } else {
+        return (size_t)-1;
+    }
+    if ((us[1] < lower) || (us[1] > upper)) return (size_t)-1;
+    // A null-terminator is not a continuation byte, so this stops there.
+    for (size_t i = 1; i < length; i++) {
+        if ((us[i] & 0xC0) != 0x80) return (size_t)-1;
+        value = (value << 6) | (us[i] & 0x3F);
+    }
+    if (codepoint) *codepoint = value;
+    return length;
+}
+
+/*! Encodes a single Unicode code point as UTF-8.
+
+    \details
+    This is the reverse of colr_utf8_decode(). The result is not
+    null-terminated.
+
+    \po dest      Destination for the encoded bytes. Must have room for at least 4 bytes.
+    \pi codepoint The code point to encode.
+    \return       The number of bytes written to \p dest (1-4).
+    \retval 0      if \p dest is `NULL`, or \p codepoint is a surrogate or
+                   above `U+10FFFF`.
+
+    \sa colr_utf8_decode
+*/
+size_t colr_utf8_encode(char* dest, uint32_t codepoint) {
+    if (!dest) return 0;
+    if (codepoint < 0x80) {
+        dest[0] = (char)codepoint;
+        return 1;
+    } else if (codepoint < 0x800) {
+        dest[0] = (char)(0xC0 | (codepoint >> 6));
+        dest[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    } else if (codepoint < 0x10000) {
+        if ((codepoint >= 0xD800) && (codepoint <= 0xDFFF)) return 0;
+        dest[0] = (char)(0xE0 | (codepoint >> 12));
+        dest[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        dest[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    } else if (codepoint <= 0x10FFFF) {
+        dest[0] = (char)(0xF0 | (codepoint >> 18));
+        dest[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        dest[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        dest[3] = (char)(0x80 | (codepoint & 0x3F));
+        return 4;
+    }
+    return 0;
+}
+
+/*! Attempts to retrieve a `winsize` struct from an `ioctl` call.
+
+    \details
+    This is not cached, see colr_term_size(). The file descriptor can be set
+    with colr_term_size_set_fd().
+
+    \details
+    If the call fails, the environment variables `LINES` and `COLUMNS` are checked.
+    If that fails, a default `winsize` struct is returned:
+    \code
+    (struct winsize){.ws_row=35, .ws_col=80, .ws_xpixel=0, .ws_ypixel=0}
+    \endcode
+
+    \details
+    `man ioctl_tty` says that `.ws_xpixel` and `.ws_ypixel` are unused.
+
+    \return A `winsize` struct (`sys/ioctl.h`) with window size information.
+*/
+struct winsize colr_win_size(void) {
+    struct winsize ws = {.ws_row=0, .ws_col=0, .ws_xpixel=0, .ws_ypixel=0};
+    if (ioctl(atomic_load(&colr_term_size_cache.fd), TIOCGWINSZ, &ws) < 0) {
+        // No support? Print a message for debug builds, when not testing.
+        #ifndef COLR_TEST
+            dbug("No support for ioctl TIOCGWINSZ, using defaults.\n");
+        #endif
+        return colr_win_size_env();
+    }
+    return ws;
+}
+
+/*! Get window/terminal size using the environment variables `LINES`, `COLUMNS`,
+    or `COLS`.
+
+    \details
+    This is used as a fallback if the `ioctl()` call fails in colr_win_size().
+    If environment variables are not available, a default `winsize` struct is returned:
+    \code
+    (struct winsize){.ws_row=35, .ws_col=80, .ws_xpixel=0, .ws_ypixel=0}
+    \endcode
+
+
+    \return A `winsize` struct (`sys/ioctl.h`) with window size information.
+*/
+struct winsize colr_win_size_env(void) {
+    char* env_rows = getenv("LINES");
+    unsigned short default_rows = 0;
+    if (!env_rows || sscanf(env_rows, "%hu", &default_rows) != 1) {
+        default_rows = 35;
+    }
+    char* env_cols = getenv("COLUMNS");
+    if (!env_cols) env_cols = getenv("COLS");
 
     unsigned short default_cols = 0;
     if (!env_cols || sscanf(env_cols, "%hu", &default_cols) != 1) {
@@ -4366,7 +6309,15 @@ void format_bgx(char* out, unsigned char num) {
 */
 void format_bg_RGB(char* out, RGB rgb) {
     if (!out) return;
-    snprintf(out, CODE_RGB_LEN, "\x1b[48;2;%d;%d;%dm", rgb.red, rgb.green, rgb.blue);
+    // Same as "\x1b[48;2;%d;%d;%dm", rainbows create a lot of these.
+    memcpy(out, "\x1b[48;2;", 7);
+    char* p = colr_fmt_uchar(out + 7, rgb.red);
+    *p++ = ';';
+    p = colr_fmt_uchar(p, rgb.green);
+    *p++ = ';';
+    p = colr_fmt_uchar(p, rgb.blue);
+    p[0] = 'm';
+    p[1] = '\0';
 }
 
 /*! Create an escape code for a true color (rgb) fore color using an
@@ -4409,7 +6360,15 @@ void format_fgx(char* out, unsigned char num) {
 */
 void format_fg_RGB(char* out, RGB rgb) {
     if (!out) return;
-    snprintf(out, CODE_RGB_LEN, "\x1b[38;2;%d;%d;%dm", rgb.red, rgb.green, rgb.blue);
+    // Same as "\x1b[38;2;%d;%d;%dm", rainbows create a lot of these.
+    memcpy(out, "\x1b[38;2;", 7);
+    char* p = colr_fmt_uchar(out + 7, rgb.red);
+    *p++ = ';';
+    p = colr_fmt_uchar(p, rgb.green);
+    *p++ = ';';
+    p = colr_fmt_uchar(p, rgb.blue);
+    p[0] = 'm';
+    p[1] = '\0';
 }
 
 /*! Create an escape code for a true color (rgb) fore color using an
@@ -4518,8 +6477,13 @@ char* _colr_join(void* joinerp, ...) {
     ColorResult* joiner_cresp = NULL;
     ColorText* joiner_ctextp = NULL;
 
+    // ColorArgs are only text-less codes, so they are empty when disabled.
+    bool disabled = colr_is_disabled();
     bool needs_reset = false;
-    if (ColorArg_is_ptr(joinerp)) {
+    if (ColorArg_is_ptr(joinerp) && disabled) {
+        ColorArg_free(joinerp);
+        joiner = "";
+    } else if (ColorArg_is_ptr(joinerp)) {
         // It's a ColorArg.
         joiner_cargp = joinerp;
         joiner = ColorArg_to_esc(*joiner_cargp);
@@ -4561,7 +6525,10 @@ char* _colr_join(void* joinerp, ...) {
         // back, style, and ColrC macros. I'm going to free them, so the user
         // doesn't have to keep track of all the temporary pieces that built
         // this string.
-        if (ColorArg_is_ptr(arg)) {
+        if (ColorArg_is_ptr(arg) && disabled) {
+            ColorArg_free(arg);
+            piece = "";
+        } else if (ColorArg_is_ptr(arg)) {
             // It's a ColorArg.
             cargp = arg;
             piece = ColorArg_to_esc(*cargp);
@@ -4642,7 +6609,8 @@ size_t _colr_join_size(void* joinerp, va_list args) {
             need_join = true;
         }
     }
-    length += CODE_RESET_LEN;
+    // No reset code is added when colors are disabled.
+    length += colr_is_disabled() ? 1 : CODE_RESET_LEN;
     return length;
 }
 
@@ -4888,7 +6856,10 @@ size_t _colr_join_array_length(void* ps) {
 size_t _colr_ptr_length(void* p) {
     if (!p) return 0;
     size_t length = 0;
-    if (ColorArg_is_ptr(p)) {
+    if (ColorArg_is_ptr(p) && colr_is_disabled()) {
+        // An empty string, when colors are disabled.
+        length = 1;
+    } else if (ColorArg_is_ptr(p)) {
         // It's a ColorArg.
         ColorArg* cargp = p;
         length = ColorArg_length(*cargp);
@@ -4970,6 +6941,90 @@ char* _colr_ptr_to_str(void* p) {
     return strdup((char*)p);
 }
 
+/*! Colorizes the capture groups for every match of a regex pattern in
+    a \string, using ColorArgs, ColorTexts, or escape-code strings.
+
+    \details
+    You should use the colr_re_groups() macro instead.
+
+    \warninternal
+
+    \pi s        The string to operate on.
+    \pi pattern  The regex pattern, with one or more capture groups.
+    \pi re_flags Flags for `regcomp()`. `REG_EXTENDED` is always used.
+    \pi ...      \parblock
+                     ColorArg pointers, ColorText pointers, or escape-code
+                     strings, one for each group, ending with _ColrLastArg.
+                     `NULL` leaves a group alone.
+                     \colrwillfree
+                 \endparblock
+    \return      \parblock
+                     An allocated string with the result, or `NULL` if \p s /
+                     \p pattern is `NULL`, the pattern doesn't compile, or
+                     allocation fails.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa colr_re_groups
+    \sa colr_str_re_groups
+*/
+char* _colr_re_groups(const char* restrict s, const char* restrict pattern, int re_flags, ...) {
+    va_list args;
+    va_start(args, re_flags);
+    va_list argcopy;
+    va_copy(argcopy, args);
+    size_t count = 0;
+    void* arg = NULL;
+    while_colr_va_arg(argcopy, void*, arg) count++;
+    va_end(argcopy);
+
+    char** codes = count ? calloc(count, sizeof(char*)) : NULL;
+    // Strings that belong to the caller are not freed.
+    bool* owned = count ? calloc(count, sizeof(bool)) : NULL;
+    bool failed = count && !(codes && owned);
+    for (size_t i = 0; i < count; i++) {
+        arg = va_arg(args, void*);
+        if (!arg) continue;
+        char* code = NULL;
+        if (ColorArg_is_ptr(arg)) {
+            code = ColorArg_to_esc(*(ColorArg*)arg);
+            ColorArg_free(arg);
+        } else if (ColorText_is_ptr(arg)) {
+            code = ColorText_to_esc(*(ColorText*)arg);
+            ColorText_free(arg);
+        } else if (ColorResult_is_ptr(arg)) {
+            code = ColorResult_to_str(*(ColorResult*)arg);
+            if (code) code = strdup(code);
+            ColorResult_free(arg);
+        } else {
+            // It better be a string.
+            if (!failed) codes[i] = arg;
+            continue;
+        }
+        if (failed) {
+            free(code);
+            continue;
+        }
+        codes[i] = code;
+        owned[i] = true;
+    }
+    va_end(args);
+
+    char* result = NULL;
+    regex_t* repat = (!failed && s && pattern) ? colr_re_cache_acquire(pattern, re_flags) : NULL;
+    if (repat) {
+        result = colr_str_re_groups(s, repat, codes, count);
+        colr_re_cache_release(repat);
+    }
+    for (size_t i = 0; !failed && (i < count); i++) {
+        if (owned[i]) free(codes[i]);
+    }
+    free(codes);
+    free(owned);
+    return result;
+}
+
 /*! Compares two ArgTypes.
 
     \details
@@ -5184,7 +7239,8 @@ char* ColorArg_example(ColorArg carg, bool colorized) {
     \sa ColorArg
 */
 void ColorArg_free(ColorArg* p) {
-    if (!p) return;
+    // The COLR_DISABLE placeholder is not allocated.
+    if (!p || (p == &colr_disabled_arg)) return;
     free(p);
 }
 
@@ -5264,11 +7320,15 @@ ColorArg ColorArg_from_RGB(ArgType type, RGB value) {
     and the `.value.type` member will be set to `TYPE_INVALID`.
     This means that `ColorArg_is_invalid(carg) == true`.
 
-    \pi s   The escape code to parse. It must not have extra characters.
+    \details
+    For combined codes (`"\x1b[1;31m"`), only the first color/style is used.
+    Use ColorArgs_from_esc_s() to get all of them.
+
+    \pi s   The escape code to parse.
     \return An initialized ColorArg, possibly invalid.
 
     \sa ColorArg
-    \sa colr_str_get_codes
+    \sa ColorArgs_from_esc_s
     \sa ColorValue_from_esc
     \sa BasicValue_from_esc
     \sa ExtendedValue_from_esc
@@ -5276,39 +7336,15 @@ ColorArg ColorArg_from_RGB(ArgType type, RGB value) {
     \sa RGB_from_esc
 */
 ColorArg ColorArg_from_esc(const char* s) {
-    ColorValue cval = ColorValue_from_esc(s);
-    if (ColorValue_is_invalid(cval)) {
-        return (ColorArg){
-            .marker=COLORARG_MARKER,
-            .type=ARGTYPE_NONE,
-            .value=cval
-        };
-    }
-    // The value is good, I hate that the fore/back info was lost.
-    if (cval.type == TYPE_STYLE) {
-        return (ColorArg){
-            .marker=COLORARG_MARKER,
-            .type=STYLE,
-            .value=cval
-        };
-    }
-    // So, I'll parse out the fore/back information.
-    // Fore colors start with: "\x1b[3" or "\x1b[9".
-    // Back colors with: "\x1b[4" or "\x1b[1".
-    if ((s[2] == '3') || (s[2] == '9')) {
-        return (ColorArg){
-            .marker=COLORARG_MARKER,
-            .type=FORE,
-            .value=cval
-        };
-    }
-    assert((s[2] == '4') || (s[2] == '1'));
-    // Back color.
-    return (ColorArg){
+    ColorArg carg = {
         .marker=COLORARG_MARKER,
-        .type=BACK,
-        .value=cval
+        .type=ARGTYPE_NONE,
+        .value=(ColorValue){.type=TYPE_INVALID},
     };
+    if (!s) return carg;
+    // Only the first ColorArg is used, for combined codes.
+    ColorArgs_from_esc_s(&carg, 1, s, strlen(s));
+    return carg;
 }
 
 /*! Build a ColorArg (fore, back, or style value) from a known color name/style.
@@ -5712,11 +7748,201 @@ char* ColorArgs_array_repr(ColorArg** lst) {
     return repr_start;
 }
 
+/*! Parse an SGR escape-code \string into one or more ColorArgs.
+
+    \details
+    Any SGR parameter list is decoded in a single pass, including combined
+    codes like `"\x1b[1;38;5;208;48;2;1;2;3m"`, and the colon-separated forms
+    (`"\x1b[38:5:208m"`, `"\x1b[38:2::1:2:3m"`).
+    Parameters are looked up in the `colr_sgr_info` table. Nothing is allocated.
+
+    \details
+    Unknown parameters, and extended/RGB colors that are out of range or
+    incomplete, produce an invalid ColorArg (`.type == ARGTYPE_NONE`), so the
+    count always reflects what was in the code. Underline colors (`58;...`) are
+    skipped.
+
+    \details
+    Like `snprintf()`, the return value is the number of ColorArgs found, even
+    if \p dest did not have room for all of them. Use `dest = NULL` and
+    `dest_len = 0` to count them.
+
+    \po dest     Destination for the ColorArgs. Can be `NULL` if \p dest_len is `0`.
+    \pi dest_len Maximum number of ColorArgs to write to \p dest.
+    \pi s        \parblock
+                    The escape code to parse. It must start with `"\x1b["`.
+                    It does not need to be null-terminated, parsing stops at
+                    the first `m`, or at \p length bytes.
+                 \endparblock
+    \pi length   Maximum number of bytes to read from \p s.
+    \return      The number of ColorArgs found, or `0` if \p s is `NULL` or not
+                 a complete SGR code.
+
+    \examplecodefor{ColorArgs_from_esc_s,.c}
+    char* s = "\x1b[1;38;5;208;48;2;1;2;3m";
+    ColorArg cargs[4];
+    size_t count = ColorArgs_from_esc_s(cargs, 4, s, strlen(s));
+    assert(count == 3);
+    for (size_t i = 0; i < count; i++) {
+        char* repr = ColorArg_repr(cargs[i]);
+        printf("%s\n", repr);
+        free(repr);
+    }
+    \endexamplecode
+
+    \sa ColorArg_from_esc
+    \sa ColorArgs_from_str
+*/
+size_t ColorArgs_from_esc_s(ColorArg* dest, size_t dest_len, const char* s, size_t length) {
+    if (!s || (length < 3) || (s[0] != '\x1b') || (s[1] != '[')) return 0;
+    if (!dest) dest_len = 0;
+    // Make sure it is a complete SGR code (digits and separators only).
+    size_t end = 2;
+    while ((end < length) && (isdigit((unsigned char)s[end]) || (s[end] == ';') || (s[end] == ':'))) {
+        end++;
+    }
+    if ((end == length) || (s[end] != 'm')) return 0;
+
+    enum {
+        STATE_PARAM,
+        STATE_EXT_MODE,
+        STATE_EXT_VALUE,
+        STATE_RGB_SPACE,
+        STATE_RGB_RED,
+        STATE_RGB_GREEN,
+        STATE_RGB_BLUE,
+    } state = STATE_PARAM;
+    // The ArgType for an extended/RGB color, or ARGTYPE_NONE for underline colors.
+    ArgType ext_type = ARGTYPE_NONE;
+    RGB rgb = {0, 0, 0};
+    bool rgb_invalid = false;
+    size_t count = 0;
+    size_t i = 2;
+    while (true) {
+        // Empty parameters are 0. Large values are capped, they are invalid anyway.
+        unsigned int value = 0;
+        while (isdigit((unsigned char)s[i])) {
+            if (value < 100000) value = (value * 10) + (s[i] - '0');
+            i++;
+        }
+        ColorArg carg = {.marker=COLORARG_MARKER, .type=ARGTYPE_NONE};
+        bool have_carg = false;
+        switch (state) {
+            case STATE_PARAM: {
+                ColrSgrInfo info = {SGR_UNKNOWN, 0};
+                if (value < colr_sgr_info_len) info = colr_sgr_info[value];
+                switch (info.action) {
+                    case SGR_FORE_BASIC:
+                    case SGR_BACK_BASIC:
+                        carg.type = info.action == SGR_FORE_BASIC ? FORE : BACK;
+                        carg.value = (ColorValue){.type=TYPE_BASIC, .basic=info.value};
+                        have_carg = true;
+                        break;
+                    case SGR_STYLE:
+                        carg.type = STYLE;
+                        carg.value = (ColorValue){.type=TYPE_STYLE, .style=info.value};
+                        have_carg = true;
+                        break;
+                    case SGR_FORE_EXT:
+                    case SGR_BACK_EXT:
+                    case SGR_UNDERLINE_EXT:
+                        ext_type = (
+                            info.action == SGR_FORE_EXT ? FORE :
+                            info.action == SGR_BACK_EXT ? BACK : ARGTYPE_NONE
+                        );
+                        state = STATE_EXT_MODE;
+                        break;
+                    default:
+                        carg.value = (ColorValue){.type=TYPE_INVALID};
+                        have_carg = true;
+                }
+                break;
+            }
+            case STATE_EXT_MODE:
+                if (value == 5) {
+                    state = STATE_EXT_VALUE;
+                } else if (value == 2) {
+                    rgb_invalid = false;
+                    state = STATE_RGB_RED;
+                    if (s[i] == ':') {
+                        // The ITU form may have a color-space id before the
+                        // values (38:2:ID:R:G:B), count the values that are left.
+                        size_t values_left = 1;
+                        for (size_t j = i + 1; (s[j] != ';') && (s[j] != 'm'); j++) {
+                            if (s[j] == ':') values_left++;
+                        }
+                        if (values_left > 3) state = STATE_RGB_SPACE;
+                    }
+                } else {
+                    carg.value = (ColorValue){.type=TYPE_INVALID};
+                    have_carg = ext_type != ARGTYPE_NONE;
+                    state = STATE_PARAM;
+                }
+                break;
+            case STATE_EXT_VALUE:
+                if (value > 255) {
+                    carg.value = (ColorValue){.type=TYPE_INVALID_EXT_RANGE};
+                } else {
+                    carg.type = ext_type;
+                    carg.value = (ColorValue){.type=TYPE_EXTENDED, .ext=value};
+                }
+                have_carg = ext_type != ARGTYPE_NONE;
+                state = STATE_PARAM;
+                break;
+            case STATE_RGB_SPACE:
+                state = STATE_RGB_RED;
+                break;
+            case STATE_RGB_RED:
+                rgb.red = value;
+                if (value > 255) rgb_invalid = true;
+                state = STATE_RGB_GREEN;
+                break;
+            case STATE_RGB_GREEN:
+                rgb.green = value;
+                if (value > 255) rgb_invalid = true;
+                state = STATE_RGB_BLUE;
+                break;
+            case STATE_RGB_BLUE:
+                rgb.blue = value;
+                if (value > 255) rgb_invalid = true;
+                if (rgb_invalid) {
+                    carg.value = (ColorValue){.type=TYPE_INVALID_RGB_RANGE};
+                } else {
+                    carg.type = ext_type;
+                    carg.value = (ColorValue){.type=TYPE_RGB, .rgb=rgb};
+                }
+                have_carg = ext_type != ARGTYPE_NONE;
+                state = STATE_PARAM;
+                break;
+        }
+        if (have_carg) {
+            if (count < dest_len) dest[count] = carg;
+            count++;
+        }
+        // Parameters end at 'm'. Anything else is a separator.
+        if (i == end) break;
+        i++;
+    }
+    if ((state != STATE_PARAM) && (ext_type != ARGTYPE_NONE)) {
+        // Incomplete extended/RGB color.
+        if (count < dest_len) {
+            dest[count] = (ColorArg){
+                .marker=COLORARG_MARKER,
+                .type=ARGTYPE_NONE,
+                .value=(ColorValue){.type=TYPE_INVALID},
+            };
+        }
+        count++;
+    }
+    return count;
+}
+
 /*! Create an array of ColorArgs from escape-codes found in a \string.
 
     \details
-    This uses ColorArg_from_esc() and colr_str_get_codes() to build a heap-allocated
-    array of heap-allocated ColorArgs.
+    This uses ColrTokenIter_next() and ColorArgs_from_esc_s() to build a
+    heap-allocated array of heap-allocated ColorArgs. Combined codes, like
+    `"\x1b[1;31;47m"`, produce one ColorArg for each color/style.
 
     \pi s      \parblock
                     A string to get the escape-codes from.
@@ -5761,20 +7987,71 @@ char* ColorArgs_array_repr(ColorArg** lst) {
     \endexamplecode
 */
 ColorArg** ColorArgs_from_str(const char* s, bool unique) {
-    // It's okay to pass a NULL pointer to colr_str_get_codes().
-    char** codes = colr_str_get_codes(s, unique);
-    // There may not be any escape-codes in the string, or allocation failed.
-    if (!codes) return NULL;
-    // Count ColorArgs needed.
+    if (!s) return NULL;
+    return ColorArgs_from_str_n(s, strlen(s), unique);
+}
+
+/*! Like ColorArgs_from_str(), but only uses the first \p length bytes of
+    \p s, which does not need to be null-terminated.
+
+    \pi s      The string to get ColorArgs from.
+    \pi length Number of bytes in \p s to use.
+    \pi unique Whether to only include unique ColorArgs.
+    \return    \parblock
+                   A `NULL`-terminated array of ColorArg pointers, or `NULL`
+                   if there were no escape codes.
+                   \mustfree ColorArgs_array_free()
+                   \maybenullalloc
+               \endparblock
+
+    \sa ColorArgs_from_str
+*/
+ColorArg** ColorArgs_from_str_n(const char* s, size_t length, bool unique) {
+    if (!s || !length) return NULL;
+    // Count the ColorArgs first, so they can all be parsed into one array.
+    size_t total = 0;
+    ColrTokenIter iter = ColrTokenIter_new_n(s, length);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_SGR) continue;
+        total += ColorArgs_from_esc_s(NULL, 0, token.start, token.length);
+    }
+    // There may not be any escape-codes in the string.
+    if (!total) return NULL;
+    ColorArg* parsed = malloc(sizeof(ColorArg) * total);
+    if (!parsed) return NULL;
+    size_t parsed_len = 0;
+    iter = ColrTokenIter_new_n(s, length);
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_SGR) continue;
+        parsed_len += ColorArgs_from_esc_s(
+            parsed + parsed_len,
+            total - parsed_len,
+            token.start,
+            token.length
+        );
+    }
+    // There will be a NULL element added to this array.
+    ColorArg** cargs = malloc(sizeof(ColorArg*) * (total + 1));
+    if (!cargs) {
+        free(parsed);
+        return NULL;
+    }
     size_t count = 0;
-    while (codes[count++]);
-    // There will be a NULL element added to this array, just like the code array.
-    ColorArg** cargs = malloc(sizeof(ColorArg*) * count);
-    count--;
-    for (size_t i = 0; i < count; i++) {
-        cargs[i] = ColorArg_to_ptr(ColorArg_from_esc(codes[i]));
+    for (size_t i = 0; i < total; i++) {
+        if (unique) {
+            bool found = false;
+            for (size_t j = 0; j < count; j++) {
+                if (ColorArg_eq(*(cargs[j]), parsed[i])) {
+                    found = true;
+                    break;
+                }
+            }
+            if (found) continue;
+        }
+        cargs[count++] = ColorArg_to_ptr(parsed[i]);
     }
-    colr_str_array_free(codes);
+    free(parsed);
     cargs[count] = NULL;
     return cargs;
 }
@@ -6381,19 +8658,22 @@ size_t ColorText_length(ColorText ctext) {
     // Empty text yields an empty string, so just "\0".
     if (!ctext.text) return 1;
     size_t length = strlen(ctext.text);
-    if (ctext.fore) length+=ColorArg_length(*(ctext.fore));
-    if (ctext.back) length+=ColorArg_length(*(ctext.back));
-    if (ctext.style) length+=ColorArg_length(*(ctext.style));
-    if (ctext.style || ctext.fore || ctext.back) length += CODE_RESET_LEN;
+    // Only the text and justification are used when colors are disabled.
+    if (!colr_is_disabled()) {
+        if (ctext.fore) length+=ColorArg_length(*(ctext.fore));
+        if (ctext.back) length+=ColorArg_length(*(ctext.back));
+        if (ctext.style) length+=ColorArg_length(*(ctext.style));
+        if (ctext.style || ctext.fore || ctext.back) length += CODE_RESET_LEN;
+    }
     if (!ColorJustify_is_empty(ctext.just)) {
         // Justification will be used, calculate that in.
-        size_t noncode_len = colr_str_noncode_len(ctext.text);
+        size_t display_width = colr_str_display_width(ctext.text);
         if (ctext.just.width == 0) {
             // Go ahead and set the actual width, to reduce calls to colr_term_size().
             TermSize ts = colr_term_size();
             ctext.just.width = ts.columns;
         }
-        int diff = ctext.just.width - noncode_len;
+        int diff = ctext.just.width - display_width;
         // 0 or negative difference means no extra chars are added anyway.
         length += colr_max(0, diff);
     }
@@ -6496,6 +8776,39 @@ void ColorText_set_values(ColorText* ctext, char* text, ...) {
     }
     va_end(args);
 }
+
+/*! Creates a \string with only the escape-codes for a ColorText's style,
+    fore, and back colors.
+
+    \details
+    The text, justification, and reset code are not included. This is useful
+    when the same style is applied to text that is not part of the ColorText.
+
+    \pi ctext ColorText to get the escape-codes for.
+    \return   \parblock
+                  An allocated string with the escape-codes, which may be
+                  empty (`""`) when no colors are set.
+                  \mustfree
+                  \maybenullalloc
+              \endparblock
+
+    \sa ColorText
+    \sa ColorText_to_str
+*/
+char* ColorText_to_esc(ColorText ctext) {
+    // Same order as ColorText_to_str().
+    ColorArg* cargs[] = {ctext.style, ctext.fore, ctext.back};
+    char codes[CODE_ANY_LEN] = {0};
+    for (size_t i = 0; i < 3; i++) {
+        if (!cargs[i] || ColorArg_is_empty(*cargs[i])) continue;
+        char* code = ColorArg_to_esc(*cargs[i]);
+        if (!code) continue;
+        strcat(codes, code);
+        free(code);
+    }
+    return strdup(codes);
+}
+
 /*! Copies a ColorText into allocated memory and returns the pointer.
 
     \details
@@ -6535,6 +8848,12 @@ char* ColorText_to_str(ColorText ctext) {
     if (!ctext.text) return NULL;
     // Make room for any fore/back/style code combo plus the reset_all code.
     char* final = calloc(ColorText_length(ctext), sizeof(char));
+    if (colr_is_disabled()) {
+        // No codes, and no reset.
+        ctext.style = NULL;
+        ctext.fore = NULL;
+        ctext.back = NULL;
+    }
     bool do_reset = (ctext.style || ctext.fore || ctext.back);
     if (ctext.style && !ColorArg_is_empty(*(ctext.style))) {
         char* stylecode = ColorArg_to_esc(*(ctext.style));
@@ -6882,39 +9201,7 @@ char* ColorValue_example(ColorValue cval) {
     \sa ColorArg_from_esc
 */
 ColorValue ColorValue_from_esc(const char* s) {
-    if (!s || s[0] == '\0') return ColorValue_from_value(TYPE_INVALID, NULL);
-    // RGB?
-    RGB rgb;
-    int rgb_ret = RGB_from_esc(s, &rgb);
-    if (rgb_ret == COLOR_INVALID_RANGE) {
-        return ColorValue_from_value(TYPE_INVALID_RGB_RANGE, NULL);
-    } else if (rgb_ret != COLOR_INVALID) {
-        return ColorValue_from_value(TYPE_RGB, &rgb);
-    }
-    // Extended colors?
-    int x_ret = ExtendedValue_from_esc(s);
-    if (x_ret == COLOR_INVALID_RANGE) {
-        return ColorValue_from_value(TYPE_INVALID_EXT_RANGE, NULL);
-    } else if (ExtendedValue_is_valid(x_ret)) {
-        // Need to cast back into a real ExtendedValue now that I know it's
-        // not invalid. Also, ColorValue_from_value expects a pointer, to
-        // help with it's "dynamic" uses.
-        ExtendedValue xval = ext(x_ret);
-        return ColorValue_from_value(TYPE_EXTENDED, &xval);
-    }
-    // Basic?
-    int b_ret = BasicValue_from_esc(s);
-    if (BasicValue_is_valid(b_ret)) {
-        BasicValue bval = (BasicValue)b_ret;
-        return ColorValue_from_value(TYPE_BASIC, &bval);
-    }
-    // Style?
-    int s_ret = StyleValue_from_esc(s);
-    if (StyleValue_is_valid(s_ret)) {
-        StyleValue sval = (StyleValue)s_ret;
-        return ColorValue_from_value(TYPE_STYLE, &sval);
-    }
-    return ColorValue_from_value(TYPE_INVALID, NULL);
+    return ColorArg_from_esc(s).value;
 }
 
 /*! Create a ColorValue from a known color name, or RGB \string.
@@ -7419,36 +9706,1742 @@ bool ColorValue_to_esc_s(char* dest, ArgType type, ColorValue cval) {
     dest[0] = '\0';
     return false;
 }
-/*! Compares two BasicValues.
 
-    \details
-    This is used to implement colr_eq().
+/*! Get a precomputed escape-code from a ColrGradient's ramp.
 
-    \pi a   The first BasicValue to compare.
-    \pi b   The second BasicValue to compare.
-    \return `true` if they are equal, otherwise `false`.
+    \pi gradient The ColrGradient to use, with a ramp from ColrGradient_set_length().
+    \pi index    Position in the ramp. Positions past the end use the last code.
+    \po length   \parblock
+                     If not `NULL`, set to the length of the escape-code,
+                     not including the `'\0'`.
+                 \endparblock
+    \return      \parblock
+                     The escape-code, owned by \p gradient.
+                     `NULL` is returned if \p gradient is `NULL`, or it has
+                     no ramp.
+                 \endparblock
 
-    \sa BasicValue
+    \sa ColrGradient
 */
-bool BasicValue_eq(BasicValue a, BasicValue b) {
-    return (a == b);
+const char* ColrGradient_code(const ColrGradient* gradient, size_t index, size_t* length) {
+    if (!(gradient && gradient->ramp)) return NULL;
+    if (index >= gradient->length) index = gradient->length - 1;
+    if (length) *length = gradient->ramp[index].length;
+    return gradient->ramp[index].code;
 }
 
-/*! Convert an escape-code \string to an actual BasicValue enum value.
+/*! Free a ColrGradient, and it's ramp.
 
-    \pi s   \parblock
-                Escape-code string.
-                \mustnull
-            \endparblock
-    \retval BasicValue value on success.
-    \retval BASIC_INVALID on error (or if \p s is `NULL`).
-    \retval BASIC_INVALID_RANGE if the code number was outside of the range `0-255`.
+    \pi gradient The ColrGradient to free. If `NULL`, nothing is done.
 
-    \sa BasicValue
+    \sa ColrGradient
 */
-BasicValue BasicValue_from_esc(const char* s) {
-    if (!s) return BASIC_INVALID;
-    unsigned short escnum;
+void ColrGradient_free(ColrGradient* gradient) {
+    if (!gradient) return;
+    free(gradient->ramp);
+    free(gradient);
+}
+
+/*! Create a new ColrGradient, for blending colors and formatting their
+    escape-codes.
+
+    \pi fmter The RGB_fmter to create escape-codes with.
+    \pi space The ColrGradientSpace to blend colors in.
+    \pi stops \parblock
+                  The colors to blend, evenly spaced from start to end.
+                  A single stop is a solid color.
+              \endparblock
+    \pi count Number of colors in \p stops, up to COLR_GRADIENT_MAX_STOPS.
+    \return   \parblock
+                  An allocated ColrGradient, or `NULL` if \p fmter / \p stops
+                  is `NULL`, \p count is out of range, or allocation fails.
+                  You must use ColrGradient_free() to release it.
+                  \maybenullalloc
+              \endparblock
+
+    \sa ColrGradient
+*/
+ColrGradient* ColrGradient_new(RGB_fmter fmter, ColrGradientSpace space, const RGB* stops, size_t count) {
+    if (!(fmter && stops && count)) return NULL;
+    if (count > COLR_GRADIENT_MAX_STOPS) return NULL;
+    ColrGradient* gradient = calloc(1, sizeof(ColrGradient));
+    if (!gradient) return NULL;
+    gradient->fmter = fmter;
+    gradient->space = space;
+    gradient->stop_count = count;
+    for (size_t i = 0; i < count; i++) {
+        if (space == GRADIENT_OKLAB) {
+            RGB_to_oklab(stops[i], gradient->stops[i]);
+        } else {
+            RGB_to_linear(stops[i], gradient->stops[i]);
+        }
+    }
+    return gradient;
+}
+
+/*! Get the color at a position in a ColrGradient.
+
+    \pi gradient The ColrGradient to use.
+    \pi pos      Position in the gradient, from `0.0` (first stop) to `1.0`
+                 (last stop). Other values are clamped.
+    \return      The blended RGB value, or `rgb(0, 0, 0)` if \p gradient is `NULL`.
+
+    \sa ColrGradient
+*/
+RGB ColrGradient_rgb(const ColrGradient* gradient, double pos) {
+    if (!gradient) return rgb(0, 0, 0);
+    if (!(pos > 0.0)) pos = 0.0;
+    if (pos > 1.0) pos = 1.0;
+    size_t index = 0;
+    double t = 0.0;
+    if (gradient->stop_count > 1) {
+        double segment = pos * (double)(gradient->stop_count - 1);
+        index = (size_t)segment;
+        if (index > gradient->stop_count - 2) index = gradient->stop_count - 2;
+        t = segment - (double)index;
+    }
+    const double* a = gradient->stops[index];
+    const double* b = gradient->stops[(gradient->stop_count > 1) ? index + 1 : index];
+    double values[3];
+    for (size_t i = 0; i < 3; i++) {
+        values[i] = a[i] + ((b[i] - a[i]) * t);
+    }
+    return (
+        gradient->space == GRADIENT_OKLAB ?
+            RGB_from_oklab(values) :
+            RGB_from_linear(values)
+    );
+}
+
+/*! Precompute the escape-codes for every position in a ColrGradient.
+
+    \details
+    Position `0` is the first stop, and position `length - 1` is the last.
+    Nothing is recomputed if the ramp already has this length.
+
+    \pi gradient The ColrGradient to fill the ramp for.
+    \pi length   Number of positions. `0` is treated as `1`.
+    \return      `true` on success, or `false` if \p gradient is `NULL` or
+                 allocation fails.
+
+    \sa ColrGradient
+*/
+bool ColrGradient_set_length(ColrGradient* gradient, size_t length) {
+    if (!gradient) return false;
+    if (!length) length = 1;
+    if (gradient->ramp && (gradient->length == length)) return true;
+    ColrRainbowCode* ramp = realloc(gradient->ramp, length * sizeof(ColrRainbowCode));
+    if (!ramp) return false;
+    gradient->ramp = ramp;
+    gradient->length = length;
+    for (size_t i = 0; i < length; i++) {
+        double pos = (length > 1) ? ((double)i / (double)(length - 1)) : 0.0;
+        RGB rgbval = ColrGradient_rgb(gradient, pos);
+        if (i && colr_eq(rgbval, ramp[i - 1].rgb)) {
+            // Neighbors are often the same color, there's no need to format it.
+            ramp[i] = ramp[i - 1];
+            continue;
+        }
+        ramp[i].rgb = rgbval;
+        ramp[i].used = true;
+        gradient->fmter(ramp[i].code, rgbval);
+        ramp[i].length = strlen(ramp[i].code);
+    }
+    return true;
+}
+
+/*! Add a highlighting rule to a ColrHighlighter, using a ColorArg's
+    escape-code as the style.
+
+    \pi highlighter The ColrHighlighter to add to.
+    \pi pattern     The regex pattern to highlight.
+    \pi re_flags    Flags for `regcomp()`. `REG_EXTENDED` is always used.
+    \pi priority    Priority for overlapping matches. Higher priorities win.
+    \pi hlstyle     The ColorArg to style matches with.
+                    ColorArg_free() is called after it is added.
+    \return         `true` if the rule was added, otherwise `false`.
+
+    \sa ColrHighlighter_add
+*/
+bool ColrHighlighter_add_ColorArg(ColrHighlighter* highlighter, const char* pattern, int re_flags, int priority, ColorArg* hlstyle) {
+    char* codes = hlstyle ? ColorArg_to_esc(*hlstyle) : NULL;
+    bool added = ColrHighlighter_add_str(highlighter, pattern, re_flags, priority, codes);
+    if (codes) free(codes);
+    ColorArg_free(hlstyle);
+    return added;
+}
+
+/*! Add a highlighting rule to a ColrHighlighter, using a ColorText's
+    fore, back, and style as the style.
+
+    \details
+    The ColorText's text and justification are not used.
+
+    \pi highlighter The ColrHighlighter to add to.
+    \pi pattern     The regex pattern to highlight.
+    \pi re_flags    Flags for `regcomp()`. `REG_EXTENDED` is always used.
+    \pi priority    Priority for overlapping matches. Higher priorities win.
+    \pi hlstyle     The ColorText to style matches with.
+                    ColorText_free() is called after it is added.
+    \return         `true` if the rule was added, otherwise `false`.
+
+    \sa ColrHighlighter_add
+*/
+bool ColrHighlighter_add_ColorText(ColrHighlighter* highlighter, const char* pattern, int re_flags, int priority, ColorText* hlstyle) {
+    if (!hlstyle) return ColrHighlighter_add_str(highlighter, pattern, re_flags, priority, NULL);
+    char* codes = ColorText_to_esc(*hlstyle);
+    ColorText_free(hlstyle);
+    if (!codes) return false;
+    bool added = ColrHighlighter_add_str(highlighter, pattern, re_flags, priority, codes);
+    free(codes);
+    return added;
+}
+
+/*! Add a highlighting rule to a ColrHighlighter.
+
+    \details
+    CODE_RESET_ALL is inserted after every highlighted match.
+    Using `NULL` as a style is like using an empty string (""), which only
+    inserts CODE_RESET_ALL.
+
+    \pi highlighter The ColrHighlighter to add to.
+    \pi pattern     The regex pattern to highlight.
+    \pi re_flags    Flags for `regcomp()`. `REG_EXTENDED` is always used.
+    \pi priority    Priority for overlapping matches. Higher priorities win.
+    \pi hlstyle     The escape-codes to insert before each match. It is copied.
+    \return         `true` if the rule was added, or `false` if
+                    \p highlighter / \p pattern is `NULL`, the pattern doesn't
+                    compile, or allocation fails.
+
+    \sa ColrHighlighter_add
+*/
+bool ColrHighlighter_add_str(ColrHighlighter* highlighter, const char* pattern, int re_flags, int priority, const char* hlstyle) {
+    if (!(highlighter && pattern)) return false;
+    if (highlighter->count == highlighter->cap) {
+        size_t cap = highlighter->cap ? highlighter->cap * 2 : 8;
+        ColrHighlightRule* rules = realloc(highlighter->rules, cap * sizeof(ColrHighlightRule));
+        if (!rules) return false;
+        highlighter->rules = rules;
+        highlighter->cap = cap;
+    }
+    ColrHighlightRule rule = {.codes=NULL, .codes_len=0, .priority=priority};
+    rule.codes = strdup(hlstyle ? hlstyle : "");
+    if (!rule.codes) return false;
+    rule.codes_len = strlen(rule.codes);
+    // Always use extended regex.
+    if (!(re_flags & REG_EXTENDED)) re_flags = re_flags | REG_EXTENDED;
+    if (regcomp(&rule.repat, pattern, re_flags)) {
+        free(rule.codes);
+        return false;
+    }
+    // Keep the rules sorted, after any others with the same priority.
+    size_t index = highlighter->count;
+    while (index && (highlighter->rules[index - 1].priority < priority)) index--;
+    memmove(
+        highlighter->rules + index + 1,
+        highlighter->rules + index,
+        (highlighter->count - index) * sizeof(ColrHighlightRule)
+    );
+    highlighter->rules[index] = rule;
+    highlighter->count++;
+    return true;
+}
+
+/*! Free a ColrHighlighter, and all of it's rules.
+
+    \pi highlighter The ColrHighlighter to free. If `NULL`, nothing is done.
+
+    \sa ColrHighlighter
+*/
+void ColrHighlighter_free(ColrHighlighter* highlighter) {
+    if (!highlighter) return;
+    for (size_t i = 0; i < highlighter->count; i++) {
+        regfree(&highlighter->rules[i].repat);
+        free(highlighter->rules[i].codes);
+    }
+    free(highlighter->rules);
+    free(highlighter);
+}
+
+/*! Highlight a \string with a ColrHighlighter's rules.
+
+    \details
+    The string is tokenized once, and each rule's pattern is matched against
+    the text between existing escape-codes, so existing codes are never
+    matched or modified. That is one regex pass per rule, because POSIX
+    regex can't merge patterns with different flags and priorities into one.
+    Matches are chosen by rule priority, skipping any that overlap a match
+    from a higher priority rule, and the result is built in a single pass
+    with one allocation.
+
+    \details
+    Each match is followed by CODE_RESET_ALL, and then by every existing SGR
+    code since the last reset, so highlighting inside of text that is already
+    colored or styled does not end it's colors early.
+    Matches never span across existing escape-codes, and empty matches are
+    ignored. Anchors like `^` and `$` only match at the start and end of the
+    whole string, not around escape-codes.
+
+    \pi highlighter The ColrHighlighter to use.
+    \pi s           The string to highlight.
+    \return         \parblock
+                        An allocated string with the result, or `NULL` if
+                        \p highlighter / \p s is `NULL`, or allocation fails.
+                        \mustfree
+                        \maybenullalloc
+                    \endparblock
+
+    \sa ColrHighlighter
+*/
+char* ColrHighlighter_highlight(ColrHighlighter* highlighter, const char* s) {
+    if (!(highlighter && s)) return NULL;
+    size_t s_len = strlen(s);
+    // Text spans between escape-codes, and every SGR code found.
+    ColrMatches texts = {.matches=NULL, .count=0, .cap=0};
+    ColrMatches codes = {.matches=NULL, .count=0, .cap=0};
+    /*
+        The SGR codes that are active in each text span, since the last reset.
+        These are indexes into `codes`, not string offsets.
+    */
+    ColrMatches restores = {.matches=NULL, .count=0, .cap=0};
+    bool failed = false;
+    size_t active = 0;
+    ColrTokenIter titer = ColrTokenIter_new(s);
+    ColrToken token;
+    while (!failed && ColrTokenIter_next(&titer, &token)) {
+        regmatch_t span = {.rm_so=token.offset, .rm_eo=token.offset + token.length};
+        if (token.type == TOKEN_SGR) {
+            // A reset ("\x1b[m" or "\x1b[0m") leaves nothing to restore.
+            if ((token.length == 3) || (
+                (token.length == CODE_RESET_LEN - 1) &&
+                (strncmp(token.start, CODE_RESET_ALL, token.length) == 0)
+            )) {
+                active = codes.count;
+                continue;
+            }
+            // So does a reset at the start of a combined code, like "\x1b[0;31m".
+            if ((token.start[2] == ';') || (strncmp(token.start + 2, "0;", 2) == 0)) {
+                active = codes.count;
+            }
+            failed = !ColrMatches_append(&codes, span);
+            continue;
+        }
+        if (token.type != TOKEN_TEXT) continue;
+        regmatch_t restore = {.rm_so=active, .rm_eo=codes.count};
+        failed = !(ColrMatches_append(&texts, span) && ColrMatches_append(&restores, restore));
+    }
+    ColrHighlightSpan* spans = NULL;
+    size_t span_count = 0;
+    size_t span_cap = 0;
+    size_t final_len = s_len;
+    /*
+        Chosen spans are grouped by rule, in order, so each rule's spans can
+        be checked against higher priority spans by walking a cursor for
+        every higher priority rule.
+    */
+    size_t* rule_first = calloc(highlighter->count + 1, sizeof(size_t));
+    size_t* cursors = calloc(highlighter->count + 1, sizeof(size_t));
+    if (!(rule_first && cursors)) failed = true;
+    for (size_t r = 0; !failed && (r < highlighter->count); r++) {
+        ColrHighlightRule* rule = &highlighter->rules[r];
+        rule_first[r] = span_count;
+        for (size_t h = 0; h < r; h++) cursors[h] = rule_first[h];
+        for (size_t t = 0; !failed && (t < texts.count); t++) {
+            ColrMatchIter miter = ColrMatchIter_new(s, &rule->repat);
+            miter.pos = texts.matches[t].rm_so;
+            miter.length = texts.matches[t].rm_eo;
+            // `$` only matches at the end of the whole string.
+            if (miter.length < s_len) miter.eflags = REG_NOTEOL;
+            size_t restore_len = 0;
+            for (regoff_t c = restores.matches[t].rm_so; c < restores.matches[t].rm_eo; c++) {
+                restore_len += codes.matches[c].rm_eo - codes.matches[c].rm_so;
+            }
+            regmatch_t match;
+            while (ColrMatchIter_next(&miter, &match)) {
+                if (match.rm_so == match.rm_eo) continue;
+                bool overlaps = false;
+                for (size_t h = 0; !overlaps && (h < r); h++) {
+                    size_t end = rule_first[h + 1];
+                    while ((cursors[h] < end) && (spans[cursors[h]].match.rm_eo <= match.rm_so)) {
+                        cursors[h]++;
+                    }
+                    overlaps = (cursors[h] < end) && (spans[cursors[h]].match.rm_so < match.rm_eo);
+                }
+                if (overlaps) continue;
+                if (span_count == span_cap) {
+                    span_cap = span_cap ? span_cap * 2 : 16;
+                    ColrHighlightSpan* grown = realloc(spans, span_cap * sizeof(ColrHighlightSpan));
+                    if (!grown) {
+                        failed = true;
+                        break;
+                    }
+                    spans = grown;
+                }
+                spans[span_count++] = (ColrHighlightSpan){.match=match, .rule=r};
+                final_len += rule->codes_len + (CODE_RESET_LEN - 1) + restore_len;
+            }
+        }
+        rule_first[r + 1] = span_count;
+    }
+    free(rule_first);
+    free(cursors);
+    char* result = failed ? NULL : malloc(final_len + 1);
+    if (!result) {
+        ColrMatches_free(&texts);
+        ColrMatches_free(&codes);
+        ColrMatches_free(&restores);
+        free(spans);
+        return NULL;
+    }
+    if (span_count) qsort(spans, span_count, sizeof(ColrHighlightSpan), ColrHighlightSpan_cmp);
+    char* dest = result;
+    size_t pos = 0;
+    size_t t = 0;
+    for (size_t i = 0; i < span_count; i++) {
+        regmatch_t match = spans[i].match;
+        ColrHighlightRule* rule = &highlighter->rules[spans[i].rule];
+        // Find the text span that this match is in.
+        while (texts.matches[t].rm_eo < match.rm_eo) t++;
+        regmatch_t restore = restores.matches[t];
+        memcpy(dest, s + pos, match.rm_so - pos);
+        dest += match.rm_so - pos;
+        memcpy(dest, rule->codes, rule->codes_len);
+        dest += rule->codes_len;
+        memcpy(dest, s + match.rm_so, match.rm_eo - match.rm_so);
+        dest += match.rm_eo - match.rm_so;
+        memcpy(dest, CODE_RESET_ALL, CODE_RESET_LEN - 1);
+        dest += CODE_RESET_LEN - 1;
+        for (regoff_t c = restore.rm_so; c < restore.rm_eo; c++) {
+            regmatch_t code = codes.matches[c];
+            memcpy(dest, s + code.rm_so, code.rm_eo - code.rm_so);
+            dest += code.rm_eo - code.rm_so;
+        }
+        pos = match.rm_eo;
+    }
+    memcpy(dest, s + pos, s_len - pos);
+    dest[s_len - pos] = '\0';
+    ColrMatches_free(&texts);
+    ColrMatches_free(&codes);
+    ColrMatches_free(&restores);
+    free(spans);
+    return result;
+}
+
+/*! Create a new, empty, ColrHighlighter.
+
+    \return \parblock
+                An allocated ColrHighlighter, or `NULL` if allocation fails.
+                You must use ColrHighlighter_free() to release it.
+                \maybenullalloc
+            \endparblock
+
+    \sa ColrHighlighter
+    \sa ColrHighlighter_add
+*/
+ColrHighlighter* ColrHighlighter_new(void) {
+    return calloc(1, sizeof(ColrHighlighter));
+}
+
+/*! Compares two ColrHighlightSpans by starting offset, for `qsort()`.
+
+    \pi a   Pointer to the first ColrHighlightSpan.
+    \pi b   Pointer to the second ColrHighlightSpan.
+    \return `-1`, `0`, or `1`, like `strcmp()`.
+
+    \sa ColrHighlighter_highlight
+*/
+int ColrHighlightSpan_cmp(const void* a, const void* b) {
+    regoff_t a_so = ((const ColrHighlightSpan*)a)->match.rm_so;
+    regoff_t b_so = ((const ColrHighlightSpan*)b)->match.rm_so;
+    return (a_so > b_so) - (a_so < b_so);
+}
+
+/*! Appends a match to a ColrMatches, growing it if needed.
+
+    \details
+    The array doubles in size when it is full, so appending is amortized
+    constant time.
+
+    \pi cmatches The ColrMatches to append to.
+    \pi match    The match to append.
+    \return      `true` if the match was appended, or `false` if \p cmatches
+                 is `NULL`, or allocation fails.
+
+    \sa ColrMatches
+*/
+bool ColrMatches_append(ColrMatches* cmatches, regmatch_t match) {
+    if (!cmatches) return false;
+    if (cmatches->count == cmatches->cap) {
+        size_t cap = cmatches->cap ? cmatches->cap * 2 : 8;
+        regmatch_t* matches = realloc(cmatches->matches, cap * sizeof(regmatch_t));
+        if (!matches) return false;
+        cmatches->matches = matches;
+        cmatches->cap = cap;
+    }
+    cmatches->matches[cmatches->count++] = match;
+    return true;
+}
+
+/*! Frees the matches in a ColrMatches, and resets it to an empty ColrMatches.
+
+    \details
+    The ColrMatches struct itself is not freed.
+
+    \pi cmatches The ColrMatches to free the matches for. If `NULL`, nothing is done.
+
+    \sa ColrMatches
+*/
+void ColrMatches_free(ColrMatches* cmatches) {
+    if (!cmatches) return;
+    free(cmatches->matches);
+    *cmatches = (ColrMatches){.matches=NULL, .count=0, .cap=0};
+}
+
+/*! Collects all non-overlapping matches for a regex pattern in a \string.
+
+    \pi s         The string to search.
+    \pi repattern The pattern to look for.
+    \return       \parblock
+                      A ColrMatches with all matches. ColrMatches.count is `0`
+                      if there are no matches, \p s / \p repattern is `NULL`,
+                      or allocation fails.
+                      You must use ColrMatches_free() to free the matches.
+                  \endparblock
+
+    \examplecodefor{ColrMatches_from_re,.c}
+    regex_t* repat = colr_re_cache_acquire("fo+", 0);
+    if (!repat) return EXIT_FAILURE;
+    ColrMatches cmatches = ColrMatches_from_re("This foo is a foo string.", repat);
+    for (size_t i = 0; i < cmatches.count; i++) {
+        printf(
+            "Found a match at: %d-%d\n",
+            cmatches.matches[i].rm_so,
+            cmatches.matches[i].rm_eo
+        );
+    }
+    ColrMatches_free(&cmatches);
+    colr_re_cache_release(repat);
+    \endexamplecode
+
+    \sa ColrMatchIter_next
+*/
+ColrMatches ColrMatches_from_re(const char* s, regex_t* repattern) {
+    ColrMatches cmatches = {.matches=NULL, .count=0, .cap=0};
+    ColrMatchIter iter = ColrMatchIter_new(s, repattern);
+    regmatch_t match;
+    while (ColrMatchIter_next(&iter, &match)) {
+        if (!ColrMatches_append(&cmatches, match)) {
+            ColrMatches_free(&cmatches);
+            break;
+        }
+    }
+    return cmatches;
+}
+
+/*! Replaces matches in a \string, in a single forward pass.
+
+    \details
+    The exact size of the result is computed from the match spans, and each
+    gap and replacement is copied once into a single allocation.
+
+    \details
+    Using `NULL` as a replacement is like using an empty string (""), which
+    removes the matches from \p s.
+
+    \pi cmatches \parblock
+                     The matches to replace, like the ones from
+                     ColrMatches_from_re(). They must be in order, and must
+                     not overlap.
+                 \endparblock
+    \pi s        The string that was searched.
+    \pi repl     The string to replace with.
+    \return      \parblock
+                     An allocated string with the result, or `NULL` if
+                     \p cmatches / \p s is `NULL`, the matches are out of
+                     order/bounds, or allocation fails.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa colr_str_replace_re_pat_all
+*/
+char* ColrMatches_replace(const ColrMatches* cmatches, const char* restrict s, const char* restrict repl) {
+    if (!(cmatches && s)) return NULL;
+    if (!repl) repl = "";
+    size_t s_len = strlen(s);
+    size_t repl_len = strlen(repl);
+    size_t final_len = s_len;
+    size_t pos = 0;
+    for (size_t i = 0; i < cmatches->count; i++) {
+        regmatch_t match = cmatches->matches[i];
+        if (
+            (match.rm_so < 0) ||
+            ((size_t)match.rm_so < pos) ||
+            (match.rm_eo < match.rm_so) ||
+            ((size_t)match.rm_eo > s_len)
+        ) {
+            return NULL;
+        }
+        final_len = final_len - (match.rm_eo - match.rm_so) + repl_len;
+        pos = match.rm_eo;
+    }
+    char* result = malloc(final_len + 1);
+    if (!result) return NULL;
+    char* dest = result;
+    pos = 0;
+    for (size_t i = 0; i < cmatches->count; i++) {
+        regmatch_t match = cmatches->matches[i];
+        memcpy(dest, s + pos, match.rm_so - pos);
+        dest += match.rm_so - pos;
+        memcpy(dest, repl, repl_len);
+        dest += repl_len;
+        pos = match.rm_eo;
+    }
+    memcpy(dest, s + pos, s_len - pos);
+    dest[s_len - pos] = '\0';
+    return result;
+}
+
+/*! Creates a ColrMatchIter, for use with ColrMatchIter_next().
+
+    \pi s         \parblock
+                      The string to search. It is not copied, and must outlive
+                      the iterator.
+                      \mustnullin
+                  \endparblock
+    \pi repattern The pattern to look for.
+    \return       An initialized ColrMatchIter.
+
+    \sa ColrMatchIter_next
+*/
+ColrMatchIter ColrMatchIter_new(const char* s, regex_t* repattern) {
+    return (ColrMatchIter){
+        .s=s,
+        .length=s ? strlen(s) : 0,
+        .repattern=repattern,
+        .pos=0,
+        .eflags=0,
+    };
+}
+
+/*! Finds the next non-overlapping match for a ColrMatchIter's pattern.
+
+    \details
+    Nothing is allocated. Matches are found lazily, one for each call.
+    Anchors like `^` only match at the start of the string, not at the start
+    of each search. After an empty match, the next search starts one byte
+    later, so patterns like `x*` always make progress.
+
+    \pi iter  The ColrMatchIter to advance, from ColrMatchIter_new().
+    \po match \parblock
+                  Set to the next match, with offsets from the start of the
+                  string.
+              \endparblock
+    \return   `true` if \p match was set, or `false` when there are no more
+              matches (or \p iter / \p match is `NULL`).
+
+    \sa ColrMatches_from_re
+*/
+bool ColrMatchIter_next(ColrMatchIter* iter, regmatch_t* match) {
+    return ColrMatchIter_next_groups(iter, match, 1);
+}
+
+/*! Finds the next non-overlapping match for a ColrMatchIter's pattern,
+    including capture groups.
+
+    \details
+    This is like ColrMatchIter_next(), except the offsets for each capture
+    group are also set. Groups that did not participate in the match have
+    their offsets set to `-1`.
+
+    \pi iter   The ColrMatchIter to advance, from ColrMatchIter_new().
+    \po groups \parblock
+                   Set to the whole match (`groups[0]`), followed by the
+                   capture groups, with offsets from the start of the string.
+                   It must have room for at least \p nmatch elements.
+               \endparblock
+    \pi nmatch The number of elements in \p groups, usually
+               `repattern->re_nsub + 1`.
+    \return    `true` if \p groups was set, or `false` when there are no more
+               matches (or \p iter / \p groups is `NULL`, or \p nmatch is `0`).
+
+    \sa ColrMatchIter_next
+    \sa colr_str_re_groups
+*/
+bool ColrMatchIter_next_groups(ColrMatchIter* iter, regmatch_t* groups, size_t nmatch) {
+    if (!(iter && iter->s && iter->repattern && groups && nmatch)) return false;
+    if (iter->pos > iter->length) return false;
+    groups[0] = (regmatch_t){.rm_so=iter->pos, .rm_eo=iter->length};
+    // Some regexec() implementations treat the start offset as the start of the string.
+    int eflags = REG_STARTEND | iter->eflags | (iter->pos ? REG_NOTBOL : 0);
+    if (regexec(iter->repattern, iter->s, nmatch, groups, eflags)) {
+        iter->pos = iter->length + 1;
+        return false;
+    }
+    iter->pos = groups[0].rm_eo;
+    // Empty matches must still move forward.
+    if (groups[0].rm_so == groups[0].rm_eo) iter->pos++;
+    return true;
+}
+
+/*! Detects the capabilities of a terminal, using the environment and `isatty()`.
+
+    \details
+    `$NO_COLOR` (when set to anything but an empty string) and `TERM=dumb`
+    disable colors. The color depth comes from `$COLORTERM` (`truecolor` or
+    `24bit`) and `$TERM` (`*256color*`).
+
+    \details
+    This is called once by colr_term_caps(), you shouldn't need to call it
+    yourself.
+
+    \pi fd File descriptor to check with `isatty()`.
+    \return   A ColrTermCaps struct, with the detected capabilities.
+
+    \sa colr_term_caps
+*/
+ColrTermCaps ColrTermCaps_probe(int fd) {
+    ColrTermCaps caps = {.depth=DEPTH_BASIC, .is_tty=false, .disabled=false};
+    caps.is_tty = (fd >= 0) && isatty(fd);
+    char* no_color = getenv("NO_COLOR");
+    if (no_color && no_color[0] != '\0') caps.disabled = true;
+    char* term = getenv("TERM");
+    char* colorterm = getenv("COLORTERM");
+    if (term && colr_str_eq(term, "dumb")) {
+        caps.depth = DEPTH_NONE;
+        caps.disabled = true;
+    } else if (colorterm && colr_istr_either(colorterm, "truecolor", "24bit")) {
+        caps.depth = DEPTH_RGB;
+    } else if (term && strstr(term, "256color")) {
+        caps.depth = DEPTH_EXTENDED;
+    }
+    return caps;
+}
+
+/*! Determines whether a ColrToken is an escape-code span (not text).
+
+    \pi token The ColrToken to check.
+    \return   `true` if the token is a color code, or other escape code, otherwise `false`.
+
+    \sa ColrTokenIter_next
+*/
+bool ColrToken_is_code(ColrToken token) {
+    return (token.type == TOKEN_SGR) || (token.type == TOKEN_CSI) || (token.type == TOKEN_ESC);
+}
+
+/*! Scans a possible escape sequence at the start of a \string.
+
+    \details
+    This understands Control Sequence Introducer codes (`"\x1b[" params
+    intermediates final`), and other two-byte/intermediate escape sequences.
+    CSI codes ending in `m`, with only digits and separators for parameters,
+    are Select Graphic Rendition (color/style) codes.
+
+    \details
+    Malformed or unterminated sequences are not codes, and `TOKEN_NONE` is
+    returned.
+
+    \pi s      \parblock
+                   The string to scan. The sequence must start at `s[0]`.
+                   \mustnullin
+               \endparblock
+    \po length Set to the length of the escape sequence, or `0` if it is not one.
+    \return    `TOKEN_SGR`, `TOKEN_CSI`, `TOKEN_ESC`, or `TOKEN_NONE` if \p s
+               does not start with a complete escape sequence.
+
+    \sa ColrTokenIter_next
+*/
+ColrTokenType ColrToken_scan_esc(const char* s, size_t* length) {
+    // The null-terminator ends every sequence, so the length is never reached.
+    return ColrToken_scan_esc_n(s, SIZE_MAX, length);
+}
+
+/*! Like ColrToken_scan_esc(), but scans no more than \p length bytes.
+
+    \details
+    The string does not need to be null-terminated. A sequence that is cut
+    off by \p length is not complete, and `TOKEN_NONE` is returned.
+
+    \pi s       The string to scan. The sequence must start at `s[0]`.
+    \pi length  Number of bytes available in \p s.
+    \po esc_len Set to the length of the escape sequence, or `0` if it is not one.
+    \return     `TOKEN_SGR`, `TOKEN_CSI`, `TOKEN_ESC`, or `TOKEN_NONE` if \p s
+                does not start with a complete escape sequence.
+
+    \sa ColrToken_scan_esc
+*/
+ColrTokenType ColrToken_scan_esc_n(const char* s, size_t length, size_t* esc_len) {
+    *esc_len = 0;
+    if (!s || !length || s[0] != '\x1b') return TOKEN_NONE;
+    const unsigned char* us = (const unsigned char*)s;
+    size_t i = 1;
+    if ((i < length) && (us[i] == '[')) {
+        // Parameter bytes (0x30-0x3F), intermediate bytes (0x20-0x2F),
+        // and a final byte (0x40-0x7E).
+        bool is_sgr = true;
+        i++;
+        while ((i < length) && (us[i] >= 0x30) && (us[i] <= 0x3F)) {
+            if (!(isdigit(us[i]) || (us[i] == ';') || (us[i] == ':'))) is_sgr = false;
+            i++;
+        }
+        while ((i < length) && (us[i] >= 0x20) && (us[i] <= 0x2F)) {
+            is_sgr = false;
+            i++;
+        }
+        if ((i >= length) || (us[i] < 0x40) || (us[i] > 0x7E)) return TOKEN_NONE;
+        *esc_len = i + 1;
+        return (is_sgr && (us[i] == 'm')) ? TOKEN_SGR : TOKEN_CSI;
+    } else if ((i < length) && (us[i] == ']')) {
+        // Operating System Command, terminated by BEL or ST ("\x1b\\").
+        for (i++; (i < length) && us[i]; i++) {
+            if (us[i] == '\a') {
+                *esc_len = i + 1;
+                return TOKEN_ESC;
+            } else if ((us[i] == '\x1b') && ((i + 1) < length) && (us[i + 1] == '\\')) {
+                *esc_len = i + 2;
+                return TOKEN_ESC;
+            }
+        }
+        return TOKEN_NONE;
+    }
+    // Other escape sequences, with optional intermediate bytes (0x20-0x2F),
+    // and a final byte (0x30-0x7E).
+    while ((i < length) && (us[i] >= 0x20) && (us[i] <= 0x2F)) i++;
+    if ((i >= length) || (us[i] < 0x30) || (us[i] > 0x7E)) return TOKEN_NONE;
+    *esc_len = i + 1;
+    return TOKEN_ESC;
+}
+
+/*! Creates a ColrTokenIter, for use with ColrTokenIter_next().
+
+    \pi s   \parblock
+                The string to tokenize. It is not copied, and must outlive the
+                iterator.
+                \mustnullin
+            \endparblock
+    \return An initialized ColrTokenIter.
+
+    \sa ColrTokenIter_next
+*/
+ColrTokenIter ColrTokenIter_new(const char* s) {
+    return ColrTokenIter_new_n(s, s ? strlen(s) : 0);
+}
+
+/*! Creates a ColrTokenIter for the first \p length bytes of a string, for
+    use with ColrTokenIter_next().
+
+    \details
+    The string does not need to be null-terminated, so this works for
+    memory-mapped files and other buffers. Null bytes are treated as text.
+
+    \pi s      The string to tokenize. It is not copied, and must outlive the
+               iterator.
+    \pi length Number of bytes to tokenize.
+    \return    An initialized ColrTokenIter.
+
+    \sa ColrTokenIter_next
+*/
+ColrTokenIter ColrTokenIter_new_n(const char* s, size_t length) {
+    return (ColrTokenIter){.s=s, .length=length, .pos=0, .osc_stop=0};
+}
+
+/*! Yields the next text/escape-code span from a ColrTokenIter.
+
+    \details
+    Nothing is allocated or copied. Each ColrToken points into the original
+    string. Consecutive text is yielded as a single `TOKEN_TEXT` span, and
+    malformed escape sequences are treated as text.
+
+    \pi iter  The ColrTokenIter to advance, from ColrTokenIter_new().
+    \po token Set to the next span, if any.
+    \return   `true` if \p token was set, or `false` when there are no more
+              tokens (or \p iter / \p token is `NULL`).
+
+    \examplecodefor{ColrTokenIter_next,.c}
+    char* s = colr("Testing", fore(RED));
+    if (!s) exit(1);
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        printf(
+            "%s at %zu: %zu bytes\n",
+            token.type == TOKEN_TEXT ? "text" : "code",
+            token.offset,
+            token.length
+        );
+    }
+    free(s);
+    \endexamplecode
+*/
+bool ColrTokenIter_next(ColrTokenIter* iter, ColrToken* token) {
+    if (!(iter && iter->s && token)) return false;
+    if (iter->pos >= iter->length) return false;
+    const char* start = iter->s + iter->pos;
+    const char* stop = iter->s + iter->length;
+    size_t length = 0;
+    ColrTokenType type = ColrTokenIter_scan_esc(iter, start, &length);
+    if (type == TOKEN_NONE) {
+        // Text, up to the next complete escape sequence.
+        type = TOKEN_TEXT;
+        // A malformed escape sequence at the start is just text.
+        const char* search = start + (start[0] == '\x1b');
+        const char* end = memchr(search, '\x1b', stop - search);
+        size_t esc_len = 0;
+        while (end && (ColrTokenIter_scan_esc(iter, end, &esc_len) == TOKEN_NONE)) {
+            end = memchr(end + 1, '\x1b', stop - (end + 1));
+        }
+        length = (end ? end : stop) - start;
+    }
+    *token = (ColrToken){
+        .type=type,
+        .start=start,
+        .offset=iter->pos,
+        .length=length,
+    };
+    iter->pos += length;
+    return true;
+}
+
+/*! Like ColrToken_scan_esc_n(), but remembers where unterminated OSC
+    sequences stop, so they are not scanned again.
+
+    \details
+    An OSC without a BEL/ST terminator scans to the next null byte (or the
+    end of the string). Any OSC that starts before that point is also
+    unterminated, so it is treated as text without scanning.
+
+    \warninternal
+
+    \pi iter    The ColrTokenIter being advanced.
+    \pi p       Pointer to the possible escape sequence, inside of `iter->s`.
+    \po esc_len Set to the length of the escape sequence, or `0` if it is not one.
+    \return     The token type, like ColrToken_scan_esc_n().
+*/
+ColrTokenType ColrTokenIter_scan_esc(ColrTokenIter* iter, const char* p, size_t* esc_len) {
+    size_t pos = p - iter->s;
+    size_t remaining = iter->length - pos;
+    bool is_osc = (remaining > 1) && (p[0] == '\x1b') && (p[1] == ']');
+    if (is_osc && (pos < iter->osc_stop)) {
+        *esc_len = 0;
+        return TOKEN_NONE;
+    }
+    ColrTokenType type = ColrToken_scan_esc_n(p, remaining, esc_len);
+    if (is_osc && (type == TOKEN_NONE)) {
+        const char* nul = memchr(p + 2, '\0', remaining - 2);
+        iter->osc_stop = nul ? (size_t)(nul - iter->s) : iter->length;
+    }
+    return type;
+}
+
+/*! Get the escape-code for a rainbow step, formatting it only when it is
+    not already cached.
+
+    \pi rainbow The ColrRainbow to use.
+    \pi offset  The offset in the rainbow, like rainbow_step() uses.
+    \po length  \parblock
+                    If not `NULL`, set to the length of the escape-code,
+                    not including the `'\0'`.
+                \endparblock
+    \return     \parblock
+                    The escape-code, owned by \p rainbow. It is only valid until
+                    the next call with \p rainbow.
+                    `NULL` is returned if \p rainbow is `NULL`.
+                \endparblock
+
+    \sa ColrRainbow
+*/
+const char* ColrRainbow_code(ColrRainbow* rainbow, size_t offset, size_t* length) {
+    if (!rainbow) return NULL;
+    RGB rgbval = ColrRainbow_rgb(rainbow, offset);
+    uint32_t key = ((uint32_t)rgbval.red << 16) | ((uint32_t)rgbval.green << 8) | rgbval.blue;
+    // Fibonacci hashing, to spread nearby colors out.
+    ColrRainbowCode* entry = &rainbow->codes[((key * 2654435761u) >> 8) % COLR_RAINBOW_CACHE_SIZE];
+    if (!(entry->used && RGB_eq(entry->rgb, rgbval))) {
+        rainbow->fmter(entry->code, rgbval);
+        entry->length = strlen(entry->code);
+        entry->rgb = rgbval;
+        entry->used = true;
+    }
+    if (length) *length = entry->length;
+    return entry->code;
+}
+
+/*! Write the characters held in a ColrRainbow's `pending` bytes, until it is
+    empty or needs more input.
+
+    \details
+    This is used by ColrRainbow_feed() and ColrRainbow_flush(), so a
+    character is written the same way whether it was split across chunks or
+    not. Invalid characters are written one byte at a time.
+
+    \pi rainbow The ColrRainbow to use.
+    \pi out     The file to write to.
+    \pi final   Whether there is no more input, so incomplete characters are
+                written one byte at a time instead of being held.
+*/
+void ColrRainbow_drain(ColrRainbow* rainbow, FILE* out, bool final) {
+    while (rainbow->pending_len) {
+        size_t char_len = colr_mb_char_len(rainbow->pending, rainbow->pending_len);
+        if (!char_len) {
+            if (!final && (rainbow->pending_len < sizeof(rainbow->pending))) return;
+            char_len = (size_t)-1;
+        }
+        if (!colr_is_valid_mblen(char_len)) char_len = 1;
+        ColrRainbow_write_char(rainbow, out, rainbow->pending, char_len);
+        rainbow->pending_len -= char_len;
+        memmove(rainbow->pending, rainbow->pending + char_len, rainbow->pending_len);
+    }
+}
+
+/*! Rainbowize a chunk of text, writing it to a file.
+
+    \details
+    The position in the rainbow is kept between calls, so feeding a string
+    in any number of chunks writes the same codes/text as _rainbow() would,
+    without the final CODE_RESET_ALL. Multibyte characters that are split
+    across chunks are held until the rest of their bytes are fed.
+    Invalid multibyte characters are written one byte at a time.
+
+    \details
+    Call ColrRainbow_finish() when there is no more text.
+
+    \pi rainbow The ColrRainbow to use, from ColrRainbow_new().
+    \pi out     The file to write to. It is not flushed.
+    \pi s       The text to rainbowize. It does not need to be null-terminated.
+    \pi length  Number of bytes in \p s.
+    \return     `true` on success, or `false` if \p rainbow / \p out is `NULL`,
+                or \p s is `NULL` while \p length is not `0`.
+
+    \sa ColrRainbow
+*/
+bool ColrRainbow_feed(ColrRainbow* rainbow, FILE* out, const char* s, size_t length) {
+    if (!(rainbow && out)) return false;
+    if (!length) return true;
+    if (!s) return false;
+    size_t i = 0;
+    // Finish a character from the last chunk, one byte at a time.
+    while (rainbow->pending_len && (i < length)) {
+        rainbow->pending[rainbow->pending_len++] = s[i++];
+        ColrRainbow_drain(rainbow, out, false);
+    }
+    while (i < length) {
+        size_t char_len = colr_mb_char_len(s + i, length - i);
+        if (!char_len) {
+            // Split character, save it for the next chunk.
+            rainbow->pending_len = length - i;
+            memcpy(rainbow->pending, s + i, rainbow->pending_len);
+            break;
+        }
+        if (!colr_is_valid_mblen(char_len)) char_len = 1;
+        ColrRainbow_write_char(rainbow, out, s + i, char_len);
+        i += char_len;
+    }
+    return true;
+}
+
+/*! Finish rainbowizing text that was written with ColrRainbow_feed().
+
+    \details
+    Any bytes left from an incomplete multibyte character are written, and
+    then CODE_RESET_ALL is written. The position in the rainbow is reset, so
+    \p rainbow can be used for another stream.
+
+    \details
+    Unlike _rainbow(), the reset code comes after any trailing newlines,
+    because they have already been written.
+
+    \pi rainbow The ColrRainbow to use, from ColrRainbow_new().
+    \pi out     The file to write to. It is not flushed.
+    \return     `true` on success, or `false` if \p rainbow / \p out is `NULL`.
+
+    \sa ColrRainbow
+*/
+bool ColrRainbow_finish(ColrRainbow* rainbow, FILE* out) {
+    if (!ColrRainbow_flush(rainbow, out)) return false;
+    fputs(CODE_RESET_ALL, out);
+    rainbow->pos = 0;
+    rainbow->span_left = 0;
+    return true;
+}
+
+/*! Write any bytes left from an incomplete multibyte character that was
+    fed to ColrRainbow_feed().
+
+    \details
+    Unlike ColrRainbow_finish(), the position in the rainbow is kept, and
+    no reset code is written. This is useful when the text is fed in lines,
+    and an invalid character at the end of a line shouldn't carry over to
+    the next one.
+
+    \pi rainbow The ColrRainbow to use, from ColrRainbow_new().
+    \pi out     The file to write to. It is not flushed.
+    \return     `true` on success, or `false` if \p rainbow / \p out is `NULL`.
+
+    \sa ColrRainbow
+*/
+bool ColrRainbow_flush(ColrRainbow* rainbow, FILE* out) {
+    if (!(rainbow && out)) return false;
+    ColrRainbow_drain(rainbow, out, true);
+    return true;
+}
+
+/*! Free a ColrRainbow.
+
+    \pi rainbow The ColrRainbow to free. If `NULL`, nothing is done.
+
+    \sa ColrRainbow
+*/
+void ColrRainbow_free(ColrRainbow* rainbow) {
+    free(rainbow);
+}
+
+/*! Create a new ColrRainbow, for generating rainbow colors and escape-codes.
+
+    \pi fmter  The RGB_fmter to create escape-codes with.
+    \pi freq   Frequency ("tightness") of the colors, like rainbow_step() uses.
+    \pi offset Starting offset in the rainbow, for ColrRainbow_feed().
+    \pi spread Number of characters per color, for ColrRainbow_feed().
+    \return    \parblock
+                   An allocated ColrRainbow, or `NULL` if \p fmter is `NULL` or
+                   allocation fails.
+                   You must use ColrRainbow_free() to release it.
+                   \maybenullalloc
+               \endparblock
+
+    \sa ColrRainbow
+*/
+ColrRainbow* ColrRainbow_new(RGB_fmter fmter, double freq, size_t offset, size_t spread) {
+    if (!fmter) return NULL;
+    ColrRainbow* rainbow = calloc(1, sizeof(ColrRainbow));
+    if (!rainbow) return NULL;
+    if (freq < 0.1) freq = 0.1;
+    if (!offset) offset = 1;
+    if (spread < 1) spread = 1;
+    rainbow->fmter = fmter;
+    rainbow->freq = freq;
+    rainbow->start = offset;
+    rainbow->spread = spread;
+    // I don't like comparing function pointers, but _rainbow() does it too.
+    rainbow->is_back = (fmter == format_bg_RGB) || (fmter == format_bg_RGB_term);
+    return rainbow;
+}
+
+/*! Get the color for a rainbow step, which always matches
+    `rainbow_step(rainbow->freq, offset)`.
+
+    \details
+    When \p offset is a little larger than the last one, the last `sin()`
+    values are rotated to get the new ones. Otherwise, or when the rotated
+    values are too close to being rounded differently, they are computed
+    with `sin()`.
+
+    \pi rainbow The ColrRainbow to use.
+    \pi offset  The offset in the rainbow, like rainbow_step() uses.
+    \return     An RGB value for the step, or `rgb(0, 0, 0)` if \p rainbow
+                is `NULL`.
+
+    \sa ColrRainbow
+*/
+RGB ColrRainbow_rgb(ColrRainbow* rainbow, size_t offset) {
+    if (!rainbow) return rgb(0, 0, 0);
+    if (!offset) offset = 1;
+    size_t delta = offset - rainbow->offset;
+    if (
+        (!rainbow->offset) ||
+        (offset < rainbow->offset) ||
+        (delta > COLR_RAINBOW_MAX_DELTA) ||
+        (rainbow->steps >= COLR_RAINBOW_RESEED)
+    ) {
+        ColrRainbow_seed(rainbow, offset);
+    } else if (delta) {
+        if (!rainbow->rot_ready[delta]) {
+            rainbow->rot_sins[delta] = sin(rainbow->freq * delta);
+            rainbow->rot_coss[delta] = cos(rainbow->freq * delta);
+            rainbow->rot_ready[delta] = true;
+        }
+        double rot_sin = rainbow->rot_sins[delta];
+        double rot_cos = rainbow->rot_coss[delta];
+        for (size_t i = 0; i < 3; i++) {
+            double s = rainbow->sins[i];
+            double c = rainbow->coss[i];
+            rainbow->sins[i] = (s * rot_cos) + (c * rot_sin);
+            rainbow->coss[i] = (c * rot_cos) - (s * rot_sin);
+        }
+        rainbow->offset = offset;
+        rainbow->steps++;
+        /*  Bound the error from rounding the angle in rainbow_step(), libm,
+            and the rotations, with plenty of room to spare.
+            Larger offsets mean larger angles, and a larger margin.
+        */
+        double margin = 2e-12 * (
+            (2 * rainbow->freq * offset) +
+            (rainbow->steps * ((rainbow->freq * COLR_RAINBOW_MAX_DELTA) + 4)) +
+            8
+        );
+        for (size_t i = 0; i < 3; i++) {
+            double val = (rainbow->sins[i] * 127) + 128;
+            double fraction = val - floor(val);
+            if ((fraction < margin) || (fraction > (1 - margin))) {
+                ColrRainbow_seed(rainbow, offset);
+                break;
+            }
+        }
+    }
+    return rgb(
+        (rainbow->sins[0] * 127) + 128,
+        (rainbow->sins[1] * 127) + 128,
+        (rainbow->sins[2] * 127) + 128
+    );
+}
+
+/*! Compute the state for a ColrRainbow at a certain offset, using the same
+    math as rainbow_step().
+
+    \pi rainbow The ColrRainbow to set the state for.
+    \pi offset  The offset in the rainbow, like rainbow_step() uses.
+
+    \sa ColrRainbow
+*/
+void ColrRainbow_seed(ColrRainbow* rainbow, size_t offset) {
+    if (!rainbow) return;
+    if (!offset) offset = 1;
+    double base = rainbow->freq * offset;
+    double phases[] = {0, (2 * M_PI) / 3, (4 * M_PI) / 3};
+    for (size_t i = 0; i < 3; i++) {
+        rainbow->sins[i] = sin(base + phases[i]);
+        rainbow->coss[i] = cos(base + phases[i]);
+    }
+    rainbow->offset = offset;
+    rainbow->steps = 0;
+}
+
+/*! Move the position for ColrRainbow_feed(), as if some text was already fed.
+
+    \details
+    This allows separate chunks of text to be rainbowized independently
+    (possibly on other threads), with the same codes as feeding all of the
+    text to one ColrRainbow. Any pending multibyte character is dropped.
+
+    \pi rainbow The ColrRainbow to modify.
+    \pi pos     Number of bytes that came before the next chunk.
+    \pi chars   Number of characters in those bytes, counted the same way
+                ColrRainbow_feed() counts them. This only matters when the
+                spread is greater than `1`.
+    \return     `true` on success, or `false` if \p rainbow is `NULL`.
+
+    \sa ColrRainbow
+*/
+bool ColrRainbow_set_pos(ColrRainbow* rainbow, size_t pos, size_t chars) {
+    if (!rainbow) return false;
+    rainbow->pos = pos;
+    // The color for the first character may have started before it.
+    rainbow->span_left = (rainbow->spread - (chars % rainbow->spread)) % rainbow->spread;
+    rainbow->pending_len = 0;
+    return true;
+}
+
+/*! Write a single character for ColrRainbow_feed(), with a new rainbow code
+    when one is needed.
+
+    \pi rainbow The ColrRainbow to use.
+    \pi out     The file to write to.
+    \pi c       The character to write.
+    \pi length  Number of bytes in the character.
+
+    \sa ColrRainbow_feed
+*/
+void ColrRainbow_write_char(ColrRainbow* rainbow, FILE* out, const char* c, size_t length) {
+    if (!rainbow->span_left) {
+        size_t code_len = 0;
+        const char* code = ColrRainbow_code(rainbow, rainbow->start + rainbow->pos, &code_len);
+        fwrite(code, 1, code_len, out);
+        // Same as _rainbow(), the reset is only needed at the start of a color.
+        if (rainbow->is_back && (c[0] == '\n')) fputs(CODE_RESET_BACK, out);
+        rainbow->span_left = rainbow->spread;
+    }
+    fwrite(c, 1, length, out);
+    rainbow->span_left--;
+    rainbow->pos += length;
+}
+
+/*! Add a target/replacement pair to a ColrReplacer, using a ColorArg's
+    escape-code as the replacement.
+
+    \pi replacer The ColrReplacer to add to.
+    \pi target   The literal string to replace. Must not be `NULL`/empty.
+    \pi repl     The ColorArg to produce escape-codes to replace with.
+                 ColorArg_free() is called after it is added.
+    \return      `true` if the pair was added, otherwise `false`.
+
+    \sa ColrReplacer_add
+*/
+bool ColrReplacer_add_ColorArg(ColrReplacer* replacer, const char* target, ColorArg* repl) {
+    char* replstr = repl ? ColorArg_to_esc(*repl): NULL;
+    bool added = ColrReplacer_add_str(replacer, target, replstr);
+    if (replstr) free(replstr);
+    ColorArg_free(repl);
+    return added;
+}
+
+/*! Add a target/replacement pair to a ColrReplacer, using a ColorResult's
+    string as the replacement.
+
+    \pi replacer The ColrReplacer to add to.
+    \pi target   The literal string to replace. Must not be `NULL`/empty.
+    \pi repl     The ColorResult to replace with.
+                 ColorResult_free() is called after it is added.
+    \return      `true` if the pair was added, otherwise `false`.
+
+    \sa ColrReplacer_add
+*/
+bool ColrReplacer_add_ColorResult(ColrReplacer* replacer, const char* target, ColorResult* repl) {
+    char* replstr = repl ? ColorResult_to_str(*repl): NULL;
+    bool added = ColrReplacer_add_str(replacer, target, replstr);
+    ColorResult_free(repl);
+    return added;
+}
+
+/*! Add a target/replacement pair to a ColrReplacer, using a ColorText's
+    string as the replacement.
+
+    \pi replacer The ColrReplacer to add to.
+    \pi target   The literal string to replace. Must not be `NULL`/empty.
+    \pi repl     The ColorText to replace with.
+                 ColorText_free() is called after it is added.
+    \return      `true` if the pair was added, otherwise `false`.
+
+    \sa ColrReplacer_add
+*/
+bool ColrReplacer_add_ColorText(ColrReplacer* replacer, const char* target, ColorText* repl) {
+    char* replstr = repl ? ColorText_to_str(*repl): NULL;
+    bool added = ColrReplacer_add_str(replacer, target, replstr);
+    if (replstr) free(replstr);
+    ColorText_free(repl);
+    return added;
+}
+
+/*! Add a target/replacement pair to a ColrReplacer.
+
+    \details
+    Both strings are copied. Adding a target that was already added replaces
+    its old replacement string.
+
+    \details
+    Using `NULL` as a replacement is like using an empty string ("").
+
+    \pi replacer The ColrReplacer to add to.
+    \pi target   The literal string to replace. Must not be `NULL`/empty.
+    \pi repl     The string to replace with.
+    \return      `true` if the pair was added, otherwise `false`.
+
+    \sa ColrReplacer_add
+*/
+bool ColrReplacer_add_str(ColrReplacer* replacer, const char* target, const char* repl) {
+    if (!(replacer && target && target[0])) return false;
+    char* replcopy = strdup(repl ? repl : "");
+    if (!replcopy) return false;
+    size_t repl_len = strlen(replcopy);
+    for (size_t i = 0; i < replacer->count; i++) {
+        if (strcmp(replacer->patterns[i].target, target) == 0) {
+            free(replacer->patterns[i].repl);
+            replacer->patterns[i].repl = replcopy;
+            replacer->patterns[i].repl_len = repl_len;
+            return true;
+        }
+    }
+    if (replacer->count == replacer->cap) {
+        size_t cap = replacer->cap ? replacer->cap * 2 : 8;
+        ColrReplacerPattern* patterns = realloc(
+            replacer->patterns,
+            cap * sizeof(ColrReplacerPattern)
+        );
+        if (!patterns) {
+            free(replcopy);
+            return false;
+        }
+        replacer->patterns = patterns;
+        replacer->cap = cap;
+    }
+    char* targetcopy = strdup(target);
+    if (!targetcopy) {
+        free(replcopy);
+        return false;
+    }
+    replacer->patterns[replacer->count++] = (ColrReplacerPattern){
+        .target=targetcopy,
+        .target_len=strlen(targetcopy),
+        .repl=replcopy,
+        .repl_len=repl_len,
+    };
+    replacer->compiled = false;
+    return true;
+}
+
+/*! Builds the Aho-Corasick automaton for a ColrReplacer's targets.
+
+    \details
+    This is called automatically by ColrReplacer_replace() and
+    ColrReplacer_feed() when targets have been added since the last compile.
+
+    \pi replacer The ColrReplacer to compile.
+    \return      `true` on success, or `false` if \p replacer is `NULL` or
+                 allocation fails.
+
+    \sa ColrReplacer
+*/
+bool ColrReplacer_compile(ColrReplacer* replacer) {
+    if (!replacer) return false;
+    free(replacer->nodes);
+    free(replacer->edges);
+    replacer->nodes = NULL;
+    replacer->edges = NULL;
+    replacer->node_count = 0;
+    replacer->edge_count = 0;
+    replacer->compiled = false;
+    size_t total_len = 0;
+    for (size_t i = 0; i < replacer->count; i++) {
+        total_len += replacer->patterns[i].target_len;
+    }
+    // Every target byte adds at most one state and one edge.
+    replacer->nodes = malloc((total_len + 1) * sizeof(ColrReplacerNode));
+    replacer->edges = malloc((total_len + 1) * sizeof(ColrReplacerEdge));
+    size_t* queue = malloc((total_len + 1) * sizeof(size_t));
+    if (!(replacer->nodes && replacer->edges && queue)) {
+        free(queue);
+        return false;
+    }
+    ColrReplacerNode* nodes = replacer->nodes;
+    ColrReplacerEdge* edges = replacer->edges;
+    nodes[0] = (ColrReplacerNode){.edge=SIZE_MAX, .fail=0, .depth=0, .match=SIZE_MAX};
+    replacer->node_count = 1;
+    for (size_t c = 0; c < 256; c++) replacer->root_next[c] = 0;
+    // Build the trie.
+    for (size_t i = 0; i < replacer->count; i++) {
+        const unsigned char* target = (const unsigned char*)replacer->patterns[i].target;
+        size_t state = 0;
+        for (size_t j = 0; target[j]; j++) {
+            size_t child = SIZE_MAX;
+            for (size_t e = nodes[state].edge; e != SIZE_MAX; e = edges[e].next) {
+                if (edges[e].c == target[j]) {
+                    child = edges[e].node;
+                    break;
+                }
+            }
+            if (child == SIZE_MAX) {
+                child = replacer->node_count++;
+                nodes[child] = (ColrReplacerNode){
+                    .edge=SIZE_MAX,
+                    .fail=0,
+                    .depth=nodes[state].depth + 1,
+                    .match=SIZE_MAX,
+                };
+                edges[replacer->edge_count] = (ColrReplacerEdge){
+                    .node=child,
+                    .next=nodes[state].edge,
+                    .c=target[j],
+                };
+                nodes[state].edge = replacer->edge_count++;
+                if (state == 0) replacer->root_next[target[j]] = child;
+            }
+            state = child;
+        }
+        nodes[state].match = i;
+    }
+    // Set failure links breadth-first, so shorter states are always done first.
+    size_t head = 0;
+    size_t tail = 0;
+    for (size_t e = nodes[0].edge; e != SIZE_MAX; e = edges[e].next) {
+        queue[tail++] = edges[e].node;
+    }
+    while (head < tail) {
+        size_t state = queue[head++];
+        for (size_t e = nodes[state].edge; e != SIZE_MAX; e = edges[e].next) {
+            size_t child = edges[e].node;
+            size_t fail = ColrReplacer_next_state(replacer, nodes[state].fail, edges[e].c);
+            nodes[child].fail = fail;
+            // The state's own target is the longest one ending here.
+            if (nodes[child].match == SIZE_MAX) nodes[child].match = nodes[fail].match;
+            queue[tail++] = child;
+        }
+    }
+    free(queue);
+    replacer->compiled = true;
+    return true;
+}
+
+/*! Replace targets in a chunk of input, writing the result to a file.
+
+    \details
+    Input that may be part of a match that continues in the next chunk is
+    held back by ColrReplacer, and written by the next ColrReplacer_feed()
+    or ColrReplacer_finish() call. The result is the same as calling
+    ColrReplacer_replace() on all of the chunks joined together.
+
+    \pi replacer The ColrReplacer to use.
+    \pi out      The file to write to.
+    \pi s        The chunk of input. It does not need to be null-terminated.
+    \pi length   Length of \p s, in bytes.
+    \return      `true` on success, or `false` if \p replacer / \p out is `NULL`,
+                 or allocation fails.
+
+    \examplecodefor{ColrReplacer_feed,.c}
+    ColrReplacer* replacer = ColrReplacer_new();
+    ColrReplacer_add(replacer, "error", fore(RED));
+    char line[256];
+    while (fgets(line, sizeof(line), stdin)) {
+        ColrReplacer_feed(replacer, stdout, line, strlen(line));
+    }
+    ColrReplacer_finish(replacer, stdout);
+    ColrReplacer_free(replacer);
+    \endexamplecode
+
+    \sa ColrReplacer_finish
+*/
+bool ColrReplacer_feed(ColrReplacer* replacer, FILE* out, const char* s, size_t length) {
+    if (!(replacer && out)) return false;
+    if (!s) length = 0;
+    if (!(replacer->compiled || ColrReplacer_compile(replacer))) return false;
+    bool scanned = false;
+    if (!replacer->pending_len) {
+        // Nothing held back, the chunk can be scanned in place.
+        size_t consumed = ColrReplacer_scan(replacer, s, length, false, out);
+        s += consumed;
+        length -= consumed;
+        scanned = true;
+    }
+    if (!length) return true;
+    if (replacer->pending_len + length > replacer->pending_cap) {
+        size_t cap = replacer->pending_len + length;
+        char* pending = realloc(replacer->pending, cap);
+        if (!pending) return false;
+        replacer->pending = pending;
+        replacer->pending_cap = cap;
+    }
+    memcpy(replacer->pending + replacer->pending_len, s, length);
+    replacer->pending_len += length;
+    // The unconsumed tail of a chunk scanned in place is held back as-is.
+    if (scanned) return true;
+    size_t consumed = ColrReplacer_scan(
+        replacer,
+        replacer->pending,
+        replacer->pending_len,
+        false,
+        out
+    );
+    replacer->pending_len -= consumed;
+    memmove(replacer->pending, replacer->pending + consumed, replacer->pending_len);
+    return true;
+}
+
+/*! Write any input held back by ColrReplacer_feed(), replacing targets in it.
+
+    \details
+    This should be called once after the last ColrReplacer_feed() call.
+    The ColrReplacer can be reused for a new stream afterwards.
+
+    \pi replacer The ColrReplacer to use.
+    \pi out      The file to write to.
+    \return      `true` on success, or `false` if \p replacer / \p out is `NULL`,
+                 or allocation fails.
+
+    \sa ColrReplacer_feed
+*/
+bool ColrReplacer_finish(ColrReplacer* replacer, FILE* out) {
+    if (!(replacer && out)) return false;
+    if (!(replacer->compiled || ColrReplacer_compile(replacer))) return false;
+    ColrReplacer_scan(replacer, replacer->pending, replacer->pending_len, true, out);
+    replacer->pending_len = 0;
+    return true;
+}
+
+/*! Free a ColrReplacer, and all of its targets/replacements.
+
+    \pi replacer The ColrReplacer to free. If `NULL`, nothing is done.
+
+    \sa ColrReplacer
+*/
+void ColrReplacer_free(ColrReplacer* replacer) {
+    if (!replacer) return;
+    for (size_t i = 0; i < replacer->count; i++) {
+        free(replacer->patterns[i].target);
+        free(replacer->patterns[i].repl);
+    }
+    free(replacer->patterns);
+    free(replacer->nodes);
+    free(replacer->edges);
+    free(replacer->pending);
+    free(replacer);
+}
+
+/*! Create a new, empty, ColrReplacer.
+
+    \return \parblock
+                An allocated ColrReplacer, or `NULL` if allocation fails.
+                You must use ColrReplacer_free() to release it.
+                \maybenullalloc
+            \endparblock
+
+    \sa ColrReplacer
+    \sa ColrReplacer_add
+*/
+ColrReplacer* ColrReplacer_new(void) {
+    ColrReplacer* replacer = calloc(1, sizeof(ColrReplacer));
+    return replacer;
+}
+
+/*! Returns the automaton state reached from \p state after reading \p c,
+    following failure links when there is no direct transition.
+
+    \pi replacer A compiled ColrReplacer.
+    \pi state    The current state index.
+    \pi c        The next input byte.
+    \return      The next state index. `0` is the root state.
+
+    \sa ColrReplacer_compile
+*/
+size_t ColrReplacer_next_state(const ColrReplacer* replacer, size_t state, unsigned char c) {
+    while (state) {
+        for (size_t e = replacer->nodes[state].edge; e != SIZE_MAX; e = replacer->edges[e].next) {
+            if (replacer->edges[e].c == c) return replacer->edges[e].node;
+        }
+        state = replacer->nodes[state].fail;
+    }
+    return replacer->root_next[c];
+}
+
+/*! Replace all targets in a string, in a single pass.
+
+    \details
+    When targets overlap, the leftmost match is replaced. When several
+    targets match at the same position, the longest one is replaced.
+    Replacements are never scanned for targets.
+
+    \pi replacer The ColrReplacer to use.
+    \pi s        The string to operate on.
+    \return      \parblock
+                     An allocated string with the result, or `NULL` if
+                     \p replacer / \p s is `NULL`, or allocation fails.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa ColrReplacer
+    \sa ColrReplacer_feed
+*/
+char* ColrReplacer_replace(ColrReplacer* replacer, const char* s) {
+    if (!(replacer && s)) return NULL;
+    if (!(replacer->compiled || ColrReplacer_compile(replacer))) return NULL;
+    char* result = NULL;
+    size_t result_len = 0;
+    FILE* out = open_memstream(&result, &result_len);
+    if (!out) return NULL;
+    ColrReplacer_scan(replacer, s, strlen(s), true, out);
+    if (fclose(out) != 0) {
+        free(result);
+        return NULL;
+    }
+    return result;
+}
+
+/*! Scan input with a compiled ColrReplacer, writing the result to a file.
+
+    \details
+    This is the matching loop used by ColrReplacer_replace() and
+    ColrReplacer_feed(). It keeps a single candidate match, and writes it as
+    soon as no longer/earlier match is possible. Scanning resumes right after
+    the match.
+
+    \pi replacer A compiled ColrReplacer.
+    \pi s        The input to scan. It does not need to be null-terminated.
+    \pi length   Length of \p s, in bytes.
+    \pi final    \parblock
+                     Whether this is the end of the input. If `false`, input
+                     that may be part of an unfinished match is not written.
+                 \endparblock
+    \pi out      The file to write to.
+    \return      The number of bytes from \p s that were handled. This is
+                 always \p length when \p final is `true`.
+
+    \sa ColrReplacer_compile
+*/
+size_t ColrReplacer_scan(ColrReplacer* replacer, const char* s, size_t length, bool final, FILE* out) {
+    const ColrReplacerNode* nodes = replacer->nodes;
+    const ColrReplacerPattern* patterns = replacer->patterns;
+    // Everything before `written` has been written to `out`.
+    size_t written = 0;
+    size_t state = 0;
+    size_t match = SIZE_MAX;
+    size_t match_start = 0;
+    size_t i = 0;
+    while (true) {
+        if (i == length) {
+            if (match == SIZE_MAX || !final) break;
+        } else {
+            state = ColrReplacer_next_state(replacer, state, (unsigned char)s[i++]);
+            size_t found = nodes[state].match;
+            if (found != SIZE_MAX) {
+                size_t found_start = i - patterns[found].target_len;
+                if (
+                    (match == SIZE_MAX) ||
+                    (found_start < match_start) ||
+                    (
+                        (found_start == match_start) &&
+                        (patterns[found].target_len > patterns[match].target_len)
+                    )
+                ) {
+                    match = found;
+                    match_start = found_start;
+                }
+            }
+            // A longer/earlier match is possible while the state started at
+            // or before the candidate.
+            if ((match == SIZE_MAX) || (i - nodes[state].depth <= match_start)) continue;
+        }
+        fwrite(s + written, 1, match_start - written, out);
+        fwrite(patterns[match].repl, 1, patterns[match].repl_len, out);
+        written = i = match_start + patterns[match].target_len;
+        state = 0;
+        match = SIZE_MAX;
+    }
+    size_t end = length;
+    if (!final) {
+        end = i - nodes[state].depth;
+        if ((match != SIZE_MAX) && (match_start < end)) end = match_start;
+    }
+    fwrite(s + written, 1, end - written, out);
+    return end;
+}
+
+/*! Compares two BasicValues.
+
+    \details
+    This is used to implement colr_eq().
+
+    \pi a   The first BasicValue to compare.
+    \pi b   The second BasicValue to compare.
+    \return `true` if they are equal, otherwise `false`.
+
+    \sa BasicValue
+*/
+bool BasicValue_eq(BasicValue a, BasicValue b) {
+    return (a == b);
+}
+
+/*! Convert an escape-code \string to an actual BasicValue enum value.
+
+    \pi s   \parblock
+                Escape-code string.
+                \mustnull
+            \endparblock
+    \retval BasicValue value on success.
+    \retval BASIC_INVALID on error (or if \p s is `NULL`).
+    \retval BASIC_INVALID_RANGE if the code number was outside of the range `0-255`.
+
+    \sa BasicValue
+*/
+BasicValue BasicValue_from_esc(const char* s) {
+    if (!s) return BASIC_INVALID;
+    unsigned short escnum;
     if (sscanf(s, "\x1b[%hum", &escnum) != 1) {
         return BASIC_INVALID;
     }
@@ -8153,6 +12146,57 @@ RGB RGB_from_hex_default(const char* hexstr, RGB default_value) {
     }
     return rgb;
 }
+/*! Convert linear (gamma-decoded) sRGB values into an RGB value.
+
+    \pi values \parblock
+                   The red, green, and blue values, from `0.0` to `1.0`.
+                   Values out of range are clamped.
+               \endparblock
+    \return    The gamma-encoded RGB value.
+
+    \sa RGB_to_linear
+*/
+RGB RGB_from_linear(const double* values) {
+    unsigned char encoded[3];
+    for (size_t i = 0; i < 3; i++) {
+        double value = values[i];
+        if (!(value > 0.0)) value = 0.0;
+        if (value > 1.0) value = 1.0;
+        value = (
+            value <= 0.0031308 ?
+                value * 12.92 :
+                (1.055 * pow(value, 1.0 / 2.4)) - 0.055
+        );
+        encoded[i] = (unsigned char)((value * 255.0) + 0.5);
+    }
+    return rgb(encoded[0], encoded[1], encoded[2]);
+}
+
+/*! Convert OKLab values into an RGB value.
+
+    \details
+    Colors outside of the sRGB gamut are clamped.
+
+    \pi lab The lightness, a, and b values.
+    \return The closest RGB value.
+
+    \sa RGB_to_oklab
+*/
+RGB RGB_from_oklab(const double* lab) {
+    double l = lab[0] + (0.3963377774 * lab[1]) + (0.2158037573 * lab[2]);
+    double m = lab[0] - (0.1055613458 * lab[1]) - (0.0638541728 * lab[2]);
+    double s = lab[0] - (0.0894841775 * lab[1]) - (1.2914855480 * lab[2]);
+    l = l * l * l;
+    m = m * m * m;
+    s = s * s * s;
+    double values[3] = {
+        (4.0767416621 * l) - (3.3077115913 * m) + (0.2309699292 * s),
+        (-1.2684380046 * l) + (2.6097574011 * m) - (0.3413193965 * s),
+        (-0.0041960863 * l) - (0.7034186147 * m) + (1.7076147010 * s),
+    };
+    return RGB_from_linear(values);
+}
+
 /*! Convert an RGB \string into an RGB value.
 
     \details
@@ -8291,6 +12335,55 @@ char* RGB_to_hex(RGB rgb) {
     return s;
 }
 
+/*! Convert an RGB value into linear (gamma-decoded) sRGB values.
+
+    \pi rgb    The RGB value to convert.
+    \po values Array of at least 3 doubles to fill with the red, green, and
+               blue values, from `0.0` to `1.0`.
+
+    \sa RGB_from_linear
+*/
+void RGB_to_linear(RGB rgb, double* values) {
+    unsigned char encoded[3] = {rgb.red, rgb.green, rgb.blue};
+    for (size_t i = 0; i < 3; i++) {
+        double value = (double)encoded[i] / 255.0;
+        values[i] = (
+            value <= 0.04045 ?
+                value / 12.92 :
+                pow((value + 0.055) / 1.055, 2.4)
+        );
+    }
+}
+
+/*! Convert an RGB value into OKLab values.
+
+    \details
+    OKLab is a perceptual color space, blending colors in it keeps the
+    lightness more even than blending RGB values.
+
+    \pi rgb The RGB value to convert.
+    \po lab Array of at least 3 doubles to fill with the lightness, a, and b
+            values.
+
+    \sa RGB_from_oklab
+*/
+void RGB_to_oklab(RGB rgb, double* lab) {
+    double values[3];
+    RGB_to_linear(rgb, values);
+    double l = cbrt(
+        (0.4122214708 * values[0]) + (0.5363325363 * values[1]) + (0.0514459929 * values[2])
+    );
+    double m = cbrt(
+        (0.2119034982 * values[0]) + (0.6806995451 * values[1]) + (0.1073969566 * values[2])
+    );
+    double s = cbrt(
+        (0.0883024619 * values[0]) + (0.2817188376 * values[1]) + (0.6299787005 * values[2])
+    );
+    lab[0] = (0.2104542553 * l) + (0.7936177850 * m) - (0.0040720468 * s);
+    lab[1] = (1.9779984951 * l) - (2.4285922050 * m) + (0.4505937099 * s);
+    lab[2] = (0.0259040371 * l) + (0.7827717662 * m) - (0.8086757660 * s);
+}
+
 /*! Convert an RGB value into a human-friendly RGB \string suitable for input
     to RGB_from_str().
 
@@ -8571,6 +12664,240 @@ char* TermSize_repr(TermSize ts) {
     return repr;
 }
 
+/*! Colorize text with a gradient between RGB back colors.
+
+    \details
+    This uses OKLab to blend the colors. Use _gradient() for linear RGB.
+
+    \pi s        \parblock
+                     The string to colorize.
+                     \mustnullin
+                 \endparblock
+    \pi stops    The colors to blend, from start to end.
+    \pi count    Number of colors in \p stops, up to COLR_GRADIENT_MAX_STOPS.
+    \pi vertical \parblock
+                     Whether the gradient goes down the lines, instead of
+                     across each line.
+                 \endparblock
+    \return      \parblock
+                     The allocated/formatted string on success.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa _gradient
+*/
+char* gradient_bg(const char* s, const RGB* stops, size_t count, bool vertical) {
+    return _gradient(format_bg_RGB, s, GRADIENT_OKLAB, vertical, stops, count);
+}
+
+/*! This is exactly like gradient_bg(), except it uses colors that are
+    closer to the standard 256-color values.
+
+    \pi s        \parblock
+                     The string to colorize.
+                     \mustnullin
+                 \endparblock
+    \pi stops    The colors to blend, from start to end.
+    \pi count    Number of colors in \p stops, up to COLR_GRADIENT_MAX_STOPS.
+    \pi vertical \parblock
+                     Whether the gradient goes down the lines, instead of
+                     across each line.
+                 \endparblock
+    \return      \parblock
+                     The allocated/formatted string on success.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa _gradient
+*/
+char* gradient_bg_term(const char* s, const RGB* stops, size_t count, bool vertical) {
+    return _gradient(format_bg_RGB_term, s, GRADIENT_OKLAB, vertical, stops, count);
+}
+
+/*! Colorize text with a gradient between RGB fore colors.
+
+    \details
+    This uses OKLab to blend the colors. Use _gradient() for linear RGB.
+
+    \pi s        \parblock
+                     The string to colorize.
+                     \mustnullin
+                 \endparblock
+    \pi stops    The colors to blend, from start to end.
+    \pi count    Number of colors in \p stops, up to COLR_GRADIENT_MAX_STOPS.
+    \pi vertical \parblock
+                     Whether the gradient goes down the lines, instead of
+                     across each line.
+                 \endparblock
+    \return      \parblock
+                     The allocated/formatted string on success.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa _gradient
+
+    \examplecodefor{gradient_fg,.c}
+    RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+    char* s = gradient_fg("Red to blue.", stops, 2, false);
+    if (!s) return EXIT_FAILURE;
+    puts(s);
+    free(s);
+    \endexamplecode
+*/
+char* gradient_fg(const char* s, const RGB* stops, size_t count, bool vertical) {
+    return _gradient(format_fg_RGB, s, GRADIENT_OKLAB, vertical, stops, count);
+}
+
+/*! This is exactly like gradient_fg(), except it uses colors that are
+    closer to the standard 256-color values.
+
+    \pi s        \parblock
+                     The string to colorize.
+                     \mustnullin
+                 \endparblock
+    \pi stops    The colors to blend, from start to end.
+    \pi count    Number of colors in \p stops, up to COLR_GRADIENT_MAX_STOPS.
+    \pi vertical \parblock
+                     Whether the gradient goes down the lines, instead of
+                     across each line.
+                 \endparblock
+    \return      \parblock
+                     The allocated/formatted string on success.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa _gradient
+*/
+char* gradient_fg_term(const char* s, const RGB* stops, size_t count, bool vertical) {
+    return _gradient(format_fg_RGB_term, s, GRADIENT_OKLAB, vertical, stops, count);
+}
+
+/*! Handles multibyte character string conversion and character iteration for
+    all of the gradient_ functions.
+
+    \details
+    Horizontal gradients prepend a code to every character, and the ramp is as
+    wide as the longest line, in display columns, so the colors line up in
+    columns. Wide characters (CJK, most emoji) use 2 columns, and zero-width
+    characters share the code of the character before them.
+    Vertical gradients prepend one code to every line, and the ramp has one
+    color for each line.
+
+    \details
+    The `CODE_RESET_ALL` code is appended to the result.
+
+    \pi fmter    The RGB_fmter to use for creating the escape-codes.
+    \pi s        \parblock
+                     The string to colorize.
+                     \mustnullin
+                 \endparblock
+    \pi space    The ColrGradientSpace to blend colors in.
+    \pi vertical Whether the gradient goes down the lines, instead of across them.
+    \pi stops    The colors to blend, from start to end.
+    \pi count    Number of colors in \p stops, up to COLR_GRADIENT_MAX_STOPS.
+    \return      \parblock
+                     The allocated/formatted string on success.
+                     `NULL` is returned if \p s is `NULL`/empty, the stops are
+                     not usable, or allocation fails.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa ColrGradient
+*/
+char* _gradient(RGB_fmter fmter, const char* s, ColrGradientSpace space, bool vertical, const RGB* stops, size_t count) {
+    if (!s || s[0] == '\0') return NULL;
+    // Count characters/lines first, to size the ramp and the result.
+    size_t byte_len = strlen(s);
+    size_t char_count = 0;
+    size_t newlines = 0;
+    // Trailing newlines don't start a new line for the ramp.
+    size_t line_count = 1;
+    size_t width = 0;
+    size_t max_width = 0;
+    size_t i = 0;
+    while (i < byte_len) {
+        size_t char_len = colr_mb_char_len(s + i, byte_len - i);
+        // Invalid characters are copied one byte at a time.
+        if (!(char_len && colr_is_valid_mblen(char_len))) char_len = 1;
+        if (s[i] == '\n') {
+            newlines++;
+            width = 0;
+        } else {
+            char_count++;
+            line_count = newlines + 1;
+            width += (char_len == 1) ? 1 : colr_mb_char_width(s + i, char_len);
+            if (width > max_width) max_width = width;
+        }
+        i += char_len;
+    }
+    ColrGradient* gradient = ColrGradient_new(fmter, space, stops, count);
+    if (!gradient) return NULL;
+    if (!ColrGradient_set_length(gradient, vertical ? line_count : max_width)) {
+        ColrGradient_free(gradient);
+        return NULL;
+    }
+    // Same newline handling as _rainbow().
+    bool append_reset_nl = (
+        (fmter == format_bg_RGB) ||
+        (fmter == format_bg_RGB_term)
+    );
+    size_t reset_back_len = strlen(CODE_RESET_BACK);
+    size_t total_size = byte_len + (CODE_RGB_LEN * (vertical ? line_count : char_count));
+    if (append_reset_nl) total_size += reset_back_len * newlines;
+    // Room for the final CODE_RESET_ALL.
+    total_size += CODE_RESET_LEN;
+    char* out = malloc(total_size);
+    if (!out) {
+        ColrGradient_free(gradient);
+        return NULL;
+    }
+    char* cursor = out;
+    size_t line = 0;
+    // Display column, and whether the line has a code yet.
+    size_t column = 0;
+    bool line_coded = false;
+    i = 0;
+    while (i < byte_len) {
+        if (s[i] == '\n') {
+            if (append_reset_nl) {
+                memcpy(cursor, CODE_RESET_BACK, reset_back_len);
+                cursor += reset_back_len;
+            }
+            *cursor++ = '\n';
+            line++;
+            column = 0;
+            line_coded = false;
+            i++;
+            continue;
+        }
+        size_t char_len = colr_mb_char_len(s + i, byte_len - i);
+        if (!(char_len && colr_is_valid_mblen(char_len))) char_len = 1;
+        int char_width = (char_len == 1) ? 1 : colr_mb_char_width(s + i, char_len);
+        // Zero-width characters (combining marks) stay with the one before them.
+        if (vertical ? !line_coded : (char_width || !line_coded)) {
+            size_t code_len = 0;
+            // Wide characters get the color for their first column.
+            const char* code = ColrGradient_code(gradient, vertical ? line : column, &code_len);
+            memcpy(cursor, code, code_len);
+            cursor += code_len;
+            line_coded = true;
+        }
+        memcpy(cursor, s + i, char_len);
+        cursor += char_len;
+        column += char_width;
+        i += char_len;
+    }
+    cursor[0] = '\0';
+    ColrGradient_free(gradient);
+    colr_append_reset(out);
+    return out;
+}
+
 /*! Rainbow-ize some text using rgb back colors, lolcat style.
 
     \details
@@ -8731,23 +13058,38 @@ char* _rainbow(RGB_fmter fmter, const char* s, double freq, size_t offset, size_
         // There is also a reset code prepended before every newline.
         total_size += CODE_RESET_LEN * colr_str_char_count(s, '\n');
     }
-    char* out = calloc(total_size, sizeof(char));
+    // Room for the final CODE_RESET_ALL.
+    total_size += CODE_RESET_LEN;
+    char* out = malloc(total_size);
     if (!out) return NULL;
+    // Computes/formats the colors without calling sin() for every character.
+    ColrRainbow* rainbow = ColrRainbow_new(fmter, freq, offset, spread);
+    if (!rainbow) {
+        free(out);
+        return NULL;
+    }
 
-    char codes[CODE_RGB_LEN];
-    // Enough room for one (possibly multibyte) character.
-    char mb_char[MB_LEN_MAX + 1];
+    // Everything is written at the cursor, the output is never re-scanned.
+    char* cursor = out;
+    size_t reset_back_len = strlen(CODE_RESET_BACK);
+    // ASCII chars are always 1 byte in UTF-8, colr_mb_len() is not needed.
+    bool ascii_fast = (spread == 1) && colr_locale_is_utf8();
     // Iterate over each multibyte character.
     size_t i = 0;
     size_t char_len = 0;
-    while ((char_len = colr_mb_len(s + i, spread)) && colr_is_valid_mblen(char_len)) {
+    while (s[i]) {
+        if (ascii_fast && ((unsigned char)s[i] < 0x80)) {
+            char_len = 1;
+        } else {
+            char_len = colr_mb_len(s + i, spread);
+            if (!(char_len && colr_is_valid_mblen(char_len))) break;
+        }
         // Add a rainbow code to the output.
-        fmter(codes, rainbow_step(freq, offset + i));
-        strcat(out, codes);
-        // Write the multibyte char at (s + i), the length is char_len.
-        // Basically copying the string from (s + i) through (s + i + char_len).
-        snprintf(mb_char, char_len + 1, "%s", s + i);
-        if (append_reset_nl && (mb_char[0] == '\n')) {
+        size_t code_len = 0;
+        const char* code = ColrRainbow_code(rainbow, offset + i, &code_len);
+        memcpy(cursor, code, code_len);
+        cursor += code_len;
+        if (append_reset_nl && (s[i] == '\n')) {
             // Prepend the reset code *before* newlines for back-rainbows.
             // NOTE: Some terminals won't colorize '\t' like they will a space.
             //       '\n\t' looks different than '\n '. I could try to account
@@ -8756,12 +13098,17 @@ char* _rainbow(RGB_fmter fmter, const char* s, double freq, size_t offset, size_
             //       reset at all, and leave long lines of background color.
             //       For now, just know that '\t' is special when doing
             //       background-colors, and it's not my fault.
-            strcat(out, CODE_RESET_BACK);
+            memcpy(cursor, CODE_RESET_BACK, reset_back_len);
+            cursor += reset_back_len;
         }
-        strcat(out, mb_char);
+        // Copy the multibyte char at (s + i), the length is char_len.
+        memcpy(cursor, s + i, char_len);
+        cursor += char_len;
         // Jump past the multibyte character for the next code.
         i += char_len;
     }
+    cursor[0] = '\0';
+    ColrRainbow_free(rainbow);
     colr_append_reset(out);
 
     return out;
@@ -39,7 +39,9 @@
     \endexamplecode
 */
 ColorResult* Colr_cursor_hide(void) {
-    return ColorResult_from_stra(COLR_ESC "?25l");
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_cursor_hide(&cmdbuf);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that shows the cursor when printed.
@@ -51,7 +53,9 @@ ColorResult* Colr_cursor_hide(void) {
             \endparblock
 */
 ColorResult* Colr_cursor_show(void) {
-    return ColorResult_from_stra(COLR_ESC "?25h");
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_cursor_show(&cmdbuf);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will erase the display or part of the display
@@ -77,21 +81,9 @@ ColorResult* Colr_cursor_show(void) {
     \endexamplecode
 */
 ColorResult* Colr_erase_display(EraseMethod method) {
-    if (method == ALL) method = ALL_MOVE;
-    if (method == ALL_MOVE_ERASE) {
-        // ALL_MOVE + ALL_ERASE
-        // finallen *= 2;
-        // char dblcodes[finallen];
-        char* methstr_move = EraseMethod_to_str(ALL_MOVE);
-        char* methstr_erase = EraseMethod_to_str(ALL_ERASE);
-        return Colr_cat(COLR_ESC, methstr_move, "J;" COLR_ESC, methstr_erase, "J");
-    }
-    char* methstr = EraseMethod_to_str(method);
-    if (!methstr) return NULL;
-    size_t finallen = COLR_ESC_LEN + 2;
-    char codes[finallen];
-    snprintf(codes, finallen, COLR_ESC "%sJ", methstr);
-    return ColorResult_from_stra(codes);
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_erase_display(&cmdbuf, method);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will erase line or part of a line when printed.
@@ -120,15 +112,10 @@ ColorResult* Colr_erase_display(EraseMethod method) {
 
 */
 ColorResult* Colr_erase_line(EraseMethod method) {
-    if (method == ALL) method = ALL_MOVE;
-    assert((method == END) || (method == START) || (method == ALL_MOVE));
-    char* methstr = EraseMethod_to_str(method);
-    if (!methstr) return NULL;
-    size_t finallen = COLR_ESC_LEN + 2;
-    char codes[finallen];
-    snprintf(codes, finallen, COLR_ESC "%sK", methstr);
-    return ColorResult_from_stra(codes);
-
+    assert((method == END) || (method == START) || (method == ALL_MOVE) || (method == ALL));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_erase_line(&cmdbuf, method);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor back a number
@@ -145,9 +132,9 @@ ColorResult* Colr_erase_line(EraseMethod method) {
                 \endparblock
 */
 ColorResult* Colr_move_back(unsigned int columns) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dD", columns ? columns : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_back(&cmdbuf, columns);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor back to the
@@ -160,7 +147,9 @@ ColorResult* Colr_move_back(unsigned int columns) {
                 \endparblock
 */
 ColorResult* Colr_move_return(void) {
-    return ColorResult_from_stra("\r");
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_return(&cmdbuf);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor to a specific
@@ -180,9 +169,9 @@ ColorResult* Colr_move_return(void) {
                 \endparblock
 */
 ColorResult* Colr_move_column(unsigned int column) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dG", column ? column : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_column(&cmdbuf, column);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor down a number
@@ -199,9 +188,9 @@ ColorResult* Colr_move_column(unsigned int column) {
                 \endparblock
 */
 ColorResult* Colr_move_down(unsigned int lines) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dB", lines ? lines : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_down(&cmdbuf, lines);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor forward a number
@@ -218,9 +207,9 @@ ColorResult* Colr_move_down(unsigned int lines) {
                 \endparblock
 */
 ColorResult* Colr_move_forward(unsigned int columns) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dC", columns ? columns : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_forward(&cmdbuf, columns);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor down a number
@@ -237,9 +226,9 @@ ColorResult* Colr_move_forward(unsigned int columns) {
                 \endparblock
 */
 ColorResult* Colr_move_next(unsigned int lines) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dE", lines ? lines : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_next(&cmdbuf, lines);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 
@@ -264,15 +253,9 @@ ColorResult* Colr_move_next(unsigned int lines) {
                 \endparblock
 */
 ColorResult* Colr_move_pos(unsigned int line, unsigned int column) {
-    char* codes = NULL;
-    asprintf_or_return(
-        NULL,
-        &codes,
-        COLR_ESC "%d;%dH",
-        line ? line : 1,
-        column ? column : 1
-    );
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_pos(&cmdbuf, line, column);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor up a number of
@@ -289,9 +272,9 @@ ColorResult* Colr_move_pos(unsigned int line, unsigned int column) {
                 \endparblock
 */
 ColorResult* Colr_move_prev(unsigned int lines) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dF", lines ? lines : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_prev(&cmdbuf, lines);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will move the cursor up a number of
@@ -311,9 +294,9 @@ ColorResult* Colr_move_prev(unsigned int lines) {
                 \endparblock
 */
 ColorResult* Colr_move_up(unsigned int lines) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dA", lines ? lines : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_move_up(&cmdbuf, lines);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that restores a previously saved cursor
@@ -341,7 +324,9 @@ ColorResult* Colr_move_up(unsigned int lines) {
     \endexamplecode
 */
 ColorResult* Colr_pos_restore(void) {
-    return ColorResult_from_stra(COLR_ESC "u");
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_pos_restore(&cmdbuf);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that saves the cursor position when printed.
@@ -356,7 +341,9 @@ ColorResult* Colr_pos_restore(void) {
             \endparblock
 */
 ColorResult* Colr_pos_save(void) {
-    return ColorResult_from_stra(COLR_ESC "s");
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_pos_save(&cmdbuf);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will scroll the cursor down a number
@@ -388,9 +375,9 @@ ColorResult* Colr_pos_save(void) {
     \endexamplecode
 */
 ColorResult* Colr_scroll_down(unsigned int lines) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dT", lines ? lines : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_scroll_down(&cmdbuf, lines);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
 }
 
 /*! Returns an allocated ColorResult that will scroll the cursor up a number
@@ -407,7 +394,1217 @@ ColorResult* Colr_scroll_down(unsigned int lines) {
                 \endparblock
 */
 ColorResult* Colr_scroll_up(unsigned int lines) {
-    char* codes = NULL;
-    asprintf_or_return(NULL, &codes, COLR_ESC "%dS", lines ? lines : 1);
-    return ColorResult_to_ptr(ColorResult_new(codes));
+    ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+    ColrCmdBuf_scroll_up(&cmdbuf, lines);
+    return ColrCmdBuf_to_ColorResult(&cmdbuf);
+}
+
+/*! Compares the colors and style of two ColrCells, ignoring the characters.
+
+    \pi a   The first ColrCell to compare.
+    \pi b   The second ColrCell to compare.
+    \return `true` if the colors and styles match, otherwise `false`.
+
+    \sa ColrCell
+*/
+bool ColrCell_attrs_eq(ColrCell a, ColrCell b) {
+    return (
+        ColorValue_eq(a.fore, b.fore) &&
+        ColorValue_eq(a.back, b.back) &&
+        ColorValue_eq(a.style, b.style)
+    );
+}
+
+/*! Creates an empty ColrCell, a blank cell with no colors or style.
+
+    \return An empty ColrCell.
+
+    \sa ColrCell
+*/
+ColrCell ColrCell_empty(void) {
+    return (ColrCell){
+        .codepoint=0,
+        .fore=ColorValue_empty(),
+        .back=ColorValue_empty(),
+        .style=ColorValue_empty(),
+    };
+}
+
+/*! Compares two ColrCells.
+
+    \pi a   The first ColrCell to compare.
+    \pi b   The second ColrCell to compare.
+    \return `true` if the characters, colors, and styles match, otherwise `false`.
+
+    \sa ColrCell
+*/
+bool ColrCell_eq(ColrCell a, ColrCell b) {
+    return (a.codepoint == b.codepoint) && ColrCell_attrs_eq(a, b);
+}
+
+/*! Appends bytes to a ColrCmdBuf, growing it as needed.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi s      Bytes to append. This does not need to be null-terminated.
+    \pi length Number of bytes to append.
+    \return    `true` on success, or `false` if allocation failed.
+*/
+bool ColrCmdBuf_append(ColrCmdBuf* cmdbuf, const char* s, size_t length) {
+    if (!(cmdbuf && s)) return false;
+    // Always room for the null-terminator.
+    size_t needed = cmdbuf->length + length + 1;
+    if (needed > cmdbuf->cap) {
+        size_t cap = cmdbuf->cap ? cmdbuf->cap : COLR_CMDBUF_SIZE;
+        while (cap < needed) cap *= 2;
+        char* buf = realloc(cmdbuf->buf, cap);
+        if (!buf) return false;
+        cmdbuf->buf = buf;
+        cmdbuf->cap = cap;
+    }
+    memcpy(cmdbuf->buf + cmdbuf->length, s, length);
+    cmdbuf->length += length;
+    cmdbuf->buf[cmdbuf->length] = '\0';
+    return true;
+}
+
+/*! Appends an escape code with a single number, like `"\x1b[5A"`.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi n      The number for the code.
+    \pi final  The character that ends the code, like `'A'`.
+    \return    `true` on success, or `false` if allocation failed.
+*/
+bool ColrCmdBuf_append_code(ColrCmdBuf* cmdbuf, unsigned int n, char final) {
+    return (
+        ColrCmdBuf_append(cmdbuf, COLR_ESC, COLR_ESC_LEN - 1) &&
+        ColrCmdBuf_append_uint(cmdbuf, n) &&
+        ColrCmdBuf_append(cmdbuf, &final, 1)
+    );
+}
+
+/*! Appends a \string to a ColrCmdBuf.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi s      The string to append.
+    \return    `true` on success, or `false` if allocation failed.
+*/
+bool ColrCmdBuf_append_str(ColrCmdBuf* cmdbuf, const char* s) {
+    if (!s) return false;
+    return ColrCmdBuf_append(cmdbuf, s, strlen(s));
+}
+
+/*! Appends the decimal digits for an `unsigned int`, like `"%u"` would,
+    without the `snprintf()` overhead.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi n      The number to append.
+    \return    `true` on success, or `false` if allocation failed.
+*/
+bool ColrCmdBuf_append_uint(ColrCmdBuf* cmdbuf, unsigned int n) {
+    char digits[16];
+    size_t start = sizeof(digits);
+    do {
+        digits[--start] = (char)('0' + (n % 10));
+        n /= 10;
+    } while (n);
+    return ColrCmdBuf_append(cmdbuf, digits + start, sizeof(digits) - start);
+}
+
+/*! Removes everything from a ColrCmdBuf, keeping the allocation for reuse.
+
+    \pi cmdbuf The ColrCmdBuf to clear.
+*/
+void ColrCmdBuf_clear(ColrCmdBuf* cmdbuf) {
+    if (!cmdbuf) return;
+    cmdbuf->length = 0;
+    if (cmdbuf->buf) cmdbuf->buf[0] = '\0';
+}
+
+/*! Appends a code to hide the cursor.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_cursor_hide
+*/
+bool ColrCmdBuf_cursor_hide(ColrCmdBuf* cmdbuf) {
+    return ColrCmdBuf_append_str(cmdbuf, COLR_ESC "?25l");
+}
+
+/*! Appends a code to show the cursor.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_cursor_show
+*/
+bool ColrCmdBuf_cursor_show(ColrCmdBuf* cmdbuf) {
+    return ColrCmdBuf_append_str(cmdbuf, COLR_ESC "?25h");
+}
+
+/*! Appends a code to erase the display, or part of the display.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi method The erase method.
+    \return    `true` on success, or `false` if allocation failed, or the
+               EraseMethod was invalid.
+
+    \sa Colr_erase_display
+*/
+bool ColrCmdBuf_erase_display(ColrCmdBuf* cmdbuf, EraseMethod method) {
+    if (method == ALL) method = ALL_MOVE;
+    if (method == ALL_MOVE_ERASE) {
+        return (
+            ColrCmdBuf_erase_display(cmdbuf, ALL_MOVE) &&
+            ColrCmdBuf_erase_display(cmdbuf, ALL_ERASE)
+        );
+    }
+    char* methstr = EraseMethod_to_str(method);
+    if (!methstr) return false;
+    return (
+        ColrCmdBuf_append(cmdbuf, COLR_ESC, COLR_ESC_LEN - 1) &&
+        ColrCmdBuf_append_str(cmdbuf, methstr) &&
+        ColrCmdBuf_append(cmdbuf, "J", 1)
+    );
+}
+
+/*! Appends a code to erase the line, or part of the line.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi method The erase method (END, START, ALL_MOVE, or ALL).
+    \return    `true` on success, or `false` if allocation failed, or the
+               EraseMethod was invalid.
+
+    \sa Colr_erase_line
+*/
+bool ColrCmdBuf_erase_line(ColrCmdBuf* cmdbuf, EraseMethod method) {
+    if (method == ALL) method = ALL_MOVE;
+    if (!((method == END) || (method == START) || (method == ALL_MOVE))) return false;
+    char* methstr = EraseMethod_to_str(method);
+    return (
+        ColrCmdBuf_append(cmdbuf, COLR_ESC, COLR_ESC_LEN - 1) &&
+        ColrCmdBuf_append_str(cmdbuf, methstr) &&
+        ColrCmdBuf_append(cmdbuf, "K", 1)
+    );
+}
+
+/*! Writes everything in a ColrCmdBuf to a file descriptor, with one `write()`
+    call, and clears it.
+
+    \details
+    `write()` is only called again if the first call was interrupted, or only
+    wrote part of the buffer. Anything that couldn't be written is kept for
+    the next flush.
+
+    \details
+    This bypasses `FILE` buffering, so call `fflush(stdout)` first if you
+    have been using `printf()`/colr_print() for the same terminal.
+
+    \pi cmdbuf The ColrCmdBuf to flush.
+    \pi fd     The file descriptor to write to, like `STDOUT_FILENO`.
+    \return    The number of bytes written.
+
+    \examplecodefor{ColrCmdBuf_flush,.c}
+    #include "colr.controls.h"
+
+    int main(void) {
+        ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+        ColrCmdBuf_cursor_hide(&cmdbuf);
+        ColrCmdBuf_pos_save(&cmdbuf);
+        ColrCmdBuf_move_pos(&cmdbuf, 1, 1);
+        ColrCmdBuf_erase_line(&cmdbuf, ALL);
+        ColrCmdBuf_append_str(&cmdbuf, "Status: okay");
+        ColrCmdBuf_pos_restore(&cmdbuf);
+        ColrCmdBuf_cursor_show(&cmdbuf);
+        // All of that is sent at once.
+        ColrCmdBuf_flush(&cmdbuf, STDOUT_FILENO);
+        ColrCmdBuf_free(&cmdbuf);
+    }
+    \endexamplecode
+*/
+size_t ColrCmdBuf_flush(ColrCmdBuf* cmdbuf, int fd) {
+    if (!(cmdbuf && cmdbuf->length)) return 0;
+    size_t written = 0;
+    while (written < cmdbuf->length) {
+        ssize_t count = write(fd, cmdbuf->buf + written, cmdbuf->length - written);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        written += (size_t)count;
+    }
+    memmove(cmdbuf->buf, cmdbuf->buf + written, cmdbuf->length - written);
+    cmdbuf->length -= written;
+    cmdbuf->buf[cmdbuf->length] = '\0';
+    return written;
+}
+
+/*! Frees the allocated buffer in a ColrCmdBuf. The ColrCmdBuf itself is not
+    free'd, and can be used again.
+
+    \pi cmdbuf The ColrCmdBuf to free the buffer for.
+*/
+void ColrCmdBuf_free(ColrCmdBuf* cmdbuf) {
+    if (!cmdbuf) return;
+    free(cmdbuf->buf);
+    *cmdbuf = ColrCmdBuf_new();
+}
+
+/*! Appends a code to move the cursor back a number of columns.
+
+    \pi cmdbuf  The ColrCmdBuf to append to.
+    \pi columns The number of columns to move. Using `0` is the same as using `1`.
+    \return     `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_back
+*/
+bool ColrCmdBuf_move_back(ColrCmdBuf* cmdbuf, unsigned int columns) {
+    return ColrCmdBuf_append_code(cmdbuf, columns ? columns : 1, 'D');
+}
+
+/*! Appends a code to move the cursor to a specific column.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi column The column to move to, starting at `1`. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_column
+*/
+bool ColrCmdBuf_move_column(ColrCmdBuf* cmdbuf, unsigned int column) {
+    return ColrCmdBuf_append_code(cmdbuf, column ? column : 1, 'G');
+}
+
+/*! Appends a code to move the cursor down a number of lines.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi lines  The number of lines to move. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_down
+*/
+bool ColrCmdBuf_move_down(ColrCmdBuf* cmdbuf, unsigned int lines) {
+    return ColrCmdBuf_append_code(cmdbuf, lines ? lines : 1, 'B');
+}
+
+/*! Appends a code to move the cursor forward a number of columns.
+
+    \pi cmdbuf  The ColrCmdBuf to append to.
+    \pi columns The number of columns to move. Using `0` is the same as using `1`.
+    \return     `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_forward
+*/
+bool ColrCmdBuf_move_forward(ColrCmdBuf* cmdbuf, unsigned int columns) {
+    return ColrCmdBuf_append_code(cmdbuf, columns ? columns : 1, 'C');
+}
+
+/*! Appends a code to move the cursor down a number of lines, at the start
+    of the line.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi lines  The number of lines to move. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_next
+*/
+bool ColrCmdBuf_move_next(ColrCmdBuf* cmdbuf, unsigned int lines) {
+    return ColrCmdBuf_append_code(cmdbuf, lines ? lines : 1, 'E');
+}
+
+/*! Appends a code to move the cursor to a line and column.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi line   The line to move to, starting at `1`. Using `0` is the same as using `1`.
+    \pi column The column to move to, starting at `1`. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_pos
+*/
+bool ColrCmdBuf_move_pos(ColrCmdBuf* cmdbuf, unsigned int line, unsigned int column) {
+    return (
+        ColrCmdBuf_append(cmdbuf, COLR_ESC, COLR_ESC_LEN - 1) &&
+        ColrCmdBuf_append_uint(cmdbuf, line ? line : 1) &&
+        ColrCmdBuf_append(cmdbuf, ";", 1) &&
+        ColrCmdBuf_append_uint(cmdbuf, column ? column : 1) &&
+        ColrCmdBuf_append(cmdbuf, "H", 1)
+    );
+}
+
+/*! Appends a code to move the cursor up a number of lines, at the start of
+    the line.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi lines  The number of lines to move. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_prev
+*/
+bool ColrCmdBuf_move_prev(ColrCmdBuf* cmdbuf, unsigned int lines) {
+    return ColrCmdBuf_append_code(cmdbuf, lines ? lines : 1, 'F');
+}
+
+/*! Appends a carriage return, to move the cursor to the start of the line.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_return
+*/
+bool ColrCmdBuf_move_return(ColrCmdBuf* cmdbuf) {
+    return ColrCmdBuf_append(cmdbuf, "\r", 1);
+}
+
+/*! Appends a code to move the cursor up a number of lines.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi lines  The number of lines to move. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_move_up
+*/
+bool ColrCmdBuf_move_up(ColrCmdBuf* cmdbuf, unsigned int lines) {
+    return ColrCmdBuf_append_code(cmdbuf, lines ? lines : 1, 'A');
+}
+
+/*! Creates an empty ColrCmdBuf. Nothing is allocated until something is
+    appended.
+
+    \return A ColrCmdBuf, ready to use.
+
+    \sa ColrCmdBuf_free
+*/
+ColrCmdBuf ColrCmdBuf_new(void) {
+    return (ColrCmdBuf){.buf=NULL, .length=0, .cap=0};
+}
+
+/*! Appends a code to restore a saved cursor position.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_pos_restore
+*/
+bool ColrCmdBuf_pos_restore(ColrCmdBuf* cmdbuf) {
+    return ColrCmdBuf_append_str(cmdbuf, COLR_ESC "u");
+}
+
+/*! Appends a code to save the cursor position.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_pos_save
+*/
+bool ColrCmdBuf_pos_save(ColrCmdBuf* cmdbuf) {
+    return ColrCmdBuf_append_str(cmdbuf, COLR_ESC "s");
+}
+
+/*! Appends a code to scroll down a number of lines. New lines are added to
+    the top.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi lines  The number of lines to scroll. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_scroll_down
+*/
+bool ColrCmdBuf_scroll_down(ColrCmdBuf* cmdbuf, unsigned int lines) {
+    return ColrCmdBuf_append_code(cmdbuf, lines ? lines : 1, 'T');
+}
+
+/*! Appends a code to scroll up a number of lines. New lines are added to
+    the bottom.
+
+    \pi cmdbuf The ColrCmdBuf to append to.
+    \pi lines  The number of lines to scroll. Using `0` is the same as using `1`.
+    \return    `true` on success, or `false` if allocation failed.
+
+    \sa Colr_scroll_up
+*/
+bool ColrCmdBuf_scroll_up(ColrCmdBuf* cmdbuf, unsigned int lines) {
+    return ColrCmdBuf_append_code(cmdbuf, lines ? lines : 1, 'S');
+}
+
+/*! Moves the contents of a ColrCmdBuf into an allocated ColorResult.
+
+    \details
+    The buffer is handed over to the ColorResult, so the ColrCmdBuf is empty
+    afterwards.
+
+    \pi cmdbuf The ColrCmdBuf to use.
+    \return    \parblock
+                   An allocated ColorResult, or `NULL` if the ColrCmdBuf was
+                   empty.
+                   \maybenullalloc
+                   \colrmightfree
+               \endparblock
+*/
+ColorResult* ColrCmdBuf_to_ColorResult(ColrCmdBuf* cmdbuf) {
+    if (!(cmdbuf && cmdbuf->length)) {
+        ColrCmdBuf_free(cmdbuf);
+        return NULL;
+    }
+    ColorResult* cres = ColorResult_to_ptr(ColorResult_new(cmdbuf->buf));
+    if (!cres) {
+        ColrCmdBuf_free(cmdbuf);
+        return NULL;
+    }
+    *cmdbuf = ColrCmdBuf_new();
+    return cres;
+}
+
+/*! Adds to the amount of work done for a ColrProgress, without drawing it.
+
+    \details
+    This is a lock-free atomic update, so it is safe to call from any thread.
+
+    \pi progress The ColrProgress to update.
+    \pi amount   Amount of work that was just done.
+*/
+void ColrProgress_add(ColrProgress* progress, size_t amount) {
+    if (!progress) return;
+    atomic_fetch_add_explicit(&progress->current, amount, memory_order_relaxed);
+}
+
+/*! Redraws a ColrProgress, if it changed and it's time to redraw.
+
+    \details
+    Redraws happen at most once per `interval_ns`, unless `force` is `true`.
+    The first draw, and the draw that completes the bar, are never skipped.
+
+    \details
+    If another thread is already drawing, this returns right away.
+
+    \pi progress The ColrProgress to draw.
+    \pi fd       The file descriptor to write to, like `STDOUT_FILENO`.
+    \pi force    Whether to ignore the redraw interval.
+    \return      The number of bytes written, which is `0` when nothing was drawn.
+
+    \sa ColrProgress_update
+*/
+size_t ColrProgress_draw(ColrProgress* progress, int fd, bool force) {
+    if (!progress) return 0;
+    if (atomic_flag_test_and_set_explicit(&progress->drawing, memory_order_acquire)) {
+        return 0;
+    }
+    size_t written = 0;
+    uint64_t now = colr_monotonic_ns();
+    bool done = atomic_load_explicit(&progress->current, memory_order_relaxed) >= progress->total;
+    bool due = (now - progress->last_ns) >= progress->interval_ns;
+    if ((force || done || due || !progress->started) && ColrProgress_render(progress)) {
+        size_t length = progress->out.length;
+        written = ColrCmdBuf_flush(&progress->out, fd);
+        if (written < length) {
+            // What is on the terminal is unknown now, so redraw it all next time.
+            progress->started = false;
+            ColrCmdBuf_clear(&progress->out);
+        }
+        progress->last_ns = now;
+    }
+    atomic_flag_clear_explicit(&progress->drawing, memory_order_release);
+    return written;
+}
+
+/*! Returns the number of filled cells for a ColrProgress at some point.
+
+    \pi progress The ColrProgress to use.
+    \pi current  Amount of work done.
+    \return      The number of filled cells, up to `progress->width`.
+*/
+size_t ColrProgress_filled(ColrProgress* progress, size_t current) {
+    if (!progress) return 0;
+    if (current >= progress->total) return progress->width;
+    return (size_t)(((double)current / (double)progress->total) * (double)progress->width);
+}
+
+/*! Draws a ColrProgress one last time, ignoring the redraw interval, and
+    moves to the next line.
+
+    \details
+    This should be called after all of the worker threads are done with it.
+
+    \pi progress The ColrProgress to finish.
+    \pi fd       The file descriptor to write to, like `STDOUT_FILENO`.
+    \return      The number of bytes written.
+*/
+size_t ColrProgress_finish(ColrProgress* progress, int fd) {
+    if (!progress) return 0;
+    size_t written = ColrProgress_draw(progress, fd, true);
+    ColrCmdBuf_clear(&progress->out);
+    if (ColrCmdBuf_append(&progress->out, "\n", 1)) {
+        written += ColrCmdBuf_flush(&progress->out, fd);
+    }
+    return written;
+}
+
+/*! Frees a ColrProgress.
+
+    \pi progress The ColrProgress to free.
+*/
+void ColrProgress_free(ColrProgress* progress) {
+    if (!progress) return;
+    ColrCmdBuf_free(&progress->out);
+    free(progress);
+}
+
+/*! Creates a ColrProgress.
+
+    \pi total Total amount of work to do.
+    \pi width \parblock
+                  Width of the bar, in cells, not including the brackets and
+                  percentage. If `0` is used, the bar fills the terminal's
+                  width.
+              \endparblock
+    \pi rate  Maximum number of redraws per second. If `0` is used, COLR_REDRAW_RATE is used.
+    \return   \parblock
+                  An allocated ColrProgress.
+                  \mustfree ColrProgress_free()
+                  \maybenullalloc
+              \endparblock
+
+    \examplecodefor{ColrProgress_new,.c}
+    #include "colr.controls.h"
+
+    int main(void) {
+        size_t total = 1000000;
+        ColrProgress* progress = ColrProgress_new(total, 40, 0);
+        if (!progress) return EXIT_FAILURE;
+        progress->fill = "\x1b[32m=\x1b[0m";
+        for (size_t i = 0; i < total; i++) {
+            // Do some work here, the terminal is only written to 15 times per second.
+            ColrProgress_update(progress, 1, STDOUT_FILENO);
+        }
+        ColrProgress_finish(progress, STDOUT_FILENO);
+        ColrProgress_free(progress);
+    }
+    \endexamplecode
+*/
+ColrProgress* ColrProgress_new(size_t total, size_t width, unsigned int rate) {
+    if (!width) {
+        TermSize ts = colr_term_size();
+        // Room for "[", "] ", and "100%".
+        width = (ts.columns > 8) ? (size_t)ts.columns - 8 : 1;
+    }
+    ColrProgress* progress = malloc(sizeof(ColrProgress));
+    if (!progress) return NULL;
+    atomic_init(&progress->current, 0);
+    progress->total = total;
+    progress->width = width;
+    progress->fill = "=";
+    progress->empty = " ";
+    progress->interval_ns = 1000000000ULL / (rate ? rate : COLR_REDRAW_RATE);
+    progress->last_ns = 0;
+    progress->drawn = 0;
+    progress->percent = 0;
+    progress->started = false;
+    atomic_flag_clear(&progress->drawing);
+    progress->out = ColrCmdBuf_new();
+    return progress;
+}
+
+/*! Returns the percentage done for a ColrProgress at some point.
+
+    \pi progress The ColrProgress to use.
+    \pi current  Amount of work done.
+    \return      The percentage, from `0` to `100`.
+*/
+unsigned int ColrProgress_percent(ColrProgress* progress, size_t current) {
+    if (!progress) return 0;
+    if (current >= progress->total) return 100;
+    return (unsigned int)(((double)current / (double)progress->total) * 100);
+}
+
+/*! Builds the output for the next ColrProgress redraw, in `progress->out`.
+
+    \details
+    The first render draws the entire bar at the start of the line. After
+    that, only the cells between the old and new fill position, and the
+    percentage (if it changed), are drawn.
+
+    \pi progress The ColrProgress to render.
+    \return      `true` if there is something to draw, otherwise `false`.
+*/
+bool ColrProgress_render(ColrProgress* progress) {
+    if (!progress) return false;
+    ColrCmdBuf* out = &progress->out;
+    ColrCmdBuf_clear(out);
+    size_t current = atomic_load_explicit(&progress->current, memory_order_relaxed);
+    size_t filled = ColrProgress_filled(progress, current);
+    unsigned int percent = ColrProgress_percent(progress, current);
+    size_t start = 0;
+    size_t stop = progress->width;
+    if (progress->started) {
+        if ((filled == progress->drawn) && (percent == progress->percent)) return false;
+        start = (filled < progress->drawn) ? filled : progress->drawn;
+        stop = (filled < progress->drawn) ? progress->drawn : filled;
+        if ((start != stop) && !ColrCmdBuf_move_column(out, (unsigned int)(start + 2))) {
+            return false;
+        }
+    } else if (!(ColrCmdBuf_move_return(out) && ColrCmdBuf_append(out, "[", 1))) {
+        return false;
+    }
+    for (size_t i = start; i < stop; i++) {
+        if (!ColrCmdBuf_append_str(out, (i < filled) ? progress->fill : progress->empty)) {
+            return false;
+        }
+    }
+    if (!progress->started) {
+        if (!ColrCmdBuf_append(out, "] ", 2)) return false;
+    } else if (percent != progress->percent) {
+        if (!ColrCmdBuf_move_column(out, (unsigned int)(progress->width + 4))) return false;
+    }
+    if (!progress->started || (percent != progress->percent)) {
+        // Right-aligned, like "%3u%%".
+        char* pad = (percent < 10) ? "  " : ((percent < 100) ? " " : "");
+        if (!(
+            ColrCmdBuf_append_str(out, pad) &&
+            ColrCmdBuf_append_uint(out, percent) &&
+            ColrCmdBuf_append(out, "%", 1)
+        )) {
+            return false;
+        }
+    }
+    progress->started = true;
+    progress->drawn = filled;
+    progress->percent = percent;
+    return true;
+}
+
+/*! Sets the amount of work done for a ColrProgress, without drawing it.
+
+    \details
+    This is a lock-free atomic update, so it is safe to call from any thread.
+
+    \pi progress The ColrProgress to update.
+    \pi current  Amount of work done.
+*/
+void ColrProgress_set(ColrProgress* progress, size_t current) {
+    if (!progress) return;
+    atomic_store_explicit(&progress->current, current, memory_order_relaxed);
+}
+
+/*! Adds to the amount of work done for a ColrProgress, and redraws it if
+    it's time to.
+
+    \pi progress The ColrProgress to update.
+    \pi amount   Amount of work that was just done.
+    \pi fd       The file descriptor to write to, like `STDOUT_FILENO`.
+    \return      The number of bytes written, which is `0` when nothing was drawn.
+
+    \sa ColrProgress_add ColrProgress_draw
+*/
+size_t ColrProgress_update(ColrProgress* progress, size_t amount, int fd) {
+    ColrProgress_add(progress, amount);
+    return ColrProgress_draw(progress, fd, false);
+}
+
+/*! Appends the escape codes needed to switch from the \p current colors and
+    style to the ones in \p cell.
+
+    \details
+    Only the codes that changed are written. A reset code is only used when
+    a color is removed, or the style changes, because styles stack up.
+
+    \pi     screen  The ColrScreen to append to (it's `out` member).
+    \pi     current \parblock
+                        The colors/style that are currently active.
+                        It is updated to match \p cell.
+                    \endparblock
+    \pi     cell    The ColrCell with the colors/style to switch to.
+    \return `true` on success, or `false` if allocation failed.
+*/
+bool ColrScreen_append_attrs(ColrScreen* screen, ColrCell* current, ColrCell cell) {
+    if (ColrCell_attrs_eq(*current, cell)) return true;
+    bool fore_eq = ColorValue_eq(current->fore, cell.fore);
+    bool back_eq = ColorValue_eq(current->back, cell.back);
+    bool style_eq = ColorValue_eq(current->style, cell.style);
+    if (
+        (!style_eq && !ColorValue_is_empty(current->style)) ||
+        (!fore_eq && ColorValue_is_empty(cell.fore)) ||
+        (!back_eq && ColorValue_is_empty(cell.back))
+    ) {
+        if (!ColrCmdBuf_append(&screen->out, CODE_RESET_ALL, CODE_RESET_LEN - 1)) return false;
+        *current = ColrCell_empty();
+        fore_eq = ColorValue_is_empty(cell.fore);
+        back_eq = ColorValue_is_empty(cell.back);
+        style_eq = ColorValue_is_empty(cell.style);
+    }
+    char code[CODE_ANY_LEN];
+    if (!style_eq && ColorValue_to_esc_s(code, STYLE, cell.style)) {
+        if (!ColrCmdBuf_append(&screen->out, code, strlen(code))) return false;
+    }
+    if (!fore_eq && ColorValue_to_esc_s(code, FORE, cell.fore)) {
+        if (!ColrCmdBuf_append(&screen->out, code, strlen(code))) return false;
+    }
+    if (!back_eq && ColorValue_to_esc_s(code, BACK, cell.back)) {
+        if (!ColrCmdBuf_append(&screen->out, code, strlen(code))) return false;
+    }
+    current->fore = cell.fore;
+    current->back = cell.back;
+    current->style = cell.style;
+    return true;
+}
+
+/*! Clears the back buffer of a ColrScreen, so every cell is empty.
+
+    \details
+    Nothing is written until ColrScreen_flush() is called.
+
+    \pi screen The ColrScreen to clear.
+*/
+void ColrScreen_clear(ColrScreen* screen) {
+    if (!(screen && screen->cells)) return;
+    ColrCell empty = ColrCell_empty();
+    for (size_t i = 0; i < (screen->rows * screen->columns); i++) {
+        screen->cells[i] = empty;
+    }
+}
+
+/*! Writes the cells that changed since the last flush to a file descriptor,
+    with one `write()` call.
+
+    \details
+    The output is built with ColrScreen_render(). The first flush, and the
+    first flush after ColrScreen_resize(), writes every cell.
+
+    \pi screen The ColrScreen to flush.
+    \pi fd     The file descriptor to write to, like `STDOUT_FILENO`.
+    \return    The number of bytes written.
+
+    \examplecodefor{ColrScreen_flush,.c}
+    #include "colr.controls.h"
+
+    int main(void) {
+        ColrScreen* screen = ColrScreen_new(0, 0);
+        if (!screen) return EXIT_FAILURE;
+        colr_control(Colr_cursor_hide());
+        for (int tick = 0; tick < 50; tick++) {
+            char counter[32];
+            snprintf(counter, sizeof(counter), "Tick: %d", tick);
+            ColrScreen_write(screen, 0, 0, Colr("Dashboard", fore(BLUE), style(BRIGHT)));
+            // Only the changed digits are written on each flush.
+            ColrScreen_write(screen, 1, 0, Colr(counter, fore(GREEN)));
+            ColrScreen_flush(screen, STDOUT_FILENO);
+            usleep(100000);
+        }
+        colr_control(Colr_cursor_show());
+        ColrScreen_free(screen);
+    }
+    \endexamplecode
+*/
+size_t ColrScreen_flush(ColrScreen* screen, int fd) {
+    if (!screen) return 0;
+    size_t length = ColrScreen_render(screen);
+    if (!length) return 0;
+    size_t written = ColrCmdBuf_flush(&screen->out, fd);
+    if (written < length) {
+        // What is on the terminal is unknown now, so redraw it all next time.
+        screen->redraw = true;
+        ColrCmdBuf_clear(&screen->out);
+        return written;
+    }
+    memcpy(screen->front, screen->cells, sizeof(ColrCell) * screen->rows * screen->columns);
+    screen->redraw = false;
+    return written;
+}
+
+/*! Frees a ColrScreen, and it's buffers.
+
+    \pi screen The ColrScreen to free.
+*/
+void ColrScreen_free(ColrScreen* screen) {
+    if (!screen) return;
+    free(screen->cells);
+    free(screen->front);
+    ColrCmdBuf_free(&screen->out);
+    free(screen);
+}
+
+/*! Allocates a ColrScreen, with empty cells.
+
+    \pi rows    Number of rows, or `0` to use the terminal's size from colr_term_size().
+    \pi columns Number of columns, or `0` to use the terminal's size from colr_term_size().
+    \return     \parblock
+                    An allocated ColrScreen.
+                    \mustfree ColrScreen_free()
+                    \maybenullalloc
+                \endparblock
+
+    \sa ColrScreen_flush
+*/
+ColrScreen* ColrScreen_new(size_t rows, size_t columns) {
+    ColrScreen* screen = calloc(1, sizeof(ColrScreen));
+    if (!screen) return NULL;
+    if (!ColrScreen_resize(screen, rows, columns)) {
+        ColrScreen_free(screen);
+        return NULL;
+    }
+    return screen;
+}
+
+/*! Builds the output for the cells that changed since the last flush,
+    without writing it.
+
+    \details
+    The output is stored in `screen->out` (a ColrCmdBuf), and used by
+    ColrScreen_flush().
+    Runs of changed cells are written with as few cursor moves and color
+    changes as possible. Small gaps of unchanged cells are written again
+    when that is shorter than moving the cursor past them.
+
+    \pi screen The ColrScreen to render.
+    \return    The length of the output, or `0` if nothing changed, or
+               allocation failed.
+*/
+size_t ColrScreen_render(ColrScreen* screen) {
+    if (!(screen && screen->cells)) return 0;
+    ColrCmdBuf_clear(&screen->out);
+    ColrCell current = ColrCell_empty();
+    // The terminal's colors are unknown until the first reset.
+    bool attrs_known = false;
+    // The cursor position is unknown until the first move.
+    size_t cur_row = SIZE_MAX;
+    size_t cur_col = SIZE_MAX;
+    for (size_t row = 0; row < screen->rows; row++) {
+        for (size_t column = 0; column < screen->columns; column++) {
+            size_t index = (row * screen->columns) + column;
+            ColrCell cell = screen->cells[index];
+            if (!screen->redraw && ColrCell_eq(cell, screen->front[index])) continue;
+            if (cell.codepoint == COLR_CELL_WIDE_CONT) {
+                // The left half was unchanged, but the whole character is drawn.
+                column--;
+                index--;
+                cell = screen->cells[index];
+            }
+            if ((cur_row != row) || (cur_col != column)) {
+                bool rewrite = (
+                    attrs_known &&
+                    (cur_row == row) &&
+                    (column > cur_col) &&
+                    ((column - cur_col) <= COLR_SCREEN_GAP_MAX)
+                );
+                for (size_t i = cur_col; rewrite && (i < column); i++) {
+                    ColrCell gapcell = screen->cells[(row * screen->columns) + i];
+                    rewrite = (gapcell.codepoint < 0x80) && ColrCell_attrs_eq(gapcell, current);
+                }
+                if (rewrite) {
+                    for (size_t i = cur_col; i < column; i++) {
+                        char c = (char)screen->cells[(row * screen->columns) + i].codepoint;
+                        if (!ColrCmdBuf_append(&screen->out, c ? &c : " ", 1)) return 0;
+                    }
+                } else if ((cur_row == row) && (column > cur_col)) {
+                    if (!ColrCmdBuf_move_forward(&screen->out, column - cur_col)) return 0;
+                } else if (!ColrCmdBuf_move_pos(&screen->out, row + 1, column + 1)) {
+                    return 0;
+                }
+            }
+            if (!attrs_known) {
+                if (!ColrCmdBuf_append(&screen->out, CODE_RESET_ALL, CODE_RESET_LEN - 1)) return 0;
+                current = ColrCell_empty();
+                attrs_known = true;
+            }
+            if (!ColrScreen_append_attrs(screen, &current, cell)) return 0;
+            char encoded[4] = {' '};
+            size_t encoded_len = cell.codepoint ? colr_utf8_encode(encoded, cell.codepoint) : 0;
+            if (!ColrCmdBuf_append(&screen->out, encoded, encoded_len ? encoded_len : 1)) return 0;
+            size_t width = (colr_codepoint_width(cell.codepoint) == 2) ? 2 : 1;
+            column += width - 1;
+            cur_row = row;
+            cur_col = column + 1;
+            // The cursor waits to wrap at the last column, so it's unknown.
+            if (cur_col >= screen->columns) cur_row = SIZE_MAX;
+        }
+    }
+    if (!ColrCell_attrs_eq(current, ColrCell_empty())) {
+        if (!ColrCmdBuf_append(&screen->out, CODE_RESET_ALL, CODE_RESET_LEN - 1)) return 0;
+    }
+    return screen->out.length;
+}
+
+/*! Resizes a ColrScreen, keeping the cells that still fit.
+
+    \details
+    Everything is written on the next ColrScreen_flush().
+
+    \pi screen  The ColrScreen to resize.
+    \pi rows    Number of rows, or `0` to use the terminal's size from colr_term_size().
+    \pi columns Number of columns, or `0` to use the terminal's size from colr_term_size().
+    \return     `true` on success, or `false` if allocation failed.
+*/
+bool ColrScreen_resize(ColrScreen* screen, size_t rows, size_t columns) {
+    if (!screen) return false;
+    if (!(rows && columns)) {
+        TermSize ts = colr_term_size();
+        if (!rows) rows = ts.rows;
+        if (!columns) columns = ts.columns;
+    }
+    ColrCell* cells = malloc(sizeof(ColrCell) * rows * columns);
+    ColrCell* front = malloc(sizeof(ColrCell) * rows * columns);
+    if (!(cells && front)) {
+        free(cells);
+        free(front);
+        return false;
+    }
+    ColrCell empty = ColrCell_empty();
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t column = 0; column < columns; column++) {
+            size_t index = (row * columns) + column;
+            front[index] = empty;
+            cells[index] = empty;
+            if ((row < screen->rows) && (column < screen->columns)) {
+                cells[index] = screen->cells[(row * screen->columns) + column];
+            }
+        }
+        // A wide character may have lost it's right half.
+        if (columns && (colr_codepoint_width(cells[(row * columns) + columns - 1].codepoint) == 2)) {
+            cells[(row * columns) + columns - 1] = empty;
+        }
+    }
+    free(screen->cells);
+    free(screen->front);
+    screen->cells = cells;
+    screen->front = front;
+    screen->rows = rows;
+    screen->columns = columns;
+    screen->redraw = true;
+    return true;
+}
+
+/*! Sets a single cell in the back buffer of a ColrScreen.
+
+    \details
+    Wide characters use two cells, the second one is set to
+    COLR_CELL_WIDE_CONT. Any wide character that is partly overwritten is
+    replaced with a blank.
+
+    \pi screen The ColrScreen to modify.
+    \pi row    The row to set, starting at `0`.
+    \pi column The column to set, starting at `0`.
+    \pi cell   The ColrCell to use.
+    \return    \parblock
+                   `true` if the cell was set, or `false` if it was out of
+                   bounds, or the character was a control character, a
+                   zero-width character, or a wide character in the last
+                   column.
+               \endparblock
+*/
+bool ColrScreen_set(ColrScreen* screen, size_t row, size_t column, ColrCell cell) {
+    if (!(screen && screen->cells)) return false;
+    if ((row >= screen->rows) || (column >= screen->columns)) return false;
+    if (cell.codepoint == COLR_CELL_WIDE_CONT) return false;
+    if (cell.codepoint && ((cell.codepoint < 0x20) || (cell.codepoint == 0x7F))) return false;
+    int width = colr_codepoint_width(cell.codepoint);
+    if (width == 0) return false;
+    if ((width == 2) && ((column + 1) >= screen->columns)) return false;
+    ColrCell* cells = screen->cells;
+    size_t index = (row * screen->columns) + column;
+    size_t last = column + width - 1;
+    // Don't leave half of a wide character behind.
+    if (cells[index].codepoint == COLR_CELL_WIDE_CONT) cells[index - 1] = ColrCell_empty();
+    if (
+        ((last + 1) < screen->columns) &&
+        (cells[index + width].codepoint == COLR_CELL_WIDE_CONT)
+    ) {
+        cells[index + width] = ColrCell_empty();
+    }
+    cells[index] = cell;
+    if (width == 2) {
+        cell.codepoint = COLR_CELL_WIDE_CONT;
+        cells[index + 1] = cell;
+    }
+    return true;
+}
+
+/*! Writes a ColorText into the back buffer of a ColrScreen, using it's colors
+    and style for every cell.
+
+    \details
+    This is the same as ColrScreen_write_str(), with the ColorText's colors.
+    Justification is not used.
+
+    \pi screen The ColrScreen to modify.
+    \pi row    The row to start at, starting at `0`.
+    \pi column The column to start at, starting at `0`.
+    \pi ctext  \parblock
+                   The ColorText to write.
+                   \colrwillfree
+               \endparblock
+    \return    The number of characters that were set.
+
+    \sa ColrScreen_write_str
+*/
+size_t ColrScreen_write(ColrScreen* screen, size_t row, size_t column, ColorText* ctext) {
+    if (!ctext) return 0;
+    ColrCell attrs = ColrCell_empty();
+    if (ctext->fore) attrs.fore = ctext->fore->value;
+    if (ctext->back) attrs.back = ctext->back->value;
+    if (ctext->style) attrs.style = ctext->style->value;
+    size_t count = ColrScreen_write_str(screen, row, column, ctext->text, attrs);
+    ColorText_free(ctext);
+    return count;
+}
+
+/*! Writes a UTF-8 \string into the back buffer of a ColrScreen.
+
+    \details
+    A newline moves to the next row, at the starting column. Characters that
+    don't fit on the row are dropped. Escape codes in the string are skipped,
+    use \p attrs to set the colors and style.
+
+    \pi screen The ColrScreen to modify.
+    \pi row    The row to start at, starting at `0`.
+    \pi column The column to start at, starting at `0`.
+    \pi s      The string to write.
+    \pi attrs  A ColrCell with the colors/style to use. The `codepoint` is ignored.
+    \return    The number of characters that were set.
+
+    \sa ColrScreen_set
+*/
+size_t ColrScreen_write_str(ColrScreen* screen, size_t row, size_t column, const char* s, ColrCell attrs) {
+    if (!(screen && s)) return 0;
+    size_t count = 0;
+    size_t current = column;
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_TEXT) continue;
+        size_t i = 0;
+        while (i < token.length) {
+            uint32_t codepoint = 0;
+            size_t char_len = colr_utf8_decode(token.start + i, &codepoint);
+            if (!colr_is_valid_mblen(char_len) || ((i + char_len) > token.length)) {
+                // Skip bad bytes.
+                i++;
+                continue;
+            }
+            i += char_len;
+            if (codepoint == '\n') {
+                row++;
+                current = column;
+                continue;
+            }
+            int width = colr_codepoint_width(codepoint);
+            attrs.codepoint = codepoint;
+            if (ColrScreen_set(screen, row, current, attrs)) {
+                count++;
+                current += width;
+            }
+        }
+    }
+    return count;
+}
+
+/*! Draws a ColrSpinner, advancing it one frame, if it's time to redraw.
+
+    \details
+    The first draw writes the frame and message at the start of the line.
+    After that, only the frame is rewritten.
+
+    \details
+    If another thread is already drawing, this returns right away.
+
+    \pi spinner The ColrSpinner to draw.
+    \pi fd      The file descriptor to write to, like `STDOUT_FILENO`.
+    \return     The number of bytes written, which is `0` when nothing was drawn.
+*/
+size_t ColrSpinner_draw(ColrSpinner* spinner, int fd) {
+    if (!spinner) return 0;
+    if (atomic_flag_test_and_set_explicit(&spinner->drawing, memory_order_acquire)) {
+        return 0;
+    }
+    size_t written = 0;
+    size_t frame_count = spinner->frames ? strlen(spinner->frames) : 0;
+    uint64_t now = colr_monotonic_ns();
+    if (frame_count && (!spinner->started || ((now - spinner->last_ns) >= spinner->interval_ns))) {
+        ColrCmdBuf* out = &spinner->out;
+        ColrCmdBuf_clear(out);
+        if (spinner->started) spinner->frame++;
+        spinner->frame %= frame_count;
+        char* frame = spinner->frames + spinner->frame;
+        bool ok;
+        if (spinner->started) {
+            ok = ColrCmdBuf_move_column(out, 1) && ColrCmdBuf_append(out, frame, 1);
+        } else {
+            ok = ColrCmdBuf_move_return(out) && ColrCmdBuf_append(out, frame, 1);
+            if (ok && spinner->msg) {
+                ok = ColrCmdBuf_append(out, " ", 1) && ColrCmdBuf_append_str(out, spinner->msg);
+            }
+        }
+        if (ok) {
+            size_t length = out->length;
+            written = ColrCmdBuf_flush(out, fd);
+            // Short writes redraw the message next time.
+            spinner->started = (written == length);
+            ColrCmdBuf_clear(out);
+            spinner->last_ns = now;
+        }
+    }
+    atomic_flag_clear_explicit(&spinner->drawing, memory_order_release);
+    return written;
+}
+
+/*! Erases the line that a ColrSpinner was drawn on, and resets it so it can
+    be drawn again.
+
+    \pi spinner The ColrSpinner to finish.
+    \pi fd      The file descriptor to write to, like `STDOUT_FILENO`.
+    \return     The number of bytes written.
+*/
+size_t ColrSpinner_finish(ColrSpinner* spinner, int fd) {
+    if (!spinner) return 0;
+    spinner->started = false;
+    spinner->frame = 0;
+    ColrCmdBuf_clear(&spinner->out);
+    if (!(ColrCmdBuf_erase_line(&spinner->out, ALL) && ColrCmdBuf_move_return(&spinner->out))) {
+        return 0;
+    }
+    return ColrCmdBuf_flush(&spinner->out, fd);
+}
+
+/*! Frees a ColrSpinner.
+
+    \pi spinner The ColrSpinner to free.
+*/
+void ColrSpinner_free(ColrSpinner* spinner) {
+    if (!spinner) return;
+    ColrCmdBuf_free(&spinner->out);
+    free(spinner);
+}
+
+/*! Creates a ColrSpinner, using COLR_SPINNER_FRAMES.
+
+    \pi msg  Message to draw after the spinner, or `NULL`. This is not copied.
+    \pi rate Maximum number of redraws per second. If `0` is used, COLR_REDRAW_RATE is used.
+    \return  \parblock
+                 An allocated ColrSpinner.
+                 \mustfree ColrSpinner_free()
+                 \maybenullalloc
+             \endparblock
+*/
+ColrSpinner* ColrSpinner_new(char* msg, unsigned int rate) {
+    ColrSpinner* spinner = malloc(sizeof(ColrSpinner));
+    if (!spinner) return NULL;
+    spinner->frames = COLR_SPINNER_FRAMES;
+    spinner->frame = 0;
+    spinner->msg = msg;
+    spinner->interval_ns = 1000000000ULL / (rate ? rate : COLR_REDRAW_RATE);
+    spinner->last_ns = 0;
+    spinner->started = false;
+    atomic_flag_clear(&spinner->drawing);
+    spinner->out = ColrCmdBuf_new();
+    return spinner;
+}
+
+/*! Returns the time from a monotonic clock, in nanoseconds.
+
+    \details
+    This is only useful for measuring time between two calls, like the
+    redraw interval for ColrProgress and ColrSpinner.
+
+    \return The current monotonic time, in nanoseconds.
+*/
+uint64_t colr_monotonic_ns(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
 }
@@ -20,11 +20,23 @@
 #define COLR_CONTROLS_H
 
 #include "colr.h"
+#include <errno.h> // For EINTR, when writing ColrScreen output.
+#include <time.h> // For the monotonic clock used by ColrProgress/ColrSpinner.
 
 //! Escape sequence to use when creating escape codes.
 #define COLR_ESC "\x1b["
 //! Length of COLR_ESC, with `NULL`-terminator.
 #define COLR_ESC_LEN 3
+//! Initial allocation size for a ColrCmdBuf.
+#define COLR_CMDBUF_SIZE 256
+//! ColrCell.codepoint for the right half of a wide (2 column) character.
+#define COLR_CELL_WIDE_CONT ((uint32_t)-1)
+//! Largest gap that ColrScreen_flush() will re-write, instead of moving the cursor.
+#define COLR_SCREEN_GAP_MAX 3
+//! Default number of redraws per second for ColrProgress/ColrSpinner.
+#define COLR_REDRAW_RATE 15
+//! Default frames for a ColrSpinner.
+#define COLR_SPINNER_FRAMES "|/-\\"
 
 /*! Like colr_fprint(stdout, ...) except it flushes stdout after it prints.
 
@@ -101,6 +113,127 @@ typedef enum EraseMethod {
     ALL
 } EraseMethod;
 
+/*! A growing buffer of cursor controls and text, written with one `write()`.
+
+    \details
+    Create it with ColrCmdBuf_new(), append to it with the ColrCmdBuf_*
+    functions, send it with ColrCmdBuf_flush(), and free it with
+    ColrCmdBuf_free(). Nothing is allocated for each command.
+*/
+typedef struct ColrCmdBuf {
+    //! The commands, always null-terminated when allocated.
+    char* buf;
+    //! Length of the commands, in bytes.
+    size_t length;
+    //! Allocated size of `buf`.
+    size_t cap;
+} ColrCmdBuf;
+
+//! A single character cell for a ColrScreen.
+typedef struct ColrCell {
+    //! The character's code point, `0` for a blank cell, or COLR_CELL_WIDE_CONT.
+    uint32_t codepoint;
+    //! Fore color for the cell, or an empty ColorValue.
+    ColorValue fore;
+    //! Back color for the cell, or an empty ColorValue.
+    ColorValue back;
+    //! Style for the cell, or an empty ColorValue.
+    ColorValue style;
+} ColrCell;
+
+/*! A double-buffered screen of ColrCells.
+
+    \details
+    Cells are drawn into the back buffer with ColrScreen_set() and
+    ColrScreen_write(). ColrScreen_flush() compares them with the last frame
+    that was flushed, and only writes the cells that changed.
+
+    \details
+    Rows and columns start at `0`.
+*/
+typedef struct ColrScreen {
+    //! Number of rows.
+    size_t rows;
+    //! Number of columns.
+    size_t columns;
+    //! The frame being drawn, `rows * columns` cells.
+    ColrCell* cells;
+    //! The last frame that was flushed.
+    ColrCell* front;
+    //! Whether every cell must be written on the next flush.
+    bool redraw;
+    //! Output for the next flush, built by ColrScreen_render().
+    ColrCmdBuf out;
+} ColrScreen;
+
+/*! A progress bar, drawn on the current line, like `[=====     ]  50%`.
+
+    \details
+    Worker threads can call ColrProgress_add() at any time, it's a lock-free
+    atomic update. ColrProgress_draw() redraws at most `rate` times per second,
+    and only writes the cells and percentage that changed since the last
+    redraw.
+
+    \details
+    `fill` and `empty` are drawn for each cell of the bar. They must each be
+    one column wide when printed, but they can be multi-byte, or colorized
+    (like `"\x1b[32m=\x1b[0m"`). They are not free'd.
+*/
+typedef struct ColrProgress {
+    //! Amount of work done, updated atomically.
+    atomic_size_t current;
+    //! Total amount of work to do.
+    size_t total;
+    //! Width of the bar, in cells, not including the brackets and percentage.
+    size_t width;
+    //! String to draw for each filled cell.
+    char* fill;
+    //! String to draw for each empty cell.
+    char* empty;
+    //! Minimum nanoseconds between redraws.
+    uint64_t interval_ns;
+    //! Time of the last redraw, from colr_monotonic_ns().
+    uint64_t last_ns;
+    //! Number of filled cells on the terminal.
+    size_t drawn;
+    //! Percentage on the terminal.
+    unsigned int percent;
+    //! Whether the entire bar has been drawn once.
+    bool started;
+    //! Held by the thread that is redrawing.
+    atomic_flag drawing;
+    //! Output for each redraw.
+    ColrCmdBuf out;
+} ColrProgress;
+
+/*! A spinner, drawn at the start of the current line, followed by a message.
+
+    \details
+    ColrSpinner_draw() advances the spinner at most `rate` times per second,
+    and only rewrites the spinner's frame after the first draw. It can be
+    called from any thread.
+*/
+typedef struct ColrSpinner {
+    //! Frames to draw, one byte per frame. This is not free'd.
+    char* frames;
+    //! Index of the current frame.
+    size_t frame;
+    //! Message to draw after the spinner, or `NULL`. This is not free'd.
+    char* msg;
+    //! Minimum nanoseconds between redraws.
+    uint64_t interval_ns;
+    //! Time of the last redraw, from colr_monotonic_ns().
+    uint64_t last_ns;
+    //! Whether the message has been drawn.
+    bool started;
+    //! Held by the thread that is redrawing.
+    atomic_flag drawing;
+    //! Output for each redraw.
+    ColrCmdBuf out;
+} ColrSpinner;
+
+uint64_t colr_monotonic_ns(void);
+
 ColorResult* Colr_cursor_hide(void);
 ColorResult* Colr_cursor_show(void);
 ColorResult* Colr_erase_display(EraseMethod method);
@@ -119,4 +252,62 @@ ColorResult* Colr_pos_save(void);
 ColorResult* Colr_scroll_down(unsigned int lines);
 ColorResult* Colr_scroll_up(unsigned int lines);
 
+bool ColrCell_attrs_eq(ColrCell a, ColrCell b);
+ColrCell ColrCell_empty(void);
+bool ColrCell_eq(ColrCell a, ColrCell b);
+
+bool ColrCmdBuf_append(ColrCmdBuf* cmdbuf, const char* s, size_t length);
+bool ColrCmdBuf_append_code(ColrCmdBuf* cmdbuf, unsigned int n, char final);
+bool ColrCmdBuf_append_str(ColrCmdBuf* cmdbuf, const char* s);
+bool ColrCmdBuf_append_uint(ColrCmdBuf* cmdbuf, unsigned int n);
+void ColrCmdBuf_clear(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_cursor_hide(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_cursor_show(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_erase_display(ColrCmdBuf* cmdbuf, EraseMethod method);
+bool ColrCmdBuf_erase_line(ColrCmdBuf* cmdbuf, EraseMethod method);
+size_t ColrCmdBuf_flush(ColrCmdBuf* cmdbuf, int fd);
+void ColrCmdBuf_free(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_move_back(ColrCmdBuf* cmdbuf, unsigned int columns);
+bool ColrCmdBuf_move_column(ColrCmdBuf* cmdbuf, unsigned int column);
+bool ColrCmdBuf_move_down(ColrCmdBuf* cmdbuf, unsigned int lines);
+bool ColrCmdBuf_move_forward(ColrCmdBuf* cmdbuf, unsigned int columns);
+bool ColrCmdBuf_move_next(ColrCmdBuf* cmdbuf, unsigned int lines);
+bool ColrCmdBuf_move_pos(ColrCmdBuf* cmdbuf, unsigned int line, unsigned int column);
+bool ColrCmdBuf_move_prev(ColrCmdBuf* cmdbuf, unsigned int lines);
+bool ColrCmdBuf_move_return(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_move_up(ColrCmdBuf* cmdbuf, unsigned int lines);
+ColrCmdBuf ColrCmdBuf_new(void);
+bool ColrCmdBuf_pos_restore(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_pos_save(ColrCmdBuf* cmdbuf);
+bool ColrCmdBuf_scroll_down(ColrCmdBuf* cmdbuf, unsigned int lines);
+bool ColrCmdBuf_scroll_up(ColrCmdBuf* cmdbuf, unsigned int lines);
+ColorResult* ColrCmdBuf_to_ColorResult(ColrCmdBuf* cmdbuf);
+
+void ColrProgress_add(ColrProgress* progress, size_t amount);
+size_t ColrProgress_draw(ColrProgress* progress, int fd, bool force);
+size_t ColrProgress_filled(ColrProgress* progress, size_t current);
+size_t ColrProgress_finish(ColrProgress* progress, int fd);
+void ColrProgress_free(ColrProgress* progress);
+ColrProgress* ColrProgress_new(size_t total, size_t width, unsigned int rate);
+unsigned int ColrProgress_percent(ColrProgress* progress, size_t current);
+bool ColrProgress_render(ColrProgress* progress);
+void ColrProgress_set(ColrProgress* progress, size_t current);
+size_t ColrProgress_update(ColrProgress* progress, size_t amount, int fd);
+
+bool ColrScreen_append_attrs(ColrScreen* screen, ColrCell* current, ColrCell cell);
+void ColrScreen_clear(ColrScreen* screen);
+size_t ColrScreen_flush(ColrScreen* screen, int fd);
+void ColrScreen_free(ColrScreen* screen);
+ColrScreen* ColrScreen_new(size_t rows, size_t columns);
+size_t ColrScreen_render(ColrScreen* screen);
+bool ColrScreen_resize(ColrScreen* screen, size_t rows, size_t columns);
+bool ColrScreen_set(ColrScreen* screen, size_t row, size_t column, ColrCell cell);
+size_t ColrScreen_write(ColrScreen* screen, size_t row, size_t column, ColorText* ctext);
+size_t ColrScreen_write_str(ColrScreen* screen, size_t row, size_t column, const char* s, ColrCell attrs);
+
+size_t ColrSpinner_draw(ColrSpinner* spinner, int fd);
+size_t ColrSpinner_finish(ColrSpinner* spinner, int fd);
+void ColrSpinner_free(ColrSpinner* spinner);
+ColrSpinner* ColrSpinner_new(char* msg, unsigned int rate);
+
 #endif // COLR_CONTROLS_H
@@ -145,13 +145,17 @@
     This is for the `sin()` function used in `rainbow_step()`.
 */
 #include <math.h>
+#include <langinfo.h> // nl_langinfo, for UTF-8 locale detection.
 #include <limits.h> // Used for asprintf return checking.
 #include <locale.h> // Not used in colr.c, but necessary for users of rainbow stuff.
 #ifdef COLR_GNU
     #include <printf.h> // For register_printf_specifier.
 #endif
+#include <pthread.h> // For the compiled-regex cache lock.
 #include <regex.h> // For colr_str_replace_re and friends.
+#include <signal.h> // For the SIGWINCH handler in colr_term_size_watch().
 #include <stdarg.h> // Variadic functions and `va_list`.
+#include <stdatomic.h> // For the UTF-8 locale and terminal-size caches.
 #include <stdbool.h>
 #include <stdint.h> // marker integers for colr structs
 #include <stdio.h> // snprintf, fileno, etc.
@@ -327,6 +331,27 @@
 //! Seed value for colr_str_hash().
 #define COLR_HASH_SEED 5381
 
+/*! Default number of compiled regex patterns kept by colr_re_cache_acquire().
+    This can be defined before including colr.h, or changed at runtime with
+    colr_re_cache_set_capacity().
+*/
+#ifndef COLR_RE_CACHE_SIZE
+    #define COLR_RE_CACHE_SIZE 32
+#endif
+
+//! Number of formatted escape-codes cached by a ColrRainbow.
+#define COLR_RAINBOW_CACHE_SIZE 256
+/*! Largest jump between offsets that a ColrRainbow rotates it's state for,
+    instead of calling `sin()`/`cos()` again.
+*/
+#define COLR_RAINBOW_MAX_DELTA 16
+//! Number of rotations before a ColrRainbow calls `sin()`/`cos()` again.
+#define COLR_RAINBOW_RESEED 64
+//! Marks a ColrTermSizeCache.size as filled in, so a `0x0` size can be cached.
+#define COLR_TERM_SIZE_VALID ((uint_fast64_t)1 << 32)
+//! Maximum number of color stops in a ColrGradient.
+#define COLR_GRADIENT_MAX_STOPS 16
+
 /*! Format character string suitable for use in the printf-family of functions.
     This can be defined to any single-char string before including colr.h if
     you don't want to use the default value.
@@ -1096,6 +1121,89 @@ extern int colr_printf_esc_mod;
 */
 #define ColrColorResult(cres, ...) ColorResult_Colr(cres, __VA_ARGS__, _ColrLastArg)
 
+/*! \def ColrHighlighter_add
+    Add a highlighting rule to a ColrHighlighter, using a ColorArg, ColorText,
+    or escape-code \string as the style.
+
+    \details
+    This calls the appropriate ColrHighlighter_add_\<type\> function for
+    \p hlstyle. ColorArgs and ColorTexts are `free()`'d when they are added.
+
+    \pi highlighter The ColrHighlighter to add to.
+    \pi pattern     The regex pattern to highlight.
+    \pi re_flags    Flags for `regcomp()`. `REG_EXTENDED` is always used.
+    \pi priority    \parblock
+                        Priority for overlapping matches. Higher priorities win,
+                        and rules with the same priority win in the order
+                        they were added.
+                    \endparblock
+    \pi hlstyle     A ColorArg, ColorText, or escape-code \string to style
+                    matches with.
+                    \colrwillfree
+    \return         `true` if the rule was added, otherwise `false`.
+
+    \examplecodefor{ColrHighlighter_add,.c}
+    ColrHighlighter* highlighter = ColrHighlighter_new();
+    ColrHighlighter_add(highlighter, "ERROR|FATAL", 0, 1, fore(RED));
+    ColrHighlighter_add(highlighter, "[0-9]+", 0, 0, Colr("", fore(BLUE), style(BRIGHT)));
+    char* result = ColrHighlighter_highlight(highlighter, "ERROR 42: FATAL 7");
+    if (result) {
+        puts(result);
+        free(result);
+    }
+    ColrHighlighter_free(highlighter);
+    \endexamplecode
+
+    \sa ColrHighlighter
+*/
+#define ColrHighlighter_add(highlighter, pattern, re_flags, priority, hlstyle) \
+    _Generic( \
+        (hlstyle), \
+        char*: ColrHighlighter_add_str, \
+        ColorArg*: ColrHighlighter_add_ColorArg, \
+        ColorText*: ColrHighlighter_add_ColorText \
+    )(highlighter, pattern, re_flags, priority, hlstyle)
+
+/*! \def ColrReplacer_add
+    Add a target/replacement pair to a ColrReplacer, using a \string,
+    ColorArg, ColorResult, or ColorText as the replacement.
+
+    \details
+    This calls the appropriate ColrReplacer_add_\<type\> function for \p repl.
+    ColorArgs, ColorResults, and ColorTexts are converted to strings and
+    `free()`'d when they are added.
+
+    \pi replacer The ColrReplacer to add to.
+    \pi target   The literal string to replace. Must not be `NULL`/empty.
+    \pi repl     A \string, ColorArg, ColorResult, or ColorText to replace with.
+                 \colrwillfree
+    \return      `true` if the pair was added, otherwise `false`.
+
+    \examplecodefor{ColrReplacer_add,.c}
+    ColrReplacer* replacer = ColrReplacer_new();
+    ColrReplacer_add(replacer, "error", Colr("error", fore(RED)));
+    ColrReplacer_add(replacer, "warning", fore(YELLOW));
+    ColrReplacer_add(replacer, "info", "INFO");
+    char* result = ColrReplacer_replace(replacer, "info: warning, error!");
+    if (result) {
+        puts(result);
+        free(result);
+    }
+    ColrReplacer_free(replacer);
+    \endexamplecode
+
+    \sa ColrReplacer
+    \sa colr_replace_all
+*/
+#define ColrReplacer_add(replacer, target, repl) \
+    _Generic( \
+        (repl), \
+        char*: ColrReplacer_add_str, \
+        ColorArg*: ColrReplacer_add_ColorArg, \
+        ColorResult*: ColrReplacer_add_ColorResult, \
+        ColorText*: ColrReplacer_add_ColorText \
+    )(replacer, target, repl)
+
 /*! \def colr
     Create an allocated string directly from Colr() arguments.
 
@@ -1984,6 +2092,67 @@ extern int colr_printf_esc_mod;
         ColorText*: colr_str_replace_re_all_ColorText \
     )(s, target, repl, flags)
 
+/*! \def colr_re_groups
+    Colorize each capture group for every match of a regex pattern \string
+    in \p s, with it's own ColorArg, ColorText, or escape-code string.
+
+    \details
+    All groups are colorized in a single pass over \p s, and the result is
+    built with one allocation. CODE_RESET_ALL is inserted after every
+    colorized group.
+
+    \details
+    The first color is used for group `1`, the second for group `2`, and so on.
+    Using `NULL` for a color leaves that group alone. When groups are nested,
+    the outer group is colorized.
+
+    \pi s        \parblock
+                     The string to operate on.
+                     \mustnull
+                 \endparblock
+    \pi pattern  A regex pattern \string, with one or more capture groups.
+    \pi re_flags \parblock
+                     Flags for `regcomp()`. `REG_EXTENDED` is always used, whether
+                     flags are provided or not.
+                 \endparblock
+    \pi ...      \parblock
+                     One or more ColorArg pointers, ColorText pointers, or
+                     escape-code strings, one for each group.
+                     \colrwillfree
+                 \endparblock
+
+    \return      \parblock
+                     An allocated string with the result, or `NULL` if \p s
+                     or \p pattern is `NULL`, or the pattern doesn't compile.
+                     \mustfree
+                     \maybenullalloc
+                 \endparblock
+
+    \sa colr_replace_re_all
+    \sa colr_str_re_groups
+
+    \examplecodefor{colr_re_groups,.c}
+    #include "colr.h"
+    int main(void) {
+        char* mystring = "name=colr, version=0.4.0";
+        char* colorized = colr_re_groups(
+            mystring,
+            "([a-z]+)=([^,]+)",
+            0,
+            fore(BLUE),
+            Colr("", fore(GREEN), style(BRIGHT))
+        );
+        if (!colorized) return EXIT_FAILURE;
+        puts(colorized);
+        free(colorized);
+    }
+    \endexamplecode
+
+    \example colr_re_groups_example.c
+*/
+#define colr_re_groups(s, pattern, re_flags, ...) \
+    _colr_re_groups(s, pattern, re_flags, __VA_ARGS__, _ColrLastArg)
+
 /*! \def colr_repr
     Transforms several ColrC objects into their string representations.
 
@@ -2524,6 +2693,30 @@ extern int colr_printf_esc_mod;
 */
 #define while_colr_va_arg(ap, vartype, x) while (x = va_arg(ap, vartype), !_colr_is_last_arg(x))
 
+#ifdef COLR_DISABLE
+/*! \def COLR_DISABLE
+    When defined (before including colr.h, and while compiling colr.c), the
+    color macros stop building ColorArgs, and colors are disabled at runtime
+    by default (colr_is_disabled()).
+
+    \details
+    fore(), back(), and style() return a pointer to the shared, empty,
+    colr_disabled_arg, so no ColorArgs are allocated or formatted, and they
+    can still be stored in a `ColorArg*` and passed to ColorArg_free().
+    Colr(), Colr_fmt(), and the other macros are unchanged, so they keep
+    their types, and free any ColorArgs they are given. Their results have
+    no colors while colr_is_disabled() is `true`.
+
+    \sa colr_set_disabled
+*/
+    #undef back
+    #define back(x) ((void)sizeof(x), &colr_disabled_arg)
+    #undef fore
+    #define fore(x) ((void)sizeof(x), &colr_disabled_arg)
+    #undef style
+    #define style(x) ((void)sizeof(x), &colr_disabled_arg)
+#endif // COLR_DISABLE
+
 
 /*! Basic color values, with a few convenience values for extended colors.
     \internal
@@ -2812,6 +3005,33 @@ typedef struct ColorNameData {
     RGB rgb;
 } ColorNameData;
 
+//! Actions for SGR parameters, used in the colr_sgr_info table.
+typedef enum ColrSgrAction {
+    SGR_UNKNOWN = 0,
+    SGR_FORE_BASIC = 1,
+    SGR_BACK_BASIC = 2,
+    SGR_STYLE = 3,
+    //! An extended or RGB fore color follows (`38;5;N` or `38;2;R;G;B`).
+    SGR_FORE_EXT = 4,
+    //! An extended or RGB back color follows (`48;5;N` or `48;2;R;G;B`).
+    SGR_BACK_EXT = 5,
+    //! An underline color follows. It is parsed, but not used.
+    SGR_UNDERLINE_EXT = 6,
+} ColrSgrAction;
+
+/*! Holds the action and value for an SGR parameter.
+
+    \details
+    This is used for the `colr_sgr_info` array in colr.c, where the index is
+    the SGR parameter.
+*/
+typedef struct ColrSgrInfo {
+    //! What to do with the parameter.
+    ColrSgrAction action;
+    //! The BasicValue or StyleValue for the parameter, if any.
+    int value;
+} ColrSgrInfo;
+
 //! Holds an ArgType, and a ColorValue.
 typedef struct ColorArg {
     //! A marker used to inspect void pointers and determine if they are ColorArgs.
@@ -2857,6 +3077,309 @@ typedef struct TermSize {
     unsigned short columns;
 } TermSize;
 
+/*! Cached terminal size, used by colr_term_size().
+
+    \details
+    The rows/columns are packed into one atomic value, so they can be read
+    and replaced from any thread without a lock. The `SIGWINCH` handler from
+    colr_term_size_watch() only sets the `stale` flag, which is safe to do
+    from a signal handler.
+*/
+typedef struct ColrTermSizeCache {
+    //! File descriptor to query with `ioctl()`, from colr_term_size_set_fd().
+    atomic_int fd;
+    //! COLR_TERM_SIZE_VALID, with rows and columns in the low 32 bits.
+    atomic_uint_fast64_t size;
+    //! Set when the size must be queried again.
+    atomic_bool stale;
+    //! Whether the `SIGWINCH` handler is installed.
+    bool watching;
+    //! The `SIGWINCH` action that was replaced by colr_term_size_watch().
+    struct sigaction old_action;
+} ColrTermSizeCache;
+
+//! Color depths that a terminal can display, detected by ColrTermCaps_probe().
+typedef enum ColrColorDepth {
+    //! No colors at all (`TERM=dumb`).
+    DEPTH_NONE = 0,
+    //! Basic colors, like BasicValue.
+    DEPTH_BASIC = 1,
+    //! 256-color support (`TERM=*-256color`), like ExtendedValue.
+    DEPTH_EXTENDED = 2,
+    //! 24-bit color support (`COLORTERM=truecolor`), like RGB.
+    DEPTH_RGB = 3,
+} ColrColorDepth;
+
+/*! Terminal capabilities, detected once by colr_term_caps().
+
+    \details
+    This is filled in once, and never modified afterwards, so it can be read
+    from any thread without a lock.
+*/
+typedef struct ColrTermCaps {
+    //! The detected color depth.
+    ColrColorDepth depth;
+    //! Whether the probed file descriptor is a terminal.
+    bool is_tty;
+    //! Whether colors were disabled with `NO_COLOR`, or `TERM=dumb`.
+    bool disabled;
+} ColrTermCaps;
+
+//! One-time storage for colr_term_caps().
+typedef struct ColrTermCapsCache {
+    //! Makes sure colr_term_caps_init() only runs once.
+    pthread_once_t once;
+    //! The capabilities, set by colr_term_caps_init().
+    ColrTermCaps caps;
+} ColrTermCapsCache;
+
+//! Span types yielded by ColrTokenIter_next().
+typedef enum ColrTokenType {
+    TOKEN_NONE = -1,
+    TOKEN_TEXT = 0,
+    TOKEN_SGR = 1,
+    TOKEN_CSI = 2,
+    TOKEN_ESC = 3,
+} ColrTokenType;
+
+#ifndef DOXYGEN_SKIP
+// This makes enum values more friendly to _Generic, by explicitly casting
+// from `int` to the enum type.
+#define TOKEN_NONE ((ColrTokenType)TOKEN_NONE)
+#define TOKEN_TEXT ((ColrTokenType)TOKEN_TEXT)
+#define TOKEN_SGR ((ColrTokenType)TOKEN_SGR)
+#define TOKEN_CSI ((ColrTokenType)TOKEN_CSI)
+#define TOKEN_ESC ((ColrTokenType)TOKEN_ESC)
+#endif
+
+/*! A span of text or escape-code, inside of a \string being tokenized.
+
+    \details
+    Tokens point into the original string, nothing is copied or allocated.
+    The span is <em>not</em> null-terminated, use ColrToken.length.
+*/
+typedef struct ColrToken {
+    //! The type of span (text, color code, other escape code).
+    ColrTokenType type;
+    //! Pointer to the start of the span, inside of the original string.
+    const char* start;
+    //! Offset of the span, from the start of the original string.
+    size_t offset;
+    //! Length of the span, in bytes.
+    size_t length;
+} ColrToken;
+
+//! Iterator state for ColrTokenIter_next(). Create it with ColrTokenIter_new().
+typedef struct ColrTokenIter {
+    //! The string being tokenized.
+    const char* s;
+    //! Length of the string, in bytes.
+    size_t length;
+    //! Current offset into the string.
+    size_t pos;
+    //! Offset where the last unterminated OSC sequence stopped scanning.
+    size_t osc_stop;
+} ColrTokenIter;
+
+//! A single target/replacement pair, used by ColrReplacer.
+typedef struct ColrReplacerPattern {
+    //! The literal string to replace.
+    char* target;
+    //! Length of the target string.
+    size_t target_len;
+    //! The replacement string.
+    char* repl;
+    //! Length of the replacement string.
+    size_t repl_len;
+} ColrReplacerPattern;
+
+//! A state in the ColrReplacer automaton.
+typedef struct ColrReplacerNode {
+    //! Index of the first edge leaving this state, or `SIZE_MAX` for none.
+    size_t edge;
+    //! Index of the failure state.
+    size_t fail;
+    //! Length of the prefix that this state represents.
+    size_t depth;
+    //! Index of the longest pattern ending at this state, or `SIZE_MAX` for none.
+    size_t match;
+} ColrReplacerNode;
+
+//! A transition between two ColrReplacer states.
+typedef struct ColrReplacerEdge {
+    //! Index of the state this edge leads to.
+    size_t node;
+    //! Index of the next edge leaving the same state, or `SIZE_MAX` for none.
+    size_t next;
+    //! The byte that triggers this transition.
+    unsigned char c;
+} ColrReplacerEdge;
+
+/*! A compiled set of literal target/replacement pairs.
+
+    \details
+    The targets are compiled into an Aho-Corasick automaton, so any number of
+    targets can be replaced in a single pass over the input, producing a single
+    output string. When targets overlap, the leftmost match wins, and the
+    longest target wins when several matches start at the same position.
+
+    \details
+    Create one with ColrReplacer_new(), add pairs with ColrReplacer_add(),
+    and release it with ColrReplacer_free(). Input can be replaced all at once
+    with ColrReplacer_replace(), or streamed in chunks with
+    ColrReplacer_feed() and ColrReplacer_finish().
+*/
+typedef struct ColrReplacer {
+    //! Target/replacement pairs, in the order they were added.
+    ColrReplacerPattern* patterns;
+    //! Number of patterns.
+    size_t count;
+    //! Allocated length of ColrReplacer.patterns.
+    size_t cap;
+    //! Automaton states, built by ColrReplacer_compile(). The root is `0`.
+    ColrReplacerNode* nodes;
+    //! Number of states.
+    size_t node_count;
+    //! Automaton transitions.
+    ColrReplacerEdge* edges;
+    //! Number of transitions.
+    size_t edge_count;
+    //! Transitions from the root state, indexed by byte.
+    size_t root_next[256];
+    //! Whether the automaton is up to date with ColrReplacer.patterns.
+    bool compiled;
+    //! Undecided input held back between ColrReplacer_feed() calls.
+    char* pending;
+    //! Length of ColrReplacer.pending.
+    size_t pending_len;
+    //! Allocated length of ColrReplacer.pending.
+    size_t pending_cap;
+} ColrReplacer;
+
+//! Type returned from colr_str_hash.
+typedef unsigned long ColrHash;
+//! Format for `ColrHash` in printf-like functions.
+#define COLR_HASH_FMT "%lu"
+
+/*! A compiled regex pattern, held by the regex cache.
+
+    \details
+    ColrRegexCacheEntry.repat must be the first member, so the `regex_t*`
+    returned by colr_re_cache_acquire() can be turned back into an entry.
+*/
+typedef struct ColrRegexCacheEntry {
+    //! The compiled pattern.
+    regex_t repat;
+    //! The pattern string that was compiled.
+    char* pattern;
+    //! Flags used with `regcomp()`.
+    int re_flags;
+    //! Hash of ColrRegexCacheEntry.pattern, for quicker lookups.
+    ColrHash hash;
+    //! Number of callers still using this entry.
+    size_t refs;
+    //! Whether this entry is still in the cache (not evicted).
+    bool cached;
+    //! The next most recently used entry.
+    struct ColrRegexCacheEntry* prev;
+    //! The next least recently used entry.
+    struct ColrRegexCacheEntry* next;
+} ColrRegexCacheEntry;
+
+//! Statistics for the regex cache, from colr_re_cache_stats().
+typedef struct ColrRegexCacheStats {
+    //! Number of lookups that found an already-compiled pattern.
+    size_t hits;
+    //! Number of lookups that had to compile the pattern.
+    size_t misses;
+    //! Number of compiled patterns currently cached.
+    size_t count;
+    //! Maximum number of compiled patterns to cache.
+    size_t capacity;
+} ColrRegexCacheStats;
+
+//! Least-recently-used cache of compiled regex patterns, keyed by (pattern, flags).
+typedef struct ColrRegexCache {
+    //! Lock for all cache members, and the entries' ColrRegexCacheEntry.refs.
+    pthread_mutex_t lock;
+    //! The most recently used entry.
+    ColrRegexCacheEntry* head;
+    //! The least recently used entry, evicted first.
+    ColrRegexCacheEntry* tail;
+    //! Hit/miss counters, count, and capacity.
+    ColrRegexCacheStats stats;
+} ColrRegexCache;
+
+/*! A growable, contiguous, array of regex matches.
+
+    \details
+    Use ColrMatches_from_re() to collect all matches, or ColrMatchIter_next()
+    to find them one at a time without storing them.
+    Release the matches with ColrMatches_free().
+*/
+typedef struct ColrMatches {
+    //! The matches, with offsets from the start of the string that was searched.
+    regmatch_t* matches;
+    //! Number of matches.
+    size_t count;
+    //! Allocated length of ColrMatches.matches.
+    size_t cap;
+} ColrMatches;
+
+//! Iterator state for ColrMatchIter_next(). Create it with ColrMatchIter_new().
+typedef struct ColrMatchIter {
+    //! The string being searched.
+    const char* s;
+    //! Length of the string being searched.
+    size_t length;
+    //! The regex pattern to match.
+    regex_t* repattern;
+    //! Offset to start the next search at.
+    size_t pos;
+    //! Extra flags for `regexec()`, like `REG_NOTEOL` when ColrMatchIter.length is not the real end.
+    int eflags;
+} ColrMatchIter;
+
+//! A single highlighting rule, used by ColrHighlighter.
+typedef struct ColrHighlightRule {
+    //! The compiled pattern.
+    regex_t repat;
+    //! Escape-codes inserted before each match.
+    char* codes;
+    //! Length of ColrHighlightRule.codes.
+    size_t codes_len;
+    //! Priority for overlapping matches. Higher priorities win.
+    int priority;
+} ColrHighlightRule;
+
+//! A match that was chosen for highlighting by ColrHighlighter_highlight().
+typedef struct ColrHighlightSpan {
+    //! The match offsets.
+    regmatch_t match;
+    //! Index of the ColrHighlightRule that matched.
+    size_t rule;
+} ColrHighlightSpan;
+
+/*! A set of prioritized regex highlighting rules.
+
+    \details
+    Each rule styles every match of it's pattern. When matches from different
+    rules overlap, the rule with the higher priority wins, and the other match
+    is left alone. Existing escape-codes are never matched or modified.
+
+    \details
+    Create one with ColrHighlighter_new(), add rules with
+    ColrHighlighter_add(), and release it with ColrHighlighter_free().
+*/
+typedef struct ColrHighlighter {
+    //! Rules, sorted by priority (highest first), then by the order they were added.
+    ColrHighlightRule* rules;
+    //! Number of rules.
+    size_t count;
+    //! Allocated length of ColrHighlighter.rules.
+    size_t cap;
+} ColrHighlighter;
+
 #ifndef DOXYGEN_SKIP
 //! An array of BasicInfo items, used with BasicValue_from_str().
 extern const BasicInfo basic_names[];
@@ -2881,10 +3404,28 @@ extern const ColorNameData colr_name_data[];
 //! Length of colr_name_data.
 extern const size_t colr_name_data_len;
 
-//! Type returned from colr_str_hash.
-typedef unsigned long ColrHash;
-//! Format for `ColrHash` in printf-like functions.
-#define COLR_HASH_FMT "%lu"
+//! The global compiled-regex cache, used by colr_re_cache_acquire().
+extern ColrRegexCache colr_re_cache;
+//! The global terminal-size cache, used by colr_term_size().
+extern ColrTermSizeCache colr_term_size_cache;
+//! The global terminal-capability cache, used by colr_term_caps().
+extern ColrTermCapsCache colr_term_caps_cache;
+//! Whether colors are disabled for the whole process, see colr_set_disabled().
+extern atomic_bool colr_disabled;
+//! The empty ColorArg that fore(), back(), and style() use with COLR_DISABLE.
+extern ColorArg colr_disabled_arg;
+
+//! An array of ColrSgrInfo, indexed by SGR parameter, used with ColorArgs_from_esc_s().
+extern const ColrSgrInfo colr_sgr_info[];
+//! Length of colr_sgr_info.
+extern const size_t colr_sgr_info_len;
+
+//! Stage 1 of the display-width table, indexed by `codepoint >> 8`.
+extern const unsigned char colr_width_stage1[];
+//! Length of colr_width_stage1.
+extern const size_t colr_width_stage1_len;
+//! Stage 2 of the display-width table, with 2-bit widths for 256 code points per block.
+extern const unsigned char colr_width_stage2[][64];
 
 //! A specific ColorArg-like struct that marks the end of variadic argument lists.
 struct _ColrLastArg_s {
@@ -2923,10 +3464,18 @@ char* colr_char_repr(char c);
 bool colr_char_should_escape(const char c);
 
 bool colr_check_marker(uint32_t marker, void* p);
+int colr_codepoint_width(uint32_t codepoint);
 char* colr_empty_str(void);
+char* colr_fmt_uchar(char* out, unsigned char value);
 void colr_free_argsv(va_list args);
 void colr_free_re_matches(regmatch_t** matches);
+size_t colr_fwrite_pad(FILE* fp, char pad, size_t count);
+size_t colr_fwrite_text(FILE* fp, const char* s, size_t length, bool strip_codes);
 bool colr_is_colr_ptr(void* p);
+bool colr_is_disabled(void);
+bool colr_locale_is_utf8(void);
+size_t colr_mb_char_len(const char* s, size_t length);
+int colr_mb_char_width(const char* s, size_t length);
 size_t colr_mb_len(const char* s, size_t length);
 
 #ifdef COLR_GNU
@@ -2934,9 +3483,19 @@ int colr_printf_handler(FILE *fp, const struct printf_info *info, const void *co
 int colr_printf_info(const struct printf_info *info, size_t n, int *argtypes, int *sz);
 // The contructor attribute isn't used because not everyone needs this.
 void colr_printf_register(void); // __attribute__((constructor))
+size_t colr_printf_write(FILE* fp, const struct printf_info* info, void* p);
 #endif
 
+regex_t* colr_re_cache_acquire(const char* pattern, int re_flags);
+void colr_re_cache_clear(void);
+void colr_re_cache_evict(size_t capacity);
+ColrRegexCacheEntry* colr_re_cache_find(const char* pattern, int re_flags, ColrHash hash);
+void colr_re_cache_release(regex_t* repat);
+void colr_re_cache_set_capacity(size_t capacity);
+ColrRegexCacheStats colr_re_cache_stats(void);
 regmatch_t** colr_re_matches(const char* s, regex_t* repattern);
+void colr_set_disabled(bool disabled);
+bool colr_set_disabled_auto(void);
 bool colr_set_locale(void);
 bool colr_supports_rgb(void);
 bool colr_supports_rgb_static(void);
@@ -2950,6 +3509,7 @@ char* colr_str_center(const char* s, int width, const char padchar);
 size_t colr_str_code_count(const char* s);
 size_t colr_str_code_len(const char* s);
 char* colr_str_copy(char* restrict dest, const char* restrict src, size_t length);
+size_t colr_str_display_width(const char* s);
 bool colr_str_ends_with(const char* restrict s, const char* restrict suffix);
 char** colr_str_get_codes(const char* s, bool unique);
 bool colr_str_has_ColorArg(const char* s, ColorArg* carg);
@@ -2965,6 +3525,7 @@ char* colr_str_lstrip_char(const char* s, const char c);
 char* colr_str_lstrip_chars(const char* restrict s, const char* restrict chars);
 size_t colr_str_mb_len(const char* s);
 size_t colr_str_noncode_len(const char* s);
+char* colr_str_re_groups(const char* restrict s, regex_t* repattern, char* const* codes, size_t count);
 
 char* colr_str_replace(const char* restrict s, const char* restrict target, const char* restrict repl);
 char* colr_str_replace_all(const char* restrict s, const char* restrict target, const char* restrict repl);
@@ -2988,6 +3549,7 @@ char* colr_str_replace_re_pat_all(const char* restrict s, regex_t* repattern, co
 char* colr_str_replace_re_pat_all_ColorArg(const char* restrict s, regex_t* repattern, ColorArg* repl);
 char* colr_str_replace_re_pat_all_ColorResult(const char* restrict s, regex_t* repattern, ColorResult* repl);
 char* colr_str_replace_re_pat_all_ColorText(const char* restrict s, regex_t* repattern, ColorText* repl);
+size_t colr_str_replace_re_pat_all_fp(FILE* fp, const char* restrict s, regex_t* repattern, const char* restrict repl);
 char* colr_str_replace_re_pat_ColorArg(const char* restrict s, regex_t* repattern, ColorArg* repl);
 char* colr_str_replace_re_pat_ColorResult(const char* restrict s, regex_t* repattern, ColorResult* repl);
 char* colr_str_replace_re_pat_ColorText(const char* restrict s, regex_t* repattern, ColorText* repl);
@@ -3005,9 +3567,18 @@ char* colr_str_repr(const char* s);
 char* colr_str_rjust(const char* s, int width, const char padchar);
 bool colr_str_starts_with(const char* restrict s, const char* restrict prefix);
 char* colr_str_strip_codes(const char* s);
+char* colr_str_strip_codes_n(const char* s, size_t length);
 char* colr_str_to_lower(const char* s);
 
+ColrTermCaps colr_term_caps(void);
+void colr_term_caps_init(void);
 TermSize colr_term_size(void);
+void colr_term_size_invalidate(void);
+void colr_term_size_set_fd(int fd);
+void colr_term_size_sigwinch(int signum, siginfo_t* info, void* context);
+bool colr_term_size_watch(bool enabled);
+size_t colr_utf8_decode(const char* s, uint32_t* codepoint);
+size_t colr_utf8_encode(char* dest, uint32_t codepoint);
 struct winsize colr_win_size(void);
 struct winsize colr_win_size_env(void);
 void format_bgx(char* out, unsigned char num);
@@ -3034,6 +3605,116 @@ typedef void (*RGB_fmter)(char* out, RGB rgb);
 */
 typedef char* (*rainbow_creator)(const char* s, double freq, size_t offset, size_t spread);
 
+//! A formatted escape-code, cached by a ColrRainbow or precomputed by a ColrGradient.
+typedef struct ColrRainbowCode {
+    //! The RGB value that was formatted.
+    RGB rgb;
+    //! Whether this entry has been filled.
+    bool used;
+    //! Length of the escape-code, not including the `'\0'`.
+    size_t length;
+    //! The escape-code, from the ColrRainbow's RGB_fmter.
+    char code[CODE_RGB_LEN];
+} ColrRainbowCode;
+
+/*! Holds state for generating rainbow colors without calling `sin()` three
+    times for every step, and without formatting every escape-code.
+
+    \details
+    Each step rotates the previous `sin()`/`cos()` values for the red, green,
+    and blue phases. When a rotated value is too close to the point where it
+    would be rounded differently, it is recomputed with `sin()`/`cos()`, so
+    the colors always match rainbow_step().
+
+    \details
+    It can also rainbowize a stream of text in chunks, with ColrRainbow_feed()
+    and ColrRainbow_finish(). The position in the rainbow is kept between
+    chunks, and multibyte characters may be split across them.
+
+    \details
+    Use ColrRainbow_new() to create one, and ColrRainbow_free() to release it.
+*/
+typedef struct ColrRainbow {
+    //! Formatter for the escape-codes.
+    RGB_fmter fmter;
+    //! Frequency ("tightness") of the colors.
+    double freq;
+    //! Starting offset for ColrRainbow_feed().
+    size_t start;
+    //! Number of characters for each color, for ColrRainbow_feed().
+    size_t spread;
+    //! Whether CODE_RESET_BACK is written before newlines (back-color formatters).
+    bool is_back;
+    //! Number of bytes written by ColrRainbow_feed() so far.
+    size_t pos;
+    //! Number of characters left for the current color in ColrRainbow_feed().
+    size_t span_left;
+    //! Bytes from a multibyte character that was split across chunks.
+    char pending[MB_LEN_MAX];
+    //! Number of bytes in `pending`.
+    size_t pending_len;
+    //! Offset for the current state, `0` when there is no state yet.
+    size_t offset;
+    //! Number of rotations since the state was computed with `sin()`/`cos()`.
+    size_t steps;
+    //! Current `sin()` values for the red, green, and blue phases.
+    double sins[3];
+    //! Current `cos()` values for the red, green, and blue phases.
+    double coss[3];
+    //! `sin()` of the rotation angle for each offset delta.
+    double rot_sins[COLR_RAINBOW_MAX_DELTA + 1];
+    //! `cos()` of the rotation angle for each offset delta.
+    double rot_coss[COLR_RAINBOW_MAX_DELTA + 1];
+    //! Whether the rotation for each offset delta has been computed.
+    bool rot_ready[COLR_RAINBOW_MAX_DELTA + 1];
+    //! Formatted escape-codes, indexed by a hash of their RGB value.
+    ColrRainbowCode codes[COLR_RAINBOW_CACHE_SIZE];
+} ColrRainbow;
+
+//! Color spaces that a ColrGradient can blend colors in.
+typedef enum ColrGradientSpace {
+    //! Blend linear (gamma-decoded) sRGB values.
+    GRADIENT_LINEAR_RGB = 0,
+    //! Blend OKLab values, which keeps the lightness of the colors more even.
+    GRADIENT_OKLAB = 1,
+} ColrGradientSpace;
+
+/*! Holds the color stops for a gradient, and a precomputed "ramp" of
+    formatted escape-codes.
+
+    \details
+    The stops are converted to the ColrGradientSpace once, when the gradient
+    is created. ColrGradient_set_length() fills the ramp with one escape-code
+    for every position, so colorizing text is only a lookup and a copy.
+
+    \details
+    Use ColrGradient_new() to create one, and ColrGradient_free() to release it.
+*/
+typedef struct ColrGradient {
+    //! Formatter for the escape-codes.
+    RGB_fmter fmter;
+    //! Color space that the stops are blended in.
+    ColrGradientSpace space;
+    //! Number of stops in `stops`.
+    size_t stop_count;
+    //! Color stops, converted to `space`.
+    double stops[COLR_GRADIENT_MAX_STOPS][3];
+    //! Number of entries in `ramp`.
+    size_t length;
+    //! Formatted escape-codes for every position, from ColrGradient_set_length().
+    ColrRainbowCode* ramp;
+} ColrGradient;
+
+char* _gradient(RGB_fmter fmter, const char* s, ColrGradientSpace space, bool vertical, const RGB* stops, size_t count);
+/*! \internal
+    Gradient-related functions.
+    \endinternal
+*/
+char* gradient_fg(const char* s, const RGB* stops, size_t count, bool vertical);
+char* gradient_fg_term(const char* s, const RGB* stops, size_t count, bool vertical);
+char* gradient_bg(const char* s, const RGB* stops, size_t count, bool vertical);
+char* gradient_bg_term(const char* s, const RGB* stops, size_t count, bool vertical);
+
 char* _rainbow(RGB_fmter fmter, const char* s, double freq, size_t offset, size_t spread);
 /*! \internal
     Rainbow-related functions.
@@ -3061,6 +3742,7 @@ bool _colr_is_last_arg(void* p);
 size_t _colr_ptr_length(void* p);
 char* _colr_ptr_repr(void* p);
 char* _colr_ptr_to_str(void* p);
+char* _colr_re_groups(const char* restrict s, const char* restrict pattern, int re_flags, ...);
 
 /*! \internal
     The multi-type variadiac function behind the colr_join() macro.
@@ -3113,7 +3795,9 @@ ColorArg* ColorArg_to_ptr(ColorArg carg);
 char* ColorArg_to_esc(ColorArg carg);
 bool ColorArg_to_esc_s(char* dest, ColorArg carg);
 
+size_t ColorArgs_from_esc_s(ColorArg* dest, size_t dest_len, const char* s, size_t length);
 ColorArg** ColorArgs_from_str(const char* s, bool unique);
+ColorArg** ColorArgs_from_str_n(const char* s, size_t length, bool unique);
 
 /*! \internal
     ColorJustify functions that deal with colr/string justification.
@@ -3161,6 +3845,7 @@ size_t ColorText_length(ColorText ctext);
 char* ColorText_repr(ColorText ctext);
 ColorText* ColorText_set_just(ColorText* ctext, ColorJustify cjust);
 void ColorText_set_values(ColorText* ctext, char* text, ...);
+char* ColorText_to_esc(ColorText ctext);
 ColorText* ColorText_to_ptr(ColorText ctext);
 char* ColorText_to_str(ColorText ctext);
 
@@ -3197,6 +3882,91 @@ char* ColorValue_repr(ColorValue cval);
 char* ColorValue_to_esc(ArgType type, ColorValue cval);
 bool ColorValue_to_esc_s(char* dest, ArgType type, ColorValue cval);
 
+/*! \internal
+    ColrHighlighter functions, for applying many prioritized regex highlighting rules at once.
+    \endinternal
+*/
+bool ColrHighlighter_add_ColorArg(ColrHighlighter* highlighter, const char* pattern, int re_flags, int priority, ColorArg* hlstyle);
+bool ColrHighlighter_add_ColorText(ColrHighlighter* highlighter, const char* pattern, int re_flags, int priority, ColorText* hlstyle);
+bool ColrHighlighter_add_str(ColrHighlighter* highlighter, const char* pattern, int re_flags, int priority, const char* hlstyle);
+void ColrHighlighter_free(ColrHighlighter* highlighter);
+char* ColrHighlighter_highlight(ColrHighlighter* highlighter, const char* s);
+ColrHighlighter* ColrHighlighter_new(void);
+int ColrHighlightSpan_cmp(const void* a, const void* b);
+
+/*! \internal
+    ColrMatches and ColrMatchIter functions, for collecting/iterating regex matches.
+    \endinternal
+*/
+bool ColrMatches_append(ColrMatches* cmatches, regmatch_t match);
+void ColrMatches_free(ColrMatches* cmatches);
+ColrMatches ColrMatches_from_re(const char* s, regex_t* repattern);
+char* ColrMatches_replace(const ColrMatches* cmatches, const char* restrict s, const char* restrict repl);
+ColrMatchIter ColrMatchIter_new(const char* s, regex_t* repattern);
+bool ColrMatchIter_next(ColrMatchIter* iter, regmatch_t* match);
+bool ColrMatchIter_next_groups(ColrMatchIter* iter, regmatch_t* groups, size_t nmatch);
+
+/*! \internal
+    ColrTermCaps functions, for detecting terminal capabilities.
+    \endinternal
+*/
+ColrTermCaps ColrTermCaps_probe(int fd);
+
+/*! \internal
+    ColrToken and ColrTokenIter functions, for tokenizing escape-code strings.
+    \endinternal
+*/
+bool ColrToken_is_code(ColrToken token);
+ColrTokenType ColrToken_scan_esc(const char* s, size_t* length);
+ColrTokenType ColrToken_scan_esc_n(const char* s, size_t length, size_t* esc_len);
+ColrTokenIter ColrTokenIter_new(const char* s);
+ColrTokenIter ColrTokenIter_new_n(const char* s, size_t length);
+bool ColrTokenIter_next(ColrTokenIter* iter, ColrToken* token);
+ColrTokenType ColrTokenIter_scan_esc(ColrTokenIter* iter, const char* p, size_t* esc_len);
+
+/*! \internal
+    ColrGradient functions, for blending colors and precomputing their codes.
+    \endinternal
+*/
+const char* ColrGradient_code(const ColrGradient* gradient, size_t index, size_t* length);
+void ColrGradient_free(ColrGradient* gradient);
+ColrGradient* ColrGradient_new(RGB_fmter fmter, ColrGradientSpace space, const RGB* stops, size_t count);
+RGB ColrGradient_rgb(const ColrGradient* gradient, double pos);
+bool ColrGradient_set_length(ColrGradient* gradient, size_t length);
+
+/*! \internal
+    ColrRainbow functions, for generating rainbow colors/codes.
+    \endinternal
+*/
+const char* ColrRainbow_code(ColrRainbow* rainbow, size_t offset, size_t* length);
+void ColrRainbow_drain(ColrRainbow* rainbow, FILE* out, bool final);
+bool ColrRainbow_feed(ColrRainbow* rainbow, FILE* out, const char* s, size_t length);
+bool ColrRainbow_finish(ColrRainbow* rainbow, FILE* out);
+bool ColrRainbow_flush(ColrRainbow* rainbow, FILE* out);
+void ColrRainbow_free(ColrRainbow* rainbow);
+ColrRainbow* ColrRainbow_new(RGB_fmter fmter, double freq, size_t offset, size_t spread);
+RGB ColrRainbow_rgb(ColrRainbow* rainbow, size_t offset);
+void ColrRainbow_seed(ColrRainbow* rainbow, size_t offset);
+bool ColrRainbow_set_pos(ColrRainbow* rainbow, size_t pos, size_t chars);
+void ColrRainbow_write_char(ColrRainbow* rainbow, FILE* out, const char* c, size_t length);
+
+/*! \internal
+    ColrReplacer functions, for replacing many literal targets in one pass.
+    \endinternal
+*/
+bool ColrReplacer_add_ColorArg(ColrReplacer* replacer, const char* target, ColorArg* repl);
+bool ColrReplacer_add_ColorResult(ColrReplacer* replacer, const char* target, ColorResult* repl);
+bool ColrReplacer_add_ColorText(ColrReplacer* replacer, const char* target, ColorText* repl);
+bool ColrReplacer_add_str(ColrReplacer* replacer, const char* target, const char* repl);
+bool ColrReplacer_compile(ColrReplacer* replacer);
+bool ColrReplacer_feed(ColrReplacer* replacer, FILE* out, const char* s, size_t length);
+bool ColrReplacer_finish(ColrReplacer* replacer, FILE* out);
+void ColrReplacer_free(ColrReplacer* replacer);
+ColrReplacer* ColrReplacer_new(void);
+size_t ColrReplacer_next_state(const ColrReplacer* replacer, size_t state, unsigned char c);
+char* ColrReplacer_replace(ColrReplacer* replacer, const char* s);
+size_t ColrReplacer_scan(ColrReplacer* replacer, const char* s, size_t length, bool final, FILE* out);
+
 /*! \internal
     BasicValue functions.
     \endinternal
@@ -3247,11 +4017,15 @@ RGB RGB_from_ExtendedValue(ExtendedValue eval);
 int RGB_from_esc(const char* s, RGB* rgb);
 int RGB_from_hex(const char* hexstr, RGB* rgb);
 RGB RGB_from_hex_default(const char* hexstr, RGB default_value);
+RGB RGB_from_linear(const double* values);
+RGB RGB_from_oklab(const double* lab);
 int RGB_from_str(const char* arg, RGB* rgb);
 RGB RGB_grayscale(RGB rgb);
 RGB RGB_inverted(RGB rgb);
 RGB RGB_monochrome(RGB rgb);
 char* RGB_to_hex(RGB rgb);
+void RGB_to_linear(RGB rgb, double* values);
+void RGB_to_oklab(RGB rgb, double* lab);
 char* RGB_to_str(RGB rgb);
 RGB RGB_to_term_RGB(RGB rgb);
 char* RGB_repr(RGB rgb);
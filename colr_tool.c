@@ -11,30 +11,47 @@
 
 
 int main(int argc, char* argv[]) {
+    // Justifying piped input with width 0 should still use the terminal width.
+    if (!isatty(STDIN_FILENO) && isatty(STDOUT_FILENO)) colr_term_size_set_fd(STDOUT_FILENO);
+    // All output is buffered, and only written when it is full or flushed.
+    out_init(stdout);
     ColrOpts opts = ColrOpts_new();
     int parse_ret = parse_args(argc, argv, &opts);
     // print_opts_repr(opts);
     // Any non-negative return means we should stop right here.
     if (parse_ret >= 0) {
         ColrOpts_cleanup(&opts);
-        return parse_ret;
+        return out_finish(stdout, parse_ret);
     }
-    // Non-colorizing/formatting options.
-    if (opts.list_codes) {
-        return run_colr_cmd(list_codes, &opts);
+    // Line by line stdin processing, for colorizing, justifying, or stripping.
+    if (opts.stream) {
+        return run_colr_cmd(stream_text, &opts);
+    } else if (opts.list_codes) {
+        return run_colr_cmd((opts.jobs > 1) ? list_codes_jobs : list_codes, &opts);
     } else if (opts.strip_codes) {
-        return run_colr_cmd(strip_codes, &opts);
+        return run_colr_cmd((opts.jobs > 1) ? strip_codes_jobs : strip_codes, &opts);
     } else if (opts.translate_code) {
         return run_colr_cmd(translate_code, &opts);
     } else if (opts.is_disabled) {
         // No need to colorize anything, colors were disabled. We are `cat` now, except worse.
         return run_colr_cmd(print_plain, &opts);
+    } else if (opts.highlighter) {
+        return run_colr_cmd(highlight_text, &opts);
+    } else if (opts.rainbow_stream) {
+        return run_colr_cmd(rainbowize_stream, &opts);
+    } else if (ColrOpts_use_rainbow_jobs(&opts)) {
+        return run_colr_cmd(rainbowize_jobs, &opts);
+    } else if (opts.text_mapped) {
+        return run_colr_cmd(colorize_mapped, &opts);
     }
 
     ColorText* ctext = NULL;
     // Rainbowize the text arg.
     if (opts.rainbow_fore || opts.rainbow_back) {
         ctext = rainbowize(&opts);
+    } else if (opts.gradient_count) {
+        // Gradient across/down the text.
+        ctext = gradientize(&opts);
     } else {
         // Colorize text using fore, back, or style.
         ctext = Colr(
@@ -64,18 +81,211 @@ int main(int argc, char* argv[]) {
         if (opts.free_text) free(opts.text);
         return EXIT_FAILURE;
     }
-    fprintf(opts.out_stream, "%s", text);
+    out_puts(opts.out_stream, text);
     bool has_newline = (
         colr_str_ends_with(text, "\n") ||
         colr_str_ends_with(text, "\n" CODE_RESET_ALL)
     );
     if (!has_newline) {
-        fprintf(opts.out_stream, "\n");
+        out_putc(opts.out_stream, '\n');
     }
 
     free(text);
     ColrOpts_free_text(&opts);
-    return EXIT_SUCCESS;
+    return out_finish(opts.out_stream, EXIT_SUCCESS);
+}
+
+/*! Free the chunks and listed ColorArgs in a ColrJobs.
+
+    \pi jobs The ColrJobs to free, from ColrJobs_init(). The struct itself is not free'd.
+*/
+void ColrJobs_free(ColrJobs* jobs) {
+    if (!jobs->chunks) return;
+    for (size_t i = 0; i < jobs->count; i++) {
+        free(jobs->chunks[i].out);
+        if (jobs->chunks[i].cargs) ColorArgs_array_free(jobs->chunks[i].cargs);
+    }
+    free(jobs->chunks);
+    jobs->chunks = NULL;
+    jobs->count = 0;
+    free(jobs->cargs);
+    jobs->cargs = NULL;
+    jobs->carg_count = 0;
+    pthread_cond_destroy(&jobs->cond);
+    pthread_mutex_destroy(&jobs->lock);
+}
+
+/*! Initialize a ColrJobs, splitting `opts->text` into chunks for --jobs.
+
+    \details
+    Chunks end at newlines that are not inside escape sequences, so every
+    chunk can be processed on its own. For rainbows with a spread, the
+    characters before each chunk are counted here.
+
+    \po jobs  The ColrJobs to initialize.
+    \pi opts  ColrOpts to get the text/options from.
+    \pi work  Function to process a chunk, on a worker thread.
+    \pi write Function to write a processed chunk, in order.
+    \return   `true` on success, or `false` if allocation failed.
+              ColrJobs_free() must be called either way.
+*/
+bool ColrJobs_init(ColrJobs* jobs, ColrOpts* opts, colr_job_func work, colr_job_func write) {
+    *jobs = (ColrJobs){
+        .opts=opts,
+        .chunks=NULL,
+        .count=0,
+        .work=work,
+        .write=write,
+        .next=0,
+        .written=0,
+        .window=opts->jobs * 2,
+        .failed=false,
+        .last_char='\0',
+        .items=0,
+        .cargs=NULL,
+        .carg_count=0,
+    };
+    pthread_mutex_init(&jobs->lock, NULL);
+    pthread_cond_init(&jobs->cond, NULL);
+    size_t chunk_size = opts->text_len / (opts->jobs * CT_CHUNKS_PER_JOB);
+    if (chunk_size < CT_MIN_CHUNK_SIZE) chunk_size = CT_MIN_CHUNK_SIZE;
+    if (chunk_size > CT_MAX_CHUNK_SIZE) chunk_size = CT_MAX_CHUNK_SIZE;
+    // There may be fewer chunks than this, when the lines are long.
+    size_t max_count = (opts->text_len / chunk_size) + 1;
+    jobs->chunks = calloc(max_count, sizeof(ColrChunk));
+    if (!jobs->chunks) return false;
+    bool do_count = (opts->rainbow_fore || opts->rainbow_back) && (opts->rainbow_spread > 1);
+    size_t start = 0;
+    size_t chars = 0;
+    while ((start < opts->text_len) && (jobs->count < max_count)) {
+        size_t end = (jobs->count == (max_count - 1)) ?
+            opts->text_len :
+            find_chunk_end(opts->text, opts->text_len, start, start + chunk_size);
+        jobs->chunks[jobs->count++] = (ColrChunk){
+            .text=opts->text + start,
+            .length=end - start,
+            .offset=start,
+            .chars=chars,
+        };
+        if (do_count) chars += count_chars(opts->text + start, end - start);
+        start = end;
+    }
+    return true;
+}
+
+/*! Process the chunks in a ColrJobs with `opts->jobs` threads, and write
+    them in order.
+
+    \details
+    The calling thread writes each chunk as soon as it, and every chunk
+    before it, is processed. Threads do not get more than `jobs->window`
+    chunks ahead of the writer, so memory use does not grow with the input.
+
+    \pi jobs The ColrJobs to run, from ColrJobs_init().
+    \return  `true` if every chunk was processed and written, otherwise `false`.
+*/
+bool ColrJobs_run(ColrJobs* jobs) {
+    // setlocale() is not thread-safe, so the locale is set up front.
+    if (!colr_locale_is_utf8()) colr_set_locale();
+    size_t thread_count = (jobs->opts->jobs < jobs->count) ? jobs->opts->jobs : jobs->count;
+    pthread_t threads[CT_MAX_JOBS];
+    size_t started = 0;
+    while (started < thread_count) {
+        if (pthread_create(&threads[started], NULL, ColrJobs_worker, jobs) != 0) break;
+        started++;
+    }
+    bool ok = started > 0;
+    for (size_t i = 0; ok && (i < jobs->count); i++) {
+        ColrChunk* chunk = &jobs->chunks[i];
+        pthread_mutex_lock(&jobs->lock);
+        while (!chunk->done) pthread_cond_wait(&jobs->cond, &jobs->lock);
+        pthread_mutex_unlock(&jobs->lock);
+        ok = !chunk->failed && jobs->write(jobs, chunk);
+        free(chunk->out);
+        chunk->out = NULL;
+        pthread_mutex_lock(&jobs->lock);
+        jobs->written++;
+        pthread_cond_broadcast(&jobs->cond);
+        pthread_mutex_unlock(&jobs->lock);
+    }
+    if (!ok) {
+        // Stop the other threads early.
+        pthread_mutex_lock(&jobs->lock);
+        jobs->failed = true;
+        pthread_cond_broadcast(&jobs->cond);
+        pthread_mutex_unlock(&jobs->lock);
+    }
+    for (size_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    return ok;
+}
+
+/*! Thread function for ColrJobs_run(), which processes chunks until there
+    are none left.
+
+    \pi arg Pointer to the ColrJobs.
+    \return Always `NULL`.
+*/
+void* ColrJobs_worker(void* arg) {
+    ColrJobs* jobs = arg;
+    while (1) {
+        pthread_mutex_lock(&jobs->lock);
+        while (
+            !jobs->failed &&
+            (jobs->next < jobs->count) &&
+            (jobs->next >= (jobs->written + jobs->window))
+        ) {
+            pthread_cond_wait(&jobs->cond, &jobs->lock);
+        }
+        if (jobs->failed || (jobs->next >= jobs->count)) {
+            pthread_mutex_unlock(&jobs->lock);
+            return NULL;
+        }
+        ColrChunk* chunk = &jobs->chunks[jobs->next++];
+        pthread_mutex_unlock(&jobs->lock);
+        bool ok = jobs->work(jobs, chunk);
+        pthread_mutex_lock(&jobs->lock);
+        chunk->failed = !ok;
+        chunk->done = true;
+        pthread_cond_broadcast(&jobs->cond);
+        pthread_mutex_unlock(&jobs->lock);
+    }
+}
+
+/*! Write the output for a processed chunk, for ColrJobs_run().
+
+    \pi jobs The ColrJobs that the chunk belongs to.
+    \pi chunk The chunk to write.
+    \return   `true` on success, or `false` if writing failed.
+*/
+bool ColrJobs_write_chunk(ColrJobs* jobs, ColrChunk* chunk) {
+    jobs->items += chunk->items;
+    if (!chunk->out_len) return true;
+    jobs->last_char = chunk->out[chunk->out_len - 1];
+    return out_write(jobs->opts->out_stream, chunk->out, chunk->out_len);
+}
+
+/*! Determine whether the text for the current options can be memory-mapped.
+
+    \details
+    Mapped text is not null-terminated, so it can only be used by commands
+    that use `opts->text_len`: listing codes, stripping codes, plain output,
+    fore/back/style colors without justification, and rainbows with --jobs.
+
+    \pi opts ColrOpts to get the options from.
+    \return  `true` if colorize_mapped() or one of the commands can use mapped text.
+*/
+bool ColrOpts_can_map(ColrOpts* opts) {
+    // Same order as main().
+    if (opts->list_codes || opts->strip_codes) return true;
+    if (opts->translate_code) return false;
+    if (opts->is_disabled || ColrOpts_use_rainbow_jobs(opts)) return true;
+    return !(
+        opts->highlighter ||
+        opts->gradient_count ||
+        opts->rainbow_fore ||
+        opts->rainbow_back ||
+        (opts->just.method != JUST_NONE)
+    );
 }
 
 /*! Free the ColorArgs and text used by colr-tool, if needed, and set them
@@ -90,22 +300,21 @@ void ColrOpts_cleanup(ColrOpts* opts) {
     ColrOpts_free_text(opts);
 }
 
-/*! Free the ColorArgs used by colr-tool, if needed, and set them to `NULL`.
+/*! Free the ColorArgs and highlighting rules used by colr-tool, if needed,
+    and set them to `NULL`.
 
     \po opts ColrOpts to get the ColorArgs/options from.
 */
 void ColrOpts_free_args(ColrOpts* opts) {
-    if (opts->fore) {
-        free(opts->fore);
-        opts->fore = NULL;
-    }
-    if (opts->back) {
-        free(opts->back);
-        opts->back = NULL;
-    }
-    if (opts->style) {
-        free(opts->style);
-        opts->style = NULL;
+    ColorArg_free(opts->fore);
+    opts->fore = NULL;
+    ColorArg_free(opts->back);
+    opts->back = NULL;
+    ColorArg_free(opts->style);
+    opts->style = NULL;
+    if (opts->highlighter) {
+        ColrHighlighter_free(opts->highlighter);
+        opts->highlighter = NULL;
     }
 }
 
@@ -114,6 +323,13 @@ void ColrOpts_free_args(ColrOpts* opts) {
     \pi opts ColrOpts to get the text/options from.
 */
 void ColrOpts_free_text(ColrOpts* opts) {
+    if (opts->text && opts->text_mapped) {
+        munmap(opts->text, opts->text_len);
+        opts->text = NULL;
+        opts->text_len = 0;
+        opts->text_mapped = false;
+        return;
+    }
     if (opts->text && opts->free_text) {
         free(opts->text);
         opts->text = NULL;
@@ -129,6 +345,8 @@ void ColrOpts_free_text(ColrOpts* opts) {
 ColrOpts ColrOpts_new(void) {
     return (ColrOpts){
         .text=NULL,
+        .text_len=0,
+        .text_mapped=false,
         .fore=NULL,
         .back=NULL,
         .style=NULL,
@@ -142,6 +360,13 @@ ColrOpts ColrOpts_new(void) {
         .rainbow_freq=CT_DEFAULT_FREQ,
         .rainbow_offset=CT_DEFAULT_OFFSET,
         .rainbow_spread=CT_DEFAULT_SPREAD,
+        .rainbow_stream=false,
+        .stream=false,
+        .jobs=1,
+        .gradient_count=0,
+        .gradient_back=false,
+        .gradient_vertical=false,
+        .gradient_space=GRADIENT_OKLAB,
         .auto_disable=false,
         .is_disabled=false,
         .list_codes=false,
@@ -149,6 +374,7 @@ ColrOpts ColrOpts_new(void) {
         .strip_codes=false,
         .translate_code=false,
         .out_stream=stdout,
+        .highlighter=NULL,
     };
 }
 
@@ -162,7 +388,8 @@ ColrOpts ColrOpts_new(void) {
              \mustfree
 */
 char* ColrOpts_repr(ColrOpts opts) {
-    char* text_repr = opts.text ? colr_repr(opts.text) : NULL;
+    // Mapped text is not null-terminated, and may be huge.
+    char* text_repr = (opts.text && !opts.text_mapped) ? colr_repr(opts.text) : NULL;
     char* fore_repr = opts.fore ? colr_repr(*(opts.fore)) : NULL;
     char* back_repr = opts.back ? colr_repr(*(opts.back)) : NULL;
     char* style_repr = opts.style ? colr_repr(*(opts.style)) : NULL;
@@ -178,6 +405,8 @@ char* ColrOpts_repr(ColrOpts opts) {
     .back=%s,\n\
     .style=%s,\n\
     .just=%s,\n\
+    .text_len=%zu,\n\
+    .text_mapped=%s,\n\
     .filepath=%s,\n\
     .free_text=%s,\n\
     .free_colr_text=%s,\n\
@@ -187,6 +416,13 @@ char* ColrOpts_repr(ColrOpts opts) {
     .rainbow_freq=%lf,\n\
     .rainbow_offset=%lu,\n\
     .rainbow_spread=%lu,\n\
+    .rainbow_stream=%s,\n\
+    .stream=%s,\n\
+    .jobs=%zu,\n\
+    .gradient_count=%lu,\n\
+    .gradient_back=%s,\n\
+    .gradient_vertical=%s,\n\
+    .gradient_space=%s,\n\
     .auto_disable=%s,\n\
     .is_disabled=%s,\n\
     .list_codes=%s,\n\
@@ -194,12 +430,15 @@ char* ColrOpts_repr(ColrOpts opts) {
     .strip_codes=%s,\n\
     .translate_code=%s,\n\
     .out_stream=%s,\n\
+    .highlighter=%s,\n\
 )",
         text_repr ? text_repr : "NULL",
         fore_repr ? fore_repr : "NULL",
         back_repr ? back_repr : "NULL",
         style_repr ? style_repr : "NULL",
         just_repr ? just_repr : "<couldn't allocate repr>",
+        opts.text_len,
+        bool_str(opts.text_mapped),
         file_repr ? file_repr : "NULL",
         bool_str(opts.free_text),
         bool_str(opts.free_colr_text),
@@ -209,13 +448,21 @@ char* ColrOpts_repr(ColrOpts opts) {
         opts.rainbow_freq,
         opts.rainbow_offset,
         opts.rainbow_spread,
+        bool_str(opts.rainbow_stream),
+        bool_str(opts.stream),
+        opts.jobs,
+        opts.gradient_count,
+        bool_str(opts.gradient_back),
+        bool_str(opts.gradient_vertical),
+        opts.gradient_space == GRADIENT_OKLAB ? "GRADIENT_OKLAB" : "GRADIENT_LINEAR_RGB",
         bool_str(opts.auto_disable),
         bool_str(opts.is_disabled),
         bool_str(opts.list_codes),
         bool_str(opts.list_unique_codes),
         bool_str(opts.strip_codes),
         bool_str(opts.translate_code),
-        stream_name(opts.out_stream)
+        stream_name(opts.out_stream),
+        opts.highlighter ? "<ColrHighlighter>" : "NULL"
     );
     free(text_repr);
     free(fore_repr);
@@ -226,13 +473,14 @@ char* ColrOpts_repr(ColrOpts opts) {
     return repr;
 }
 
-/*! Set `.is_disabled` if `.auto_disable` is set and `.out_stream` is not a tty.
+/*! Set `.is_disabled` if `.auto_disable` is set and `.out_stream` is not a tty,
+    or colors are disabled for the whole process (like with COLR_DISABLE).
 
     \pi opts ColrOpts to get the settings\FILE from.
     \return  The value of `opts.is_disabled` after setting it.
 */
 bool ColrOpts_set_disabled(ColrOpts* opts) {
-    opts->is_disabled = (
+    opts->is_disabled = colr_is_disabled() || (
         opts->auto_disable &&
         !isatty(fileno(opts->out_stream))
     );
@@ -242,20 +490,39 @@ bool ColrOpts_set_disabled(ColrOpts* opts) {
 /*! Get or set the text to work with, based on options.
 
     \details
-    If `opts->filepath` is not `NULL`, it is read from a file.
+    If `opts->filepath` is not `NULL`, it is read from a file. Regular files
+    are memory-mapped instead when ColrOpts_can_map() allows it, and
+    `opts->text_mapped` is set.
 
     \details
     If `opts->text == "-"`, it is read from stdin.
 
     \details
-    If processing-options are set (`.list_codes`, `.strip_codes`, `.translate_code`),
-    the default is to read from stdin.
+    If processing-options are set (`.list_codes`, `.strip_codes`, `.translate_code`,
+    `.highlighter`), the default is to read from stdin.
+
+    \details
+    If stdin would be rainbowized without justification, it is not read here.
+    `opts->rainbow_stream` is set instead, and rainbowize_stream() reads it.
+
+    \details
+    If stdin is not a regular file, and it would be colorized, justified, or
+    stripped, it is not read here either. `opts->stream` is set instead, and
+    stream_text() reads it line by line.
 
     \po opts A ColrOpts to set the text for.
     \return  `true` if text was set (or already set), otherwise `false`.
 */
 bool ColrOpts_set_text(ColrOpts* opts) {
     if (opts->filepath) {
+        if (ColrOpts_can_map(opts)) {
+            // Use the file data in place, if possible.
+            opts->text = map_file_arg(opts->filepath, &opts->text_len);
+            if (opts->text) {
+                opts->text_mapped = true;
+                return true;
+            }
+        }
         // Read from file.
         opts->text = read_file_arg(opts->filepath);
         opts->free_text = true;
@@ -263,6 +530,7 @@ bool ColrOpts_set_text(ColrOpts* opts) {
             printferr("\nFailed to allocate for file data!\n");
             return false;
         }
+        opts->text_len = strlen(opts->text);
         return true;
     }
     if (colr_str_starts_with(opts->text, "\\-")) {
@@ -274,9 +542,39 @@ bool ColrOpts_set_text(ColrOpts* opts) {
     // Do stdin if explicitly requested.
     bool do_stdin = colr_str_eq(opts->text, "-");
     // Do stdin if there is no text, and one of the commands is being used.
-    bool is_cmd = (opts->list_codes || opts->strip_codes || opts->translate_code);
-    if (!opts->text && is_cmd) do_stdin = true;
+    bool is_cmd = (
+        opts->list_codes ||
+        opts->strip_codes ||
+        opts->translate_code ||
+        opts->highlighter
+    );
+    // Rainbows can be written while stdin is read, for `tail -f` and friends.
+    bool can_stream = (
+        (opts->rainbow_fore || opts->rainbow_back) &&
+        !(is_cmd || opts->is_disabled) &&
+        (opts->just.method == JUST_NONE)
+    );
+    // Effects still read stdin when colors are disabled, the text is just plain.
+    bool is_effect = opts->rainbow_fore || opts->rainbow_back || opts->gradient_count;
+    if (!opts->text && (is_cmd || is_effect)) do_stdin = true;
 
+    // Regular files are split into chunks for --jobs, instead.
+    if (do_stdin && can_stream && !((opts->jobs > 1) && fd_is_file(fileno(stdin)))) {
+        opts->rainbow_stream = true;
+        return true;
+    }
+    // Pipes and terminals are processed line by line, as they are read.
+    // These need all of the text at once.
+    bool needs_all = (
+        opts->list_codes ||
+        opts->translate_code ||
+        opts->highlighter ||
+        opts->gradient_count
+    );
+    if (do_stdin && !needs_all && !fd_is_file(fileno(stdin))) {
+        opts->stream = true;
+        return true;
+    }
     if (do_stdin) {
         // Fill text with stdin if a marker argument was used.
         // Read from stdin.
@@ -287,7 +585,93 @@ bool ColrOpts_set_text(ColrOpts* opts) {
             return false;
         }
     }
-    return opts->text ? true : false;
+    if (!opts->text) return false;
+    opts->text_len = strlen(opts->text);
+    return true;
+}
+
+/*! Determine whether the text should be rainbowized with rainbowize_jobs().
+
+    \pi opts ColrOpts to get the options from.
+    \return  `true` if --jobs was used for an unjustified rainbow, otherwise `false`.
+*/
+bool ColrOpts_use_rainbow_jobs(ColrOpts* opts) {
+    // Same order as main().
+    if (opts->highlighter) return false;
+    return (
+        (opts->jobs > 1) &&
+        (opts->rainbow_fore || opts->rainbow_back) &&
+        (opts->just.method == JUST_NONE)
+    );
+}
+
+/*! Colorize memory-mapped `opts->text` with the fore/back/style options,
+    writing it straight from the mapping, and return an exit status code.
+
+    \details
+    The output is the same as ColorText_to_str() would produce, with the reset
+    code before any trailing newlines, but the text is never copied.
+
+    \pi opts Pointer to ColrOpts to get the text/options from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`.
+*/
+int colorize_mapped(ColrOpts* opts) {
+    if (!(opts->text && opts->text_len)) {
+        printferr("No text to work with.\n");
+        return EXIT_FAILURE;
+    }
+    char* codes = ColorText_to_esc(
+        (ColorText){.fore=opts->fore, .back=opts->back, .style=opts->style}
+    );
+    if (!codes) {
+        printferr("\nFailed to allocate for escape codes!\n");
+        return EXIT_FAILURE;
+    }
+    const char* text = opts->text;
+    size_t length = opts->text_len;
+    size_t body_len = length;
+    while (body_len && (text[body_len - 1] == '\n')) body_len--;
+    // Like colr_append_reset(), an existing reset code at the end is used.
+    size_t reset_len = CODE_RESET_LEN - 1;
+    bool has_reset = (
+        (body_len == length) &&
+        (length >= reset_len) &&
+        (memcmp(text + length - reset_len, CODE_RESET_ALL, reset_len) == 0)
+    );
+    out_puts(opts->out_stream, codes);
+    free(codes);
+    out_write(opts->out_stream, text, body_len);
+    if (!has_reset) out_puts(opts->out_stream, CODE_RESET_ALL);
+    out_write(opts->out_stream, text + body_len, length - body_len);
+    bool has_newline = (
+        (body_len < length) ||
+        (has_reset && (length > reset_len) && (text[length - reset_len - 1] == '\n'))
+    );
+    if (!has_newline) {
+        out_putc(opts->out_stream, '\n');
+    }
+    return EXIT_SUCCESS;
+}
+
+/*! Count the characters in some text, the same way ColrRainbow_feed() does.
+
+    \details
+    Invalid multibyte characters are counted one byte at a time.
+
+    \pi s      The text to count characters in. It does not need to be null-terminated.
+    \pi length Number of bytes in \p s.
+    \return    The number of characters.
+*/
+size_t count_chars(const char* s, size_t length) {
+    size_t count = 0;
+    size_t i = 0;
+    while (i < length) {
+        size_t char_len = colr_mb_char_len(s + i, length - i);
+        if (!(char_len && colr_is_valid_mblen(char_len))) char_len = 1;
+        i += char_len;
+        count++;
+    }
+    return count;
 }
 
 /*! Checks to see if a directory path exists.
@@ -303,6 +687,17 @@ bool dir_exists(const char* dirpath) {
     return ((st.st_mode & S_IFMT) == S_IFDIR);
 }
 
+/*! Checks to see if a file descriptor is a regular file.
+
+    \pi fd The file descriptor to check.
+    \return `true` if `fd` is a regular file, otherwise `false` (pipes, terminals, errors).
+*/
+bool fd_is_file(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) < 0) return false;
+    return S_ISREG(st.st_mode);
+}
+
 /*! Checks to see if a file path exists.
 
     \pi filepath File path to check.
@@ -313,6 +708,101 @@ bool file_exists(const char* filepath) {
     return (access(filepath, R_OK) == 0);
 }
 
+/*! Find the end of a chunk of text for --jobs.
+
+    \details
+    Chunks end right after a newline, at or after \p target. A newline that
+    is inside an escape sequence (an OSC sequence can hold one) is skipped,
+    and trailing newlines always stay with the last chunk.
+
+    \pi text   The text to split. It does not need to be null-terminated.
+    \pi length Number of bytes in \p text.
+    \pi start  Offset where the chunk starts.
+    \pi target Offset where the chunk should end, at the earliest.
+    \return    The offset where the chunk ends, which is \p length when there
+               is no other place to split the text.
+*/
+size_t find_chunk_end(const char* text, size_t length, size_t start, size_t target) {
+    size_t body_len = length;
+    while (body_len && (text[body_len - 1] == '\n')) body_len--;
+    size_t pos = target;
+    while (pos < body_len) {
+        const char* newline = memchr(text + pos, '\n', body_len - pos);
+        if (!newline) break;
+        size_t end = (size_t)(newline - text) + 1;
+        // Only the last escape sequence before the newline could contain it.
+        const char* esc = memrchr(text + start, '\x1b', (size_t)(newline - text) - start);
+        size_t esc_len = 0;
+        bool is_split = (
+            esc &&
+            (ColrToken_scan_esc_n(esc, (size_t)(newline - esc), &esc_len) == TOKEN_NONE) &&
+            (ColrToken_scan_esc_n(esc, length - (size_t)(esc - text), &esc_len) != TOKEN_NONE)
+        );
+        if (!is_split) return end;
+        pos = end;
+    }
+    return length;
+}
+
+/*! Colorize `opts->text` with a gradient, and return a ColorText with the result.
+
+    \pi opts Pointer to ColrOpts to get the text/gradient options from.
+    \return  An allocated ColorText, with a gradient `.text` member.
+*/
+ColorText* gradientize(ColrOpts* opts) {
+    bool do_term = !colr_supports_rgb_static();
+    RGB_fmter fmter = (
+        do_term ?
+            (opts->gradient_back ? format_bg_RGB_term : format_fg_RGB_term) :
+            (opts->gradient_back ? format_bg_RGB : format_fg_RGB)
+    );
+    char* colorized = _gradient(
+        fmter,
+        opts->text,
+        opts->gradient_space,
+        opts->gradient_vertical,
+        opts->gradient_stops,
+        opts->gradient_count
+    );
+    if (!colorized) return NULL;
+    if (opts->free_text) {
+        free(opts->text);
+        opts->text = NULL;
+        opts->free_text = false;
+    }
+    opts->free_colr_text = true;
+    return Colr(
+        colorized,
+        opts->fore,
+        opts->back,
+        opts->style
+    );
+}
+
+/*! Highlight `opts->text` with `opts->highlighter`, and return an exit status code.
+
+    \pi opts Pointer to ColrOpts to get the text/highlighter from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`.
+*/
+int highlight_text(ColrOpts* opts) {
+    if (!opts->text) {
+        printferr("\nNo text to highlight!\n");
+        return EXIT_FAILURE;
+    }
+    char* highlighted = ColrHighlighter_highlight(opts->highlighter, opts->text);
+    if (!highlighted) {
+        printferr("\nFailed to create highlighted text!\n");
+        return EXIT_FAILURE;
+    }
+    out_puts(opts->out_stream, highlighted);
+    if (!colr_str_ends_with(highlighted, "\n")) {
+        // Add a newline, for prettier output.
+        out_putc(opts->out_stream, '\n');
+    }
+    free(highlighted);
+    return EXIT_SUCCESS;
+}
+
 /*! List all escape-codes found in the text and return an exit status code.
 
     \pi opts Pointer to ColrOpts to get the text/options from.
@@ -322,11 +812,15 @@ int list_codes(ColrOpts* opts) {
     if (!opts->text) {
         printferr("\nNo text to examine!\n");
         return EXIT_FAILURE;
-    } else if (opts->text[0] == '\0') {
+    } else if (!opts->text_len) {
         printferr("\nText was empty!\n");
         return EXIT_FAILURE;
     }
-    ColorArg** carg_list = ColorArgs_from_str(opts->text, opts->list_unique_codes);
+    ColorArg** carg_list = ColorArgs_from_str_n(
+        opts->text,
+        opts->text_len,
+        opts->list_unique_codes
+    );
 
     if (!carg_list) {
         printferr("\nNo codes found.\n");
@@ -339,7 +833,8 @@ int list_codes(ColrOpts* opts) {
             !opts->is_disabled
         );
         if (!carg_example) continue;
-        fprintf(opts->out_stream, "%s\n", carg_example);
+        out_puts(opts->out_stream, carg_example);
+        out_putc(opts->out_stream, '\n');
         free(carg_example);
     }
     // Free the ColorArgs, and the list of pointers.
@@ -347,11 +842,275 @@ int list_codes(ColrOpts* opts) {
     return EXIT_SUCCESS;
 }
 
+/*! Find the escape codes in a chunk of text, for list_codes_jobs().
+
+    \details
+    When listing unique codes, `chunk->cargs` is set to the codes that are
+    unique in this chunk, and list_codes_write() skips the ones that were
+    already listed. Otherwise, `chunk->out` is set to the listing.
+
+    \pi jobs  The ColrJobs that the chunk belongs to.
+    \po chunk The chunk to process.
+    \return   `true` on success, or `false` if allocation failed.
+*/
+bool list_codes_chunk(ColrJobs* jobs, ColrChunk* chunk) {
+    ColrOpts* opts = jobs->opts;
+    ColorArg** carg_list = ColorArgs_from_str_n(
+        chunk->text,
+        chunk->length,
+        opts->list_unique_codes
+    );
+    // There may not be any escape-codes in this chunk.
+    if (!carg_list) return true;
+    if (opts->list_unique_codes) {
+        chunk->cargs = carg_list;
+        return true;
+    }
+    FILE* out = open_memstream(&chunk->out, &chunk->out_len);
+    if (!out) {
+        ColorArgs_array_free(carg_list);
+        return false;
+    }
+    for (size_t i = 0; carg_list[i]; i++) {
+        char* carg_example = ColorArg_example(
+            *(carg_list[i]),
+            !opts->is_disabled
+        );
+        if (!carg_example) continue;
+        out_puts(out, carg_example);
+        out_putc(out, '\n');
+        free(carg_example);
+        chunk->items++;
+    }
+    ColorArgs_array_free(carg_list);
+    return fclose(out) == 0;
+}
+
+/*! List all escape-codes found in the text with `opts->jobs` threads, and
+    return an exit status code.
+
+    \details
+    The output is the same as list_codes().
+
+    \pi opts Pointer to ColrOpts to get the text/options from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`
+*/
+int list_codes_jobs(ColrOpts* opts) {
+    if (!opts->text) {
+        printferr("\nNo text to examine!\n");
+        return EXIT_FAILURE;
+    } else if (!opts->text_len) {
+        printferr("\nText was empty!\n");
+        return EXIT_FAILURE;
+    }
+    ColrJobs jobs;
+    bool ok = (
+        ColrJobs_init(&jobs, opts, list_codes_chunk, list_codes_write) &&
+        ColrJobs_run(&jobs)
+    );
+    size_t items = jobs.items;
+    ColrJobs_free(&jobs);
+    if (!ok) {
+        printferr("\nFailed to list codes!\n");
+        return EXIT_FAILURE;
+    } else if (!items) {
+        printferr("\nNo codes found.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/*! Write the escape codes for a processed chunk, for list_codes_jobs().
+
+    \details
+    Unique codes that were listed for an earlier chunk are skipped.
+
+    \pi jobs  The ColrJobs that the chunk belongs to.
+    \pi chunk The chunk to write.
+    \return   `true` on success, or `false` if allocation or writing failed.
+*/
+bool list_codes_write(ColrJobs* jobs, ColrChunk* chunk) {
+    if (!chunk->cargs) return ColrJobs_write_chunk(jobs, chunk);
+    ColrOpts* opts = jobs->opts;
+    for (size_t i = 0; chunk->cargs[i]; i++) {
+        bool found = false;
+        for (size_t j = 0; j < jobs->carg_count; j++) {
+            if (ColorArg_eq(jobs->cargs[j], *(chunk->cargs[i]))) {
+                found = true;
+                break;
+            }
+        }
+        if (found) continue;
+        ColorArg* tmp = realloc(jobs->cargs, sizeof(ColorArg) * (jobs->carg_count + 1));
+        if (!tmp) return false;
+        jobs->cargs = tmp;
+        jobs->cargs[jobs->carg_count++] = *(chunk->cargs[i]);
+        jobs->items++;
+        char* carg_example = ColorArg_example(
+            *(chunk->cargs[i]),
+            !opts->is_disabled
+        );
+        if (!carg_example) continue;
+        out_puts(opts->out_stream, carg_example);
+        out_putc(opts->out_stream, '\n');
+        free(carg_example);
+    }
+    ColorArgs_array_free(chunk->cargs);
+    chunk->cargs = NULL;
+    return true;
+}
+
+/*! Memory-map a regular file, for reading it in place.
+
+    \details
+    The file must be at the start (offset `0`), because the entire file is
+    mapped. The kernel is told that it will be read sequentially.
+
+    \pi fd     The file descriptor to map. It is not closed.
+    \po length Set to the length of the file data, on success.
+    \return    \parblock
+                   A pointer to the file data, which is <em>not</em>
+                   null-terminated, or `NULL` if the file is empty, not a
+                   regular file, or can't be mapped.
+                   It must be released with `munmap(data, length)`.
+               \endparblock
+*/
+char* map_file(int fd, size_t* length) {
+    struct stat st;
+    if ((fstat(fd, &st) < 0) || !S_ISREG(st.st_mode) || (st.st_size <= 0)) return NULL;
+    if (lseek(fd, 0, SEEK_CUR) != 0) return NULL;
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return NULL;
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    *length = (size_t)st.st_size;
+    return data;
+}
+
+/*! Memory-map a regular file by path, for reading it in place.
+
+    \pi filepath The file path to map.
+    \po length   Set to the length of the file data, on success.
+    \return      Same as map_file().
+*/
+char* map_file_arg(const char* filepath, size_t* length) {
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) return NULL;
+    char* data = map_file(fd, length);
+    // The mapping stays valid after closing.
+    close(fd);
+    return data;
+}
+
+/*! Finish writing to an output stream, and return an exit status code.
+
+    \details
+    Buffered output is written. If any output could not be written, a message
+    is printed and `EXIT_FAILURE` is returned.
+
+    \pi fp  The stream to finish.
+    \pi ret The exit status code from the command.
+    \return  \p ret, or `EXIT_FAILURE` if the output could not be written.
+*/
+int out_finish(FILE* fp, int ret) {
+    if (out_flush(fp)) return ret;
+    printferr("\nFailed to write output: %s\n", strerror(errno));
+    return EXIT_FAILURE;
+}
+
+/*! Write everything that is buffered for an output stream.
+
+    \details
+    Output is only written when the buffer is full, or at one of these
+    explicit flush points, like before waiting for more input.
+
+    \pi fp The stream to flush.
+    \return `true` if all output has been written, or `false` if there was an
+            error writing to the stream.
+*/
+bool out_flush(FILE* fp) {
+    return (fflush_unlocked(fp) == 0) && !ferror_unlocked(fp);
+}
+
+/*! Give an output stream a large buffer, so output is written with as few
+    `write()` calls as possible.
+
+    \details
+    This must be called before anything is written to the stream. The buffer
+    is used until the stream is flushed at exit, so it is never free'd.
+
+    \pi fp The stream to buffer.
+    \return `true` if the buffer was set, otherwise `false` (the stream keeps
+            the default buffer).
+*/
+bool out_init(FILE* fp) {
+    char* buffer = malloc(CT_OUT_BUFFER_SIZE);
+    if (!buffer) return false;
+    if (setvbuf(fp, buffer, _IOFBF, CT_OUT_BUFFER_SIZE) != 0) {
+        free(buffer);
+        return false;
+    }
+    return true;
+}
+
+/*! Open a buffered output stream that writes to `stderr`'s file descriptor,
+    for `--err`.
+
+    \details
+    `stderr` itself is left unbuffered, so error messages are written right
+    away. The new stream is flushed by out_finish() at exit.
+
+    \return A new buffered stream, or `stderr` if it could not be opened.
+*/
+FILE* out_open_err(void) {
+    int fd = dup(STDERR_FILENO);
+    if (fd < 0) return stderr;
+    FILE* fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        return stderr;
+    }
+    out_init(fp);
+    return fp;
+}
+
+/*! Write a single character to an output stream.
+
+    \details
+    Only the main thread writes output, so the stream is not locked.
+
+    \pi fp The stream to write to.
+    \pi c  The character to write.
+*/
+void out_putc(FILE* fp, char c) {
+    fputc_unlocked(c, fp);
+}
+
+/*! Write a string to an output stream, without a newline.
+
+    \pi fp The stream to write to.
+    \pi s  The string to write.
+*/
+void out_puts(FILE* fp, const char* s) {
+    fputs_unlocked(s, fp);
+}
+
+/*! Write bytes to an output stream.
+
+    \pi fp     The stream to write to.
+    \pi s      The bytes to write. They do not need to be null-terminated.
+    \pi length Number of bytes to write.
+    \return    `true` if the bytes were written (or buffered), otherwise `false`.
+*/
+bool out_write(FILE* fp, const char* s, size_t length) {
+    return fwrite_unlocked(s, 1, length, fp) == length;
+}
+
 int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* opts) {
     int argval_just;
     double argval_freq;
     size_t argval_offset;
     size_t argval_spread;
+    size_t argval_jobs;
 
     switch (c) {
         case 0:
@@ -362,8 +1121,8 @@ int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* o
             break;
         case 'b':
             if (opts->back) {
-                // Happens when --rainbow is used.
-                printferr("BACK was set with --rainbow.\n");
+                // Happens when --rainbow, --gradient, or --back was already used.
+                printferr("BACK was already set with: %s\n", color_arg_str(opts, true));
                 return EXIT_FAILURE;
             }
             if (colr_str_either(optarg, "rainbow", "rainbowterm")) {
@@ -388,7 +1147,7 @@ int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* o
             opts->just.width = argval_just;
             break;
         case 'e':
-            opts->out_stream = stderr;
+            if (opts->out_stream == stdout) opts->out_stream = out_open_err();
             break;
         case 'F':
             if (colr_str_eq(optarg, "-")) {
@@ -404,8 +1163,8 @@ int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* o
             break;
         case 'f':
             if (opts->fore) {
-                // Happens when --rainbow is used.
-                printferr("FORE was set with --rainbow.\n");
+                // Happens when --rainbow, --gradient, or --fore was already used.
+                printferr("FORE was already set with: %s\n", color_arg_str(opts, false));
                 return EXIT_FAILURE;
             }
             if (colr_str_either(optarg, "rainbow", "rainbowterm")) {
@@ -417,9 +1176,38 @@ int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* o
                 if (!validate_color_arg(*(opts->fore), optarg)) return EXIT_FAILURE;
             }
             break;
+        case 'G':
+            if (opts->back) {
+                printferr("BACK was already set, can't use --gradientbg.\n");
+                return EXIT_FAILURE;
+            }
+            if (!parse_gradient_arg(optarg, true, opts)) return EXIT_FAILURE;
+            break;
+        case 'g':
+            if (opts->fore) {
+                printferr("FORE was already set, can't use --gradient.\n");
+                return EXIT_FAILURE;
+            }
+            if (!parse_gradient_arg(optarg, false, opts)) return EXIT_FAILURE;
+            break;
+        case 'H':
+            if (!parse_highlight_arg(optarg, opts)) return EXIT_FAILURE;
+            break;
         case 'h':
             print_usage_full();
             return EXIT_SUCCESS;
+        case 'j':
+            if (!parse_size_arg(optarg, &argval_jobs)) {
+                printferr("Invalid value for --jobs: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            if (!argval_jobs) {
+                // Use every processor.
+                long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+                argval_jobs = (cpu_count > 0) ? (size_t)cpu_count : 1;
+            }
+            opts->jobs = (argval_jobs > CT_MAX_JOBS) ? CT_MAX_JOBS : argval_jobs;
+            break;
         case 'l':
             if (opts->just.method != JUST_NONE) {
                 printferr("Justification was already set with: %s\n", just_arg_str(opts->just));
@@ -452,7 +1240,14 @@ int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* o
             }
             opts->rainbow_freq = argval_freq;
             break;
+        case 'V':
+            opts->gradient_vertical = true;
+            break;
         case 'R':
+            if (opts->gradient_count) {
+                printferr("Can't use --rainbow with --gradient.\n");
+                return EXIT_FAILURE;
+            }
             if (!opts->fore)  {
                 opts->rainbow_fore = true;
                 opts->fore = ColorArg_to_ptr(ColorArg_empty());
@@ -519,7 +1314,11 @@ int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* o
 }
 
 int parse_arg_long(const char* long_name, ColrOpts* opts) {
-    if (colr_str_eq(long_name, "basic")) {
+    if (colr_str_eq(long_name, "linear")) {
+        // Not a command, just a gradient option.
+        opts->gradient_space = GRADIENT_LINEAR_RGB;
+        return -1;
+    } else if (colr_str_eq(long_name, "basic")) {
         return print_basic(opts, false);
     } else if (colr_str_eq(long_name, "256")) {
         return print_256(opts, false);
@@ -582,18 +1381,25 @@ int parse_args(int argc, char** argv, ColrOpts* opts) {
         {"rjust", required_argument, 0, 'r'},
         {"center", required_argument, 0, 'c'},
         {"rainbow", no_argument, 0, 'R'},
+        {"gradient", required_argument, 0, 'g'},
+        {"gradientbg", required_argument, 0, 'G'},
         // Commands
         {"listcodes", no_argument, 0, 'z'},
         {"stripcodes", no_argument, 0, 'x'},
         {"translate", no_argument, 0, 't'},
+        {"highlight", required_argument, 0, 'H'},
         // Command options.
         {"auto-disable", no_argument, 0, 'a'},
         {"err", no_argument, 0, 'e'},
         {"unique", no_argument, 0, 'u'},
+        {"jobs", required_argument, 0, 'j'},
         // Rainbow options.
         {"frequency", required_argument, 0, 'q'},
         {"offset", required_argument, 0, 'o'},
         {"spread", required_argument, 0, 'w'},
+        // Gradient options.
+        {"linear", no_argument, 0, 0},
+        {"vertical", no_argument, 0, 'V'},
         // Example Commands.
         {"basic", no_argument, 0, 0 },
         {"basicbg", no_argument, 0, 0 },
@@ -615,7 +1421,7 @@ int parse_args(int argc, char** argv, ColrOpts* opts) {
         c = getopt_long(
             argc,
             argv,
-            ":aehRtuvxzb:c:F:f:l:o:q:r:s:w:",
+            ":aehRtuVvxzb:c:F:f:G:g:H:j:l:o:q:r:s:w:",
             long_options,
             &option_index
         );
@@ -631,7 +1437,8 @@ int parse_args(int argc, char** argv, ColrOpts* opts) {
     bool no_colr_opts = (
         opts->list_codes ||
         opts->strip_codes ||
-        opts->translate_code
+        opts->translate_code ||
+        opts->highlighter
     );
     while (optind < argc) {
         if (!opts->text && !opts->filepath) {
@@ -687,11 +1494,12 @@ int parse_args(int argc, char** argv, ColrOpts* opts) {
     if (!opts->back) opts->back = ColorArg_to_ptr(ColorArg_empty());
     if (!opts->style) opts->style = ColorArg_to_ptr(ColorArg_empty());
 
+    // Disabled colors are checked first, there is no need to stream them.
+    ColrOpts_set_disabled(opts);
     if (!ColrOpts_set_text(opts)) {
         printferr("\nNo text to work with!\n");
         return EXIT_FAILURE;
     }
-    ColrOpts_set_disabled(opts);
     return -1;
 }
 
@@ -711,6 +1519,123 @@ bool parse_double_arg(const char* s, double* value) {
     return true;
 }
 
+/*! Parse a --gradient/--gradientbg argument, and set the gradient stops in
+    `opts`.
+
+    \details
+    The argument format is `COLOR/COLOR[/COLOR...]`, where each color is an
+    RGB value, hex color, or known name (see RGB_from_str()).
+    On error, a message is printed and `false` is returned.
+
+    \pi s       The argument to parse.
+    \pi do_back Whether the gradient is for back colors.
+    \po opts    ColrOpts to set the gradient stops for.
+    \return     `true` if the stops were set, otherwise `false`.
+*/
+bool parse_gradient_arg(const char* s, bool do_back, ColrOpts* opts) {
+    if (opts->gradient_count || opts->rainbow_fore || opts->rainbow_back) {
+        printferr("Only one gradient/rainbow can be used.\n");
+        return false;
+    }
+    char* colors = s ? strdup(s) : NULL;
+    if (!colors) {
+        printferr("Failed to allocate for --gradient colors!\n");
+        return false;
+    }
+    size_t count = 0;
+    char* name = colors;
+    bool ok = true;
+    while (ok && name) {
+        char* sep = strchr(name, '/');
+        if (sep) *sep = '\0';
+        if (count == COLR_GRADIENT_MAX_STOPS) {
+            printferr(
+                "Too many colors for --gradient, max is %d: %s\n",
+                COLR_GRADIENT_MAX_STOPS,
+                s
+            );
+            ok = false;
+        } else if (RGB_from_str(name, &(opts->gradient_stops[count])) != 0) {
+            printferr("Invalid gradient color: %s\n", name);
+            ok = false;
+        }
+        count++;
+        name = sep ? sep + 1 : NULL;
+    }
+    free(colors);
+    if (!ok) return false;
+    if (count < 2) {
+        printferr("Expecting at least two colors for --gradient: %s\n", s);
+        return false;
+    }
+    opts->gradient_count = count;
+    opts->gradient_back = do_back;
+    // Set to empty, so the positional arguments skip it.
+    if (do_back) {
+        opts->back = ColorArg_to_ptr(ColorArg_empty());
+    } else {
+        opts->fore = ColorArg_to_ptr(ColorArg_empty());
+    }
+    return true;
+}
+
+/*! Parse a --highlight argument, and add it's rule to `opts->highlighter`.
+
+    \details
+    The argument format is `FORE[/BACK[/STYLE]]=PATTERN`. Any of the colors
+    may be empty. On error, a message is printed and `false` is returned.
+
+    \pi s    The argument to parse.
+    \po opts ColrOpts to add the highlighting rule to.
+    \return  `true` if the rule was added, otherwise `false`.
+*/
+bool parse_highlight_arg(const char* s, ColrOpts* opts) {
+    const char* pattern = s ? strchr(s, '=') : NULL;
+    if (!pattern || (pattern == s) || (pattern[1] == '\0')) {
+        printferr("Invalid value for --highlight, expecting COLOR=PATTERN: %s\n", s);
+        return false;
+    }
+    char* colors = strndup(s, pattern - s);
+    if (!colors) {
+        printferr("Failed to allocate for --highlight colors!\n");
+        return false;
+    }
+    pattern++;
+    ColorArg* cargs[3] = {NULL, NULL, NULL};
+    char* name = colors;
+    bool ok = true;
+    for (size_t i = 0; ok && name; i++) {
+        char* sep = strchr(name, '/');
+        if (sep) *sep = '\0';
+        if (i > 2) {
+            printferr("Too many colors for --highlight: %s\n", s);
+            ok = false;
+        } else if (name[0] != '\0') {
+            cargs[i] = i == 0 ? fore(name) : i == 1 ? back(name) : style(name);
+            ok = validate_color_arg(*(cargs[i]), name);
+        }
+        name = sep ? sep + 1 : NULL;
+    }
+    free(colors);
+    if (!ok) {
+        for (size_t i = 0; i < 3; i++) free(cargs[i]);
+        return false;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        if (!cargs[i]) cargs[i] = ColorArg_to_ptr(ColorArg_empty());
+    }
+    if (!opts->highlighter) opts->highlighter = ColrHighlighter_new();
+    bool added = ColrHighlighter_add(
+        opts->highlighter,
+        pattern,
+        0,
+        0,
+        Colr("", cargs[0], cargs[1], cargs[2])
+    );
+    if (!added) printferr("Invalid pattern for --highlight: %s\n", pattern);
+    return added;
+}
+
 /*! Parse a user argument as an integer, and set `value` to the parsed integer
     value.
 
@@ -754,13 +1679,15 @@ int print_256(ColrOpts* opts, bool do_back) {
         carg = do_back ? back(ext(i)) : fore(ext(i));
         if (i < 16) {
             text = colr_cat(carg, num);
-            fprintf(opts->out_stream, "%s ", text);
-            if ((i == 7) || (i == 15)) fprintf(opts->out_stream, "\n");
+            out_puts(opts->out_stream, text);
+            out_putc(opts->out_stream, ' ');
+            if ((i == 7) || (i == 15)) out_putc(opts->out_stream, '\n');
             free(text);
         } else {
             // Print the number as is.
             text = colr_cat(carg, num);
-            fprintf(opts->out_stream, "%s ", text);
+            out_puts(opts->out_stream, text);
+            out_putc(opts->out_stream, ' ');
             free(text);
             // Print the other 5 in the group.
             int j = i;
@@ -769,10 +1696,11 @@ int print_256(ColrOpts* opts, bool do_back) {
                 snprintf(num, 4, "%03d", j);
                 carg = do_back ? back(ext(j)) : fore(ext(j));
                 text = colr_cat(carg, num);
-                fprintf(opts->out_stream, "%s ", text);
+                out_puts(opts->out_stream, text);
+                out_putc(opts->out_stream, ' ');
                 free(text);
             }
-            fprintf(opts->out_stream, "\n");
+            out_putc(opts->out_stream, '\n');
         }
     }
     // Print the grayscale numbers.
@@ -780,10 +1708,11 @@ int print_256(ColrOpts* opts, bool do_back) {
         snprintf(num, 4, "%03d", i);
         carg = do_back ? back(ext(i)) : fore(ext(i));
         text = colr_cat(carg, num);
-        fprintf(opts->out_stream, "%s ", text);
+        out_puts(opts->out_stream, text);
+        out_putc(opts->out_stream, ' ');
         free(text);
     }
-    fprintf(opts->out_stream, "\n");
+    out_putc(opts->out_stream, '\n');
     return EXIT_SUCCESS;
 }
 
@@ -797,7 +1726,7 @@ int print_basic(ColrOpts* opts, bool do_back) {
         char* name = basic_names[i].name;
         BasicValue val = basic_names[i].value;
         if (colr_str_either(name, "black", "lightblack")) {
-            fprintf(opts->out_stream, "\n");
+            out_putc(opts->out_stream, '\n');
         }
         BasicValue otherval = colr_str_ends_with(name, "black") ? WHITE : BLACK;
         asprintf_or_return(1, &namefmt, "%-14s", name);
@@ -806,11 +1735,12 @@ int print_basic(ColrOpts* opts, bool do_back) {
         } else {
             text = colr_cat(fore(val), back(otherval), namefmt);
         }
-        fprintf(opts->out_stream, "%s", text);
+        out_puts(opts->out_stream, text);
         free(namefmt);
         free(text);
     }
-    fprintf(opts->out_stream, "%s\n", CODE_RESET_ALL);
+    out_puts(opts->out_stream, CODE_RESET_ALL);
+    out_putc(opts->out_stream, '\n');
     return EXIT_SUCCESS;
 }
 
@@ -823,7 +1753,8 @@ int print_plain(ColrOpts* opts) {
         printferr("\nNo text to work with!\n");
         return EXIT_FAILURE;
     }
-    fprintf(opts->out_stream, "%s\n", opts->text);
+    out_write(opts->out_stream, opts->text, opts->text_len);
+    out_putc(opts->out_stream, '\n');
     return EXIT_SUCCESS;
 }
 
@@ -878,14 +1809,14 @@ int print_names(ColrOpts* opts, bool do_rgb) {
         if (third >= colr_name_data_len) continue;
         print_name(opts, third, do_rgb);
         printed++;
-        fprintf(opts->out_stream, "\n");
+        out_putc(opts->out_stream, '\n');
     }
     // Print remaining names, should be 3 or less.
     while (printed < colr_name_data_len) {
         print_name(opts, printed, do_rgb);
         printed++;
     }
-    fprintf(opts->out_stream, "\n\n");
+    out_puts(opts->out_stream, "\n\n");
     return EXIT_SUCCESS;
 }
 
@@ -896,11 +1827,11 @@ int print_rainbow(ColrOpts* opts, bool do_back) {
     char text[] = "This is a demo of the rainbow function.";
     char* rainbowtxt;
     if (do_back) {
-        rainbowtxt = colr_supports_rgb() ?
+        rainbowtxt = colr_supports_rgb_static() ?
             rainbow_bg(text, CT_DEFAULT_FREQ, CT_DEFAULT_OFFSET, CT_DEFAULT_SPREAD) :
             rainbow_bg_term(text, CT_DEFAULT_FREQ, CT_DEFAULT_OFFSET, CT_DEFAULT_SPREAD);
     } else {
-        rainbowtxt = colr_supports_rgb() ?
+        rainbowtxt = colr_supports_rgb_static() ?
             rainbow_fg(text, CT_DEFAULT_FREQ, CT_DEFAULT_OFFSET, CT_DEFAULT_SPREAD) :
             rainbow_fg_term(text, CT_DEFAULT_FREQ, CT_DEFAULT_OFFSET, CT_DEFAULT_SPREAD);
     }
@@ -910,7 +1841,8 @@ int print_rainbow(ColrOpts* opts, bool do_back) {
         rainbowtxt
     );
     free(rainbowtxt);
-    fprintf(opts->out_stream, "%s\n", textfmt);
+    out_puts(opts->out_stream, textfmt);
+    out_putc(opts->out_stream, '\n');
     free(textfmt);
     return EXIT_SUCCESS;
 }
@@ -950,16 +1882,17 @@ int print_rgb(ColrOpts* opts, bool do_back, bool term_rgb) {
                 }
                 free(num);
                 count++;
-                fprintf(opts->out_stream, "%s ", text);
+                out_puts(opts->out_stream, text);
+                out_putc(opts->out_stream, ' ');
                 free(text);
                 if (count > 3) {
-                    fprintf(opts->out_stream, "\n");
+                    out_putc(opts->out_stream, '\n');
                     count = 0;
                 }
             }
         }
     }
-    fprintf(opts->out_stream, "\n");
+    out_putc(opts->out_stream, '\n');
     return EXIT_SUCCESS;
 }
 
@@ -974,11 +1907,14 @@ int print_usage(const char* reason) {
     Usage:\n\
         colr -h | -v\n\
         colr --basic | --256 | --names | --rainbowize | --rgb | --rgbterm\n\
-        colr (-t | -x | -z [-u]) [-a] [TEXT]\n\
+        colr (-t | -x | -z [-u]) [-a] [-j num] [TEXT]\n\
+        colr -H spec... [-a] [TEXT | -F file]\n\
         colr [TEXT] [-R] [FORE | -f color] [BACK | -b color] [STYLE | -s style]\n\
              [-a] [-c num | -l num | -r num] [-o num] [-q num]\n\
         colr [-F file] [-R] [FORE | -f color] [BACK | -b color] [STYLE | -s style]\n\
-             [-a] [-c num | -l num | -r num] [-o num] [-q num]\n\
+             [-a] [-c num | -l num | -r num] [-j num] [-o num] [-q num]\n\
+        colr [TEXT | -F file] (-g colors | -G colors) [-V] [--linear]\n\
+             [FORE | BACK] [STYLE | -s style] [-a] [-c num | -l num | -r num]\n\
     ", NAME, VERSION);
     return EXIT_SUCCESS;
 }
@@ -1006,6 +1942,8 @@ int print_usage_full() {
 "        TEXT                    : Text to colorize.\n",
 "                                  Use \"-\" or \"-F -\" to force stdin.\n",
 "                                  Default: stdin\n",
+"                                  Piped stdin is processed line by line,\n",
+"                                  and justified line by line.\n",
 "        FORE                    : Fore color name/value for text.\n",
 "                                  If set to 'rainbow', the text will be rainbowized.\n",
 "                                  If set to 'rainbowterm', 256-color codes are used,\n",
@@ -1022,9 +1960,23 @@ int print_usage_full() {
 "        -F file,--file file     : Read text from a file.\n",
 "                                  Use \"-F -\" to force stdin.\n",
 "        -f val,--fore val       : Specify the fore color explicitly, in any order.\n",
+"        -G val,--gradientbg val : Same as --gradient, for back colors.\n",
+"        -g val,--gradient val   : Blend fore colors across the text.\n",
+"                                  The value is COLOR/COLOR[/COLOR...], with up to\n",
+"                                  " colr_macro_str(COLR_GRADIENT_MAX_STOPS) " colors. Colors are blended in OKLab.\n",
+"        -H spec,--highlight spec: Highlight regex matches in the text.\n",
+"                                  The spec is FORE[/BACK[/STYLE]]=PATTERN.\n",
+"                                  This can be used more than once. Earlier\n",
+"                                  rules win when matches overlap.\n",
 "        -h, --help              : Print this message and exit.\n",
+"        -j num,--jobs num       : Number of threads for -x, -z, or rainbows,\n",
+"                                  when the text is a file. The file is split\n",
+"                                  at newlines, and the output is the same.\n",
+"                                  If \"0\" is given, every processor is used.\n",
+"                                  Default: 1\n",
 "        -l num,--ljust num      : Left-justify the resulting text using the specified width.\n",
 "                                  If \"0\" is given, the terminal-width will be used.\n",
+"        --linear                : Blend gradient colors in linear RGB, instead of OKLab.\n",
 "        -o num,--offset num     : Starting offset into the rainbow if \"rainbow\"\n",
 "                                  is used as a fore/back color.\n",
 "                                  This will \"shift\" the starting color of the\n",
@@ -1044,6 +1996,7 @@ int print_usage_full() {
 "        -s val,--style val      : Specify the style explicitly, in any order.\n",
 "        -t,--translate          : Translate a color into all three color types.\n",
 "        -u,--unique             : Only list unique escape codes with -z.\n",
+"        -V,--vertical           : Blend gradient colors down the lines, instead of across.\n",
 "        -v,--version            : Show version and exit.\n",
 "        -x,--stripcodes         : Strip escape codes from the text.\n",
 "        -z,--listcodes          : List escape codes found in the text.\n",
@@ -1063,17 +2016,17 @@ NULL
     };
     size_t i = 0;
     while (help_lines[i]) {
-        printf("%s", help_lines[i++]);
+        out_puts(stdout, help_lines[i++]);
     }
 
-    puts("\n");
+    out_puts(stdout, "\n\n");
     return EXIT_SUCCESS;
 }
 
 /*! Print the ColrC version.
 */
 int print_version(void) {
-    printf(NAME " v. " VERSION "\n");
+    out_puts(stdout, NAME " v. " VERSION "\n");
     return EXIT_SUCCESS;
 }
 
@@ -1083,7 +2036,7 @@ int print_version(void) {
     \return  An allocated ColorText, with a rainbowized `.text` member.
 */
 ColorText* rainbowize(ColrOpts* opts) {
-    bool do_term_rainbow = opts->rainbow_term || !colr_supports_rgb();
+    bool do_term_rainbow = opts->rainbow_term || !colr_supports_rgb_static();
     rainbow_creator func = (
         do_term_rainbow ?
             (opts->rainbow_fore ? rainbow_fg_term : rainbow_bg_term) :
@@ -1115,36 +2068,240 @@ ColorText* rainbowize(ColrOpts* opts) {
     );
 }
 
+/*! Rainbowize a chunk of text, for rainbowize_jobs().
+
+    \details
+    The rainbow starts where it would be if all of the text before the chunk
+    was rainbowized. The last chunk gets the same reset codes and newline as
+    rainbowize() and main() would add to the whole text.
+
+    \pi jobs  The ColrJobs that the chunk belongs to.
+    \po chunk The chunk to process. `chunk->out` is set to the rainbowized text.
+    \return   `true` on success, or `false` if allocation failed.
+*/
+bool rainbowize_chunk(ColrJobs* jobs, ColrChunk* chunk) {
+    ColrOpts* opts = jobs->opts;
+    ColrRainbow* rainbow = rainbowize_new(opts);
+    if (!rainbow) return false;
+    ColrRainbow_set_pos(rainbow, chunk->offset, chunk->chars);
+    FILE* out = open_memstream(&chunk->out, &chunk->out_len);
+    if (!out) {
+        ColrRainbow_free(rainbow);
+        return false;
+    }
+    ColrRainbow_feed(rainbow, out, chunk->text, chunk->length);
+    bool is_last = (chunk->offset + chunk->length) == opts->text_len;
+    // Bytes left from an invalid character at the end of the text.
+    if (is_last) ColrRainbow_flush(rainbow, out);
+    ColrRainbow_free(rainbow);
+    if (is_last && !rainbowize_chunk_finish(out, &chunk->out, &chunk->out_len)) {
+        fclose(out);
+        return false;
+    }
+    return fclose(out) == 0;
+}
+
+/*! Write the reset codes and newline for the last chunk of rainbowize_jobs(),
+    the same way rainbowize() and main() would for the whole text.
+
+    \details
+    Both resets (from _rainbow() and ColorText_to_str()) go before any
+    trailing newlines, and a newline is added if there isn't one.
+    The chunk may contain null bytes, so nothing here uses `strlen()`.
+
+    \pi out     The open memstream for the chunk, after all of it's text.
+    \pi buffer  The memstream's buffer pointer.
+    \pi length  The memstream's length pointer.
+    \return     `true` on success, or `false` if the memstream fails.
+*/
+bool rainbowize_chunk_finish(FILE* out, char** buffer, size_t* length) {
+    if (fflush(out) != 0) return false;
+    const char* text = *buffer;
+    size_t text_len = *length;
+    size_t newlines = 0;
+    while ((newlines < text_len) && (text[text_len - newlines - 1] == '\n')) newlines++;
+    size_t reset_len = CODE_RESET_LEN - 1;
+    bool ends_with_reset = (
+        (text_len >= reset_len) &&
+        (memcmp(text + text_len - reset_len, CODE_RESET_ALL, reset_len) == 0)
+    );
+    if (newlines) {
+        // The resets overwrite the newlines, which are written after them.
+        if (fseeko(out, (off_t)(text_len - newlines), SEEK_SET) != 0) return false;
+        fwrite(CODE_RESET_ALL CODE_RESET_ALL, 1, reset_len * 2, out);
+        for (size_t i = 0; i < newlines; i++) fputc('\n', out);
+    } else if (ends_with_reset) {
+        // Already reset, it only needs a newline.
+        bool has_newline = (text_len > reset_len) && (text[text_len - reset_len - 1] == '\n');
+        if (!has_newline) fputc('\n', out);
+    } else {
+        fwrite(CODE_RESET_ALL "\n", 1, reset_len + 1, out);
+    }
+    return !ferror(out);
+}
+
+/*! Rainbowize `opts->text` with `opts->jobs` threads, and return an exit
+    status code.
+
+    \details
+    The output is the same as rainbowize() produces for valid text, when it is
+    printed by main(). Like rainbowize_stream(), invalid multibyte characters
+    are written one byte at a time.
+
+    \pi opts Pointer to ColrOpts to get the text/rainbow options from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`.
+*/
+int rainbowize_jobs(ColrOpts* opts) {
+    if (!(opts->text && opts->text_len)) {
+        printferr("No text to work with.\n");
+        return EXIT_FAILURE;
+    }
+    // Any fore/back/style codes that were not rainbowized come first.
+    char* codes = ColorText_to_esc(
+        (ColorText){.fore=opts->fore, .back=opts->back, .style=opts->style}
+    );
+    if (!codes) {
+        printferr("\nFailed to allocate for rainbow!\n");
+        return EXIT_FAILURE;
+    }
+    out_puts(opts->out_stream, codes);
+    free(codes);
+    ColrJobs jobs;
+    bool ok = (
+        ColrJobs_init(&jobs, opts, rainbowize_chunk, ColrJobs_write_chunk) &&
+        ColrJobs_run(&jobs)
+    );
+    ColrJobs_free(&jobs);
+    if (!ok) {
+        printferr("\nFailed to create rainbow!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/*! Create a ColrRainbow for streaming, using the rainbow options.
+
+    \pi opts Pointer to ColrOpts to get the rainbow options from.
+    \return  An allocated ColrRainbow, or `NULL` if allocation failed.
+*/
+ColrRainbow* rainbowize_new(ColrOpts* opts) {
+    bool do_term_rainbow = opts->rainbow_term || !colr_supports_rgb_static();
+    RGB_fmter fmter = (
+        do_term_rainbow ?
+            (opts->rainbow_fore ? format_fg_RGB_term : format_bg_RGB_term) :
+            (opts->rainbow_fore ? format_fg_RGB : format_bg_RGB)
+    );
+    return ColrRainbow_new(
+        fmter,
+        opts->rainbow_freq,
+        opts->rainbow_offset,
+        opts->rainbow_spread
+    );
+}
+
+/*! Rainbowize stdin as it is read, and return an exit status code.
+
+    \details
+    Each chunk is written (and flushed) as soon as it is read, so memory use
+    does not grow with the input, and `tail -f` output shows up line by line.
+    The output is the same as rainbowize() would produce for the whole input.
+
+    \pi opts Pointer to ColrOpts to get the rainbow options from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`.
+*/
+int rainbowize_stream(ColrOpts* opts) {
+    ColrRainbow* rainbow = rainbowize_new(opts);
+    // Any fore/back/style codes that were not rainbowized come first.
+    char* codes = ColorText_to_esc(
+        (ColorText){.fore=opts->fore, .back=opts->back, .style=opts->style}
+    );
+    if (!(rainbow && codes)) {
+        ColrRainbow_free(rainbow);
+        free(codes);
+        printferr("\nFailed to allocate for rainbow!\n");
+        return EXIT_FAILURE;
+    }
+    if (isatty(fileno(stdin)) && isatty(fileno(stderr))) {
+        printferr("\nReading from stdin until EOF (Ctrl + D)...\n");
+    }
+    char buffer[CT_READ_SIZE];
+    size_t total = 0;
+    char last_char = '\0';
+    ssize_t length;
+    while ((length = read(fileno(stdin), buffer, sizeof(buffer))) != 0) {
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (!total) out_puts(opts->out_stream, codes);
+        ColrRainbow_feed(rainbow, opts->out_stream, buffer, (size_t)length);
+        out_flush(opts->out_stream);
+        total += (size_t)length;
+        last_char = buffer[length - 1];
+    }
+    free(codes);
+    if (!total) {
+        ColrRainbow_free(rainbow);
+        printferr("No text to work with.\n");
+        return EXIT_FAILURE;
+    }
+    ColrRainbow_finish(rainbow, opts->out_stream);
+    ColrRainbow_free(rainbow);
+    if (last_char != '\n') {
+        // Add a newline, for prettier output.
+        out_putc(opts->out_stream, '\n');
+    }
+    return EXIT_SUCCESS;
+}
+
 /*! Read file data and return an allocated string.
+
+    \details
+    The buffer doubles in size as needed, so this takes linear time.
+
+    \pi fp The file to read. It is closed when done, unless it is `stdin`.
+    \return An allocated string with the file data, or `NULL` if there was no
+            data, or on error (possibly with an error message printed).
 */
 char* read_file(FILE* fp) {
-    size_t line_length = 1024;
-    char line[line_length];
-    size_t buffer_length = line_length;
-    char* buffer = NULL;
+    size_t buffer_length = 4096;
     size_t total = 0;
-    while ((fgets(line, line_length, fp))) {
-        total += strlen(line);
-        if (!buffer) {
-            // First line.
-            buffer = calloc(buffer_length, sizeof(char));
-        } else if (total >= buffer_length) {
-            buffer_length *= 3;
-            buffer = realloc(buffer, buffer_length);
-            if (!buffer) {
-                printferr("Failed to reallocate for file data!\n");
-                return NULL;
-            }
+    char* buffer = malloc(buffer_length);
+    if (!buffer) {
+        if (fp != stdin) fclose(fp);
+        printferr("Failed to allocate for file data!\n");
+        return NULL;
+    }
+    size_t count;
+    // Always room for the null-terminator.
+    while ((count = fread(buffer + total, 1, buffer_length - total - 1, fp))) {
+        total += count;
+        if ((buffer_length - total) > 1) continue;
+        buffer_length *= 2;
+        char* tmp = realloc(buffer, buffer_length);
+        if (!tmp) {
+            free(buffer);
+            if (fp != stdin) fclose(fp);
+            printferr("Failed to reallocate for file data!\n");
+            return NULL;
         }
-        strcat(buffer, line);
+        buffer = tmp;
     }
-    if (ferror(fp)) {
+    bool failed = ferror(fp);
+    if (fp != stdin) fclose(fp);
+    if (failed) {
+        free(buffer);
         perror("Cannot read file");
         return NULL;
     }
-    if (fp != stdin) fclose(fp);
+    if (!total) {
+        free(buffer);
+        return NULL;
+    }
+    buffer[total] = '\0';
     return buffer;
 }
+
 /*! Read file data, and return an allocated string.
 
     \pi filepath The file path to read.
@@ -1180,8 +2337,180 @@ int run_colr_cmd(colr_tool_cmd func, ColrOpts* opts) {
     int ret = func(opts);
     ColrOpts_free_text(opts);
     ColrOpts_free_args(opts);
-    return ret;
+    return out_finish(opts->out_stream, ret);
+}
+/*! Colorize, justify, or strip stdin line by line, as it is read, and return
+    an exit status code.
+
+    \details
+    Only the lines from the last read are kept in memory, and the output is
+    flushed before waiting for more input, so `tail -f` output shows up right
+    away. Justification is done for each line, instead of the text as a whole.
+
+    \pi opts Pointer to ColrOpts to get the text options from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`.
+*/
+int stream_text(ColrOpts* opts) {
+    bool do_colr = !(opts->is_disabled || opts->strip_codes);
+    bool do_rainbow = do_colr && (opts->rainbow_fore || opts->rainbow_back);
+    // Unjustified text only needs the codes once, at the start.
+    char* codes = NULL;
+    if (do_colr && (opts->just.method == JUST_NONE)) {
+        codes = ColorText_to_esc(
+            (ColorText){.fore=opts->fore, .back=opts->back, .style=opts->style}
+        );
+        if (!codes) {
+            printferr("\nFailed to allocate for escape codes!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    ColrRainbow* rainbow = do_rainbow ? rainbowize_new(opts) : NULL;
+    if (do_rainbow && !rainbow) {
+        free(codes);
+        printferr("\nFailed to allocate for rainbow!\n");
+        return EXIT_FAILURE;
+    }
+    if (isatty(fileno(stdin)) && isatty(fileno(stderr))) {
+        printferr("\nReading from stdin until EOF (Ctrl + D)...\n");
+    }
+    // Lines are split from whatever input is available. A partial line is
+    // kept at the start of the buffer until the rest of it is read.
+    size_t buffer_cap = CT_READ_SIZE;
+    char* buffer = malloc(buffer_cap);
+    size_t buffer_len = 0;
+    size_t total = 0;
+    char last_char = '\0';
+    bool success = buffer != NULL;
+    while (success) {
+        // Everything that was processed is written before waiting for more input.
+        out_flush(opts->out_stream);
+        if ((buffer_cap - buffer_len) < CT_READ_SIZE) {
+            // A long line, with no newline yet.
+            char* tmp = realloc(buffer, buffer_cap * 2);
+            if (!tmp) {
+                success = false;
+                break;
+            }
+            buffer = tmp;
+            buffer_cap *= 2;
+        }
+        // Always room for the null-terminator.
+        ssize_t count = read(fileno(stdin), buffer + buffer_len, buffer_cap - buffer_len - 1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        } else if (count == 0) {
+            break;
+        }
+        if (!total && codes) out_puts(opts->out_stream, codes);
+        total += (size_t)count;
+        buffer_len += (size_t)count;
+        last_char = buffer[buffer_len - 1];
+        size_t start = 0;
+        char* newline;
+        while (success && (newline = memchr(buffer + start, '\n', buffer_len - start))) {
+            size_t end = (size_t)(newline - buffer);
+            buffer[end] = '\0';
+            success = stream_text_line(opts, rainbow, buffer + start, end - start);
+            out_putc(opts->out_stream, '\n');
+            start = end + 1;
+        }
+        buffer_len -= start;
+        memmove(buffer, buffer + start, buffer_len);
+    }
+    if (success && buffer_len) {
+        // The last line, with no newline.
+        buffer[buffer_len] = '\0';
+        success = stream_text_line(opts, rainbow, buffer, buffer_len);
+    }
+    free(buffer);
+    // Unjustified colors are reset once, at the end.
+    bool needs_reset = (codes != NULL);
+    free(codes);
+    if (!success) {
+        ColrRainbow_free(rainbow);
+        printferr("\nFailed to allocate for line!\n");
+        return EXIT_FAILURE;
+    }
+    if (!total) {
+        ColrRainbow_free(rainbow);
+        printferr("No text to work with.\n");
+        return EXIT_FAILURE;
+    }
+    if (needs_reset) {
+        if (rainbow) {
+            ColrRainbow_finish(rainbow, opts->out_stream);
+        } else {
+            out_puts(opts->out_stream, CODE_RESET_ALL);
+        }
+    }
+    ColrRainbow_free(rainbow);
+    if (last_char != '\n') {
+        // Add a newline, for prettier output.
+        out_putc(opts->out_stream, '\n');
+    }
+    return EXIT_SUCCESS;
+}
+
+/*! Colorize, justify, or strip a single line of text, and write it to
+    `opts->out_stream`, for stream_text().
+
+    \pi opts    Pointer to ColrOpts to get the text options from.
+    \pi rainbow A ColrRainbow to rainbowize with, or `NULL`.
+    \pi line    The line to write, without the newline.
+    \pi length  Length of `line`, in bytes.
+    \return     `true` on success, or `false` if allocation failed.
+*/
+bool stream_text_line(ColrOpts* opts, ColrRainbow* rainbow, const char* line, size_t length) {
+    if (opts->strip_codes) {
+        char* stripped = colr_str_strip_codes(line);
+        if (!stripped) return false;
+        out_puts(opts->out_stream, stripped);
+        free(stripped);
+        return true;
+    }
+    if (opts->is_disabled) {
+        out_write(opts->out_stream, line, length);
+        return true;
+    }
+    if (opts->just.method == JUST_NONE) {
+        // The codes were already written, and the reset comes at the end.
+        if (rainbow) {
+            // Bytes left from an invalid character don't carry over to the next line.
+            return (
+                ColrRainbow_feed(rainbow, opts->out_stream, line, length) &&
+                ColrRainbow_flush(rainbow, opts->out_stream)
+            );
+        }
+        out_write(opts->out_stream, line, length);
+        return true;
+    }
+    // Each line is colorized and justified on it's own.
+    char* rainbowized = NULL;
+    if (rainbow) {
+        size_t rainbowized_len = 0;
+        FILE* rainbow_out = open_memstream(&rainbowized, &rainbowized_len);
+        if (!rainbow_out) return false;
+        ColrRainbow_feed(rainbow, rainbow_out, line, length);
+        // Bytes left from an invalid character are justified with this line.
+        ColrRainbow_flush(rainbow, rainbow_out);
+        fclose(rainbow_out);
+        if (!rainbowized) return false;
+    }
+    char* justified = ColorText_to_str((ColorText){
+        .text=rainbowized ? rainbowized : (char*)line,
+        .fore=opts->fore,
+        .back=opts->back,
+        .style=opts->style,
+        .just=opts->just,
+    });
+    free(rainbowized);
+    if (!justified) return false;
+    out_puts(opts->out_stream, justified);
+    free(justified);
+    return true;
 }
+
 /*! Strip escape codes from `opts->text` and return an exit status code.
 
     \pi opts Pointer to ColrOpts to get the text from.
@@ -1191,28 +2520,79 @@ int strip_codes(ColrOpts* opts) {
     if (!opts->text) {
         printferr("\nNo text to strip!\n");
         return EXIT_FAILURE;
-    } else if (opts->text[0] == '\0') {
+    } else if (!opts->text_len) {
         printferr("\nText was empty!\n");
         return EXIT_FAILURE;
     }
-    char* stripped = colr_str_strip_codes(opts->text);
-    if (!stripped) {
-        printferr("\nFailed to create stripped text!\n");
+    // The text spans are written in place, nothing is copied.
+    ColrTokenIter iter = ColrTokenIter_new_n(opts->text, opts->text_len);
+    ColrToken token;
+    char last_char = '\0';
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_TEXT) continue;
+        out_write(opts->out_stream, token.start, token.length);
+        last_char = token.start[token.length - 1];
+    }
+    if (last_char != '\n') {
+        // Add a newline, for prettier output.
+        out_putc(opts->out_stream, '\n');
+    }
+    return EXIT_SUCCESS;
+}
+
+/*! Strip escape codes from a chunk of text, for strip_codes_jobs().
+
+    \pi jobs  The ColrJobs that the chunk belongs to.
+    \po chunk The chunk to process. `chunk->out` is set to the stripped text.
+    \return   `true` on success, or `false` if allocation failed.
+*/
+bool strip_codes_chunk(ColrJobs* jobs, ColrChunk* chunk) {
+    (void)jobs; // Unused.
+    // The stripped text is never longer than the original.
+    chunk->out = malloc(chunk->length);
+    if (!chunk->out) return false;
+    ColrTokenIter iter = ColrTokenIter_new_n(chunk->text, chunk->length);
+    ColrToken token;
+    while (ColrTokenIter_next(&iter, &token)) {
+        if (token.type != TOKEN_TEXT) continue;
+        memcpy(chunk->out + chunk->out_len, token.start, token.length);
+        chunk->out_len += token.length;
+    }
+    return true;
+}
+
+/*! Strip escape codes from `opts->text` with `opts->jobs` threads, and
+    return an exit status code.
+
+    \details
+    The output is the same as strip_codes().
+
+    \pi opts Pointer to ColrOpts to get the text from.
+    \return  `EXIT_SUCCESS` on success, otherwise `EXIT_FAILURE`
+*/
+int strip_codes_jobs(ColrOpts* opts) {
+    if (!opts->text) {
+        printferr("\nNo text to strip!\n");
+        return EXIT_FAILURE;
+    } else if (!opts->text_len) {
+        printferr("\nText was empty!\n");
         return EXIT_FAILURE;
-    } else if (stripped[0] == '\0') {
-        // Empty string was given.
-        free(stripped);
-        fprintf(opts->out_stream, "\n");
-        return EXIT_SUCCESS;
     }
-    size_t length = strlen(stripped);
-    if (stripped[length - 1] == '\n') {
-        fprintf(opts->out_stream, "%s", stripped);
-    } else {
+    ColrJobs jobs;
+    bool ok = (
+        ColrJobs_init(&jobs, opts, strip_codes_chunk, ColrJobs_write_chunk) &&
+        ColrJobs_run(&jobs)
+    );
+    char last_char = jobs.last_char;
+    ColrJobs_free(&jobs);
+    if (!ok) {
+        printferr("\nFailed to strip codes!\n");
+        return EXIT_FAILURE;
+    }
+    if (last_char != '\n') {
         // Add a newline, for prettier output.
-        fprintf(opts->out_stream, "%s\n", stripped);
+        out_putc(opts->out_stream, '\n');
     }
-    free(stripped);
     return EXIT_SUCCESS;
 }
 
@@ -1242,12 +2622,12 @@ int translate_code(ColrOpts* opts) {
     // Use the user's color to build a ColorArg.
     ColorArg* carg = fore(opts->text);
     if (!validate_color_arg(*carg, opts->text)) {
-        free(carg);
+        ColorArg_free(carg);
         return EXIT_FAILURE;
     }
     // dbug_repr("Using ColorArg", *carg);
     ColorValue cval = carg->value;
-    free(carg);
+    ColorArg_free(carg);
     BasicValue bval = cval.basic;
     ExtendedValue eval = cval.ext;
     RGB rgbval = cval.rgb;
@@ -1331,8 +2711,14 @@ int translate_code(ColrOpts* opts) {
     free(rgblbl);
     free(hexlbl);
     // Always use the ExtendedValue.
-    colr_print(Colr("●", fore(ext(eval))));
-    printf(" - %s\n", transtr);
+    char* dot = colr_cat(Colr("●", fore(ext(eval))));
+    if (dot) {
+        out_puts(stdout, dot);
+        free(dot);
+    }
+    out_puts(stdout, " - ");
+    out_puts(stdout, transtr);
+    out_putc(stdout, '\n');
     free(transtr);
     return EXIT_SUCCESS;
 }
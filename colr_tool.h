@@ -17,12 +17,16 @@
     #define _GNU_SOURCE
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <locale.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -46,9 +50,35 @@
 //! Default 'spread' for rainbowize (width for each rainbow color).
 #define CT_DEFAULT_SPREAD 1
 
+//! Maximum number of threads for --jobs.
+#define CT_MAX_JOBS 256
+//! Number of chunks for each thread with --jobs, so busy threads can catch up.
+#define CT_CHUNKS_PER_JOB 4
+//! Minimum size for each chunk of text with --jobs.
+#define CT_MIN_CHUNK_SIZE (64 * 1024)
+//! Maximum size for each chunk of text with --jobs, to limit memory use (rainbows are ~20x larger).
+#define CT_MAX_CHUNK_SIZE (1024 * 1024)
+
+//! Size of the buffer for output streams, from out_init().
+#define CT_OUT_BUFFER_SIZE (256 * 1024)
+//! Number of bytes to read from stdin at a time, when streaming.
+#define CT_READ_SIZE (64 * 1024)
+
 //! Short-hand for (x ? "true" : "false")
 #define bool_str(x) (x ? "true" : "false")
 
+/*! \def color_arg_str
+    Like just_arg_str(), for the colr tool argument that set FORE or BACK.
+    \pi opts    A ColrOpts pointer.
+    \pi is_back Whether to check BACK, instead of FORE.
+*/
+#define color_arg_str(opts, is_back) ( \
+        ((opts)->gradient_count && ((opts)->gradient_back == (is_back))) ? \
+            ((is_back) ? "--gradientbg" : "--gradient") : \
+        ((is_back) ? (opts)->rainbow_back : (opts)->rainbow_fore) ? "--rainbow" : \
+        ((is_back) ? "--back" : "--fore") \
+    )
+
 /*! \def just_arg_str
     Like ColorJustifyMethod_repr(), but for colr tool arguments.
     \pi x A ColorJustify.
@@ -143,6 +173,10 @@ typedef struct ColrOpts_s {
     ColorArg* back;
     ColorArg* style;
     ColorJustify just;
+    // Length of the text. Mapped text is not null-terminated, so this must be used.
+    size_t text_len;
+    // Whether the text is a memory-mapped file, that must be unmapped instead of free'd.
+    bool text_mapped;
     // A file path to read text from.
     const char* filepath;
     // Whether to free the ColrOpts.text member when exiting.
@@ -158,6 +192,18 @@ typedef struct ColrOpts_s {
     double rainbow_freq;
     size_t rainbow_offset;
     size_t rainbow_spread;
+    // Whether to rainbowize stdin as it is read, instead of reading it all.
+    bool rainbow_stream;
+    // Whether to process stdin line by line as it is read, instead of reading it all.
+    bool stream;
+    // Number of threads for processing the text, from --jobs.
+    size_t jobs;
+    // Gradient opts.
+    RGB gradient_stops[COLR_GRADIENT_MAX_STOPS];
+    size_t gradient_count;
+    bool gradient_back;
+    bool gradient_vertical;
+    ColrGradientSpace gradient_space;
     // Non-colorizing options.
     bool auto_disable;
     bool is_disabled;
@@ -166,10 +212,72 @@ typedef struct ColrOpts_s {
     bool list_unique_codes;
     bool strip_codes;
     bool translate_code;
+    // Highlighting rules, from --highlight.
+    ColrHighlighter* highlighter;
 } ColrOpts;
 
 typedef int (*colr_tool_cmd)(ColrOpts* opts);
 
+//! A chunk of `ColrOpts.text`, processed by one of the --jobs threads.
+typedef struct ColrChunk_s {
+    // Text for this chunk, pointing into ColrOpts.text. It is not null-terminated.
+    const char* text;
+    size_t length;
+    // Byte offset of the chunk in ColrOpts.text.
+    size_t offset;
+    // Number of characters before the chunk, for rainbow spreads.
+    size_t chars;
+    // Output for the chunk, written in order.
+    char* out;
+    size_t out_len;
+    // ColorArgs found in the chunk, for --listcodes --unique.
+    ColorArg** cargs;
+    // Number of items (escape codes) in the output.
+    size_t items;
+    // Whether the chunk was processed, and whether that failed.
+    bool done;
+    bool failed;
+} ColrChunk;
+
+struct ColrJobs_s;
+typedef bool (*colr_job_func)(struct ColrJobs_s* jobs, ColrChunk* chunk);
+
+//! Work queue for --jobs. Chunks are processed by threads, and written in order.
+typedef struct ColrJobs_s {
+    ColrOpts* opts;
+    ColrChunk* chunks;
+    size_t count;
+    // Processes a chunk, on one of the worker threads.
+    colr_job_func work;
+    // Writes a processed chunk, in order, on the main thread.
+    colr_job_func write;
+    // Index of the next chunk to process.
+    size_t next;
+    // Number of chunks that have been written.
+    size_t written;
+    // Maximum number of processed chunks waiting to be written.
+    size_t window;
+    // Whether processing stopped early, because of an error.
+    bool failed;
+    // Last character written, for the final newline.
+    char last_char;
+    // Total number of items written.
+    size_t items;
+    // ColorArgs that have been listed, for --listcodes --unique.
+    ColorArg* cargs;
+    size_t carg_count;
+    // Guards everything above, while threads are running.
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} ColrJobs;
+
+void ColrJobs_free(ColrJobs* jobs);
+bool ColrJobs_init(ColrJobs* jobs, ColrOpts* opts, colr_job_func work, colr_job_func write);
+bool ColrJobs_run(ColrJobs* jobs);
+void* ColrJobs_worker(void* arg);
+bool ColrJobs_write_chunk(ColrJobs* jobs, ColrChunk* chunk);
+
+bool ColrOpts_can_map(ColrOpts* opts);
 void ColrOpts_cleanup(ColrOpts* opts);
 void ColrOpts_free_args(ColrOpts* opts);
 void ColrOpts_free_text(ColrOpts* opts);
@@ -177,14 +285,35 @@ ColrOpts ColrOpts_new(void);
 char* ColrOpts_repr(ColrOpts opts);
 bool ColrOpts_set_disabled(ColrOpts* opts);
 bool ColrOpts_set_text(ColrOpts* opts);
+bool ColrOpts_use_rainbow_jobs(ColrOpts* opts);
 
+int colorize_mapped(ColrOpts* opts);
+size_t count_chars(const char* s, size_t length);
 bool dir_exists(const char* dirpath);
+bool fd_is_file(int fd);
 bool file_exists(const char* filepath);
+size_t find_chunk_end(const char* text, size_t length, size_t start, size_t target);
+ColorText* gradientize(ColrOpts* opts);
+int highlight_text(ColrOpts* opts);
 int list_codes(ColrOpts* opts);
+bool list_codes_chunk(ColrJobs* jobs, ColrChunk* chunk);
+int list_codes_jobs(ColrOpts* opts);
+bool list_codes_write(ColrJobs* jobs, ColrChunk* chunk);
+char* map_file(int fd, size_t* length);
+char* map_file_arg(const char* filepath, size_t* length);
+int out_finish(FILE* fp, int ret);
+bool out_flush(FILE* fp);
+bool out_init(FILE* fp);
+FILE* out_open_err(void);
+void out_putc(FILE* fp, char c);
+void out_puts(FILE* fp, const char* s);
+bool out_write(FILE* fp, const char* s, size_t length);
 int parse_arg_char(char** argv, const char* long_name, const char c, ColrOpts* opts);
 int parse_arg_long(const char* long_name, ColrOpts* opts);
 int parse_args(int argc, char** argv, ColrOpts* opts);
 bool parse_double_arg(const char* s, double* value);
+bool parse_gradient_arg(const char* s, bool do_back, ColrOpts* opts);
+bool parse_highlight_arg(const char* s, ColrOpts* opts);
 bool parse_int_arg(const char* s, int* value);
 bool parse_size_arg(const char* s, size_t* value);
 int print_256(ColrOpts* opts, bool do_back);
@@ -198,11 +327,20 @@ int print_usage(const char* reason);
 int print_usage_full(void);
 int print_version(void);
 ColorText* rainbowize(ColrOpts* opts);
+bool rainbowize_chunk(ColrJobs* jobs, ColrChunk* chunk);
+bool rainbowize_chunk_finish(FILE* out, char** buffer, size_t* length);
+int rainbowize_jobs(ColrOpts* opts);
+ColrRainbow* rainbowize_new(ColrOpts* opts);
+int rainbowize_stream(ColrOpts* opts);
 char* read_file(FILE* fp);
 char* read_file_arg(const char* filepath);
 char* read_stdin_arg(void);
 int run_colr_cmd(colr_tool_cmd func, ColrOpts* opts);
+int stream_text(ColrOpts* opts);
+bool stream_text_line(ColrOpts* opts, ColrRainbow* rainbow, const char* line, size_t length);
 int strip_codes(ColrOpts* opts);
+bool strip_codes_chunk(ColrJobs* jobs, ColrChunk* chunk);
+int strip_codes_jobs(ColrOpts* opts);
 void strip_nl(char* s);
 int translate_code(ColrOpts* opts);
 bool validate_color_arg(ColorArg carg, const char* name);
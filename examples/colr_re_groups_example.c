@@ -0,0 +1,43 @@
+#include "colr.h"
+
+int main(void) {
+    /*
+        Every capture group in the pattern can have it's own color.
+        All groups are colorized in one pass over the string.
+    */
+
+    // The string we are modifying.
+    char* mystring = "name=colr, version=0.4.0, license=GPL";
+    char* pattern = "([a-z]+)=([^,]+)";
+
+    /*
+        Keys in blue, values in green.
+    */
+    char* colorized = colr_re_groups(mystring, pattern, 0, fore(BLUE), fore(GREEN));
+    if (!colorized) return EXIT_FAILURE;
+    puts(colorized);
+    free(colorized);
+
+    /*
+        ColorTexts can set the fore, back, and style for a group.
+        Their text is not used.
+    */
+    colorized = colr_re_groups(
+        mystring,
+        pattern,
+        0,
+        Colr("", fore(YELLOW), style(BRIGHT)),
+        Colr("", fore(RED), back(WHITE))
+    );
+    if (!colorized) return EXIT_FAILURE;
+    puts(colorized);
+    free(colorized);
+
+    /*
+        Use NULL to leave a group alone.
+    */
+    colorized = colr_re_groups(mystring, pattern, 0, NULL, fore(CYAN));
+    if (!colorized) return EXIT_FAILURE;
+    puts(colorized);
+    free(colorized);
+}
@@ -515,6 +515,75 @@ subdesc(ColorArgs_array_repr) {
         ColorArgs_array_free(lst);
     }
 }
+subdesc(ColorArgs_from_esc_s) {
+    it("handles invalid esc-codes") {
+        ColorArg cargs[2];
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, NULL, 0), 0);
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "", 0), 0);
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "test", 4), 0);
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "\x1b[31", 4), 0);
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "\x1b[2A", 4), 0);
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "\x1b[xm", 4), 0);
+        // Bytes >= 0x80 are not digits.
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "\x1b[\xb2\xb3m", 5), 0);
+        // Not enough length to reach the 'm'.
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "\x1b[31m", 4), 0);
+        // Unknown parameters and bad ranges are still counted.
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, "\x1b[165m", 6), 1);
+        assert_is_invalid(cargs[0]);
+        assert_colr_eq_repr(cargs[0].type, ARGTYPE_NONE, cargs[0]);
+        char* s = "\x1b[38;5;257;48;2;1;2;300m";
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, s, strlen(s)), 2);
+        assert_colr_eq_repr(cargs[0].value.type, TYPE_INVALID_EXT_RANGE, cargs[0]);
+        assert_colr_eq_repr(cargs[1].value.type, TYPE_INVALID_RGB_RANGE, cargs[1]);
+        // Incomplete extended colors.
+        s = "\x1b[1;38;5m";
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, s, strlen(s)), 2);
+        assert_colr_eq_repr(cargs[0], style_arg(BRIGHT), cargs[0]);
+        assert_is_invalid(cargs[1]);
+    }
+    it("parses combined esc-codes") {
+        struct {
+            char* s;
+            ColorArg expected[4];
+            size_t count;
+        } tests[] = {
+            {"\x1b[m", {style_arg(RESET_ALL)}, 1},
+            {"\x1b[;31m", {style_arg(RESET_ALL), fore_arg(RED)}, 2},
+            {"\x1b[1;31;47m", {style_arg(BRIGHT), fore_arg(RED), back_arg(WHITE)}, 3},
+            {"\x1b[91;104m", {fore_arg(LIGHTRED), back_arg(LIGHTBLUE)}, 2},
+            {"\x1b[39;49;0m", {fore_arg(RESET), back_arg(RESET), style_arg(RESET_ALL)}, 3},
+            {
+                "\x1b[1;38;5;208;48;2;1;2;3m",
+                {style_arg(BRIGHT), fore_arg(ext(208)), back_arg(rgb(1, 2, 3))},
+                3
+            },
+            {"\x1b[38:5:208m", {fore_arg(ext(208))}, 1},
+            {"\x1b[48:2:1:2:3m", {back_arg(rgb(1, 2, 3))}, 1},
+            {"\x1b[48:2::1:2:3m", {back_arg(rgb(1, 2, 3))}, 1},
+            // Underline colors are skipped.
+            {"\x1b[4;58;5;9;31m", {style_arg(UNDERLINE), fore_arg(RED)}, 2},
+            // Trailing characters are ignored.
+            {"\x1b[4mtest", {style_arg(UNDERLINE)}, 1},
+        };
+        for_each(tests, i) {
+            ColorArg cargs[4];
+            size_t count = ColorArgs_from_esc_s(cargs, 4, tests[i].s, strlen(tests[i].s));
+            assert_size_eq_repr(count, tests[i].count, tests[i].s);
+            for (size_t j = 0; j < count; j++) {
+                assert_colr_eq_repr(cargs[j], tests[i].expected[j], tests[i].s);
+            }
+        }
+    }
+    it("counts without a destination") {
+        char* s = "\x1b[1;4;31;47m";
+        assert_size_eq(ColorArgs_from_esc_s(NULL, 0, s, strlen(s)), 4);
+        ColorArg cargs[2];
+        assert_size_eq(ColorArgs_from_esc_s(cargs, 2, s, strlen(s)), 4);
+        assert_colr_eq_repr(cargs[0], style_arg(BRIGHT), cargs[0]);
+        assert_colr_eq_repr(cargs[1], style_arg(UNDERLINE), cargs[1]);
+    }
+}
 subdesc(ColorArgs_from_str) {
     it("handles NULL") {
         bool do_unique = false;
@@ -546,5 +615,39 @@ subdesc(ColorArgs_from_str) {
         assert_size_eq_repr(ColorArgs_array_len(cargs), 4, cargs);
         ColorArgs_array_free(cargs);
     }
+    it("uses a length with ColorArgs_from_str_n") {
+        char* escstr = "\x1b[4m\x1b[31mtest\x1b[0m";
+        assert_null(ColorArgs_from_str_n(escstr, 0, false));
+        assert_null(ColorArgs_from_str_n(NULL, 4, false));
+        // Cut-off codes are not included.
+        ColorArg** cargs = ColorArgs_from_str_n(escstr, 8, false);
+        assert_size_eq_repr(ColorArgs_array_len(cargs), 1, cargs);
+        assert_ColorArgs_array_contains(cargs, style_arg(UNDERLINE));
+        ColorArgs_array_free(cargs);
+        cargs = ColorArgs_from_str_n(escstr, 13, false);
+        assert_size_eq_repr(ColorArgs_array_len(cargs), 2, cargs);
+        assert_ColorArgs_array_contains(cargs, fore_arg(RED));
+        ColorArgs_array_free(cargs);
+    }
+    it("handles combined escape codes") {
+        char* escstr = "\x1b[1;38;5;208;48;2;1;2;3mtest\x1b[2A\x1b[1;31mtest\x1b[0m";
+        ColorArg expected[] = {
+            style_arg(BRIGHT),
+            fore_arg(ext(208)),
+            back_arg(rgb(1, 2, 3)),
+            fore_arg(RED),
+            style_arg(RESET_ALL),
+        };
+        ColorArg** cargs = ColorArgs_from_str(escstr, false);
+        for_each(expected, i) {
+            assert_ColorArgs_array_contains(cargs, expected[i]);
+        }
+        assert_size_eq_repr(ColorArgs_array_len(cargs), 6, cargs);
+        ColorArgs_array_free(cargs);
+
+        cargs = ColorArgs_from_str(escstr, true);
+        assert_size_eq_repr(ColorArgs_array_len(cargs), 5, cargs);
+        ColorArgs_array_free(cargs);
+    }
 }
 } // describe(ColorArgs)
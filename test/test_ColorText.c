@@ -160,6 +160,8 @@ subdesc(ColorText_length) {
             {Colr_ljust("test", 0, NULL), ts.columns + 1},
             {Colr_rjust("test", 0, NULL), ts.columns + 1},
             {Colr_center("test", 0, NULL), ts.columns + 1},
+            // Wide chars use 2 columns: 12 bytes, 8 columns, 2 pad chars.
+            {Colr_ljust("１３３７", 10, NULL), 15},
         };
 
         for_each(just_tests, i) {
@@ -235,6 +237,21 @@ subdesc(ColorText_set_values) {
 
     }
 }
+subdesc(ColorText_to_esc) {
+    it("creates escape-codes without text") {
+        ColorText ctext = Colra("test", NULL);
+        char* nocodes = ColorText_to_esc(ctext);
+        assert_str_eq(nocodes, "", "Should be an empty string!");
+        free(nocodes);
+        ColorText_free_args(&ctext);
+
+        ColorText* p = Colr("test", fore(RED), back(WHITE), style(BRIGHT));
+        char* codes = ColorText_to_esc(*p);
+        assert_str_eq(codes, "\x1b[1m\x1b[31m\x1b[47m", "Codes are wrong or out of order.");
+        free(codes);
+        ColorText_free(p);
+    }
+}
 subdesc(ColorText_to_ptr) {
     it("allocates a ColorText") {
         ColorText ctext = Colra("test", fore(RED));
@@ -0,0 +1,210 @@
+/* Tests for the ColrGradient struct and the gradient functions.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+describe(ColrGradient) {
+subdesc(ColrGradient_new) {
+    it("handles NULL/bad stops") {
+        RGB stops[COLR_GRADIENT_MAX_STOPS + 1] = {{0}};
+        assert_null(ColrGradient_new(NULL, GRADIENT_OKLAB, stops, 2));
+        assert_null(ColrGradient_new(format_fg_RGB, GRADIENT_OKLAB, NULL, 2));
+        assert_null(ColrGradient_new(format_fg_RGB, GRADIENT_OKLAB, stops, 0));
+        assert_null(ColrGradient_new(format_fg_RGB, GRADIENT_OKLAB, stops, array_length(stops)));
+        assert_null(ColrGradient_code(NULL, 0, NULL));
+        assert_false(ColrGradient_set_length(NULL, 1));
+        assert_colr_eq(ColrGradient_rgb(NULL, 0.5), rgb(0, 0, 0));
+        // Does nothing.
+        ColrGradient_free(NULL);
+    }
+}
+subdesc(ColrGradient_rgb) {
+    it("blends stops") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 255, 0), rgb(0, 0, 255)};
+        ColrGradientSpace spaces[] = {GRADIENT_LINEAR_RGB, GRADIENT_OKLAB};
+        for_each(spaces, i) {
+            ColrGradient* gradient = ColrGradient_new(format_fg_RGB, spaces[i], stops, array_length(stops));
+            assert_not_null(gradient);
+            // Stops are hit exactly, and positions are clamped.
+            assert_colr_eq(ColrGradient_rgb(gradient, -1.0), stops[0]);
+            assert_colr_eq(ColrGradient_rgb(gradient, 0.0), stops[0]);
+            assert_colr_eq(ColrGradient_rgb(gradient, 0.5), stops[1]);
+            assert_colr_eq(ColrGradient_rgb(gradient, 1.0), stops[2]);
+            assert_colr_eq(ColrGradient_rgb(gradient, 2.0), stops[2]);
+            ColrGradient_free(gradient);
+        }
+        // Grays stay gray, at the midpoint of each color space.
+        RGB grays[] = {rgb(0, 0, 0), rgb(255, 255, 255)};
+        struct {
+            ColrGradientSpace space;
+            unsigned char expected;
+        } tests[] = {
+            {GRADIENT_LINEAR_RGB, 188},
+            {GRADIENT_OKLAB, 99},
+        };
+        for_each(tests, i) {
+            ColrGradient* gradient = ColrGradient_new(format_fg_RGB, tests[i].space, grays, 2);
+            RGB expected = rgb(tests[i].expected, tests[i].expected, tests[i].expected);
+            assert_colr_eq(ColrGradient_rgb(gradient, 0.5), expected);
+            ColrGradient_free(gradient);
+        }
+    }
+    it("uses a single stop as a solid color") {
+        RGB stops[] = {rgb(1, 2, 3)};
+        ColrGradient* gradient = ColrGradient_new(format_fg_RGB, GRADIENT_OKLAB, stops, 1);
+        assert_colr_eq(ColrGradient_rgb(gradient, 0.0), stops[0]);
+        assert_colr_eq(ColrGradient_rgb(gradient, 0.7), stops[0]);
+        ColrGradient_free(gradient);
+    }
+}
+subdesc(ColrGradient_set_length) {
+    it("precomputes codes") {
+        RGB_fmter fmters[] = {
+            format_bg_RGB,
+            format_bg_RGB_term,
+            format_fg_RGB,
+            format_fg_RGB_term,
+        };
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255), rgb(255, 255, 0)};
+        size_t lengths[] = {1, 2, 7, 300};
+        for_each(fmters, i) {
+            ColrGradient* gradient = ColrGradient_new(fmters[i], GRADIENT_OKLAB, stops, array_length(stops));
+            // No ramp yet.
+            assert_null(ColrGradient_code(gradient, 0, NULL));
+            for (size_t j = 0; j < array_length(lengths); j++) {
+                assert(ColrGradient_set_length(gradient, lengths[j]));
+                assert_size_eq(gradient->length, lengths[j]);
+                char expected[CODE_RGB_LEN];
+                for (size_t index = 0; index < lengths[j]; index++) {
+                    double pos = (lengths[j] > 1) ? (double)index / (double)(lengths[j] - 1) : 0.0;
+                    fmters[i](expected, ColrGradient_rgb(gradient, pos));
+                    size_t length = 0;
+                    const char* code = ColrGradient_code(gradient, index, &length);
+                    assert_str_eq(code, expected, "Ramp code does not match.");
+                    assert_size_eq(length, strlen(expected));
+                }
+                // Past the end is the last code.
+                assert_str_eq(
+                    ColrGradient_code(gradient, lengths[j] + 5, NULL),
+                    ColrGradient_code(gradient, lengths[j] - 1, NULL),
+                    "Bad last code."
+                );
+            }
+            ColrGradient_free(gradient);
+        }
+    }
+}
+subdesc(_gradient) {
+    it("handles NULL/empty strings") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+        assert_null(_gradient(format_fg_RGB, NULL, GRADIENT_OKLAB, false, stops, 2));
+        assert_null(_gradient(format_fg_RGB, "", GRADIENT_OKLAB, false, stops, 2));
+        assert_null(_gradient(format_fg_RGB, "test", GRADIENT_OKLAB, false, stops, 0));
+    }
+    it("colors characters across lines") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+        char* s = gradient_fg("a\xc3\xa9z\nbc", stops, 2, false);
+        assert_not_null(s);
+        char* red = fore_str_static(rgb(255, 0, 0));
+        char* blue = fore_str_static(rgb(0, 0, 255));
+        ColrGradient* gradient = ColrGradient_new(format_fg_RGB, GRADIENT_OKLAB, stops, 2);
+        char middle[CODE_RGB_LEN];
+        format_fg_RGB(middle, ColrGradient_rgb(gradient, 0.5));
+        ColrGradient_free(gradient);
+        char* expected = NULL;
+        // Columns line up, so the short line does not reach the last color.
+        assert(asprintf(
+            &expected,
+            "%sa%s\xc3\xa9%sz\n%sb%sc" NC,
+            red, middle, blue, red, middle
+        ) > 0);
+        assert_str_eq(s, expected, "Horizontal gradient is wrong.");
+        free(expected);
+        free(s);
+    }
+    it("uses display columns for wide and zero-width characters") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+        char* red = fore_str_static(rgb(255, 0, 0));
+        char* blue = fore_str_static(rgb(0, 0, 255));
+        ColrGradient* gradient = ColrGradient_new(format_fg_RGB, GRADIENT_OKLAB, stops, 2);
+        char middle[CODE_RGB_LEN];
+        format_fg_RGB(middle, ColrGradient_rgb(gradient, 0.5));
+        ColrGradient_free(gradient);
+        // The wide character covers the first two columns.
+        char* s = gradient_fg("\xe6\x97\xa5" "b\nabc", stops, 2, false);
+        assert_not_null(s);
+        char* expected = NULL;
+        assert(asprintf(
+            &expected,
+            "%s\xe6\x97\xa5%sb\n%sa%sb%sc" NC,
+            red, blue, red, middle, blue
+        ) > 0);
+        assert_str_eq(s, expected, "Wide characters were not 2 columns.");
+        free(expected);
+        free(s);
+        // The combining mark stays with it's base character.
+        s = gradient_fg("e\xcc\x81x", stops, 2, false);
+        assert_not_null(s);
+        assert(asprintf(&expected, "%se\xcc\x81%sx" NC, red, blue) > 0);
+        assert_str_eq(s, expected, "Zero-width characters were colored.");
+        free(expected);
+        free(s);
+    }
+    it("colors lines vertically") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+        char* s = gradient_bg("ab\n\ncd", stops, 2, true);
+        assert_not_null(s);
+        ColrGradient* gradient = ColrGradient_new(format_bg_RGB, GRADIENT_OKLAB, stops, 2);
+        char middle[CODE_RGB_LEN];
+        format_bg_RGB(middle, ColrGradient_rgb(gradient, 0.5));
+        ColrGradient_free(gradient);
+        char* expected = NULL;
+        // Back colors are reset before newlines, and empty lines get no code.
+        assert(asprintf(
+            &expected,
+            "%sab" CODE_RESET_BACK "\n" CODE_RESET_BACK "\n%scd" NC,
+            back_str_static(rgb(255, 0, 0)),
+            back_str_static(rgb(0, 0, 255))
+        ) > 0);
+        assert_str_eq(s, expected, "Vertical gradient is wrong.");
+        free(expected);
+        free(s);
+    }
+    it("does not count trailing newlines as lines") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+        char* tests[] = {"a\nb", "a\nb\n", "a\nb\n\n"};
+        for_each(tests, i) {
+            char* s = gradient_fg(tests[i], stops, 2, true);
+            assert_not_null(s);
+            char* expected = NULL;
+            // The last line with text always gets the last color.
+            assert(asprintf(
+                &expected,
+                "%sa\n%sb" NC "%s",
+                fore_str_static(rgb(255, 0, 0)),
+                fore_str_static(rgb(0, 0, 255)),
+                tests[i] + 3
+            ) > 0);
+            assert_str_eq(s, expected, tests[i]);
+            free(expected);
+            free(s);
+        }
+    }
+    it("uses the 256-color formatters") {
+        RGB stops[] = {rgb(255, 0, 0), rgb(0, 0, 255)};
+        char* fg_term = gradient_fg_term("test", stops, 2, false);
+        char* bg_term = gradient_bg_term("test", stops, 2, true);
+        assert_not_null(fg_term);
+        assert_not_null(bg_term);
+        char expected[CODE_RGB_LEN];
+        format_fg_RGB_term(expected, stops[0]);
+        assert(colr_str_starts_with(fg_term, expected));
+        format_bg_RGB_term(expected, stops[0]);
+        assert(colr_str_starts_with(bg_term, expected));
+        free(fg_term);
+        free(bg_term);
+    }
+}
+}
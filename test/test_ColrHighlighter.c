@@ -0,0 +1,161 @@
+/* Tests for the ColrHighlighter struct and its related functions.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+describe(ColrHighlighter) {
+subdesc(ColrHighlighter_add) {
+    it("handles NULL/bad patterns") {
+        assert_false(ColrHighlighter_add(NULL, "a", 0, 0, "b"));
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        assert_not_null(highlighter);
+        assert_false(ColrHighlighter_add(highlighter, NULL, 0, 0, "b"));
+        assert_false(ColrHighlighter_add(highlighter, "(bad", 0, 0, fore(RED)));
+        assert_size_eq(highlighter->count, 0);
+        ColrHighlighter_free(highlighter);
+        // Does nothing.
+        ColrHighlighter_free(NULL);
+    }
+    it("sorts rules by priority") {
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        int priorities[] = {0, 5, 0, 10, 5};
+        for_each(priorities, i) {
+            assert(ColrHighlighter_add(highlighter, "a", 0, priorities[i], "b"));
+        }
+        int expected[] = {10, 5, 5, 0, 0};
+        assert_size_eq(highlighter->count, array_length(expected));
+        for_each(expected, i) {
+            asserteq(highlighter->rules[i].priority, expected[i]);
+        }
+        ColrHighlighter_free(highlighter);
+    }
+    it("uses ColorArg/ColorText codes") {
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        assert(ColrHighlighter_add(highlighter, "a", 0, 0, fore(RED)));
+        assert(ColrHighlighter_add(highlighter, "b", 0, 0, Colr("ignored", fore(BLUE), style(BRIGHT))));
+        assert(ColrHighlighter_add(highlighter, "c", 0, 0, (char*)NULL));
+        assert_str_eq(highlighter->rules[0].codes, "\x1b[31m", "Bad ColorArg codes.");
+        assert_str_eq(highlighter->rules[1].codes, "\x1b[1m\x1b[34m", "Bad ColorText codes.");
+        assert_str_eq(highlighter->rules[2].codes, "", "Bad NULL codes.");
+        ColrHighlighter_free(highlighter);
+    }
+}
+subdesc(ColrHighlighter_highlight) {
+    it("handles NULL") {
+        assert_null(ColrHighlighter_highlight(NULL, "test"));
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        assert_null(ColrHighlighter_highlight(highlighter, NULL));
+        // No rules, the string is copied.
+        char* result = ColrHighlighter_highlight(highlighter, "test");
+        assert_str_eq(result, "test", "Empty highlighter did not copy.");
+        free(result);
+        ColrHighlighter_free(highlighter);
+    }
+    it("resolves overlaps by priority") {
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        assert(ColrHighlighter_add(highlighter, "[0-9]+", 0, 0, "<n>"));
+        assert(ColrHighlighter_add(highlighter, "[0-9.]+\\.[0-9]+", 0, 1, "<ip>"));
+        assert(ColrHighlighter_add(highlighter, "ERROR", 0, 0, "<e>"));
+        assert(ColrHighlighter_add(highlighter, "x*", 0, 0, "<empty>"));
+        struct {
+            char* s;
+            char* expected;
+        } tests[] = {
+            {"", ""},
+            {"none", "none"},
+            {"42", "<n>42" NC},
+            {"10.0.0.1", "<ip>10.0.0.1" NC},
+            {"ERROR 10.0.0.1: 42", "<e>ERROR" NC " <ip>10.0.0.1" NC ": <n>42" NC},
+            {"1ERROR2", "<n>1" NC "<e>ERROR" NC "<n>2" NC},
+        };
+        for_each(tests, i) {
+            char* result = ColrHighlighter_highlight(highlighter, tests[i].s);
+            assert_str_eq(result, tests[i].expected, tests[i].s);
+            free(result);
+        }
+        ColrHighlighter_free(highlighter);
+    }
+    it("skips existing escape codes") {
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        assert(ColrHighlighter_add(highlighter, "[0-9]+", 0, 0, "<n>"));
+        assert(ColrHighlighter_add(highlighter, "m", 0, 0, "<m>"));
+        char* s = "\x1b[31mm1\x1b[38;5;208m2\x1b[0m";
+        char* expected = (
+            "\x1b[31m<m>m" NC "\x1b[31m<n>1" NC "\x1b[31m"
+            "\x1b[38;5;208m<n>2" NC "\x1b[31m\x1b[38;5;208m\x1b[0m"
+        );
+        char* result = ColrHighlighter_highlight(highlighter, s);
+        assert_str_eq(result, expected, "Existing codes were modified.");
+        free(result);
+        ColrHighlighter_free(highlighter);
+    }
+    it("restores existing colors after a match") {
+        ColrHighlighter* highlighter = ColrHighlighter_new();
+        assert(ColrHighlighter_add(highlighter, "[0-9.]+", 0, 0, "<ip>"));
+        struct {
+            char* s;
+            char* expected;
+        } tests[] = {
+            {
+                "\x1b[31mERR 10.0.0.1 tail\x1b[0m",
+                "\x1b[31mERR <ip>10.0.0.1" NC "\x1b[31m tail\x1b[0m",
+            },
+            // Adjacent codes are restored together.
+            {
+                "\x1b[1m\x1b[31mERR 1\x1b[0m 2",
+                "\x1b[1m\x1b[31mERR <ip>1" NC "\x1b[1m\x1b[31m\x1b[0m <ip>2" NC,
+            },
+            // Nothing is restored after a reset.
+            {
+                "\x1b[31mx\x1b[m 1",
+                "\x1b[31mx\x1b[m <ip>1" NC,
+            },
+            // Other escape-codes are not restored.
+            {
+                "\x1b[34m\x1b[2Ka\x1b[2K1",
+                "\x1b[34m\x1b[2Ka\x1b[2K<ip>1" NC "\x1b[34m",
+            },
+            // Stacked styles are all restored, until a reset.
+            {
+                "\x1b[1mBold \x1b[31mred 1 here\x1b[0m \x1b[4m2",
+                "\x1b[1mBold \x1b[31mred <ip>1" NC "\x1b[1m\x1b[31m here\x1b[0m "
+                "\x1b[4m<ip>2" NC "\x1b[4m",
+            },
+            // A combined code that starts with a reset restores only itself.
+            {
+                "\x1b[1ma\x1b[0;31mb 1",
+                "\x1b[1ma\x1b[0;31mb <ip>1" NC "\x1b[0;31m",
+            },
+        };
+        for_each(tests, i) {
+            char* result = ColrHighlighter_highlight(highlighter, tests[i].s);
+            assert_str_eq(result, tests[i].expected, tests[i].s);
+            free(result);
+        }
+        ColrHighlighter_free(highlighter);
+    }
+    it("only matches anchors at the ends of the whole string") {
+        struct {
+            char* pattern;
+            char* s;
+            char* expected;
+        } tests[] = {
+            {"o$", "foo\x1b[31mbar", "foo\x1b[31mbar"},
+            {"r$", "foo\x1b[31mbar", "foo\x1b[31mba<h>r" NC "\x1b[31m"},
+            {"^b", "foo\x1b[31mbar", "foo\x1b[31mbar"},
+            {"^f", "foo\x1b[31mbar", "<h>f" NC "oo\x1b[31mbar"},
+            {"^a$", "\x1b[1ma\x1b[0m", "\x1b[1ma\x1b[0m"},
+        };
+        for_each(tests, i) {
+            ColrHighlighter* highlighter = ColrHighlighter_new();
+            assert(ColrHighlighter_add(highlighter, tests[i].pattern, 0, 0, "<h>"));
+            char* result = ColrHighlighter_highlight(highlighter, tests[i].s);
+            assert_str_eq(result, tests[i].expected, tests[i].pattern);
+            free(result);
+            ColrHighlighter_free(highlighter);
+        }
+    }
+}
+}
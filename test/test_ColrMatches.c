@@ -0,0 +1,200 @@
+/* Tests for the ColrMatches/ColrMatchIter structs and their related functions.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+describe(ColrMatches) {
+subdesc(ColrMatches_append) {
+    it("grows as needed") {
+        regmatch_t match = {.rm_so=0, .rm_eo=0};
+        assert_false(ColrMatches_append(NULL, match));
+        ColrMatches cmatches = {.matches=NULL, .count=0, .cap=0};
+        for (regoff_t i = 0; i < 100; i++) {
+            match = (regmatch_t){.rm_so=i, .rm_eo=i + 1};
+            assert(ColrMatches_append(&cmatches, match));
+        }
+        assert_size_eq(cmatches.count, 100);
+        assert(cmatches.cap >= 100);
+        for (size_t i = 0; i < cmatches.count; i++) {
+            asserteq(cmatches.matches[i].rm_so, (regoff_t)i);
+        }
+        ColrMatches_free(&cmatches);
+        assert_null(cmatches.matches);
+        assert_size_eq(cmatches.count, 0);
+        // Does nothing.
+        ColrMatches_free(NULL);
+    }
+}
+subdesc(ColrMatches_from_re) {
+    it("collects matches") {
+        struct {
+            char* s;
+            char* pattern;
+            size_t count;
+            regoff_t last_so;
+            regoff_t last_eo;
+        } tests[] = {
+            {"", "fo+", 0, 0, 0},
+            {"bar", "fo+", 0, 0, 0},
+            {"foo", "fo+", 1, 0, 3},
+            {"a foo, a fooo", "fo+", 2, 9, 13},
+            {"foofoo", "^foo", 1, 0, 3},
+            {"foo\nfoo", "foo$", 1, 4, 7},
+            // Empty matches always make progress.
+            {"baaac", "a*", 4, 5, 5},
+            {"xyz", "", 4, 3, 3},
+        };
+        for_each(tests, i) {
+            regex_t* repat = colr_re_cache_acquire(tests[i].pattern, 0);
+            assert_not_null(repat);
+            ColrMatches cmatches = ColrMatches_from_re(tests[i].s, repat);
+            assert_size_eq_repr(cmatches.count, tests[i].count, tests[i].s);
+            if (cmatches.count) {
+                asserteq(cmatches.matches[cmatches.count - 1].rm_so, tests[i].last_so);
+                asserteq(cmatches.matches[cmatches.count - 1].rm_eo, tests[i].last_eo);
+            }
+            ColrMatches_free(&cmatches);
+            colr_re_cache_release(repat);
+        }
+    }
+    it("handles NULL") {
+        ColrMatches cmatches = ColrMatches_from_re(NULL, NULL);
+        assert_size_eq(cmatches.count, 0);
+        assert_null(cmatches.matches);
+    }
+}
+subdesc(ColrMatches_replace) {
+    it("handles NULL/bad matches") {
+        ColrMatches cmatches = {.matches=NULL, .count=0, .cap=0};
+        assert_null(ColrMatches_replace(NULL, "test", "x"));
+        assert_null(ColrMatches_replace(&cmatches, NULL, "x"));
+        regmatch_t bad[][2] = {
+            // Out of order.
+            {{.rm_so=2, .rm_eo=3}, {.rm_so=0, .rm_eo=1}},
+            // Out of bounds.
+            {{.rm_so=0, .rm_eo=1}, {.rm_so=3, .rm_eo=9}},
+            // Overlapping.
+            {{.rm_so=0, .rm_eo=2}, {.rm_so=1, .rm_eo=3}},
+        };
+        for_each(bad, i) {
+            cmatches = (ColrMatches){.matches=bad[i], .count=2, .cap=2};
+            assert_null(ColrMatches_replace(&cmatches, "test", "x"));
+        }
+    }
+    it("replaces matches") {
+        struct {
+            char* s;
+            char* pattern;
+            char* repl;
+            char* expected;
+        } tests[] = {
+            {"", "fo+", "x", ""},
+            {"bar", "fo+", "x", "bar"},
+            {"foo", "fo+", NULL, ""},
+            {"foo", "fo+", "longer", "longer"},
+            {"a foo, a fooo", "fo+", "x", "a x, a x"},
+            {"1 22 333", "[0-9]+", "number", "number number number"},
+            {"abc", "x*", "-", "-a-b-c-"},
+        };
+        for_each(tests, i) {
+            regex_t* repat = colr_re_cache_acquire(tests[i].pattern, 0);
+            assert_not_null(repat);
+            ColrMatches cmatches = ColrMatches_from_re(tests[i].s, repat);
+            char* result = ColrMatches_replace(&cmatches, tests[i].s, tests[i].repl);
+            assert_str_eq(result, tests[i].expected, "Failed to replace matches.");
+            free(result);
+            // The streaming version should write the same thing.
+            char* written = NULL;
+            size_t written_len = 0;
+            FILE* out = open_memstream(&written, &written_len);
+            assert_not_null(out);
+            size_t cnt = colr_str_replace_re_pat_all_fp(out, tests[i].s, repat, tests[i].repl);
+            fclose(out);
+            assert_size_eq(cnt, cmatches.count);
+            assert_str_eq(written, tests[i].expected, "Failed to write replaced matches.");
+            free(written);
+            ColrMatches_free(&cmatches);
+            colr_re_cache_release(repat);
+        }
+        assert_size_eq(colr_str_replace_re_pat_all_fp(NULL, "a", NULL, "b"), 0);
+    }
+}
+subdesc(ColrMatchIter_next) {
+    it("handles NULL") {
+        regmatch_t match;
+        assert_false(ColrMatchIter_next(NULL, &match));
+        ColrMatchIter iter = ColrMatchIter_new(NULL, NULL);
+        assert_false(ColrMatchIter_next(&iter, &match));
+    }
+    it("yields matches lazily") {
+        regex_t* repat = colr_re_cache_acquire("[0-9]+", 0);
+        assert_not_null(repat);
+        char* s = "1 22 333";
+        regoff_t expected[][2] = {{0, 1}, {2, 4}, {5, 8}};
+        ColrMatchIter iter = ColrMatchIter_new(s, repat);
+        regmatch_t match;
+        size_t count = 0;
+        while (ColrMatchIter_next(&iter, &match)) {
+            assert(count < array_length(expected));
+            asserteq(match.rm_so, expected[count][0]);
+            asserteq(match.rm_eo, expected[count][1]);
+            count++;
+        }
+        assert_size_eq(count, array_length(expected));
+        // Exhausted iterators stay exhausted.
+        assert_false(ColrMatchIter_next(&iter, &match));
+        colr_re_cache_release(repat);
+    }
+}
+subdesc(ColrMatchIter_next_groups) {
+    it("yields capture groups") {
+        regex_t* repat = colr_re_cache_acquire("([a-z]+)=([0-9]+)?", 0);
+        assert_not_null(repat);
+        char* s = "a=1 bc=";
+        regoff_t expected[][3][2] = {
+            {{0, 3}, {0, 1}, {2, 3}},
+            {{4, 7}, {4, 6}, {-1, -1}},
+        };
+        ColrMatchIter iter = ColrMatchIter_new(s, repat);
+        regmatch_t groups[3];
+        assert_false(ColrMatchIter_next_groups(&iter, groups, 0));
+        size_t count = 0;
+        while (ColrMatchIter_next_groups(&iter, groups, array_length(groups))) {
+            assert(count < array_length(expected));
+            for_each(groups, g) {
+                asserteq(groups[g].rm_so, expected[count][g][0]);
+                asserteq(groups[g].rm_eo, expected[count][g][1]);
+            }
+            count++;
+        }
+        assert_size_eq(count, array_length(expected));
+        colr_re_cache_release(repat);
+    }
+}
+subdesc(colr_re_matches) {
+    it("wraps ColrMatches_from_re") {
+        regex_t* repat = colr_re_cache_acquire("o", 0);
+        assert_not_null(repat);
+        assert_null(colr_re_matches("xyz", repat));
+        regmatch_t** matches = colr_re_matches("foo boo", repat);
+        assert_not_null(matches);
+        size_t count = 0;
+        while (matches[count]) count++;
+        assert_size_eq(count, 4);
+        asserteq(matches[3]->rm_so, 6);
+        colr_free_re_matches(matches);
+        // Empty matches used to loop forever.
+        regex_t* empty = colr_re_cache_acquire("x*", 0);
+        matches = colr_re_matches("ab", empty);
+        assert_not_null(matches);
+        count = 0;
+        while (matches[count]) count++;
+        assert_size_eq(count, 3);
+        colr_free_re_matches(matches);
+        colr_re_cache_release(empty);
+        colr_re_cache_release(repat);
+    }
+}
+}
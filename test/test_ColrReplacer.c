@@ -0,0 +1,154 @@
+/* Tests for the ColrReplacer struct and its related functions.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+describe(ColrReplacer) {
+subdesc(ColrReplacer_add) {
+    it("handles NULL/empty targets") {
+        assert_false(ColrReplacer_add(NULL, "a", "b"));
+        ColrReplacer* replacer = ColrReplacer_new();
+        assert_not_null(replacer);
+        assert_false(ColrReplacer_add(replacer, NULL, "b"));
+        assert_false(ColrReplacer_add(replacer, "", "b"));
+        assert_size_eq(replacer->count, 0);
+        ColrReplacer_free(replacer);
+    }
+    it("replaces existing targets") {
+        ColrReplacer* replacer = ColrReplacer_new();
+        assert(ColrReplacer_add(replacer, "a", "b"));
+        assert(ColrReplacer_add(replacer, "a", "c"));
+        assert_size_eq(replacer->count, 1);
+        char* result = ColrReplacer_replace(replacer, "aaa");
+        assert_str_eq(result, "ccc", "Old replacement was used.");
+        free(result);
+        ColrReplacer_free(replacer);
+    }
+    it("adds Colr objects") {
+        ColrReplacer* replacer = ColrReplacer_new();
+        assert(ColrReplacer_add(replacer, "a", fore(RED)));
+        assert(ColrReplacer_add(replacer, "b", Colr("B", fore(BLUE))));
+        assert(ColrReplacer_add(replacer, "c", ColrResult(strdup("C"))));
+        assert(ColrReplacer_add(replacer, "d", (char*)NULL));
+        char* expected_b = colr("B", fore(BLUE));
+        char* expected = NULL;
+        assert(asprintf(&expected, "\x1b[31m%sC", expected_b) > 0);
+        char* result = ColrReplacer_replace(replacer, "abcd");
+        assert_str_eq(result, expected, "Colr replacements failed.");
+        free(expected_b);
+        free(expected);
+        free(result);
+        ColrReplacer_free(replacer);
+    }
+}
+subdesc(ColrReplacer_replace) {
+    it("handles NULL") {
+        assert_null(ColrReplacer_replace(NULL, "test"));
+        ColrReplacer* replacer = ColrReplacer_new();
+        assert_null(ColrReplacer_replace(replacer, NULL));
+        // No targets, the string is copied.
+        char* result = ColrReplacer_replace(replacer, "test");
+        assert_str_eq(result, "test", "Empty replacer did not copy.");
+        free(result);
+        ColrReplacer_free(replacer);
+    }
+    it("replaces leftmost-longest matches") {
+        char* pairs[][2] = {
+            {"he", "1"},
+            {"she", "2"},
+            {"his", "3"},
+            {"hers", "4"},
+            {"abcd", "5"},
+            {"bc", "6"},
+            {"b", "7"},
+        };
+        struct {
+            char* s;
+            char* expected;
+        } tests[] = {
+            {"", ""},
+            {"x", "x"},
+            {"he", "1"},
+            {"she", "2"},
+            {"ushers", "u2rs"},
+            {"hishers", "34"},
+            {"hishe", "31"},
+            {"hehe", "11"},
+            {"abcd", "5"},
+            {"abce", "a6e"},
+            {"abc", "a6"},
+            {"ab", "a7"},
+            {"xbxbc", "x7x6"},
+            {"abcdabcx", "5a6x"},
+        };
+        ColrReplacer* replacer = ColrReplacer_new();
+        for_each(pairs, i) {
+            assert(ColrReplacer_add(replacer, pairs[i][0], pairs[i][1]));
+        }
+        for_each(tests, i) {
+            char* result = ColrReplacer_replace(replacer, tests[i].s);
+            assert_str_eq(result, tests[i].expected, tests[i].s);
+            free(result);
+        }
+        ColrReplacer_free(replacer);
+    }
+    it("recompiles after adding targets") {
+        ColrReplacer* replacer = ColrReplacer_new();
+        ColrReplacer_add(replacer, "a", "1");
+        char* result = ColrReplacer_replace(replacer, "ab");
+        assert_str_eq(result, "1b", "First compile failed.");
+        free(result);
+        ColrReplacer_add(replacer, "b", "2");
+        result = ColrReplacer_replace(replacer, "ab");
+        assert_str_eq(result, "12", "Did not recompile.");
+        free(result);
+        ColrReplacer_free(replacer);
+    }
+}
+subdesc(ColrReplacer_feed) {
+    it("handles NULL") {
+        ColrReplacer* replacer = ColrReplacer_new();
+        assert_false(ColrReplacer_feed(NULL, stdout, "a", 1));
+        assert_false(ColrReplacer_feed(replacer, NULL, "a", 1));
+        assert_false(ColrReplacer_finish(NULL, stdout));
+        assert_false(ColrReplacer_finish(replacer, NULL));
+        ColrReplacer_free(replacer);
+    }
+    it("matches ColrReplacer_replace for any chunk split") {
+        char* pairs[][2] = {
+            {"he", "1"},
+            {"she", "2"},
+            {"hers", "4"},
+            {"abcd", "5"},
+            {"bc", "6"},
+        };
+        char* s = "ushers hishe abcabcdhe";
+        size_t length = strlen(s);
+        ColrReplacer* replacer = ColrReplacer_new();
+        for_each(pairs, i) {
+            ColrReplacer_add(replacer, pairs[i][0], pairs[i][1]);
+        }
+        char* expected = ColrReplacer_replace(replacer, s);
+        assert_not_null(expected);
+        for (size_t split = 0; split <= length; split++) {
+            for (size_t split2 = split; split2 <= length; split2++) {
+                char* result = NULL;
+                size_t result_len = 0;
+                FILE* out = open_memstream(&result, &result_len);
+                assert_not_null(out);
+                assert(ColrReplacer_feed(replacer, out, s, split));
+                assert(ColrReplacer_feed(replacer, out, s + split, split2 - split));
+                assert(ColrReplacer_feed(replacer, out, s + split2, length - split2));
+                assert(ColrReplacer_finish(replacer, out));
+                fclose(out);
+                assert_str_eq(result, expected, "Streamed result differs.");
+                free(result);
+            }
+        }
+        free(expected);
+        ColrReplacer_free(replacer);
+    }
+}
+}
@@ -0,0 +1,200 @@
+/* Tests for the ColrToken/ColrTokenIter structs and their related functions.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+describe(ColrToken) {
+subdesc(ColrToken_is_code) {
+    it("detects code tokens") {
+        struct {
+            ColrTokenType type;
+            bool expected;
+        } tests[] = {
+            {TOKEN_NONE, false},
+            {TOKEN_TEXT, false},
+            {TOKEN_SGR, true},
+            {TOKEN_CSI, true},
+            {TOKEN_ESC, true},
+        };
+        for_each(tests, i) {
+            ColrToken token = {.type=tests[i].type, .start=NULL, .offset=0, .length=0};
+            asserteq(ColrToken_is_code(token), tests[i].expected);
+        }
+    }
+}
+subdesc(ColrToken_scan_esc) {
+    it("scans escape sequences") {
+        struct {
+            char* s;
+            ColrTokenType expected;
+            size_t length;
+        } tests[] = {
+            {NULL, TOKEN_NONE, 0},
+            {"", TOKEN_NONE, 0},
+            {"test", TOKEN_NONE, 0},
+            {"\x1b", TOKEN_NONE, 0},
+            {"\x1b[", TOKEN_NONE, 0},
+            {"\x1b[31", TOKEN_NONE, 0},
+            {"\x1b[31\x1b[0m", TOKEN_NONE, 0},
+            {"\x1b[m", TOKEN_SGR, 3},
+            {"\x1b[0m", TOKEN_SGR, 4},
+            {"\x1b[31mtest", TOKEN_SGR, 5},
+            {"\x1b[38;2;255;255;255m", TOKEN_SGR, 19},
+            {"\x1b[1;38;5;208;48;2;1;2;3m", TOKEN_SGR, 24},
+            {"\x1b[38:5:208m", TOKEN_SGR, 11},
+            {"\x1b[?25l", TOKEN_CSI, 6},
+            {"\x1b[2A", TOKEN_CSI, 4},
+            {"\x1b[2J", TOKEN_CSI, 4},
+            {"\x1b[?1m", TOKEN_CSI, 5},
+            {"\x1b[1 m", TOKEN_CSI, 5},
+            {"\x1b" "7", TOKEN_ESC, 2},
+            {"\x1b(B", TOKEN_ESC, 3},
+            {"\x1b]0;title\a", TOKEN_ESC, 10},
+            {"\x1b]0;title\x1b\\", TOKEN_ESC, 11},
+            {"\x1b]0;title", TOKEN_NONE, 0},
+        };
+        for_each(tests, i) {
+            size_t length = 1337;
+            ColrTokenType type = ColrToken_scan_esc(tests[i].s, &length);
+            asserteq(type, tests[i].expected);
+            assert_size_eq_repr(length, tests[i].length, tests[i].s);
+        }
+    }
+}
+subdesc(ColrToken_scan_esc_n) {
+    it("stops at the length") {
+        struct {
+            char* s;
+            size_t length;
+            ColrTokenType expected;
+            size_t esc_len;
+        } tests[] = {
+            {"\x1b[31m", 0, TOKEN_NONE, 0},
+            {"\x1b[31m", 4, TOKEN_NONE, 0},
+            {"\x1b[31m", 5, TOKEN_SGR, 5},
+            {"\x1b[31mtest", 99, TOKEN_SGR, 5},
+            {"\x1b[2Atest", 3, TOKEN_NONE, 0},
+            {"\x1b]0;title\a", 9, TOKEN_NONE, 0},
+            {"\x1b]0;title\x1b\\", 10, TOKEN_NONE, 0},
+            {"\x1b]0;title\x1b\\", 11, TOKEN_ESC, 11},
+            {"\x1b" "7", 1, TOKEN_NONE, 0},
+            {"\x1b" "7", 2, TOKEN_ESC, 2},
+        };
+        for_each(tests, i) {
+            size_t esc_len = 1337;
+            ColrTokenType type = ColrToken_scan_esc_n(tests[i].s, tests[i].length, &esc_len);
+            asserteq(type, tests[i].expected);
+            assert_size_eq_repr(esc_len, tests[i].esc_len, tests[i].s);
+        }
+    }
+}
+subdesc(ColrTokenIter_next) {
+    it("handles NULL") {
+        ColrToken token;
+        assert_false(ColrTokenIter_next(NULL, &token));
+        ColrTokenIter iter = ColrTokenIter_new(NULL);
+        assert_false(ColrTokenIter_next(&iter, &token));
+        iter = ColrTokenIter_new("test");
+        assert_false(ColrTokenIter_next(&iter, NULL));
+        iter = ColrTokenIter_new("");
+        assert_false(ColrTokenIter_next(&iter, &token));
+    }
+    it("yields text and code spans") {
+        char* s = "a\x1b[38;2;255;255;255mbc\x1b[2A\x1b[0m\x1b[31\nde\x1b" "7";
+        struct {
+            ColrTokenType type;
+            size_t offset;
+            char* text;
+        } expected[] = {
+            {TOKEN_TEXT, 0, "a"},
+            {TOKEN_SGR, 1, "\x1b[38;2;255;255;255m"},
+            {TOKEN_TEXT, 20, "bc"},
+            {TOKEN_CSI, 22, "\x1b[2A"},
+            {TOKEN_SGR, 26, "\x1b[0m"},
+            // Malformed codes are merged into the surrounding text.
+            {TOKEN_TEXT, 30, "\x1b[31\nde"},
+            {TOKEN_ESC, 37, "\x1b" "7"},
+        };
+        ColrTokenIter iter = ColrTokenIter_new(s);
+        ColrToken token;
+        size_t count = 0;
+        while (ColrTokenIter_next(&iter, &token)) {
+            assert(count < array_length(expected));
+            asserteq(token.type, expected[count].type);
+            assert_size_eq(token.offset, expected[count].offset);
+            assert_size_eq(token.length, strlen(expected[count].text));
+            assert(token.start == s + token.offset);
+            assert(strncmp(token.start, expected[count].text, token.length) == 0);
+            count++;
+        }
+        assert_size_eq(count, array_length(expected));
+        // Exhausted iterators stay exhausted.
+        assert_false(ColrTokenIter_next(&iter, &token));
+    }
+    it("yields a single text span for plain text") {
+        ColrTokenIter iter = ColrTokenIter_new("plain \x1b\x01 text");
+        ColrToken token;
+        assert(ColrTokenIter_next(&iter, &token));
+        asserteq(token.type, TOKEN_TEXT);
+        assert_size_eq(token.length, strlen("plain \x1b\x01 text"));
+        assert_false(ColrTokenIter_next(&iter, &token));
+    }
+    it("stops at the length for ColrTokenIter_new_n") {
+        // Not null-terminated, with null bytes in the text.
+        char s[] = {'a', '\0', 'b', '\x1b', '[', '1', 'm', 'c', '\x1b', '[', '2'};
+        struct {
+            ColrTokenType type;
+            size_t offset;
+            size_t length;
+        } expected[] = {
+            {TOKEN_TEXT, 0, 3},
+            {TOKEN_SGR, 3, 4},
+            // The cut-off code is text.
+            {TOKEN_TEXT, 7, 4},
+        };
+        ColrTokenIter iter = ColrTokenIter_new_n(s, sizeof(s));
+        ColrToken token;
+        size_t count = 0;
+        while (ColrTokenIter_next(&iter, &token)) {
+            assert(count < array_length(expected));
+            asserteq(token.type, expected[count].type);
+            assert_size_eq(token.offset, expected[count].offset);
+            assert_size_eq(token.length, expected[count].length);
+            count++;
+        }
+        assert_size_eq(count, array_length(expected));
+        iter = ColrTokenIter_new_n(s, 0);
+        assert_false(ColrTokenIter_next(&iter, &token));
+    }
+    it("treats unterminated OSC sequences as text") {
+        // The first OSC is cut off by the null byte, the last one is not.
+        char s[] = {
+            '\x1b', ']', 'a', '\x1b', '[', '1', 'm', '\x1b', ']', 'b', '\0',
+            '\x1b', ']', 'c', '\a',
+        };
+        struct {
+            ColrTokenType type;
+            size_t offset;
+            size_t length;
+        } expected[] = {
+            {TOKEN_TEXT, 0, 3},
+            {TOKEN_SGR, 3, 4},
+            {TOKEN_TEXT, 7, 4},
+            {TOKEN_ESC, 11, 4},
+        };
+        ColrTokenIter iter = ColrTokenIter_new_n(s, sizeof(s));
+        ColrToken token;
+        size_t count = 0;
+        while (ColrTokenIter_next(&iter, &token)) {
+            assert(count < array_length(expected));
+            asserteq(token.type, expected[count].type);
+            assert_size_eq(token.offset, expected[count].offset);
+            assert_size_eq(token.length, expected[count].length);
+            count++;
+        }
+        assert_size_eq(count, array_length(expected));
+    }
+}
+}
@@ -161,6 +161,42 @@ subdesc(RGB_from_hex_default) {
 }
 
 // RGB_from_str
+subdesc(RGB_from_linear) {
+    it("round-trips RGB_to_linear") {
+        for (unsigned int value = 0; value < 256; value++) {
+            RGB rgbval = rgb(value, 255 - value, value / 2);
+            double values[3];
+            RGB_to_linear(rgbval, values);
+            assert_colr_eq(RGB_from_linear(values), rgbval);
+        }
+    }
+    it("clamps values") {
+        double values[] = {-1.0, 2.0, 0.0};
+        assert_colr_eq(RGB_from_linear(values), rgb(0, 255, 0));
+    }
+}
+subdesc(RGB_from_oklab) {
+    it("round-trips RGB_to_oklab") {
+        for (unsigned int r = 0; r < 256; r += 15) {
+            for (unsigned int g = 0; g < 256; g += 15) {
+                for (unsigned int b = 0; b < 256; b += 15) {
+                    double lab[3];
+                    RGB_to_oklab(rgb(r, g, b), lab);
+                    assert_colr_eq(RGB_from_oklab(lab), rgb(r, g, b));
+                }
+            }
+        }
+    }
+    it("uses the OKLab lightness") {
+        double lab[3];
+        RGB_to_oklab(rgb(255, 255, 255), lab);
+        assert(fabs(lab[0] - 1.0) < 0.001);
+        assert(fabs(lab[1]) < 0.001);
+        assert(fabs(lab[2]) < 0.001);
+        RGB_to_oklab(rgb(0, 0, 0), lab);
+        assert(fabs(lab[0]) < 0.001);
+    }
+}
 subdesc(RGB_from_str) {
     it("recognizes valid RGB strings") {
         for_len(str_tests_len, i) {
@@ -0,0 +1,150 @@
+/* Benchmarks for ColrC functions that should scale linearly.
+    These are only built with `make bench` (-DCOLR_BENCH), and can be run with
+    `./test_colrc bench`.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+#ifdef COLR_BENCH
+#include <time.h>
+
+//! Number of bytes processed for each size, at least.
+#define BENCH_MIN_BYTES (size_t)(10 * 1024 * 1024)
+//! Size of the strings used for benchmarks, the largest size benchmarked.
+#define BENCH_MAX_BYTES (size_t)(100 * 1024 * 1024)
+
+/*! Get a monotonic time, in nanoseconds, for benchmarks.
+
+    \return The current time in nanoseconds.
+*/
+double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*! Create a string of lines of text for benchmarks.
+
+    \pi length Length of the string to create.
+    \pi insert String to insert every 40 bytes, or `NULL` for plain text.
+    \return    An allocated string, or `NULL` if allocation fails.
+*/
+char* bench_text(size_t length, const char* insert) {
+    char* s = malloc(length + 1);
+    if (!s) return NULL;
+    size_t insert_len = insert ? strlen(insert) : 0;
+    size_t i = 0;
+    while (i < length) {
+        if (insert_len && ((i % 40) == 0) && ((i + insert_len) <= length)) {
+            memcpy(s + i, insert, insert_len);
+            i += insert_len;
+            continue;
+        }
+        s[i] = ((i % 80) == 79) ? '\n' : (char)('a' + (i % 26));
+        i++;
+    }
+    s[length] = '\0';
+    return s;
+}
+
+//! A function to benchmark, that handles \p s in some way.
+typedef bool (*bench_func)(const char* s);
+
+/*! Run a benchmark function for strings from 1 KB to 100 MB, and print the
+    time it took per byte.
+
+    \pi name Name of the benchmark, for the output.
+    \pi func The function to run.
+    \pi s    A string of at least 100 MB, from bench_text().
+    \return  `true` if the time per byte grows linearly, otherwise `false`
+             (also `false` if \p func fails).
+*/
+bool bench_linear(const char* name, bench_func func, char* s) {
+    size_t sizes[] = {
+        1024,
+        10 * 1024,
+        100 * 1024,
+        1024 * 1024,
+        10 * 1024 * 1024,
+        100 * 1024 * 1024,
+    };
+    double per_byte[array_length(sizes)];
+    for_each(sizes, i) {
+        // Cut the string short, without copying it.
+        char saved = s[sizes[i]];
+        s[sizes[i]] = '\0';
+        // Small inputs are repeated, so the timer is useful.
+        size_t reps = (sizes[i] < BENCH_MIN_BYTES) ? (BENCH_MIN_BYTES / sizes[i]) : 1;
+        double start = bench_now_ns();
+        bool ok = true;
+        for (size_t rep = 0; ok && (rep < reps); rep++) ok = func(s);
+        per_byte[i] = (bench_now_ns() - start) / ((double)sizes[i] * reps);
+        s[sizes[i]] = saved;
+        if (!ok) return false;
+        printf("    %s: %10zu bytes, %7.2f ns/byte\n", name, sizes[i], per_byte[i]);
+    }
+    double fastest = per_byte[0];
+    double slowest = per_byte[0];
+    for_each(per_byte, i) {
+        if (per_byte[i] < fastest) fastest = per_byte[i];
+        if (per_byte[i] > slowest) slowest = per_byte[i];
+    }
+    // Quadratic growth would be orders of magnitude apart, this allows
+    // for cache/page-fault effects on the larger sizes.
+    return slowest < (fastest * 4);
+}
+
+//! Benchmark for rainbow_fg().
+bool bench_rainbow_fg(const char* s) {
+    char* rbow = rainbow_fg(s, 0.1, 1, 1);
+    if (!rbow) return false;
+    free(rbow);
+    return true;
+}
+
+//! Benchmark for colr_str_strip_codes().
+bool bench_strip_codes(const char* s) {
+    char* stripped = colr_str_strip_codes(s);
+    if (!stripped) return false;
+    free(stripped);
+    return true;
+}
+
+//! Benchmark for ColrTokenIter_next().
+bool bench_tokens(const char* s) {
+    ColrTokenIter iter = ColrTokenIter_new(s);
+    ColrToken token;
+    size_t count = 0;
+    while (ColrTokenIter_next(&iter, &token)) count++;
+    return count > 0;
+}
+
+describe(bench) {
+subdesc(_rainbow) {
+    it("scales linearly from 1 KB to 100 MB") {
+        char* s = bench_text(BENCH_MAX_BYTES, NULL);
+        assert_not_null(s);
+        assert(bench_linear("rainbow_fg", bench_rainbow_fg, s));
+        free(s);
+    }
+}
+subdesc(_tokens) {
+    it("scales linearly from 1 KB to 100 MB") {
+        char* s = bench_text(BENCH_MAX_BYTES, "\x1b[38;5;208m");
+        assert_not_null(s);
+        assert(bench_linear("ColrTokenIter_next", bench_tokens, s));
+        assert(bench_linear("colr_str_strip_codes", bench_strip_codes, s));
+        free(s);
+    }
+    it("scales linearly with unterminated OSC sequences") {
+        char* s = bench_text(BENCH_MAX_BYTES, "\x1b]8;;");
+        assert_not_null(s);
+        assert(bench_linear("ColrTokenIter_next (OSC)", bench_tokens, s));
+        assert(bench_linear("colr_str_strip_codes (OSC)", bench_strip_codes, s));
+        free(s);
+    }
+}
+}
+#endif // COLR_BENCH
@@ -270,6 +270,55 @@ subdesc(colr_asprintf) {
         }
 
     }
+    it("matches the allocating version") {
+        // Every object is freed by printf, so they are created twice.
+        #define make_test_objs() { \
+            Colr("test", fore(RED)), \
+            Colr("", fore(RED), back(BLUE), style(BRIGHT)), \
+            Colr("lines\n\n", back(WHITE)), \
+            Colr("\n", fore(RED)), \
+            Colr("has reset" CODE_RESET_ALL, fore(RED)), \
+            Colr("inner \x1b[34mcode", style(UNDERLINE)), \
+            Colr("\xe6\x97\xa5\xe6\x9c\xac", fore(rgb(1, 2, 3))), \
+            Colr_ljust("left", 9, fore(RED)), \
+            Colr_rjust("right", 10, back(RED)), \
+            Colr_center_char("center", 11, '-', style(BRIGHT)), \
+            Colr("no colors", NULL), \
+        }
+        char* formats[] = {"%R", "%#R", "%-15R", "%15R", "% 15R", "%#-15R", "% 3R"};
+        for_each(formats, i) {
+            ColorText* objs[] = make_test_objs();
+            ColorText* copies[] = make_test_objs();
+            for (size_t j = 0; j < array_length(objs); j++) {
+                char* expected = ColorText_to_str(*copies[j]);
+                ColorText_free(copies[j]);
+                assert_not_null(expected);
+                if (strchr(formats[i], '#')) {
+                    char* stripped = colr_str_strip_codes(expected);
+                    free(expected);
+                    expected = stripped;
+                }
+                int width = 0;
+                sscanf(formats[i] + strcspn(formats[i], "0123456789"), "%d", &width);
+                if (width) {
+                    char* justified = (
+                        strchr(formats[i], '-') ? colr_str_ljust(expected, width, ' ') :
+                        strchr(formats[i], ' ') ? colr_str_center(expected, width, ' ') :
+                        colr_str_rjust(expected, width, ' ')
+                    );
+                    free(expected);
+                    expected = justified;
+                }
+                char* result = NULL;
+                int length = colr_asprintf(&result, formats[i], objs[j]);
+                assert_str_eq(result, expected, formats[i]);
+                asserteq(length, (int)strlen(expected));
+                free(result);
+                free(expected);
+            }
+        }
+        #undef make_test_objs
+    }
 }
 // colr_join
 subdesc(colr_join) {
@@ -821,6 +870,57 @@ subdesc(colr_join_array) {
         free(s);
     }
 }
+subdesc(colr_set_disabled) {
+    it("only emits text and justification") {
+        assert_false(colr_is_disabled());
+        colr_set_disabled(true);
+        assert(colr_is_disabled());
+        struct {
+            char* s;
+            char* expected;
+        } tests[] = {
+            {
+                colr_cat(fore(RED), "a", Colr("b", fore(BLUE), back(WHITE), style(BRIGHT))),
+                "ab",
+            },
+            {
+                colr_join(fore(RED), "a", Colr_join("b", "[", "]"), fore(BLUE)),
+                "a[b]",
+            },
+            {colr_join(Colr("-", fore(RED)), "a", "b"), "a-b"},
+            {colr_cat(Colr_rjust("x", 4, fore(RED))), "   x"},
+            {colr_cat(Colr_center_char("x\n", 5, '*', fore(RED))), "**x\n*"},
+        };
+        for_each(tests, i) {
+            assert_str_eq(tests[i].s, tests[i].expected, "Codes were not disabled.");
+            free(tests[i].s);
+        }
+        // Sizes are for plain text.
+        ColorText ctext = Colra("test", fore(RED), back(WHITE));
+        assert_size_eq(ColorText_length(ctext), 5);
+        char* plain = ColorText_to_str(ctext);
+        assert_str_eq(plain, "test", "ColorText_to_str() did not disable codes.");
+        free(plain);
+        ColorText_free_args(&ctext);
+        #ifdef COLR_GNU
+        char* printed = NULL;
+        colr_asprintf(&printed, "%-6" COLR_FMT "|%" COLR_FMT, Colr("ab", fore(RED)), fore(BLUE));
+        assert_str_eq(printed, "ab    |", "printf handler did not disable codes.");
+        free(printed);
+        #endif
+        colr_set_disabled(false);
+        char* s = colr_cat(Colr("z", fore(RED)));
+        assert_str_eq(s, "\x1b[31mz\x1b[0m", "Codes were not enabled again.");
+        free(s);
+    }
+    it("can be set automatically") {
+        bool disabled = colr_set_disabled_auto();
+        asserteq(disabled, colr_is_disabled());
+        ColrTermCaps caps = colr_term_caps();
+        asserteq(disabled, (caps.disabled || !caps.is_tty));
+        colr_set_disabled(false);
+    }
+}
 subdesc(colr_repr) {
     it("sends arguments to the correct _repr function") {
         ColorArg** colrargs = NULL;
@@ -576,4 +576,54 @@ subdesc(colr_replace_matches_all) {
         }
     }
 } // subdesc(colr_replace_matches_all)
+subdesc(colr_re_groups) {
+    it("handles NULL/bad patterns") {
+        assert_null(colr_re_groups(NULL, "(a)", 0, fore(RED)));
+        assert_null(colr_re_groups("a", NULL, 0, fore(RED)));
+        assert_null(colr_re_groups("a", "(a", 0, Colr("", fore(RED))));
+    }
+    it("colorizes each group") {
+        struct {
+            char* s;
+            char* pattern;
+            char* expected;
+        } tests[] = {
+            {"", "([a-z]+)=([a-z]+)", ""},
+            {"none", "([a-z]+)=([a-z]+)", "none"},
+            {"a=b", "([a-z]+)=([a-z]+)", "<1>a" NC "=<2>b" NC},
+            {"key=val, k=v", "([a-z]+)=([a-z]+)", "<1>key" NC "=<2>val" NC ", <1>k" NC "=<2>v" NC},
+            // Unmatched/empty groups are left alone.
+            {"a=", "([a-z]+)=([a-z]*)", "<1>a" NC "="},
+            {"=b", "([a-z]+)?=([a-z]+)", "=<2>b" NC},
+            // Outer groups win.
+            {"ab", "(a(b))", "<1>ab" NC},
+            // Groups without a color are left alone.
+            {"a=b=c", "([a-z])=([a-z])=([a-z])", "<1>a" NC "=<2>b" NC "=c"},
+        };
+        for_each(tests, i) {
+            char* result = colr_re_groups(tests[i].s, tests[i].pattern, 0, "<1>", "<2>");
+            assert_str_eq(result, tests[i].expected, tests[i].s);
+            free(result);
+        }
+    }
+    it("uses ColorArgs/ColorTexts") {
+        char* result = colr_re_groups(
+            "key=value",
+            "([a-z]+)=([a-z]+)",
+            0,
+            fore(BLUE),
+            Colr("ignored", fore(GREEN), style(BRIGHT))
+        );
+        assert_str_eq(
+            result,
+            "\x1b[34mkey" NC "=\x1b[1m\x1b[32mvalue" NC,
+            "Failed on ColorArg/ColorText"
+        );
+        free(result);
+        // NULL skips a group.
+        result = colr_re_groups("key=value", "([a-z]+)=([a-z]+)", 0, NULL, fore(RED));
+        assert_str_eq(result, "key=\x1b[31mvalue" NC, "Failed to skip a group");
+        free(result);
+    }
+} // subdesc(colr_re_groups)
 } // describe(colr_replace_all)
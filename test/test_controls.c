@@ -5,6 +5,21 @@
 */
 #include "test_ColrC.h"
 
+/*! Worker for the ColrProgress_add tests, adds 1000 to a ColrProgress.
+
+    \pi arg The ColrProgress to update.
+    \return `NULL`
+*/
+void* test_progress_worker(void* arg) {
+    ColrProgress* progress = arg;
+    for (size_t i = 0; i < 1000; i++) {
+        ColrProgress_add(progress, 1);
+        // Only one thread draws at a time, the rest skip it.
+        ColrProgress_draw(progress, -1, false);
+    }
+    return NULL;
+}
+
 describe(controls) {
 // Colr_cursor_hide
 subdesc(Colr_cursor_hide) {
@@ -371,6 +386,361 @@ subdesc(Colr_scroll_up) {
         }
     }
 }
+// ColrCmdBuf
+subdesc(ColrCmdBuf) {
+    it("batches controls") {
+        ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+        assert_null(cmdbuf.buf);
+        assert(ColrCmdBuf_cursor_hide(&cmdbuf));
+        assert(ColrCmdBuf_move_up(&cmdbuf, 0));
+        assert(ColrCmdBuf_move_pos(&cmdbuf, 2, 3));
+        assert(ColrCmdBuf_move_forward(&cmdbuf, 4294967295U));
+        assert(ColrCmdBuf_erase_line(&cmdbuf, ALL));
+        assert(ColrCmdBuf_erase_display(&cmdbuf, ALL_MOVE_ERASE));
+        assert(ColrCmdBuf_append_str(&cmdbuf, "text"));
+        assert(ColrCmdBuf_move_return(&cmdbuf));
+        assert(ColrCmdBuf_cursor_show(&cmdbuf));
+        char* expected = (
+            "\x1b[?25l\x1b[1A\x1b[2;3H\x1b[4294967295C\x1b[2K"
+            "\x1b[2J\x1b[3Jtext\r\x1b[?25h"
+        );
+        assert_str_eq(cmdbuf.buf, expected, "Bad batched controls.");
+        assert_size_eq(cmdbuf.length, strlen(expected));
+        // Bad methods are not appended.
+        assert_false(ColrCmdBuf_erase_line(&cmdbuf, ALL_ERASE));
+        assert_false(ColrCmdBuf_erase_display(&cmdbuf, 99));
+        assert_size_eq(cmdbuf.length, strlen(expected));
+        ColrCmdBuf_clear(&cmdbuf);
+        assert_size_eq(cmdbuf.length, 0);
+        assert_str_empty(cmdbuf.buf);
+        // Growth past the initial size.
+        for (size_t i = 0; i < COLR_CMDBUF_SIZE; i++) {
+            assert(ColrCmdBuf_move_column(&cmdbuf, (unsigned int)i));
+        }
+        assert(cmdbuf.cap > COLR_CMDBUF_SIZE);
+        assert_size_eq(cmdbuf.length, strlen(cmdbuf.buf));
+        assert_false(ColrCmdBuf_append(NULL, "x", 1));
+        ColrCmdBuf_free(&cmdbuf);
+        assert_null(cmdbuf.buf);
+        assert_size_eq(cmdbuf.cap, 0);
+        // Does nothing.
+        ColrCmdBuf_free(NULL);
+    }
+    it("flushes with one write") {
+        ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+        assert(ColrCmdBuf_pos_save(&cmdbuf));
+        assert(ColrCmdBuf_scroll_up(&cmdbuf, 2));
+        assert(ColrCmdBuf_pos_restore(&cmdbuf));
+        int fds[2];
+        assert(pipe(fds) == 0);
+        char* expected = "\x1b[s\x1b[2S\x1b[u";
+        assert_size_eq(ColrCmdBuf_flush(&cmdbuf, fds[1]), strlen(expected));
+        assert_size_eq(cmdbuf.length, 0);
+        char buf[64] = {0};
+        assert(read(fds[0], buf, sizeof(buf) - 1) == (ssize_t)strlen(expected));
+        assert_str_eq(buf, expected, "Bad flush output.");
+        // Failed writes keep the data.
+        assert(ColrCmdBuf_scroll_down(&cmdbuf, 1));
+        assert_size_eq(ColrCmdBuf_flush(&cmdbuf, -1), 0);
+        assert_str_eq(cmdbuf.buf, "\x1b[1T", "Failed flush lost data.");
+        close(fds[0]);
+        close(fds[1]);
+        ColrCmdBuf_free(&cmdbuf);
+        assert_size_eq(ColrCmdBuf_flush(&cmdbuf, 1), 0);
+    }
+    it("converts to ColorResult") {
+        ColrCmdBuf cmdbuf = ColrCmdBuf_new();
+        assert_null(ColrCmdBuf_to_ColorResult(&cmdbuf));
+        assert(ColrCmdBuf_move_down(&cmdbuf, 3));
+        assert(ColrCmdBuf_move_back(&cmdbuf, 1));
+        ColorResult* cres = ColrCmdBuf_to_ColorResult(&cmdbuf);
+        assert_not_null(cres);
+        assert_null(cmdbuf.buf);
+        assert_str_eq(ColorResult_to_str(*cres), "\x1b[3B\x1b[1D", "Bad ColorResult.");
+        colr_free(cres);
+    }
+}
+// ColrProgress
+subdesc(ColrProgress) {
+    it("redraws only what changed") {
+        ColrProgress* progress = ColrProgress_new(10, 5, 1);
+        assert_not_null(progress);
+        progress->interval_ns = 0;
+        int fds[2];
+        assert(pipe(fds) == 0);
+        struct {
+            size_t current;
+            char* expected;
+        } tests[] = {
+            {0, "\r[     ]   0%"},
+            // Nothing changed.
+            {0, ""},
+            {1, "\x1b[9G 10%"},
+            {4, "\x1b[2G==\x1b[9G 40%"},
+            {10, "\x1b[4G===\x1b[9G100%"},
+            // Going backwards erases cells.
+            {2, "\x1b[3G    \x1b[9G 20%"},
+        };
+        for_each(tests, i) {
+            ColrProgress_set(progress, tests[i].current);
+            size_t length = ColrProgress_draw(progress, fds[1], false);
+            assert_size_eq_repr(length, strlen(tests[i].expected), tests[i].expected);
+            char buf[64] = {0};
+            if (length) assert(read(fds[0], buf, sizeof(buf) - 1) == (ssize_t)length);
+            assert_str_eq(buf, tests[i].expected, "Bad progress output.");
+        }
+        close(fds[0]);
+        close(fds[1]);
+        ColrProgress_free(progress);
+        // Does nothing.
+        ColrProgress_free(NULL);
+        assert_size_eq(ColrProgress_draw(NULL, 1, true), 0);
+    }
+    it("limits the redraw rate") {
+        ColrProgress* progress = ColrProgress_new(1000, 10, 1);
+        assert_not_null(progress);
+        progress->fill = "#";
+        int fds[2];
+        assert(pipe(fds) == 0);
+        // The first draw is never skipped.
+        assert(ColrProgress_update(progress, 1, fds[1]) > 0);
+        // One redraw per second, these are skipped.
+        for (size_t i = 0; i < 500; i++) {
+            assert_size_eq(ColrProgress_update(progress, 1, fds[1]), 0);
+        }
+        // Forced draws are not skipped.
+        assert(ColrProgress_draw(progress, fds[1], true) > 0);
+        // Completing the bar is not skipped.
+        assert(ColrProgress_update(progress, 500, fds[1]) > 0);
+        char buf[256] = {0};
+        assert(read(fds[0], buf, sizeof(buf) - 1) > 0);
+        char* expected = "\x1b[7G#####\x1b[14G100%";
+        assert_str_contains(buf, expected);
+        assert(ColrProgress_finish(progress, fds[1]) == 1);
+        close(fds[0]);
+        close(fds[1]);
+        ColrProgress_free(progress);
+    }
+}
+// ColrProgress_add
+subdesc(ColrProgress_add) {
+    it("counts from many threads") {
+        ColrProgress* progress = ColrProgress_new(4000, 10, 0);
+        assert_not_null(progress);
+        pthread_t threads[4];
+        for_each(threads, i) {
+            assert(pthread_create(&threads[i], NULL, test_progress_worker, progress) == 0);
+        }
+        for_each(threads, i) {
+            pthread_join(threads[i], NULL);
+        }
+        assert_size_eq(atomic_load(&progress->current), 4000);
+        assert_size_eq(ColrProgress_percent(progress, 4000), 100);
+        assert_size_eq(ColrProgress_filled(progress, 2000), 5);
+        ColrProgress_free(progress);
+    }
+}
+// ColrScreen_render
+subdesc(ColrScreen_render) {
+    it("renders only changed cells") {
+        ColrScreen* screen = ColrScreen_new(1, 10);
+        assert_not_null(screen);
+        assert_size_eq(screen->rows, 1);
+        assert_size_eq(screen->columns, 10);
+        ColrScreen_write_str(screen, 0, 0, "abc", ColrCell_empty());
+        struct {
+            size_t columns[2];
+            char* s[2];
+            char* expected;
+        } tests[] = {
+            // First frame, everything is written.
+            {{0, 0}, {"", NULL}, "\x1b[1;1H\x1b[0mabc       "},
+            // Nothing changed.
+            {{0, 0}, {"", NULL}, ""},
+            {{3, 0}, {"d", NULL}, "\x1b[1;4H\x1b[0md"},
+            // Small gaps are written again.
+            {{0, 2}, {"x", "z"}, "\x1b[1;1H\x1b[0mxbz"},
+            // Large gaps use a cursor move.
+            {{1, 9}, {"w", "y"}, "\x1b[1;2H\x1b[0mw\x1b[7Cy"},
+        };
+        for_each(tests, i) {
+            for (size_t j = 0; j < 2; j++) {
+                if (!tests[i].s[j]) continue;
+                ColrScreen_write_str(screen, 0, tests[i].columns[j], tests[i].s[j], ColrCell_empty());
+            }
+            size_t length = ColrScreen_render(screen);
+            assert_size_eq_repr(length, strlen(tests[i].expected), tests[i].expected);
+            char* rendered = strndup(screen->out.buf ? screen->out.buf : "", length);
+            assert_str_eq(rendered, tests[i].expected, "Bad render.");
+            free(rendered);
+            // Mark the frame as written.
+            memcpy(screen->front, screen->cells, sizeof(ColrCell) * screen->rows * screen->columns);
+            screen->redraw = false;
+        }
+        ColrScreen_free(screen);
+        // Does nothing.
+        ColrScreen_free(NULL);
+        assert_size_eq(ColrScreen_render(NULL), 0);
+    }
+    it("changes colors/styles only when needed") {
+        ColrScreen* screen = ColrScreen_new(1, 4);
+        assert_not_null(screen);
+        ColrScreen_write(screen, 0, 0, Colr("ab", fore(RED)));
+        ColrScreen_write(screen, 0, 2, Colr("c", fore(RED), back(BLUE)));
+        ColrScreen_write(screen, 0, 3, Colr("d", back(BLUE)));
+        size_t length = ColrScreen_render(screen);
+        char* rendered = strndup(screen->out.buf, length);
+        assert_str_eq(
+            rendered,
+            "\x1b[1;1H\x1b[0m\x1b[31mab\x1b[44mc\x1b[0m\x1b[44md\x1b[0m",
+            "Bad color changes."
+        );
+        free(rendered);
+        ColrScreen_free(screen);
+    }
+    it("handles wide characters") {
+        ColrScreen* screen = ColrScreen_new(1, 4);
+        assert_not_null(screen);
+        assert_size_eq(ColrScreen_write_str(screen, 0, 0, "１a", ColrCell_empty()), 2);
+        asserteq(screen->cells[1].codepoint, COLR_CELL_WIDE_CONT);
+        size_t length = ColrScreen_render(screen);
+        char* rendered = strndup(screen->out.buf, length);
+        assert_str_eq(rendered, "\x1b[1;1H\x1b[0m１a ", "Bad wide character render.");
+        free(rendered);
+        memcpy(screen->front, screen->cells, sizeof(ColrCell) * screen->rows * screen->columns);
+        screen->redraw = false;
+        // Overwriting the right half clears the left half.
+        ColrScreen_write_str(screen, 0, 1, "b", ColrCell_empty());
+        asserteq(screen->cells[0].codepoint, 0);
+        length = ColrScreen_render(screen);
+        rendered = strndup(screen->out.buf, length);
+        assert_str_eq(rendered, "\x1b[1;1H\x1b[0m b", "Bad wide character overwrite.");
+        free(rendered);
+        // Wide characters don't fit in the last column.
+        assert_size_eq(ColrScreen_write_str(screen, 0, 3, "１", ColrCell_empty()), 0);
+        ColrScreen_free(screen);
+    }
+}
+// ColrScreen_set
+subdesc(ColrScreen_set) {
+    it("rejects bad cells") {
+        ColrScreen* screen = ColrScreen_new(2, 3);
+        assert_not_null(screen);
+        ColrCell cell = ColrCell_empty();
+        cell.codepoint = 'x';
+        assert(ColrScreen_set(screen, 1, 2, cell));
+        assert_false(ColrScreen_set(NULL, 0, 0, cell));
+        assert_false(ColrScreen_set(screen, 2, 0, cell));
+        assert_false(ColrScreen_set(screen, 0, 3, cell));
+        cell.codepoint = '\t';
+        assert_false(ColrScreen_set(screen, 0, 0, cell));
+        cell.codepoint = COLR_CELL_WIDE_CONT;
+        assert_false(ColrScreen_set(screen, 0, 0, cell));
+        // Combining characters.
+        cell.codepoint = 0x0301;
+        assert_false(ColrScreen_set(screen, 0, 0, cell));
+        ColrScreen_free(screen);
+    }
+}
+// ColrScreen_write_str
+subdesc(ColrScreen_write_str) {
+    it("handles newlines, escape codes, and overflow") {
+        ColrScreen* screen = ColrScreen_new(2, 3);
+        assert_not_null(screen);
+        assert_size_eq(ColrScreen_write_str(screen, 0, 1, "a\x1b[31mbcd\nef", ColrCell_empty()), 4);
+        uint32_t expected[] = {0, 'a', 'b', 0, 'e', 'f'};
+        for_each(expected, i) {
+            asserteq(screen->cells[i].codepoint, expected[i]);
+        }
+        ColrScreen_clear(screen);
+        for_each(expected, i) {
+            asserteq(screen->cells[i].codepoint, 0);
+        }
+        assert_size_eq(ColrScreen_write_str(NULL, 0, 0, "a", ColrCell_empty()), 0);
+        assert_size_eq(ColrScreen_write(screen, 0, 0, NULL), 0);
+        ColrScreen_free(screen);
+    }
+}
+// ColrScreen_resize
+subdesc(ColrScreen_resize) {
+    it("keeps cells that fit") {
+        ColrScreen* screen = ColrScreen_new(2, 3);
+        assert_not_null(screen);
+        ColrScreen_write_str(screen, 0, 0, "abc\nd１", ColrCell_empty());
+        assert(ColrScreen_resize(screen, 3, 2));
+        assert(screen->redraw);
+        uint32_t expected[] = {'a', 'b', 'd', 0, 0, 0};
+        for_each(expected, i) {
+            asserteq(screen->cells[i].codepoint, expected[i]);
+        }
+        assert_false(ColrScreen_resize(NULL, 1, 1));
+        ColrScreen_free(screen);
+        // Terminal size is used for 0.
+        screen = ColrScreen_new(0, 0);
+        assert_not_null(screen);
+        TermSize ts = colr_term_size();
+        assert_size_eq(screen->rows, ts.rows);
+        assert_size_eq(screen->columns, ts.columns);
+        ColrScreen_free(screen);
+    }
+}
+// ColrScreen_flush
+subdesc(ColrScreen_flush) {
+    it("writes the frame once") {
+        ColrScreen* screen = ColrScreen_new(2, 2);
+        assert_not_null(screen);
+        ColrScreen_write(screen, 1, 0, Colr("ok", style(BRIGHT)));
+        int fds[2];
+        assert(pipe(fds) == 0);
+        size_t length = ColrScreen_flush(screen, fds[1]);
+        char* expected = "\x1b[1;1H\x1b[0m  \x1b[2;1H\x1b[1mok\x1b[0m";
+        assert_size_eq(length, strlen(expected));
+        char buf[128] = {0};
+        assert(read(fds[0], buf, sizeof(buf) - 1) == (ssize_t)length);
+        assert_str_eq(buf, expected, "Bad flush output.");
+        assert_false(screen->redraw);
+        // Nothing changed.
+        assert_size_eq(ColrScreen_flush(screen, fds[1]), 0);
+        // Failed writes force a redraw.
+        ColrScreen_write_str(screen, 0, 0, "x", ColrCell_empty());
+        assert_size_eq(ColrScreen_flush(screen, -1), 0);
+        assert(screen->redraw);
+        close(fds[0]);
+        close(fds[1]);
+        assert_size_eq(ColrScreen_flush(NULL, 1), 0);
+        ColrScreen_free(screen);
+    }
+}
+// ColrSpinner
+subdesc(ColrSpinner) {
+    it("rewrites only the frame") {
+        ColrSpinner* spinner = ColrSpinner_new("Loading", 1);
+        assert_not_null(spinner);
+        spinner->frames = "ab";
+        int fds[2];
+        assert(pipe(fds) == 0);
+        assert_size_eq(ColrSpinner_draw(spinner, fds[1]), strlen("\ra Loading"));
+        // Too soon.
+        assert_size_eq(ColrSpinner_draw(spinner, fds[1]), 0);
+        spinner->interval_ns = 0;
+        assert(ColrSpinner_draw(spinner, fds[1]) > 0);
+        assert(ColrSpinner_draw(spinner, fds[1]) > 0);
+        assert(ColrSpinner_finish(spinner, fds[1]) > 0);
+        char buf[128] = {0};
+        assert(read(fds[0], buf, sizeof(buf) - 1) > 0);
+        assert_str_eq(
+            buf,
+            "\ra Loading\x1b[1Gb\x1b[1Ga\x1b[2K\r",
+            "Bad spinner output."
+        );
+        close(fds[0]);
+        close(fds[1]);
+        ColrSpinner_free(spinner);
+        // Does nothing.
+        ColrSpinner_free(NULL);
+        assert_size_eq(ColrSpinner_draw(NULL, 1), 0);
+    }
+}
 // EraseMethod_to_str
 subdesc(EraseMethod_to_str) {
     it("handles bad EraseMethods") {
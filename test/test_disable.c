@@ -0,0 +1,65 @@
+/* Tests for the COLR_DISABLE configuration.
+    These are only built with `make testdisable` (-DCOLR_DISABLE), which builds
+    a separate executable with colr.c, because every other test expects colors.
+
+    -Christopher Welborn 10-18-2026
+*/
+
+#include "test_ColrC.h"
+
+#ifdef COLR_DISABLE
+describe(COLR_DISABLE) {
+subdesc(colr_is_disabled) {
+    it("is disabled by default") {
+        assert(colr_is_disabled());
+    }
+}
+subdesc(fore) {
+    it("returns the shared ColorArg") {
+        ColorArg* cargs[] = {
+            fore(RED),
+            back(rgb(255, 0, 0)),
+            style(BRIGHT),
+            fore(ext(35)),
+        };
+        for_each(cargs, i) {
+            assert(cargs[i] == &colr_disabled_arg);
+            assert(ColorArg_is_ptr(cargs[i]));
+            assert(ColorArg_is_empty(*cargs[i]));
+            // It is never freed.
+            ColorArg_free(cargs[i]);
+            colr_free(cargs[i]);
+        }
+    }
+}
+subdesc(colr_cat) {
+    it("writes only text") {
+        ColorArg* carg = fore(RED);
+        char* s = colr_cat(carg, "a", Colr("b", fore(BLUE), style(BRIGHT)), back(WHITE), "c");
+        assert_str_eq(s, "abc", "Colors were not disabled.");
+        free(s);
+        s = colr_join(fore(RED), "a", "b");
+        assert_str_eq(s, "ab", "The ColorArg joiner was not empty.");
+        free(s);
+    }
+}
+subdesc(Colr) {
+    it("creates ColorTexts without colors") {
+        ColorText* ctext = Colr("test", fore(RED), back(BLUE), style(UNDERLINE));
+        assert_not_null(ctext);
+        char* s = ColorText_to_str(*ctext);
+        assert_str_eq(s, "test", "ColorText was not plain.");
+        free(s);
+        ColorText_free(ctext);
+        ColorText ctexta = Colra("test", fore(RED));
+        s = ColorText_to_str(ctexta);
+        assert_str_eq(s, "test", "ColorText was not plain.");
+        free(s);
+        ColorText_free_args(&ctexta);
+    }
+}
+}
+
+// Main entry point, for the COLR_DISABLE tests.
+snow_main();
+#endif // COLR_DISABLE
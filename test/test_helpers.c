@@ -6,6 +6,23 @@
 
 #include "test_helpers.h"
 
+//! Barrier for test_re_cache_worker(), so the threads miss at the same time.
+pthread_barrier_t test_re_cache_barrier;
+
+/*! Acquire and release the same pattern a few times, from several threads.
+
+    \pi arg Unused.
+    \return `NULL`
+*/
+void* test_re_cache_worker(void* arg) {
+    (void)arg;
+    pthread_barrier_wait(&test_re_cache_barrier);
+    for (size_t i = 0; i < 100; i++) {
+        colr_re_cache_release(colr_re_cache_acquire("((ab|cd)+[0-9]?){1,20}x", 0));
+    }
+    return NULL;
+}
+
 describe(helpers) {
 // _colr_ptr_repr
 subdesc(_colr_ptr_repr) {
@@ -342,6 +359,40 @@ subdesc(colr_check_marker) {
         }
     }
 }
+// colr_codepoint_width
+subdesc(colr_codepoint_width) {
+    it("detects display widths") {
+        struct {
+            uint32_t codepoint;
+            int expected;
+        } tests[] = {
+            // ASCII is always 1.
+            {'\0', 1},
+            {'\n', 1},
+            {'a', 1},
+            {0xe9, 1}, // é
+            {0x2bb0, 1}, // ⮰
+            // Combining marks, and zero-width chars.
+            {0x0301, 0},
+            {0x200b, 0},
+            {0x200d, 0},
+            {0xfe0f, 0},
+            {0xe0100, 0},
+            // Wide and full-width chars.
+            {0x1100, 2},
+            {0x4e00, 2},
+            {0x9fff, 2},
+            {0xff11, 2}, // １
+            {0x1f600, 2}, // 😀
+            {0x20000, 2},
+            // Outside of the table.
+            {0x10fffd, 1},
+        };
+        for_each(tests, i) {
+            asserteq(colr_codepoint_width(tests[i].codepoint), tests[i].expected);
+        }
+    }
+}
 // colr_empty_str
 subdesc(colr_empty_str) {
     it("sanity check for colr_empty_str()") {
@@ -351,6 +402,18 @@ subdesc(colr_empty_str) {
     }
 }
 // colr_free_argsv
+subdesc(colr_fmt_uchar) {
+    it("writes digits like printf") {
+        for (unsigned int i = 0; i < 256; i++) {
+            char expected[4];
+            snprintf(expected, sizeof(expected), "%d", i);
+            char digits[4] = {0};
+            char* end = colr_fmt_uchar(digits, (unsigned char)i);
+            assert_size_eq((size_t)(end - digits), strlen(expected));
+            assert_str_eq(digits, expected, "Digits don't match.");
+        }
+    }
+}
 subdesc(colr_free_argsv) {
     it("only releases ColrC objects") {
         // Run this through valgrind to check for leaks and other violations.
@@ -406,16 +469,69 @@ subdesc(colr_supports_rgb) {
 subdesc(colr_supports_rgb_static) {
     it("detects rgb support, with only 1 environment check") {
         char* original = getenv("COLORTERM");
-        setenv("COLORTERM", "truecolor", 1);
         bool is_supported = colr_supports_rgb_static();
-        assert(is_supported);
-        // Set a bad environment var value.
-        setenv("COLORTERM", "NOTAVALIDVALUE", 1);
-        // This should still succeed. Even though the environment changed,
-        // we stored the result of the previous call.
-        assert(colr_supports_rgb_static());
+        asserteq(is_supported, (colr_term_caps().depth == DEPTH_RGB));
+        // Set a different environment var value.
+        setenv("COLORTERM", is_supported ? "NOTAVALIDVALUE" : "truecolor", 1);
+        // This should still be the same. Even though the environment changed,
+        // we stored the result of the first call.
+        asserteq(colr_supports_rgb_static(), is_supported);
         // Reset the original value, just in case.
-        if (original) setenv("COLORTERM", original, 1);
+        if (original) setenv("COLORTERM", original, 1); else unsetenv("COLORTERM");
+    }
+}
+// colr_term_caps
+subdesc(colr_term_caps) {
+    it("only probes once") {
+        ColrTermCaps caps = colr_term_caps();
+        char* original = getenv("NO_COLOR");
+        setenv("NO_COLOR", caps.disabled ? "" : "1", 1);
+        ColrTermCaps again = colr_term_caps();
+        asserteq(again.disabled, caps.disabled);
+        asserteq(again.depth, caps.depth);
+        asserteq(again.is_tty, caps.is_tty);
+        if (original) setenv("NO_COLOR", original, 1); else unsetenv("NO_COLOR");
+    }
+}
+// ColrTermCaps_probe
+subdesc(ColrTermCaps_probe) {
+    it("detects capabilities") {
+        char* names[] = {"NO_COLOR", "TERM", "COLORTERM"};
+        char* originals[array_length(names)];
+        for_each(names, i) {
+            char* value = getenv(names[i]);
+            originals[i] = value ? strdup(value) : NULL;
+        }
+        struct {
+            char* no_color;
+            char* term;
+            char* colorterm;
+            ColrColorDepth depth;
+            bool disabled;
+        } tests[] = {
+            {NULL, NULL, NULL, DEPTH_BASIC, false},
+            {NULL, "xterm", NULL, DEPTH_BASIC, false},
+            {NULL, "xterm-256color", NULL, DEPTH_EXTENDED, false},
+            {NULL, "xterm-256color", "truecolor", DEPTH_RGB, false},
+            {NULL, "xterm", "24bit", DEPTH_RGB, false},
+            {NULL, "dumb", "truecolor", DEPTH_NONE, true},
+            {"", "xterm", NULL, DEPTH_BASIC, false},
+            {"1", "xterm-256color", NULL, DEPTH_EXTENDED, true},
+        };
+        for_each(tests, i) {
+            char* values[] = {tests[i].no_color, tests[i].term, tests[i].colorterm};
+            for (size_t j = 0; j < array_length(names); j++) {
+                if (values[j]) setenv(names[j], values[j], 1); else unsetenv(names[j]);
+            }
+            ColrTermCaps caps = ColrTermCaps_probe(-1);
+            asserteq(caps.depth, tests[i].depth);
+            asserteq(caps.disabled, tests[i].disabled);
+            assert_false(caps.is_tty);
+        }
+        for_each(names, i) {
+            if (originals[i]) setenv(names[i], originals[i], 1); else unsetenv(names[i]);
+            free(originals[i]);
+        }
     }
 }
 // colr_term_size
@@ -429,6 +545,37 @@ subdesc(TermSize) {
         assert(ts.rows > 0);
         assert(ts.columns > 0);
     }
+    it("colr_term_size: caches the size") {
+        // A bad file descriptor makes colr_win_size() use the environment.
+        colr_term_size_set_fd(-1);
+        if (setenv("COLUMNS", "77", 1)) perror("can't set COLUMNS for testing");
+        if (setenv("LINES", "22", 1)) perror("can't set LINES for testing");
+        TermSize ts = colr_term_size();
+        asserteq(ts.columns, 77);
+        asserteq(ts.rows, 22);
+        // Not queried again until it is invalidated.
+        if (setenv("COLUMNS", "66", 1)) perror("can't set COLUMNS for testing");
+        asserteq(colr_term_size().columns, 77);
+        colr_term_size_invalidate();
+        asserteq(colr_term_size().columns, 66);
+        // SIGWINCH invalidates it, when watching.
+        if (setenv("COLUMNS", "55", 1)) perror("can't set COLUMNS for testing");
+        assert(colr_term_size_watch(true));
+        assert(colr_term_size_watch(true));
+        asserteq(colr_term_size().columns, 55);
+        if (setenv("COLUMNS", "44", 1)) perror("can't set COLUMNS for testing");
+        assert(raise(SIGWINCH) == 0);
+        asserteq(colr_term_size().columns, 44);
+        assert(colr_term_size_watch(false));
+        // Not watching anymore.
+        if (setenv("COLUMNS", "33", 1)) perror("can't set COLUMNS for testing");
+        assert(raise(SIGWINCH) == 0);
+        asserteq(colr_term_size().columns, 44);
+        // Back to normal.
+        if (unsetenv("COLUMNS")) perror("can't unset COLUMNS for testing");
+        if (unsetenv("LINES")) perror("can't unset LINES for testing");
+        colr_term_size_set_fd(0);
+    }
     it("colr_win_size: doesn't crash") {
         // Not sure how to test this, at least the scaffolding will be here
         // when I find out.
@@ -469,7 +616,92 @@ subdesc(TermSize) {
         free(repr);
     }
 }
+// colr_locale_is_utf8
+subdesc(colr_locale_is_utf8) {
+    it("detects utf-8 locales") {
+        // The test locale is either the default "C" locale, with a UTF-8 (or
+        // empty) environment, or a UTF-8 locale.
+        assert(colr_locale_is_utf8());
+    }
+}
 // colr_mb_len
+subdesc(colr_fwrite_pad) {
+    it("writes any amount of padding") {
+        char pads[] = {' ', '-'};
+        size_t counts[] = {0, 1, 63, 64, 65, 200};
+        for_each(pads, i) {
+            for (size_t j = 0; j < array_length(counts); j++) {
+                char* written = NULL;
+                size_t written_len = 0;
+                FILE* out = open_memstream(&written, &written_len);
+                assert_not_null(out);
+                assert_size_eq(colr_fwrite_pad(out, pads[i], counts[j]), counts[j]);
+                fclose(out);
+                assert_size_eq(written_len, counts[j]);
+                for (size_t k = 0; k < written_len; k++) asserteq(written[k], pads[i]);
+                free(written);
+            }
+        }
+        assert_size_eq(colr_fwrite_pad(NULL, ' ', 5), 0);
+    }
+}
+subdesc(colr_fwrite_text) {
+    it("strips codes on the fly") {
+        struct {
+            char* s;
+            size_t length;
+            bool strip;
+            char* expected;
+        } tests[] = {
+            {"\x1b[31mred\x1b[0m", 12, false, "\x1b[31mred\x1b[0m"},
+            {"\x1b[31mred\x1b[0m", 12, true, "red"},
+            {"\x1b[31mred\x1b[0m", 7, true, "re"},
+            {"a\x1b[1mb\x1b[0m\n\n", 10, true, "ab"},
+            {"plain", 5, true, "plain"},
+            {"plain", 0, true, ""},
+        };
+        for_each(tests, i) {
+            char* written = NULL;
+            size_t written_len = 0;
+            FILE* out = open_memstream(&written, &written_len);
+            assert_not_null(out);
+            size_t length = colr_fwrite_text(out, tests[i].s, tests[i].length, tests[i].strip);
+            fclose(out);
+            assert_size_eq(length, strlen(tests[i].expected));
+            assert_str_eq(written, tests[i].expected, tests[i].s);
+            free(written);
+        }
+        assert_size_eq(colr_fwrite_text(NULL, "a", 1, false), 0);
+    }
+}
+subdesc(colr_mb_char_len) {
+    it("handles split characters") {
+        struct {
+            char* s;
+            size_t length;
+            size_t expected;
+        } tests[] = {
+            {NULL, 1, 0},
+            {"a", 0, 0},
+            {"a", 1, 1},
+            {"", 1, 1},
+            {"\xc3\xa9", 1, 0},
+            {"\xc3\xa9", 2, 2},
+            {"\xe6\x97\xa5", 2, 0},
+            {"\xe6\x97\xa5", 3, 3},
+            {"\xf0\x9f\x98\x80", 3, 0},
+            {"\xf0\x9f\x98\x80x", 5, 4},
+            // Invalid utf-8.
+            {"\xc3\x28", 2, -1},
+            {"\xff", 1, -1},
+            {"\x80", 1, -1},
+        };
+        for_each(tests, i) {
+            size_t length = colr_mb_char_len(tests[i].s, tests[i].length);
+            assert_size_eq_repr(length, tests[i].expected, tests[i].s);
+        }
+    }
+}
 subdesc(colr_mb_len) {
     it("handles NULL") {
         size_t widths[] = {
@@ -515,6 +747,10 @@ subdesc(colr_mb_len) {
             {"１３３７", 4, 12},
             // A char_len that is too large is okay. It's basically strlen().
             {"１３３７", 100, 12},
+            // Mixed single and multibyte chars.
+            {"１a３７", 2, 4},
+            {"a１３７", 2, 4},
+            {"a😀b", 3, 6},
             // Calling colr_mb_len on an ascii string is like calling strlen().
             {"test", 1, 1},
             {"test", 2, 2},
@@ -535,6 +771,99 @@ subdesc(colr_mb_len) {
         );
     }
 }
+// colr_re_cache
+subdesc(colr_re_cache) {
+    it("handles NULL/bad patterns") {
+        assert_null(colr_re_cache_acquire(NULL, 0));
+        assert_null(colr_re_cache_acquire("(bad", 0));
+        // Does nothing.
+        colr_re_cache_release(NULL);
+    }
+    it("caches compiled patterns") {
+        colr_re_cache_clear();
+        regex_t* repat = colr_re_cache_acquire("fo+", 0);
+        assert_not_null(repat);
+        regex_t* again = colr_re_cache_acquire("fo+", 0);
+        assert(again == repat);
+        // Flags are part of the key.
+        regex_t* icase = colr_re_cache_acquire("fo+", REG_ICASE);
+        assert_not_null(icase);
+        assert(icase != repat);
+        ColrRegexCacheStats stats = colr_re_cache_stats();
+        assert_size_eq(stats.hits, 1);
+        assert_size_eq(stats.misses, 2);
+        assert_size_eq(stats.count, 2);
+        regmatch_t match;
+        assert(regexec(icase, "a FOO", 1, &match, 0) == 0);
+        asserteq(match.rm_so, 2);
+        colr_re_cache_release(repat);
+        colr_re_cache_release(again);
+        colr_re_cache_release(icase);
+        colr_re_cache_clear();
+        stats = colr_re_cache_stats();
+        assert_size_eq(stats.hits, 0);
+        assert_size_eq(stats.misses, 0);
+        assert_size_eq(stats.count, 0);
+    }
+    it("evicts least recently used patterns") {
+        colr_re_cache_clear();
+        colr_re_cache_set_capacity(2);
+        colr_re_cache_release(colr_re_cache_acquire("a", 0));
+        colr_re_cache_release(colr_re_cache_acquire("b", 0));
+        // "a" becomes the most recently used, so "b" is evicted.
+        colr_re_cache_release(colr_re_cache_acquire("a", 0));
+        // Patterns that are evicted while in use are still usable.
+        regex_t* inuse = colr_re_cache_acquire("c", 0);
+        colr_re_cache_release(colr_re_cache_acquire("d", 0));
+        colr_re_cache_release(colr_re_cache_acquire("e", 0));
+        assert(regexec(inuse, "abc", 0, NULL, 0) == 0);
+        colr_re_cache_release(inuse);
+        ColrRegexCacheStats stats = colr_re_cache_stats();
+        assert_size_eq(stats.count, 2);
+        assert_size_eq(stats.capacity, 2);
+        colr_re_cache_release(colr_re_cache_acquire("e", 0));
+        colr_re_cache_release(colr_re_cache_acquire("b", 0));
+        stats = colr_re_cache_stats();
+        assert_size_eq(stats.hits, 2);
+        assert_size_eq(stats.misses, 6);
+        // Caching can be disabled.
+        colr_re_cache_set_capacity(0);
+        regex_t* uncached = colr_re_cache_acquire("a", 0);
+        assert_not_null(uncached);
+        colr_re_cache_release(uncached);
+        assert_size_eq(colr_re_cache_stats().count, 0);
+        colr_re_cache_set_capacity(COLR_RE_CACHE_SIZE);
+        colr_re_cache_clear();
+    }
+    it("caches a pattern once when threads miss at the same time") {
+        for (size_t attempt = 0; attempt < 20; attempt++) {
+            colr_re_cache_clear();
+            pthread_t threads[4];
+            pthread_barrier_init(&test_re_cache_barrier, NULL, 4);
+            for_each(threads, i) {
+                assert(pthread_create(&threads[i], NULL, test_re_cache_worker, NULL) == 0);
+            }
+            for_each(threads, i) {
+                pthread_join(threads[i], NULL);
+            }
+            pthread_barrier_destroy(&test_re_cache_barrier);
+            assert_size_eq(colr_re_cache_stats().count, 1);
+        }
+        colr_re_cache_clear();
+    }
+    it("is used by colr_str_replace_re") {
+        colr_re_cache_clear();
+        for (size_t i = 0; i < 3; i++) {
+            char* result = colr_str_replace_re_all("a foo foo", "fo+", "bar", 0);
+            assert_str_eq(result, "a bar bar", "Cached pattern failed to replace.");
+            free(result);
+        }
+        ColrRegexCacheStats stats = colr_re_cache_stats();
+        assert_size_eq(stats.hits, 2);
+        assert_size_eq(stats.misses, 1);
+        colr_re_cache_clear();
+    }
+}
 // colr_str_array_contains
 subdesc(colr_str_array_contains) {
     it("detects str list elements") {
@@ -613,6 +942,8 @@ subdesc(colr_str_center) {
             {"aa", 0, 4, " aa "},
             {"aaa", ' ', 4, " aaa"},
             {"aaaa  ", ' ', 10, "  aaaa    "},
+            {"１３", ' ', 7, "  １３ "},
+            {"e\xcc\x81", ' ', 3, " e\xcc\x81 "},
             {FORE_CODE_BASIC "a", ' ', 4, "  " FORE_CODE_BASIC "a "},
             {FORE_CODE_EXT "a", ' ', 4, "  " FORE_CODE_EXT "a "},
             {FORE_CODE_RGB "a", ' ', 4, "  " FORE_CODE_RGB "a "},
@@ -845,6 +1176,30 @@ subdesc(colr_str_copy) {
         free(dest);
     }
 }
+// colr_str_display_width
+subdesc(colr_str_display_width) {
+    it("counts display columns") {
+        struct {
+            char* s;
+            size_t expected;
+        } tests[] = {
+            {NULL, 0},
+            {"", 0},
+            {"test", 4},
+            {FORE_CODE_RGB "test" STYLE_CODE_RESET, 4},
+            {"１３３７", 8},
+            {FORE_CODE_BASIC "１３" BACK_CODE_EXT "３７" STYLE_CODE_RESET, 8},
+            {"e\xcc\x81", 1},
+            {"😀 test", 7},
+            {"⮰test⮵", 6},
+            // Invalid bytes are 1 column each.
+            {"\xff\xfe", 2},
+        };
+        for_each(tests, i) {
+            assert_size_eq_repr(colr_str_display_width(tests[i].s), tests[i].expected, tests[i].s);
+        }
+    }
+}
 // colr_str_ends_with
 subdesc(colr_str_ends_with) {
     it("detects string endings") {
@@ -1164,6 +1519,7 @@ subdesc(colr_str_ljust) {
             {"", 0, 4, "    "},
             {"a", 0, 1, "a"},
             {"a", 0, 4, "a   "},
+            {"１３", 0, 6, "１３  "},
             {"aa", 0, 4, "aa  "},
             {"aaa", ' ', 4, "aaa "},
             {"aaaa  ", ' ', 10, "aaaa      "},
@@ -1473,6 +1829,7 @@ subdesc(colr_str_rjust) {
             {"", 0, 4, "    "},
             {"a", 0, 1, "a"},
             {"a", 0, 4, "   a"},
+            {"１３", 0, 6, "  １３"},
             {"aa", 0, 4, "  aa"},
             {"aaa", ' ', 4, " aaa"},
             {"aaaa  ", ' ', 10, "    aaaa  "},
@@ -1601,6 +1958,24 @@ subdesc(colr_str_strip_codes) {
             free(stripped);
         }
     }
+    it("strips a length with colr_str_strip_codes_n") {
+        char* s = FORE_CODE_BASIC "test" BACK_CODE_RGB "more" STYLE_CODE_UL;
+        struct {
+            size_t length;
+            char* expected;
+        } tests[] = {
+            {0, ""},
+            {strlen(FORE_CODE_BASIC) - 1, "\x1b[31"},
+            {strlen(FORE_CODE_BASIC) + 2, "te"},
+            {strlen(s), "testmore"},
+        };
+        for_each(tests, i) {
+            char* stripped = colr_str_strip_codes_n(s, tests[i].length);
+            assert_str_eq(stripped, tests[i].expected, "Failed to strip codes");
+            free(stripped);
+        }
+        assert_null(colr_str_strip_codes_n(NULL, 1));
+    }
 }
 // colr_str_to_lower
 subdesc(colr_str_to_lower) {
@@ -1629,4 +2004,77 @@ subdesc(colr_str_to_lower) {
         }
     }
 }
+// colr_utf8_decode
+subdesc(colr_utf8_decode) {
+    it("decodes utf-8 chars") {
+        struct {
+            char* s;
+            size_t expected;
+            uint32_t codepoint;
+        } tests[] = {
+            {"", 0, 0},
+            {"a", 1, 'a'},
+            {"\x7f", 1, 0x7f},
+            {"\xc2\x80", 2, 0x80},
+            {"é", 2, 0xe9},
+            {"１", 3, 0xff11},
+            {"⮰test", 3, 0x2bb0},
+            {"\xef\xbf\xbf", 3, 0xffff},
+            {"😀", 4, 0x1f600},
+            {"\xf4\x8f\xbf\xbf", 4, 0x10ffff},
+        };
+        for_each(tests, i) {
+            uint32_t codepoint = 1337;
+            size_t length = colr_utf8_decode(tests[i].s, &codepoint);
+            assert_size_eq_repr(length, tests[i].expected, tests[i].s);
+            assert(codepoint == tests[i].codepoint);
+            // The codepoint is optional.
+            assert_size_eq_repr(colr_utf8_decode(tests[i].s, NULL), tests[i].expected, tests[i].s);
+        }
+        assert_size_eq(colr_utf8_decode(NULL, NULL), 0);
+    }
+    it("detects invalid utf-8 chars") {
+        char* tests[] = {
+            // Continuation bytes.
+            "\x80",
+            "\xbf",
+            // Overlong encodings.
+            "\xc0\xaf",
+            "\xc1\xbf",
+            "\xe0\x80\xaf",
+            "\xf0\x80\x80\xaf",
+            // Surrogates.
+            "\xed\xa0\x80",
+            // Above U+10FFFF.
+            "\xf4\x90\x80\x80",
+            "\xf5\x80\x80\x80",
+            "\xff",
+            // Bad/missing continuation bytes.
+            "\xc3\x28",
+            "\xe2\x28\xa1",
+            "\xe2\x82",
+            "\xf0\x9f\x98",
+        };
+        for_each(tests, i) {
+            assert_size_eq_repr(colr_utf8_decode(tests[i], NULL), (size_t)-1, tests[i]);
+        }
+    }
+}
+// colr_utf8_encode
+subdesc(colr_utf8_encode) {
+    it("encodes utf-8 chars") {
+        char* tests[] = {"a", "\x7f", "\xc2\x80", "é", "１", "\xef\xbf\xbf", "😀", "\xf4\x8f\xbf\xbf"};
+        for_each(tests, i) {
+            uint32_t codepoint = 0;
+            size_t length = colr_utf8_decode(tests[i], &codepoint);
+            char encoded[5] = {0};
+            assert_size_eq_repr(colr_utf8_encode(encoded, codepoint), length, tests[i]);
+            assert_str_eq(encoded, tests[i], "Round-trip failed.");
+        }
+        char dest[4];
+        assert_size_eq(colr_utf8_encode(NULL, 'a'), 0);
+        assert_size_eq(colr_utf8_encode(dest, 0xD800), 0);
+        assert_size_eq(colr_utf8_encode(dest, 0x110000), 0);
+    }
+}
 }
@@ -6,6 +6,271 @@
 #include "test_ColrC.h"
 
 describe(rainbow) {
+subdesc(ColrRainbow) {
+    it("handles NULL") {
+        assert_null(ColrRainbow_new(NULL, 0.1, 1, 1));
+        assert_null(ColrRainbow_code(NULL, 1, NULL));
+        assert(colr_eq(ColrRainbow_rgb(NULL, 1), rgb(0, 0, 0)));
+        // Does nothing.
+        ColrRainbow_seed(NULL, 1);
+        ColrRainbow_free(NULL);
+    }
+    it("matches rainbow_step") {
+        double freqs[] = {0.0, 0.1, 0.3, 1.0, 2.7, 13.0};
+        size_t starts[] = {0, 1, 99, 123456789};
+        // Small steps are rotated, the others are computed with sin().
+        size_t deltas[] = {0, 1, 2, 3, 4, 7, 1, 16, 17, 1, 100};
+        for_each(freqs, i) {
+            for (size_t j = 0; j < array_length(starts); j++) {
+                ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, freqs[i], 1, 1);
+                assert_not_null(rainbow);
+                size_t offset = starts[j];
+                for (size_t step = 0; step < 5000; step++) {
+                    RGB expected = rainbow_step(freqs[i], offset);
+                    RGB rgbval = ColrRainbow_rgb(rainbow, offset);
+                    assert(colr_eq(rgbval, expected));
+                    offset += deltas[step % array_length(deltas)];
+                }
+                // Going backwards works too.
+                assert(colr_eq(ColrRainbow_rgb(rainbow, 5), rainbow_step(freqs[i], 5)));
+                ColrRainbow_free(rainbow);
+            }
+        }
+    }
+    it("caches formatted codes") {
+        RGB_fmter fmters[] = {
+            format_bg_RGB,
+            format_bg_RGB_term,
+            format_fg_RGB,
+            format_fg_RGB_term,
+        };
+        for_each(fmters, i) {
+            ColrRainbow* rainbow = ColrRainbow_new(fmters[i], 0.1, 1, 1);
+            char expected[CODE_RGB_LEN];
+            for (size_t offset = 1; offset < 500; offset++) {
+                fmters[i](expected, rainbow_step(0.1, offset));
+                size_t length = 0;
+                const char* code = ColrRainbow_code(rainbow, offset, &length);
+                assert_str_eq(code, expected, "Cached code does not match.");
+                assert_size_eq(length, strlen(expected));
+            }
+            ColrRainbow_free(rainbow);
+        }
+    }
+}
+subdesc(ColrRainbow_feed) {
+    it("handles NULL") {
+        ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, 0.1, 1, 1);
+        assert_false(ColrRainbow_feed(NULL, stdout, "a", 1));
+        assert_false(ColrRainbow_feed(rainbow, NULL, "a", 1));
+        assert_false(ColrRainbow_feed(rainbow, stdout, NULL, 1));
+        assert(ColrRainbow_feed(rainbow, stdout, NULL, 0));
+        assert_false(ColrRainbow_finish(NULL, stdout));
+        assert_false(ColrRainbow_finish(rainbow, NULL));
+        ColrRainbow_free(rainbow);
+    }
+    it("matches _rainbow for any chunk size") {
+        RGB_fmter fmters[] = {
+            format_bg_RGB,
+            format_bg_RGB_term,
+            format_fg_RGB,
+            format_fg_RGB_term,
+        };
+        size_t spreads[] = {1, 3};
+        char* s = "Test \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\n\xf0\x9f\x98\x80 h\xc3\xa9llo.";
+        size_t length = strlen(s);
+        for_each(fmters, i) {
+            for (size_t j = 0; j < array_length(spreads); j++) {
+                char* expected = _rainbow(fmters[i], s, 0.3, 7, spreads[j]);
+                assert_not_null(expected);
+                ColrRainbow* rainbow = ColrRainbow_new(fmters[i], 0.3, 7, spreads[j]);
+                assert_not_null(rainbow);
+                // Chunks split the multibyte characters in every possible place.
+                for (size_t chunk = 1; chunk <= length; chunk++) {
+                    char* written = NULL;
+                    size_t written_len = 0;
+                    FILE* out = open_memstream(&written, &written_len);
+                    assert_not_null(out);
+                    for (size_t pos = 0; pos < length; pos += chunk) {
+                        size_t chunk_len = (length - pos) < chunk ? (length - pos) : chunk;
+                        assert(ColrRainbow_feed(rainbow, out, s + pos, chunk_len));
+                    }
+                    assert(ColrRainbow_finish(rainbow, out));
+                    fclose(out);
+                    assert_str_eq(written, expected, "Fed output does not match _rainbow.");
+                    free(written);
+                }
+                ColrRainbow_free(rainbow);
+                free(expected);
+            }
+        }
+    }
+    it("writes invalid bytes as-is") {
+        char* s = "a\xff\xc3";
+        char* written = NULL;
+        size_t written_len = 0;
+        FILE* out = open_memstream(&written, &written_len);
+        assert_not_null(out);
+        ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, 0.1, 1, 1);
+        assert(ColrRainbow_feed(rainbow, out, s, strlen(s)));
+        // The incomplete character is written when the stream is finished.
+        assert(ColrRainbow_finish(rainbow, out));
+        fclose(out);
+        char* stripped = colr_str_strip_codes(written);
+        assert_str_eq(stripped, s, "Invalid bytes were not written.");
+        free(stripped);
+        free(written);
+        ColrRainbow_free(rainbow);
+    }
+    it("handles invalid bytes split across chunks") {
+        char* strs[] = {
+            "ab\xf0\x9f\x98" "CDxyz\n",
+            "\xf0\x9f" "A\xe6\x97" "\xe6\x97\xa5!",
+            "x\xe2\x82\xf0\x9f\x98\x80\xc3",
+        };
+        for_each(strs, i) {
+            size_t length = strlen(strs[i]);
+            ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, 0.3, 7, 2);
+            assert_not_null(rainbow);
+            // Fed all at once.
+            char* expected = NULL;
+            size_t expected_len = 0;
+            FILE* out = open_memstream(&expected, &expected_len);
+            assert_not_null(out);
+            assert(ColrRainbow_feed(rainbow, out, strs[i], length));
+            assert(ColrRainbow_finish(rainbow, out));
+            fclose(out);
+            char* stripped = colr_str_strip_codes(expected);
+            assert_str_eq(stripped, strs[i], "Bytes were lost.");
+            free(stripped);
+            for (size_t chunk = 1; chunk <= length; chunk++) {
+                char* written = NULL;
+                size_t written_len = 0;
+                out = open_memstream(&written, &written_len);
+                assert_not_null(out);
+                for (size_t pos = 0; pos < length; pos += chunk) {
+                    size_t chunk_len = (length - pos) < chunk ? (length - pos) : chunk;
+                    assert(ColrRainbow_feed(rainbow, out, strs[i] + pos, chunk_len));
+                }
+                assert(ColrRainbow_finish(rainbow, out));
+                fclose(out);
+                assert_str_eq(written, expected, "Split chunks did not match.");
+                free(written);
+            }
+            free(expected);
+            ColrRainbow_free(rainbow);
+        }
+    }
+    it("matches unsplit output for any split") {
+        char* strs[] = {
+            "\xf0\x9f\xc3\xa9",
+            "a\xff\xc3\xa9" "b\xe6\x97\xa5",
+            "\xe2\x82\xc3\xa9\xf0\x9f\x98\x80\x80z",
+        };
+        for_each(strs, i) {
+            size_t length = strlen(strs[i]);
+            ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, 0.3, 7, 1);
+            assert_not_null(rainbow);
+            char* expected = NULL;
+            size_t expected_len = 0;
+            FILE* out = open_memstream(&expected, &expected_len);
+            assert_not_null(out);
+            assert(ColrRainbow_feed(rainbow, out, strs[i], length));
+            assert(ColrRainbow_finish(rainbow, out));
+            fclose(out);
+            // Every way to split it into three chunks, including empty ones.
+            for (size_t first = 0; first <= length; first++) {
+                for (size_t second = first; second <= length; second++) {
+                    char* written = NULL;
+                    size_t written_len = 0;
+                    out = open_memstream(&written, &written_len);
+                    assert_not_null(out);
+                    assert(ColrRainbow_feed(rainbow, out, strs[i], first));
+                    assert(ColrRainbow_feed(rainbow, out, strs[i] + first, second - first));
+                    assert(ColrRainbow_feed(rainbow, out, strs[i] + second, length - second));
+                    assert(ColrRainbow_finish(rainbow, out));
+                    fclose(out);
+                    assert_str_eq(written, expected, "Split chunks did not match.");
+                    free(written);
+                }
+            }
+            free(expected);
+            ColrRainbow_free(rainbow);
+        }
+    }
+}
+subdesc(ColrRainbow_flush) {
+    it("writes pending bytes and keeps the position") {
+        assert_false(ColrRainbow_flush(NULL, stdout));
+        ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, 0.3, 7, 1);
+        assert_not_null(rainbow);
+        assert_false(ColrRainbow_flush(rainbow, NULL));
+        char* written = NULL;
+        size_t written_len = 0;
+        FILE* out = open_memstream(&written, &written_len);
+        assert_not_null(out);
+        // The incomplete character is written before the next line.
+        assert(ColrRainbow_feed(rainbow, out, "ab\xf0", 3));
+        assert(ColrRainbow_flush(rainbow, out));
+        assert_size_eq(rainbow->pending_len, 0);
+        assert(ColrRainbow_feed(rainbow, out, "cd", 2));
+        assert(ColrRainbow_finish(rainbow, out));
+        fclose(out);
+        // Same as feeding it all at once.
+        char* expected = NULL;
+        size_t expected_len = 0;
+        out = open_memstream(&expected, &expected_len);
+        assert_not_null(out);
+        assert(ColrRainbow_feed(rainbow, out, "ab\xf0" "cd", 5));
+        assert(ColrRainbow_finish(rainbow, out));
+        fclose(out);
+        assert_str_eq(written, expected, "Flushed output does not match.");
+        free(expected);
+        free(written);
+        ColrRainbow_free(rainbow);
+    }
+}
+subdesc(ColrRainbow_set_pos) {
+    it("handles NULL") {
+        assert_false(ColrRainbow_set_pos(NULL, 0, 0));
+    }
+    it("matches _rainbow for separate chunks") {
+        size_t spreads[] = {1, 2, 3};
+        // Every chunk ends with a newline, like the colr tool's --jobs chunks.
+        char* chunks[] = {"Test \xe6\x97\xa5\n", "\xf0\x9f\x98\x80 h\xc3\xa9\n", "llo.\n"};
+        char* s = "Test \xe6\x97\xa5\n\xf0\x9f\x98\x80 h\xc3\xa9\nllo.\n";
+        for_each(spreads, i) {
+            char* expected = _rainbow(format_fg_RGB, s, 0.3, 7, spreads[i]);
+            assert_not_null(expected);
+            char* written = NULL;
+            size_t written_len = 0;
+            FILE* out = open_memstream(&written, &written_len);
+            assert_not_null(out);
+            size_t pos = 0;
+            size_t chars = 0;
+            for (size_t j = 0; j < array_length(chunks); j++) {
+                ColrRainbow* rainbow = ColrRainbow_new(format_fg_RGB, 0.3, 7, spreads[i]);
+                assert_not_null(rainbow);
+                assert(ColrRainbow_set_pos(rainbow, pos, chars));
+                size_t chunk_len = strlen(chunks[j]);
+                assert(ColrRainbow_feed(rainbow, out, chunks[j], chunk_len));
+                if (j == (array_length(chunks) - 1)) assert(ColrRainbow_finish(rainbow, out));
+                ColrRainbow_free(rainbow);
+                pos += chunk_len;
+                chars += colr_str_mb_len(chunks[j]);
+            }
+            fclose(out);
+            // _rainbow() puts the reset code before the trailing newline.
+            char* stripped = colr_str_replace(expected, CODE_RESET_ALL, "");
+            char* fed = colr_str_replace(written, CODE_RESET_ALL, "");
+            assert_str_eq(fed, stripped, "Chunked output does not match _rainbow.");
+            free(fed);
+            free(stripped);
+            free(written);
+            free(expected);
+        }
+    }
+}
 subdesc(_rainbow) {
     it("handles NULL strings") {
         char* s = _rainbow(format_fg_RGB, NULL, 0.0, 0, 0);
@@ -35,6 +300,34 @@ subdesc(_rainbow) {
             free(rbow);
         }
     }
+    it("matches rainbow_step output") {
+        char* s = "This is my string.\nWith newlines.";
+        size_t offset = 3;
+        double freq = 0.3;
+        RGB_fmter test_funcs[] = {
+            format_bg_RGB,
+            format_bg_RGB_term,
+            format_fg_RGB,
+            format_fg_RGB_term,
+        };
+        for_each(test_funcs, i) {
+            bool is_back = (test_funcs[i] == format_bg_RGB) || (test_funcs[i] == format_bg_RGB_term);
+            char* expected = calloc(strlen(s) * (CODE_RGB_LEN + CODE_RESET_LEN) + CODE_RESET_LEN, sizeof(char));
+            assert_not_null(expected);
+            char codes[CODE_RGB_LEN];
+            for (size_t j = 0; s[j]; j++) {
+                test_funcs[i](codes, rainbow_step(freq, offset + j));
+                strcat(expected, codes);
+                if (is_back && (s[j] == '\n')) strcat(expected, CODE_RESET_BACK);
+                strncat(expected, s + j, 1);
+            }
+            strcat(expected, CODE_RESET_ALL);
+            char* rbow = _rainbow(test_funcs[i], s, freq, offset, 1);
+            assert_str_eq(rbow, expected, "Rainbow output changed.");
+            free(rbow);
+            free(expected);
+        }
+    }
 }
 // rainbow_bg
 subdesc(rainbow_bg) {
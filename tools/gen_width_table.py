@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+""" gen_width_table.py
+    Generates the two-stage display-width table used by colr_codepoint_width()
+    in colr.c, using Python's `unicodedata` module.
+    -Christopher Welborn 10-18-2026
+"""
+
+import sys
+import unicodedata
+
+# Code points above this use explicit range checks in colr_codepoint_width().
+TABLE_MAX = 0x40000
+BLOCK_SIZE = 256
+# Unassigned code points in these ranges are still wide.
+WIDE_RANGES = (
+    (0x3400, 0x4DBF),
+    (0x4E00, 0x9FFF),
+    (0xF900, 0xFAFF),
+    (0x20000, 0x2FFFD),
+    (0x30000, 0x3FFFD),
+)
+
+
+def char_width(cp):
+    """ Return the display width (0, 1, or 2) for a code point. """
+    if cp < 0x80:
+        # ASCII is handled by the fast path, always 1.
+        return 1
+    c = chr(cp)
+    cat = unicodedata.category(c)
+    if cp == 0x00AD:
+        # Soft hyphen is displayed in most terminals.
+        return 1
+    if cat in ('Mn', 'Me', 'Cf', 'Cc'):
+        return 0
+    if (0x1160 <= cp <= 0x11FF) or (cp == 0x200B):
+        # Hangul medial vowels/final consonants, and zero width space.
+        return 0
+    if unicodedata.east_asian_width(c) in ('W', 'F'):
+        return 2
+    if cat == 'Cn':
+        for start, end in WIDE_RANGES:
+            if start <= cp <= end:
+                return 2
+    return 1
+
+
+def build_tables():
+    """ Build the stage 1 and stage 2 tables. """
+    blocks = []
+    block_index = {}
+    stage1 = []
+    for start in range(0, TABLE_MAX, BLOCK_SIZE):
+        packed = []
+        for i in range(0, BLOCK_SIZE, 4):
+            byte = 0
+            for j in range(4):
+                byte |= char_width(start + i + j) << (j * 2)
+            packed.append(byte)
+        packed = tuple(packed)
+        if packed not in block_index:
+            block_index[packed] = len(blocks)
+            blocks.append(packed)
+        stage1.append(block_index[packed])
+    if len(blocks) > 255:
+        raise ValueError(f'Too many blocks for an unsigned char: {len(blocks)}')
+    return stage1, blocks
+
+
+def format_values(values, indent=4, per_line=16, fmt='{:3}'):
+    """ Format a list of integers as C initializer lines. """
+    lines = []
+    for i in range(0, len(values), per_line):
+        chunk = values[i:i + per_line]
+        lines.append(' ' * indent + ', '.join(fmt.format(v) for v in chunk) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    stage1, blocks = build_tables()
+    print(f'// Generated by tools/gen_width_table.py (Unicode {unicodedata.unidata_version}).')
+    print(f'const unsigned char colr_width_stage1[] = {{')
+    print(format_values(stage1))
+    print('};')
+    print()
+    print(f'const unsigned char colr_width_stage2[][{BLOCK_SIZE // 4}] = {{')
+    for block in blocks:
+        print('    {')
+        print(format_values(block, indent=8, fmt='0x{:02x}'))
+        print('    },')
+    print('};')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -698,9 +698,11 @@ def get_gcc_cmd(
         # Remove linker options from c-file command.
         cmd = [s for s in cmd if not s.startswith('-l')]
     else:
-        # Auto-include libm if colr.o is being compiled.
+        # Auto-include libm and pthreads if colr.o is being compiled.
         if ('colr.o' in input_files) and ('-lm' not in cmd):
             cmd.append('-lm')
+        if ('colr.o' in input_files) and ('-pthread' not in cmd):
+            cmd.append('-pthread')
     cmd.insert(0, compiler)
     return cmd
 